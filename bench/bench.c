@@ -0,0 +1,245 @@
+/**
+ * @file bench.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Mesures de performance de l'IA sur des positions de référence.
+ * @version 0.1
+ * @date 2023-02-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "../src/commun.h"
+#include "../src/ia.h"
+#include "../src/puissance_quatre.h"
+#include "../src/tablebase.h"
+#include "tables.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @def PROFONDEUR_BENCH
+ * @brief la profondeur des recherches mesurées
+ */
+#define PROFONDEUR_BENCH 7
+
+/**
+ * @def PROFONDEUR_ALGORITHMES
+ * @brief la profondeur des recherches qui comparent les algorithmes
+ */
+#define PROFONDEUR_ALGORITHMES 12
+
+/**
+ * @brief Les noms des algorithmes de recherche, dans l'ordre de Algorithme.
+ */
+static const char *algorithmes[] = {"alpha-beta", "PVS", "MTD(f)"};
+
+/**
+ * @brief Les positions de référence : les colonnes jouées (de 1 à 7) depuis le
+ * plateau vide.
+ */
+static const char *positions[] = {"", "4", "44", "4453", "445362", "3344556",
+                                  "12345671234567"};
+
+/**
+ * @brief Des positions tactiques (coups choisis au hasard parmi ceux qui ne
+ * perdent pas tout de suite), résolues par df-pn et par alpha-beta.
+ */
+static const char *tactiques[] = {"7762451365743653317312",
+                                  "1323773644225561331244",
+                                  "7524176556446436744656",
+                                  "1613623771212653444212"};
+
+/**
+ * @brief Les noms des résultats, dans l'ordre de Resultat.
+ */
+static const char *resultats[] = {"inconnu", "perdu", "nul", "gagné"};
+
+/**
+ * @brief Place le jeu dans une position de référence. Le joueur courant est
+ * celui qui doit jouer.
+ *
+ * @param game le jeu
+ * @param coups les colonnes jouées (de 1 à 7)
+ */
+static void jouerPosition(Puissance4 *game, const char *coups) {
+  initGame(game);
+  changerJoueur(game);
+  for (const char *c = coups; *c; c++) {
+    unsigned colonne = *c - '1';
+    modifJeton(game, testColonne(game->plateau, colonne), colonne,
+               game->courant->type);
+    changerJoueur(game);
+  }
+}
+
+/**
+ * @brief Compare l'analyse de toutes les colonnes en une recherche
+ * (analyseColonnes) à sept recherches indépendantes, une par colonne.
+ *
+ * @param game le jeu
+ */
+static void benchAnalyse(Puissance4 *game) {
+  printf("Analyse de toutes les colonnes, profondeur %d\n", PROFONDEUR_BENCH);
+  printf("%-16s %12s %12s %8s\n", "position", "une (s)", "sept (s)", "gain");
+  for (unsigned p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+    jouerPosition(game, positions[p]);
+    reinitialiserIA();
+    double debut = secondes();
+    analyseColonnes(game, PROFONDEUR_BENCH);
+    double une = secondes() - debut;
+
+    double sept = 0;
+    for (unsigned c = 0; c < NB_COLONNE; c++) {
+      int ligne = testColonne(game->plateau, c);
+      if (ligne == -1)
+        continue;
+      reinitialiserIA();
+      modifJeton(game, ligne, c, game->courant->type);
+      changerJoueur(game);
+      debut = secondes();
+      meilleurCoup(game, PROFONDEUR_BENCH - 1);
+      sept += secondes() - debut;
+      changerJoueur(game);
+      modifJeton(game, ligne, c, VIDE);
+    }
+    printf("%-16s %12.4f %12.4f %7.2fx\n",
+           positions[p][0] ? positions[p] : "(vide)", une, sept, sept / une);
+  }
+}
+
+/**
+ * @brief Compare les algorithmes de recherche : positions visitées et durée
+ * d'une recherche complète (tables vidées), et vérifie qu'ils donnent le même
+ * score.
+ *
+ * @param game le jeu
+ * @return true si tous les algorithmes donnent les mêmes scores
+ */
+static bool benchAlgorithmes(Puissance4 *game) {
+  Recherche *r = makeRecherche();
+  if (!r)
+    return false;
+  bool ok = true;
+  double total[sizeof(algorithmes) / sizeof(algorithmes[0])] = {0};
+  unsigned long long noeuds[sizeof(algorithmes) / sizeof(algorithmes[0])] = {0};
+  printf("\nAlgorithmes de recherche, profondeur %d\n",
+         PROFONDEUR_ALGORITHMES);
+  printf("%-16s %-10s %6s %12s %10s %8s %9s\n", "position", "algorithme",
+         "score", "positions", "durée (s)", "gain", "aspiration");
+  for (unsigned p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+    jouerPosition(game, positions[p]);
+    unsigned long long reference = 0;
+    int score = 0;
+    for (unsigned a = 0; a < sizeof(algorithmes) / sizeof(algorithmes[0]);
+         a++) {
+      reinitialiserIA();
+      definirAlgorithme(r, a);
+      double debut = secondes();
+      Couple c = rechercher(r, game, PROFONDEUR_ALGORITHMES);
+      double duree = secondes() - debut;
+      StatsRecherche s = statsRecherche(r);
+      if (a == ALPHABETA) {
+        reference = s.noeuds;
+        score = c.valeur;
+      } else if (c.valeur != score) {
+        ok = false;
+      }
+      total[a] += duree;
+      noeuds[a] += s.noeuds;
+      // re-recherches de la racine sorties de la fenêtre d'aspiration
+      char echecs[16];
+      snprintf(echecs, sizeof(echecs), "%u/%u", s.echecsBas + s.echecsHaut,
+               s.iterations);
+      printf("%-16s %-10s %6d %12llu %10.4f %7.2fx %9s%s\n",
+             a ? "" : (positions[p][0] ? positions[p] : "(vide)"),
+             algorithmes[a], c.valeur, s.noeuds, duree,
+             s.noeuds ? (double)reference / s.noeuds : 0,
+             (a == MTDF) ? "-" : echecs,
+             (c.valeur != score) ? "  SCORE DIFFÉRENT" : "");
+    }
+  }
+  for (unsigned a = 0; a < sizeof(algorithmes) / sizeof(algorithmes[0]); a++)
+    printf("%-16s %-10s %6s %12llu %10.4f %7.2fx\n", a ? "" : "total",
+           algorithmes[a], "", noeuds[a], total[a],
+           noeuds[a] ? (double)noeuds[ALPHABETA] / noeuds[a] : 0);
+  destroyRecherche(r);
+  return ok;
+}
+
+/**
+ * @brief Compare la résolution de positions tactiques par df-pn (algorithme
+ * DFPN, budget illimité) à une recherche alpha-beta complète, et vérifie
+ * qu'elles donnent le même résultat.
+ *
+ * @param game le jeu
+ * @return true si les résultats sont les mêmes
+ */
+static bool benchPreuve(Puissance4 *game) {
+  Recherche *r = makeRecherche();
+  if (!r)
+    return false;
+  definirBudget(r, ~0ULL);
+  bool ok = true;
+  printf("\nRésolution de positions tactiques\n");
+  printf("%-24s %-8s %12s %10s %12s %10s %8s\n", "position", "résultat",
+         "df-pn", "durée (s)", "alpha-beta", "durée (s)", "gain");
+  for (unsigned p = 0; p < sizeof(tactiques) / sizeof(tactiques[0]); p++) {
+    jouerPosition(game, tactiques[p]);
+    reinitialiserIA();
+    definirAlgorithme(r, DFPN);
+    double debut = secondes();
+    int preuve = rechercher(r, game, 1).valeur;
+    double dureePreuve = secondes() - debut;
+    StatsRecherche s = statsRecherche(r);
+
+    reinitialiserIA();
+    definirAlgorithme(r, ALPHABETA);
+    debut = secondes();
+    int valeur = rechercher(r, game, NB_LIGNE * NB_COLONNE - game->nb_jetons)
+                     .valeur;
+    double duree = secondes() - debut;
+    Resultat res = (valeur > 0) ? GAGNE : (valeur < 0) ? PERDU : NUL;
+    if (valeur != preuve)
+      ok = false;
+    printf("%-24s %-8s %12llu %10.4f %12llu %10.4f %7.2fx%s\n", tactiques[p],
+           resultats[res], s.preuves, dureePreuve, statsRecherche(r).noeuds,
+           duree, duree / dureePreuve,
+           (valeur != preuve) ? "  RÉSULTAT DIFFÉRENT" : "");
+  }
+  destroyRecherche(r);
+  return ok;
+}
+
+/**
+ * @brief Fonction principale des mesures de performance.
+ *
+ * @return int EXIT_SUCCESS si tout s'est bien passé, EXIT_FAILURE en cas de
+ * problème
+ */
+int main() {
+  Puissance4 *game = initPuissance4();
+  if (!game)
+    return EXIT_FAILURE;
+  game->j1 = makeIA(J1, '3');
+  game->j2 = makeIA(J2, '3');
+  if (!game->j1 || !game->j2) {
+    clean(game, NULL);
+    cleanIA();
+    return EXIT_FAILURE;
+  }
+
+  benchAnalyse(game);
+  bool ok = benchAlgorithmes(game);
+  ok = benchPreuve(game) && ok;
+  jouerPosition(game, positions[3]);
+  benchTables(game);
+
+  clean(game, NULL);
+  cleanIA();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
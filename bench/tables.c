@@ -0,0 +1,337 @@
+/**
+ * @file tables.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Mesures de la table de transposition de 16 Mo à 4 Go : la table par
+ * cases de 64 octets (transposition.c), avec et sans prefetch, comparée à une
+ * table naïve d'une entrée de 16 octets par case.
+ *
+ * Chaque accès imite minimax : la clé de la position suivante est connue
+ * (prefetch éventuel), la position est évaluée (le travail fait avant la
+ * consultation), puis la table est consultée et la position stockée. La clé
+ * suivante dépend du résultat, si bien que les accès ne peuvent pas se
+ * recouvrir d'eux-mêmes : seul le prefetch cache l'attente de la mémoire.
+ * Quand le processeur les expose, les défauts de cache sont comptés.
+ *
+ * La table par cases est ensuite mesurée sur des pages normales puis sur les
+ * pages énormes obtenues (voir memoire.h), en comptant les défauts de TLB.
+ * @version 0.1
+ * @date 2023-02-28
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "tables.h"
+#include "../src/commun.h"
+#include "../src/ia.h"
+#include "../src/memoire.h"
+#include "../src/transposition.h"
+
+#include <linux/perf_event.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @def NB_ACCES
+ * @brief le nombre d'accès mesurés par table
+ */
+#define NB_ACCES (1 << 20)
+
+/**
+ * @def TAILLE_MIN
+ * @brief la plus petite table mesurée, en octets
+ */
+#define TAILLE_MIN (16ULL << 20)
+
+/**
+ * @def TAILLE_MAX
+ * @brief la plus grande table mesurée, en octets
+ */
+#define TAILLE_MAX (4ULL << 30)
+
+/**
+ * @struct entreeNaive_
+ * @brief Une entrée de la table naïve (16 octets, une par case).
+ * @typedef EntreeNaive
+ * @brief Renommer entreeNaive_.
+ */
+typedef struct entreeNaive_ {
+  uint64_t cle;             //!< La clé, 0 si l'entrée est vide
+  int16_t valeur;           //!< La valeur
+  int8_t coup;              //!< Le meilleur coup
+  unsigned char profondeur; //!< La profondeur
+  unsigned char borne;      //!< La nature de la valeur
+} EntreeNaive;
+
+/**
+ * @def DEFAUTS_TLB
+ * @brief l'événement des défauts de TLB en lecture de données
+ */
+#define DEFAUTS_TLB                                                            \
+  (PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |             \
+   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/**
+ * @brief Ouvre et démarre un compteur matériel du processus.
+ *
+ * @param type le type du compteur (PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE)
+ * @param config l'événement compté
+ * @return int le descripteur du compteur, -1 si le processeur ne l'expose pas
+ */
+static int ouvrirCompteur(unsigned type, unsigned long long config) {
+  struct perf_event_attr a;
+  memset(&a, 0, sizeof(a));
+  a.type = type;
+  a.size = sizeof(a);
+  a.config = config;
+  a.disabled = 1;
+  a.exclude_kernel = 1;
+  a.exclude_hv = 1;
+  int compteur = syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+  if (compteur != -1)
+    ioctl(compteur, PERF_EVENT_IOC_ENABLE, 0);
+  return compteur;
+}
+
+/**
+ * @brief Lit le compteur des défauts de cache.
+ *
+ * @param compteur le descripteur du compteur, -1 si aucun
+ * @return long long la valeur, 0 si aucun compteur
+ */
+static long long lireCompteur(int compteur) {
+  long long n = 0;
+  if (compteur != -1 && read(compteur, &n, sizeof(n)) != sizeof(n))
+    n = 0;
+  return n;
+}
+
+/**
+ * @brief Passe à la clé suivante, qui dépend de la valeur lue.
+ *
+ * @param cle la clé
+ * @param valeur la valeur lue
+ * @return uint64_t la clé suivante (jamais 0)
+ */
+static uint64_t suivante(uint64_t cle, int valeur) {
+  return (tirer(&cle) + (unsigned)valeur) | 1;
+}
+
+/**
+ * @brief Mesure une suite d'accès à la table naïve.
+ *
+ * @param game le jeu (la position évaluée à chaque accès)
+ * @param entrees les entrées
+ * @param masque le nombre d'entrées - 1
+ * @param compteur le compteur des défauts de cache, -1 si aucun
+ * @param defauts les défauts de cache comptés
+ * @return double la durée en secondes
+ */
+static double mesurerNaive(Puissance4 *game, EntreeNaive *entrees,
+                           unsigned long masque, int compteur,
+                           long long *defauts) {
+  uint64_t cle = 1;
+  long long avant = lireCompteur(compteur);
+  double debut = secondes();
+  for (unsigned long i = 0; i < NB_ACCES; i++) {
+    int valeur = evaluation(game);
+    EntreeNaive *e =
+        &entrees[((cle ^ (cle >> 29)) * 0x9E3779B97F4A7C15ULL >> 32) & masque];
+    if (e->cle == cle)
+      valeur += e->valeur;
+    e->cle = cle;
+    e->valeur = valeur;
+    e->profondeur = i;
+    cle = suivante(cle, valeur);
+  }
+  double duree = secondes() - debut;
+  *defauts = lireCompteur(compteur) - avant;
+  return duree;
+}
+
+/**
+ * @brief Mesure une suite d'accès à la table par cases.
+ *
+ * @param game le jeu (la position évaluée à chaque accès)
+ * @param table la table
+ * @param prefetch true pour charger la case avant l'évaluation
+ * @param compteur le compteur des défauts de cache, -1 si aucun
+ * @param defauts les défauts de cache comptés
+ * @return double la durée en secondes
+ */
+static double mesurerCases(Puissance4 *game, Transposition *table,
+                           bool prefetch, int compteur, long long *defauts) {
+  uint64_t cle = 1;
+  long long avant = lireCompteur(compteur);
+  double debut = secondes();
+  for (unsigned long i = 0; i < NB_ACCES; i++) {
+    if (prefetch)
+      prefetcherTransposition(table, cle);
+    int valeur = evaluation(game);
+    int coup, v;
+    unsigned char profondeur;
+    Borne borne;
+    if (sonderTransposition(table, cle, &coup, &v, &profondeur, &borne))
+      valeur += v;
+    stockerTransposition(table, cle, i, -1, valeur, EXACTE);
+    cle = suivante(cle, valeur);
+  }
+  double duree = secondes() - debut;
+  *defauts = lireCompteur(compteur) - avant;
+  return duree;
+}
+
+/**
+ * @brief Donne le nom d'une taille de table mesurée, en affichant qu'elle est
+ * ignorée si elle dépasse la moitié de la mémoire de la machine.
+ *
+ * @param taille la taille, en octets
+ * @param nom le nom (au moins 16 caractères)
+ * @return true si la table peut être mesurée
+ * @return false si elle est ignorée
+ */
+static bool nommerTaille(unsigned long long taille, char *nom) {
+  unsigned long long memoire =
+      (unsigned long long)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+  if (taille >= (1ULL << 30))
+    snprintf(nom, 16, "%llu Go", taille >> 30);
+  else
+    snprintf(nom, 16, "%llu Mo", taille >> 20);
+  if (taille > memoire / 2) {
+    printf("%-8s ignorée (mémoire insuffisante)\n", nom);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Affiche une mesure par accès : durée, et défauts quand ils sont
+ * comptés.
+ *
+ * @param duree la durée en secondes
+ * @param defauts les défauts comptés
+ * @param compteur le compteur des défauts, -1 si aucun
+ */
+static void afficherMesure(double duree, long long defauts, int compteur) {
+  printf(" %10.1f", duree * 1e9 / NB_ACCES);
+  if (compteur != -1)
+    printf(" %8.2f", (double)defauts / NB_ACCES);
+  else
+    printf(" %8s", "-");
+}
+
+/**
+ * @brief Compare la table naïve et la table par cases, sans et avec prefetch,
+ * toutes sur des pages normales.
+ *
+ * @param game le jeu, dans la position évaluée à chaque accès
+ */
+static void benchCases(Puissance4 *game) {
+  int compteur = ouvrirCompteur(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  printf("\nTable de transposition, %d accès (ns et défauts de cache par "
+         "accès)\n",
+         NB_ACCES);
+  printf("%-8s %10s %8s %10s %8s %10s %8s\n", "taille", "naïve", "défauts",
+         "cases", "défauts", "prefetch", "défauts");
+  autoriserPagesEnormes(false); // les pages sont comparées ensuite
+  for (unsigned long long taille = TAILLE_MIN; taille <= TAILLE_MAX;
+       taille *= 4) {
+    char nom[16];
+    if (!nommerTaille(taille, nom))
+      continue;
+    double durees[3] = {0};
+    long long defauts[3] = {0};
+    EntreeNaive *entrees = malloc(taille);
+    if (entrees) {
+      memset(entrees, 0, taille); // pages allouées avant la mesure
+      durees[0] = mesurerNaive(game, entrees,
+                               taille / sizeof(EntreeNaive) - 1, compteur,
+                               &defauts[0]);
+      free(entrees);
+    }
+    Transposition *table = makeTransposition(taille / 8);
+    if (table) {
+      durees[1] = mesurerCases(game, table, false, compteur, &defauts[1]);
+      viderTransposition(table);
+      durees[2] = mesurerCases(game, table, true, compteur, &defauts[2]);
+      destroyTransposition(table);
+    }
+    if (!entrees || !table) {
+      printf("%-8s allocation impossible\n", nom);
+      continue;
+    }
+    printf("%-8s", nom);
+    for (int i = 0; i < 3; i++)
+      afficherMesure(durees[i], defauts[i], compteur);
+    printf("\n");
+  }
+  autoriserPagesEnormes(true);
+  if (compteur != -1)
+    close(compteur);
+}
+
+/**
+ * @brief Compare la table par cases (avec prefetch) sur des pages normales et
+ * sur les pages énormes obtenues du système, dont le mode est affiché.
+ *
+ * @param game le jeu, dans la position évaluée à chaque accès
+ */
+static void benchPages(Puissance4 *game) {
+  int compteur = ouvrirCompteur(PERF_TYPE_HW_CACHE, DEFAUTS_TLB);
+  printf("\nPages de la table, %d accès avec prefetch (ns et défauts de TLB "
+         "par accès)\n",
+         NB_ACCES);
+  printf("%-8s %10s %8s %10s %8s  %s\n", "taille", "normales", "défauts",
+         "énormes", "défauts", "pages obtenues");
+  for (unsigned long long taille = TAILLE_MIN; taille <= TAILLE_MAX;
+       taille *= 4) {
+    char nom[16];
+    if (!nommerTaille(taille, nom))
+      continue;
+    double durees[2] = {0};
+    long long defauts[2] = {0};
+    ModePages mode = PAGES_NORMALES;
+    bool alloue = true;
+    for (int i = 0; i < 2; i++) { // une seule table à la fois en mémoire
+      autoriserPagesEnormes(i == 1);
+      Transposition *table = makeTransposition(taille / 8);
+      if (!table) {
+        alloue = false;
+        break;
+      }
+      mode = modeTransposition(table);
+      durees[i] = mesurerCases(game, table, true, compteur, &defauts[i]);
+      destroyTransposition(table);
+    }
+    autoriserPagesEnormes(true);
+    if (!alloue) {
+      printf("%-8s allocation impossible\n", nom);
+      continue;
+    }
+    printf("%-8s", nom);
+    for (int i = 0; i < 2; i++)
+      afficherMesure(durees[i], defauts[i], compteur);
+    printf("  %s\n", nomModePages(mode));
+  }
+  if (compteur != -1)
+    close(compteur);
+}
+
+/**
+ * @brief Mesure les tables de 16 Mo à 4 Go : durée (et défauts de cache ou
+ * de TLB quand ils sont comptés) par accès. Les tailles qui dépassent la
+ * moitié de la mémoire de la machine sont ignorées.
+ *
+ * @param game le jeu, dans la position évaluée à chaque accès
+ */
+void benchTables(Puissance4 *game) {
+  benchCases(game);
+  benchPages(game);
+}
@@ -0,0 +1,24 @@
+/**
+ * @file tables.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des mesures de la table de transposition.
+ * @version 0.1
+ * @date 2023-02-28
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef TABLES_H
+/**
+ * @def TABLES_H
+ * @brief la garde
+ */
+#define TABLES_H
+
+#include "../src/puissance_quatre.h"
+
+void benchTables(Puissance4 *);
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file donnees.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Génération de données d'auto-jeu (voir make donnees) sur le plateau
+ * donné par PUISSANCE4_PLATEAU, comme pour le jeu. Plusieurs générateurs
+ * peuvent être lancés ensemble, chacun sur son fichier ou sur le même.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "../src/donnees.h"
+#include "../src/ia.h"
+#include "../src/puissance_quatre.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Ajoute au fichier les positions des parties décrites par les
+ * arguments, puis affiche le nombre de positions du fichier.
+ *
+ * @param argc le nombre d'arguments
+ * @param argv parties profondeur fichier
+ * @return int EXIT_SUCCESS si les positions ont été écrites
+ */
+int main(int argc, char **argv) {
+  if (argc != 4 || atoi(argv[2]) < 1 || atoi(argv[2]) > 255) {
+    fprintf(stderr, "usage : %s parties profondeur fichier\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  unsigned lignes, colonnes, aligne;
+  if (getenv("PUISSANCE4_PLATEAU") &&
+      (sscanf(getenv("PUISSANCE4_PLATEAU"), "%ux%ux%u", &lignes, &colonnes,
+              &aligne) != 3 ||
+       !definirGeometrie(lignes, colonnes, aligne))) {
+    fprintf(stderr, "PUISSANCE4_PLATEAU invalide : %s\n",
+            getenv("PUISSANCE4_PLATEAU"));
+    return EXIT_FAILURE;
+  }
+  Ecrivain *e = ouvrirEcrivain(argv[3]);
+  if (!e)
+    return EXIT_FAILURE;
+  // des parties différentes d'un générateur à l'autre
+  uint64_t graine = ((uint64_t)getpid() << 32 ^ (uint64_t)time(NULL)) | 1;
+  unsigned long ajoutees = jouerDonnees(e, atol(argv[1]), atoi(argv[2]),
+                                        graine);
+  bool ok = fermerEcrivain(e);
+  cleanIA();
+  if (!ok)
+    return EXIT_FAILURE;
+
+  Donnees *d = ouvrirDonnees(argv[3]);
+  if (!d)
+    return EXIT_FAILURE;
+  size_t nb;
+  lireDonnees(d, &nb);
+  printf("%lu positions ajoutées, %zu dans le fichier\n", ajoutees, nb);
+  fermerDonnees(d);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file entrainement.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Entraînement d'un réseau d'évaluation (voir make entrainement) sur le
+ * plateau donné par PUISSANCE4_PLATEAU, comme pour le jeu. Le réseau écrit se
+ * charge avec PUISSANCE4_RESEAU.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "../src/entrainement.h"
+#include "../src/ia.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @def BUDGET_EXEMPLE
+ * @brief le nombre maximal de positions développées par df-pn par exemple
+ */
+#define BUDGET_EXEMPLE 200000ULL
+
+/**
+ * @def PARTIES_MATCH
+ * @brief le nombre de parties du match de contrôle
+ */
+#define PARTIES_MATCH 20
+
+/**
+ * @def PROFONDEUR_MATCH
+ * @brief la profondeur des recherches du match de contrôle
+ */
+#define PROFONDEUR_MATCH 4
+
+/**
+ * @brief Entraîne et écrit le réseau décrit par les arguments, puis le fait
+ * jouer contre l'heuristique.
+ *
+ * @param argc le nombre d'arguments
+ * @param argv exemples epoques fichier [threads]
+ * @return int EXIT_SUCCESS si le réseau a été écrit
+ */
+int main(int argc, char **argv) {
+  if (argc < 4 || argc > 5) {
+    fprintf(stderr, "usage : %s exemples epoques fichier [threads]\n",
+            argv[0]);
+    return EXIT_FAILURE;
+  }
+  long threads = (argc == 5) ? atol(argv[4]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (threads > 64)
+    threads = 64;
+  unsigned lignes, colonnes, aligne;
+  if (getenv("PUISSANCE4_PLATEAU") &&
+      (sscanf(getenv("PUISSANCE4_PLATEAU"), "%ux%ux%u", &lignes, &colonnes,
+              &aligne) != 3 ||
+       !definirGeometrie(lignes, colonnes, aligne))) {
+    fprintf(stderr, "PUISSANCE4_PLATEAU invalide : %s\n",
+            getenv("PUISSANCE4_PLATEAU"));
+    return EXIT_FAILURE;
+  }
+  long nb = atol(argv[1]);
+  if (nb < 10) {
+    fprintf(stderr, "Il faut au moins 10 exemples.\n");
+    return EXIT_FAILURE;
+  }
+  Exemple *exemples = malloc(nb * sizeof(Exemple));
+  Reseau *r = malloc(sizeof(Reseau));
+  if (!exemples || !r) {
+    perror("Problème d'allocation");
+    free(exemples);
+    free(r);
+    return EXIT_FAILURE;
+  }
+  uint64_t graine = (uint64_t)getpid() << 20 | 1;
+  bool ok = genererExemples(exemples, nb, threads, BUDGET_EXEMPLE, graine,
+                            stdout) == (unsigned long)nb &&
+            entrainerReseau(r, exemples, nb, atoi(argv[2]), threads, stdout);
+  if (ok) {
+    printf("perte du réseau en entiers : %.4f\n", perteReseau(r, exemples, nb));
+    ok = ecrireReseau(r, argv[3]);
+  }
+  if (ok)
+    printf("score contre l'heuristique : %.2f\n",
+           matchReseau(r, PARTIES_MATCH, PROFONDEUR_MATCH, 1, stdout));
+  cleanIA();
+  free(exemples);
+  free(r);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
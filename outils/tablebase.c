@@ -0,0 +1,44 @@
+/**
+ * @file tablebase.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Génération d'une table des finales (voir make tablebase). Une
+ * génération interrompue reprend à la dernière couche sauvegardée.
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "../src/tablebase.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * @brief Génère la table des finales décrite par les arguments.
+ *
+ * @param argc le nombre d'arguments
+ * @param argv coups jetonsMin fichier [threads]
+ * @return int EXIT_SUCCESS si la table a été écrite
+ */
+int main(int argc, char **argv) {
+  if (argc < 4 || argc > 5) {
+    fprintf(stderr, "usage : %s coups jetonsMin fichier [threads]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  long threads = (argc == 5) ? atol(argv[4]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (!genererTableFinale(argv[1], atoi(argv[2]), threads, argv[3], stdout))
+    return EXIT_FAILURE;
+
+  TableFinale *t = ouvrirTableFinale(argv[3]);
+  if (!t)
+    return EXIT_FAILURE;
+  printf("%llu positions\n", tailleTableFinale(t));
+  fermerTableFinale(t);
+  return EXIT_SUCCESS;
+}
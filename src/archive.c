@@ -0,0 +1,731 @@
+/**
+ * @file archive.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief L'archive des positions résolues.
+ *
+ * Une archive est faite de deux fichiers : un index, tableau d'enregistrements
+ * triés par clé projeté en mémoire (recherche dichotomique), et un journal
+ * (chemin.journal) où les nouveaux résultats sont ajoutés par lots, à la fin
+ * seulement. Chaque enregistrement porte une somme de contrôle : après un
+ * arrêt brutal, la fin d'un lot à moitié écrit est simplement ignorée et
+ * retirée à l'ouverture suivante. Si d'autres processus ont ajouté leurs lots
+ * après elle, elle reste dans le journal, ignorée à la lecture, jusqu'à la
+ * compaction (les lots suivants sont alignés sur les enregistrements). Quand
+ * le journal devient grand devant l'index, il est fusionné avec lui dans un
+ * nouvel index (compaction), écrit à côté puis renommé : l'ancien reste valide
+ * tant que le nouveau n'est pas complet sur le disque.
+ *
+ * Plusieurs processus peuvent utiliser la même archive : les ajouts au
+ * journal et la compaction sont faits sous verrou exclusif (flock), et chaque
+ * processus reprojette l'index quand un autre l'a remplacé. Les résultats
+ * ajoutés depuis le dernier index sont gardés en mémoire (table de hachage),
+ * ceux du journal lus à l'ouverture compris.
+ * @version 0.1
+ * @date 2023-03-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "archive.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @def VERSION
+ * @brief la version du format de l'index
+ */
+#define VERSION 1
+
+/**
+ * @def TAILLE_LOT
+ * @brief le nombre d'enregistrements écrits d'un coup dans le journal
+ */
+#define TAILLE_LOT 64
+
+/**
+ * @def INTERVALLE_SYNCHRO
+ * @brief le délai maximal (en secondes) avant qu'un résultat ajouté soit écrit
+ * dans le journal
+ */
+#define INTERVALLE_SYNCHRO 1
+
+/**
+ * @def SEUIL_COMPACTION
+ * @brief le nombre d'enregistrements du journal à partir duquel il est fusionné
+ * dans l'index (ou le quart de l'index s'il est plus grand, pour que chaque
+ * position ne soit réécrite qu'un nombre borné de fois)
+ */
+#define SEUIL_COMPACTION 4096
+
+/**
+ * @def CAPACITE_MIN
+ * @brief la capacité initiale de la table des résultats récents
+ */
+#define CAPACITE_MIN 1024
+
+/**
+ * @struct enregistrement_
+ * @brief Un résultat, tel qu'il est écrit dans les fichiers (16 octets).
+ * @typedef Enregistrement
+ * @brief Renommer enregistrement_.
+ */
+typedef struct enregistrement_ {
+  uint64_t cle;       //!< La clé canonique de la position, 0 si aucune
+  int16_t valeur;     //!< La valeur pour le joueur courant
+  int8_t coup;        //!< Le meilleur coup (dans la position canonique)
+  uint8_t profondeur; //!< La profondeur de la recherche
+  uint32_t controle;  //!< La somme de contrôle des champs précédents
+} Enregistrement;
+
+_Static_assert(sizeof(Enregistrement) == 16,
+               "un enregistrement de l'archive doit tenir sur 16 octets");
+
+/**
+ * @struct entete_
+ * @brief L'en-tête de l'index, suivi de ses enregistrements triés.
+ * @typedef Entete
+ * @brief Renommer entete_.
+ */
+typedef struct entete_ {
+  char magie[4];    //!< "P4AR"
+  uint32_t version; //!< VERSION
+  uint64_t nb;      //!< Le nombre d'enregistrements
+} Entete;
+
+/**
+ * @struct archive_
+ * @brief Une archive ouverte.
+ */
+struct archive_ {
+  char *chemin;                   //!< Le fichier de l'index
+  char *cheminJournal;            //!< Le fichier du journal
+  int journal;                    //!< Le journal, ouvert en ajout
+  Entete *index;                  //!< L'index projeté, NULL si aucun
+  size_t tailleIndex;             //!< La taille de la projection
+  ino_t inode;                    //!< L'inode de l'index projeté
+  Enregistrement *recents;        //!< Les résultats absents de l'index
+  unsigned long capacite;         //!< Capacité de recents (puissance de 2)
+  unsigned long nbRecents;        //!< Nombre de résultats dans recents
+  Enregistrement lot[TAILLE_LOT]; //!< Les résultats pas encore écrits
+  unsigned nbLot;                 //!< Leur nombre
+  time_t synchro;                 //!< La dernière écriture du journal
+  StatsArchive stats;             //!< Les compteurs
+};
+
+/**
+ * @brief Calcule la somme de contrôle d'un enregistrement.
+ *
+ * @param e l'enregistrement
+ * @return uint32_t sa somme (jamais 0, qu'un fichier mis à zéro ne passe pas)
+ */
+static uint32_t controler(const Enregistrement *e) {
+  uint64_t h = e->cle ^ ((uint64_t)(uint16_t)e->valeur << 48) ^
+               ((uint64_t)(uint8_t)e->coup << 40) ^
+               ((uint64_t)e->profondeur << 32);
+  h = (h ^ (h >> 31)) * 0x9E3779B97F4A7C15ULL;
+  return (uint32_t)(h >> 32) | 1;
+}
+
+/**
+ * @brief Indique si un enregistrement lu est intact.
+ *
+ * @param e l'enregistrement
+ * @return true si sa somme de contrôle est juste
+ * @return false sinon
+ */
+static bool intact(const Enregistrement *e) {
+  return e->cle != 0 && e->controle == controler(e);
+}
+
+/**
+ * @brief Compare deux enregistrements : par clé croissante, puis par
+ * profondeur décroissante.
+ *
+ * @param a le premier
+ * @param b le second
+ * @return int négatif, nul ou positif (voir qsort)
+ */
+static int comparer(const void *a, const void *b) {
+  const Enregistrement *x = a, *y = b;
+  if (x->cle != y->cle)
+    return (x->cle < y->cle) ? -1 : 1;
+  return (int)y->profondeur - (int)x->profondeur;
+}
+
+/**
+ * @brief Cherche une clé dans l'index.
+ *
+ * @param a l'archive
+ * @param cle la clé
+ * @return const Enregistrement* l'enregistrement, NULL si absent
+ */
+static const Enregistrement *trouverIndex(Archive *a, uint64_t cle) {
+  if (!a->index)
+    return NULL;
+  const Enregistrement *t = (const Enregistrement *)(a->index + 1);
+  size_t debut = 0, fin = a->index->nb;
+  while (debut < fin) {
+    size_t milieu = debut + (fin - debut) / 2;
+    if (t[milieu].cle < cle)
+      debut = milieu + 1;
+    else
+      fin = milieu;
+  }
+  return (debut < a->index->nb && t[debut].cle == cle) ? &t[debut] : NULL;
+}
+
+/**
+ * @brief Donne la place d'une clé dans la table des résultats récents : la
+ * sienne si elle y est, sinon la première libre de sa suite.
+ *
+ * @param a l'archive
+ * @param cle la clé
+ * @return Enregistrement* la place
+ */
+static Enregistrement *placeRecent(Archive *a, uint64_t cle) {
+  unsigned long i = ((cle ^ (cle >> 29)) * 0x9E3779B97F4A7C15ULL) >> 32;
+  for (;; i++) {
+    Enregistrement *e = &a->recents[i & (a->capacite - 1)];
+    if (e->cle == cle || e->cle == 0)
+      return e;
+  }
+}
+
+/**
+ * @brief Garde un résultat dans la table des résultats récents, à la place
+ * d'un résultat moins profond de la même position. La table est agrandie
+ * quand elle est à moitié pleine.
+ *
+ * @param a l'archive
+ * @param e le résultat
+ * @return true si le résultat a été gardé
+ * @return false en cas de problème d'allocation
+ */
+static bool retenir(Archive *a, Enregistrement e) {
+  if ((a->nbRecents + 1) * 2 > a->capacite) {
+    Enregistrement *ancienne = a->recents;
+    unsigned long capacite = a->capacite;
+    a->recents = calloc(capacite * 2, sizeof(Enregistrement));
+    if (!a->recents) {
+      perror("Problème d'allocation dans retenir.");
+      a->recents = ancienne;
+      return false;
+    }
+    a->capacite = capacite * 2;
+    for (unsigned long i = 0; i < capacite; i++)
+      if (ancienne[i].cle)
+        *placeRecent(a, ancienne[i].cle) = ancienne[i];
+    free(ancienne);
+  }
+  Enregistrement *place = placeRecent(a, e.cle);
+  if (place->cle == 0) {
+    a->nbRecents++;
+    *place = e;
+  } else if (e.profondeur >= place->profondeur)
+    *place = e;
+  return true;
+}
+
+/**
+ * @brief Oublie les résultats récents (ils sont dans l'index), sauf ceux du
+ * lot pas encore écrit.
+ *
+ * @param a l'archive
+ */
+static void oublierRecents(Archive *a) {
+  memset(a->recents, 0, a->capacite * sizeof(Enregistrement));
+  a->nbRecents = 0;
+  for (unsigned i = 0; i < a->nbLot; i++)
+    retenir(a, a->lot[i]);
+}
+
+/**
+ * @brief Projette l'index en mémoire, à la place du précédent. Un index absent
+ * équivaut à un index vide ; un index invalide est signalé et ignoré.
+ *
+ * @param a l'archive
+ */
+static void projeterIndex(Archive *a) {
+  if (a->index)
+    munmap(a->index, a->tailleIndex);
+  a->index = NULL;
+  a->inode = 0;
+  int fd = open(a->chemin, O_RDONLY);
+  if (fd == -1)
+    return;
+  struct stat s;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &s) == 0 && (size_t)s.st_size >= sizeof(Entete))
+    p = mmap(NULL, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "Index d'archive illisible : %s\n", a->chemin);
+    return;
+  }
+  Entete *e = p;
+  if (memcmp(e->magie, "P4AR", 4) != 0 || e->version != VERSION ||
+      sizeof(Entete) + e->nb * sizeof(Enregistrement) != (size_t)s.st_size) {
+    fprintf(stderr, "Index d'archive invalide : %s\n", a->chemin);
+    munmap(p, s.st_size);
+    return;
+  }
+  a->index = e;
+  a->tailleIndex = s.st_size;
+  a->inode = s.st_ino;
+  madvise(p, s.st_size, MADV_RANDOM);
+}
+
+/**
+ * @brief Indique si l'index du disque n'est plus celui projeté (un autre
+ * processus l'a remplacé).
+ *
+ * @param a l'archive
+ * @return true s'il a changé
+ * @return false sinon
+ */
+static bool indexChange(Archive *a) {
+  struct stat s;
+  if (stat(a->chemin, &s) == -1)
+    return a->inode != 0;
+  return s.st_ino != a->inode;
+}
+
+/**
+ * @brief Lit les enregistrements intacts du journal, en passant les abîmés (le
+ * verrou doit être pris).
+ *
+ * @param a l'archive
+ * @param nb renseigné avec leur nombre
+ * @param fin renseigné avec le nombre d'enregistrements du journal jusqu'au
+ * dernier intact compris, abîmés compris
+ * @param taille renseignée avec la taille du journal, en octets
+ * @return Enregistrement* les enregistrements (à libérer), NULL en cas de
+ * problème
+ */
+static Enregistrement *lireJournal(Archive *a, size_t *nb, size_t *fin,
+                                   off_t *taille) {
+  struct stat s;
+  if (fstat(a->journal, &s) == -1) {
+    perror("Journal d'archive illisible");
+    return NULL;
+  }
+  *taille = s.st_size;
+  size_t n = s.st_size / sizeof(Enregistrement);
+  Enregistrement *t = malloc((n ? n : 1) * sizeof(Enregistrement));
+  if (!t) {
+    perror("Problème d'allocation dans lireJournal.");
+    return NULL;
+  }
+  size_t lus = 0;
+  while (lus < n * sizeof(Enregistrement)) {
+    ssize_t r = pread(a->journal, (char *)t + lus,
+                      n * sizeof(Enregistrement) - lus, lus);
+    if (r <= 0)
+      break;
+    lus += r;
+  }
+  n = lus / sizeof(Enregistrement);
+  *nb = *fin = 0;
+  for (size_t i = 0; i < n; i++)
+    if (intact(&t[i])) {
+      t[(*nb)++] = t[i];
+      *fin = i + 1;
+    }
+  return t;
+}
+
+/**
+ * @brief Ouvre une archive, créée vide si elle n'existe pas. La fin abîmée du
+ * journal (écriture interrompue) est retirée ; les enregistrements abîmés
+ * suivis d'intacts sont ignorés.
+ *
+ * @param chemin le fichier de l'index (le journal est chemin.journal)
+ * @return Archive* l'archive, NULL si elle ne peut pas être ouverte
+ */
+Archive *ouvrirArchive(const char *chemin) {
+  assert(chemin);
+  Archive *a = calloc(1, sizeof(Archive));
+  if (!a) {
+    perror("Problème d'allocation dans ouvrirArchive.");
+    return NULL;
+  }
+  a->chemin = malloc(strlen(chemin) + 1);
+  a->cheminJournal = malloc(strlen(chemin) + sizeof(".journal"));
+  a->capacite = CAPACITE_MIN;
+  a->recents = calloc(a->capacite, sizeof(Enregistrement));
+  a->journal = -1;
+  if (!a->chemin || !a->cheminJournal || !a->recents) {
+    perror("Problème d'allocation dans ouvrirArchive.");
+    fermerArchive(a);
+    return NULL;
+  }
+  strcpy(a->chemin, chemin);
+  sprintf(a->cheminJournal, "%s.journal", chemin);
+  a->journal = open(a->cheminJournal, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (a->journal == -1 || flock(a->journal, LOCK_EX) == -1) {
+    perror("Impossible d'ouvrir le journal de l'archive");
+    fermerArchive(a);
+    return NULL;
+  }
+  size_t nb, fin;
+  off_t taille;
+  Enregistrement *t = lireJournal(a, &nb, &fin, &taille);
+  bool ok = t != NULL;
+  if (ok && fin > nb)
+    fprintf(stderr, "Enregistrements abîmés ignorés dans le journal "
+                    "d'archive (%zu) : %s\n",
+            fin - nb, a->cheminJournal);
+  if (ok && (off_t)(fin * sizeof(Enregistrement)) != taille) {
+    fprintf(stderr, "Fin du journal d'archive abîmée, retirée : %s\n",
+            a->cheminJournal);
+    ok = ftruncate(a->journal, fin * sizeof(Enregistrement)) == 0;
+  }
+  for (size_t i = 0; ok && i < nb; i++)
+    ok = retenir(a, t[i]);
+  free(t);
+  projeterIndex(a);
+  flock(a->journal, LOCK_UN);
+  if (!ok) {
+    fermerArchive(a);
+    return NULL;
+  }
+  a->synchro = time(NULL);
+  return a;
+}
+
+/**
+ * @brief Cherche le résultat le plus profond d'une position parmi ceux
+ * calculés au moins aussi profondément que demandé.
+ *
+ * @param a l'archive
+ * @param cle la clé canonique de la position
+ * @param profondeur la profondeur demandée
+ * @return const Enregistrement* le résultat, NULL si aucun
+ */
+static const Enregistrement *trouver(Archive *a, uint64_t cle,
+                                     unsigned profondeur) {
+  const Enregistrement *r = placeRecent(a, cle), *i = trouverIndex(a, cle);
+  if (r->cle != cle || (i && i->profondeur > r->profondeur))
+    r = i;
+  return (r && r->profondeur >= profondeur) ? r : NULL;
+}
+
+/**
+ * @brief Cherche le résultat d'une position, calculé au moins aussi
+ * profondément que demandé.
+ *
+ * @param a l'archive
+ * @param cle la clé canonique de la position
+ * @param profondeur la profondeur demandée
+ * @param coup le meilleur coup (dans la position canonique), renseigné en cas
+ * de succès
+ * @param valeur la valeur pour le joueur courant, renseignée en cas de succès
+ * @return true si un résultat utilisable a été trouvé
+ * @return false sinon
+ */
+bool chercherArchive(Archive *a, uint64_t cle, unsigned char profondeur,
+                     int *coup, int *valeur) {
+  assert(a);
+  const Enregistrement *e = trouver(a, cle, profondeur);
+  if (!e) {
+    a->stats.echecs++;
+    return false;
+  }
+  *coup = e->coup;
+  *valeur = e->valeur;
+  a->stats.succes++;
+  return true;
+}
+
+/**
+ * @brief Écrit des octets à la fin du journal (le verrou doit être pris).
+ *
+ * @param a l'archive
+ * @param p les octets
+ * @param reste leur nombre
+ * @return true si tout a été écrit
+ * @return false sinon
+ */
+static bool ecrireJournal(Archive *a, const char *p, size_t reste) {
+  while (reste > 0) {
+    ssize_t n = write(a->journal, p, reste);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      perror("Problème d'écriture du journal de l'archive");
+      return false;
+    }
+    p += n;
+    reste -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief Écrit le lot dans le journal (le verrou exclusif doit être pris). Si
+ * le journal finit par un lot interrompu, il est d'abord complété par des
+ * zéros (un enregistrement abîmé), pour que le lot soit aligné.
+ *
+ * @param a l'archive
+ * @return true si le lot est sur le disque
+ * @return false sinon
+ */
+static bool ecrireLot(Archive *a) {
+  size_t taille = a->nbLot * sizeof(Enregistrement);
+  a->nbLot = 0;
+  struct stat s;
+  if (taille > 0 && fstat(a->journal, &s) == 0 &&
+      s.st_size % sizeof(Enregistrement) != 0) {
+    char zeros[sizeof(Enregistrement)] = {0};
+    if (!ecrireJournal(a, zeros,
+                       sizeof(Enregistrement) -
+                           s.st_size % sizeof(Enregistrement)))
+      return false;
+  }
+  if (!ecrireJournal(a, (const char *)a->lot, taille))
+    return false;
+  a->stats.ecritures++;
+  return fdatasync(a->journal) == 0;
+}
+
+/**
+ * @brief Ajoute le résultat d'une position, s'il est plus profond que celui
+ * déjà archivé. Il est écrit dans le journal avec son lot (voir TAILLE_LOT et
+ * INTERVALLE_SYNCHRO) ; en attendant, il est déjà trouvé par chercherArchive.
+ *
+ * @param a l'archive
+ * @param cle la clé canonique de la position
+ * @param profondeur la profondeur de la recherche
+ * @param coup le meilleur coup dans la position canonique (de 0 à 6)
+ * @param valeur la valeur pour le joueur courant
+ * @return true si tout s'est bien passé
+ * @return false en cas de problème d'allocation ou d'écriture
+ */
+bool ajouterArchive(Archive *a, uint64_t cle, unsigned char profondeur,
+                    int coup, int valeur) {
+  assert(a);
+  assert(cle != 0);
+  assert(coup >= -1 && coup <= INT8_MAX);
+  assert(valeur >= INT16_MIN && valeur <= INT16_MAX);
+  if (trouver(a, cle, profondeur + 1U))
+    return true; // déjà mieux
+  Enregistrement e = {cle, valeur, coup, profondeur, 0};
+  e.controle = controler(&e);
+  if (!retenir(a, e))
+    return false;
+  a->lot[a->nbLot++] = e;
+  if (a->nbLot == TAILLE_LOT || time(NULL) - a->synchro >= INTERVALLE_SYNCHRO)
+    return synchroniserArchive(a);
+  return true;
+}
+
+/**
+ * @brief Écrit les résultats en attente dans le journal. Si un autre
+ * processus a remplacé l'index, il est reprojeté ; si le journal est devenu
+ * grand devant l'index, il y est fusionné (compacterArchive).
+ *
+ * @param a l'archive
+ * @return true si tout s'est bien passé
+ * @return false en cas de problème d'écriture
+ */
+bool synchroniserArchive(Archive *a) {
+  assert(a);
+  if (flock(a->journal, LOCK_EX) == -1) { // un lot à la fois
+    perror("Impossible de verrouiller le journal de l'archive");
+    return false;
+  }
+  if (indexChange(a)) { // le nouvel index contient tout le journal écrit
+    projeterIndex(a);
+    oublierRecents(a);
+  }
+  bool ok = ecrireLot(a);
+  struct stat s;
+  size_t journal = (fstat(a->journal, &s) == 0)
+                       ? s.st_size / sizeof(Enregistrement)
+                       : 0;
+  flock(a->journal, LOCK_UN);
+  a->synchro = time(NULL);
+  size_t index = a->index ? a->index->nb : 0;
+  if (ok && journal >= SEUIL_COMPACTION && journal >= index / 4)
+    ok = compacterArchive(a);
+  return ok;
+}
+
+/**
+ * @brief Ouvre le dossier d'un fichier et l'écrit sur le disque, pour qu'un
+ * renommage y survive à un arrêt brutal.
+ *
+ * @param chemin le fichier
+ */
+static void synchroniserDossier(const char *chemin) {
+  char dossier[4096] = ".";
+  const char *fin = strrchr(chemin, '/');
+  if (fin && (size_t)(fin - chemin) < sizeof(dossier))
+    snprintf(dossier, sizeof(dossier), "%.*s", (int)(fin - chemin + 1),
+             chemin);
+  int fd = open(dossier, O_RDONLY);
+  if (fd != -1) {
+    fsync(fd);
+    close(fd);
+  }
+}
+
+/**
+ * @brief Écrit le nouvel index : fusion de l'index et des enregistrements du
+ * journal (triés), en gardant pour chaque position le résultat le plus
+ * profond (celui du journal à profondeur égale).
+ *
+ * @param a l'archive
+ * @param f le fichier du nouvel index
+ * @param t les enregistrements du journal, triés par comparer
+ * @param nb leur nombre
+ * @return true si tout a été écrit
+ * @return false sinon
+ */
+static bool ecrireIndex(Archive *a, FILE *f, const Enregistrement *t,
+                        size_t nb) {
+  Entete e = {{'P', '4', 'A', 'R'}, VERSION, 0};
+  bool ok = fwrite(&e, sizeof(e), 1, f) == 1;
+  const Enregistrement *idx =
+      a->index ? (const Enregistrement *)(a->index + 1) : NULL;
+  size_t n = a->index ? a->index->nb : 0, i = 0, j = 0;
+  while (ok && (i < n || j < nb)) {
+    const Enregistrement *choisi;
+    if (j == nb || (i < n && idx[i].cle < t[j].cle))
+      choisi = &idx[i++];
+    else { // le plus profond du journal, sauf si celui de l'index l'est plus
+      choisi = &t[j];
+      while (j < nb && t[j].cle == choisi->cle)
+        j++;
+      if (i < n && idx[i].cle == choisi->cle) {
+        if (idx[i].profondeur > choisi->profondeur)
+          choisi = &idx[i];
+        i++;
+      }
+    }
+    ok = fwrite(choisi, sizeof(*choisi), 1, f) == 1;
+    e.nb++;
+  }
+  return ok && fseek(f, 0, SEEK_SET) == 0 &&
+         fwrite(&e, sizeof(e), 1, f) == 1 && fflush(f) == 0 &&
+         fsync(fileno(f)) == 0;
+}
+
+/**
+ * @brief Fusionne le journal dans l'index : le nouvel index est écrit à côté
+ * (chemin.tmp), écrit sur le disque, renommé à la place de l'ancien, puis le
+ * journal est vidé. Un arrêt brutal laisse l'ancien index ou le nouveau, et au
+ * pire un journal dont les enregistrements sont déjà dans l'index.
+ *
+ * @param a l'archive
+ * @return true si l'index a été reconstruit
+ * @return false sinon (l'archive reste utilisable)
+ */
+bool compacterArchive(Archive *a) {
+  assert(a);
+  if (flock(a->journal, LOCK_EX) == -1) {
+    perror("Impossible de verrouiller le journal de l'archive");
+    return false;
+  }
+  if (indexChange(a))
+    projeterIndex(a);
+  bool ok = ecrireLot(a);
+  size_t nb = 0, fin;
+  off_t taille;
+  Enregistrement *t = ok ? lireJournal(a, &nb, &fin, &taille) : NULL;
+  char tmp[strlen(a->chemin) + sizeof(".tmp")];
+  sprintf(tmp, "%s.tmp", a->chemin);
+  FILE *f = t ? fopen(tmp, "wb") : NULL;
+  if (f) {
+    qsort(t, nb, sizeof(Enregistrement), &comparer);
+    ok = ecrireIndex(a, f, t, nb);
+    ok = (fclose(f) == 0) && ok && rename(tmp, a->chemin) == 0;
+    if (ok) {
+      synchroniserDossier(a->chemin);
+      ok = ftruncate(a->journal, 0) == 0 && fdatasync(a->journal) == 0;
+      projeterIndex(a);
+      oublierRecents(a);
+      a->stats.compactions++;
+    } else {
+      perror("Problème d'écriture de l'index de l'archive");
+      remove(tmp);
+    }
+  } else
+    ok = false;
+  free(t);
+  flock(a->journal, LOCK_UN);
+  return ok;
+}
+
+/**
+ * @brief Appelle une fonction sur chaque résultat de l'archive (ceux de
+ * l'index, puis les récents ; une position peut y être deux fois).
+ *
+ * @param a l'archive
+ * @param f la fonction : données, clé canonique, profondeur, coup (dans la
+ * position canonique) et valeur
+ * @param donnees les données passées à f
+ */
+void parcourirArchive(Archive *a,
+                      void (*f)(void *, uint64_t, unsigned char, int, int),
+                      void *donnees) {
+  assert(a);
+  assert(f);
+  const Enregistrement *t =
+      a->index ? (const Enregistrement *)(a->index + 1) : NULL;
+  for (size_t i = 0; t && i < a->index->nb; i++)
+    f(donnees, t[i].cle, t[i].profondeur, t[i].coup, t[i].valeur);
+  for (unsigned long i = 0; i < a->capacite; i++)
+    if (a->recents[i].cle)
+      f(donnees, a->recents[i].cle, a->recents[i].profondeur,
+        a->recents[i].coup, a->recents[i].valeur);
+}
+
+/**
+ * @brief Récupère les compteurs d'une archive.
+ *
+ * @param a l'archive
+ * @return StatsArchive les compteurs
+ */
+StatsArchive statsArchive(Archive *a) {
+  assert(a);
+  StatsArchive s = a->stats;
+  s.indexees = a->index ? a->index->nb : 0;
+  s.recentes = a->nbRecents;
+  return s;
+}
+
+/**
+ * @brief Ferme une archive, après avoir écrit les résultats en attente.
+ *
+ * @param a l'archive (peut être NULL)
+ */
+void fermerArchive(Archive *a) {
+  if (!a)
+    return;
+  if (a->journal != -1) {
+    if (a->nbLot > 0)
+      synchroniserArchive(a);
+    close(a->journal);
+  }
+  if (a->index)
+    munmap(a->index, a->tailleIndex);
+  free(a->recents);
+  free(a->chemin);
+  free(a->cheminJournal);
+  free(a);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file archive.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de l'archive des positions résolues : un fichier où les
+ * résultats des recherches s'accumulent d'un processus à l'autre.
+ * @version 0.1
+ * @date 2023-03-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ARCHIVE_H
+/**
+ * @def ARCHIVE_H
+ * @brief la garde
+ */
+#define ARCHIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @typedef Archive
+ * @brief Renommer archive_ (structure opaque).
+ */
+typedef struct archive_ Archive;
+
+/**
+ * @struct statsArchive_
+ * @brief Les compteurs d'une archive.
+ * @typedef StatsArchive
+ * @brief Renommer statsArchive_.
+ */
+typedef struct statsArchive_ {
+  unsigned long long indexees;    //!< Positions de l'index trié
+  unsigned long long recentes;    //!< Positions ajoutées depuis l'index
+  unsigned long long succes;      //!< Recherches ayant trouvé un résultat
+  unsigned long long echecs;      //!< Recherches sans résultat utilisable
+  unsigned long long ecritures;   //!< Lots écrits dans le journal
+  unsigned long long compactions; //!< Index reconstruits
+} StatsArchive;
+
+Archive *ouvrirArchive(const char *);
+bool chercherArchive(Archive *, uint64_t, unsigned char, int *, int *);
+bool ajouterArchive(Archive *, uint64_t, unsigned char, int, int);
+bool synchroniserArchive(Archive *);
+bool compacterArchive(Archive *);
+void parcourirArchive(Archive *,
+                      void (*)(void *, uint64_t, unsigned char, int, int),
+                      void *);
+StatsArchive statsArchive(Archive *);
+void fermerArchive(Archive *);
+
+#endif
@@ -0,0 +1,377 @@
+/**
+ * @file bitboard.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des bitboards : les jetons d'un joueur, un bit par case,
+ * sur plusieurs mots de 64 bits pour les grands plateaux. Les cases sont
+ * rangées comme dans les clés des positions : colonne par colonne, du bas
+ * vers le haut, avec un bit libre au-dessus de chaque colonne qui empêche
+ * un alignement de passer d'une colonne à l'autre. Les opérations traitent
+ * les mots un par un, sans branchement selon les données : le compilateur en
+ * fait des instructions SIMD, et un seul mot pour le plateau standard quand
+ * le nombre de mots est une constante (voir FORMES). Les alignements et les
+ * menaces sont cherchés dans les quatre directions à la fois, une copie du
+ * bitboard par direction : quatre mots que les fonctions marquées VECTORISE
+ * décalent chacun du sien en une instruction (AVX2 ou AVX-512).
+ * @version 0.1
+ * @date 2023-03-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef BITBOARD_H
+/**
+ * @def BITBOARD_H
+ * @brief la garde
+ */
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @def OPERATION
+ * @brief une opération sur les bitboards, recopiée dans chaque appel : les
+ * décalages et le nombre de mots y deviennent des constantes
+ */
+#define OPERATION static inline __attribute__((always_inline))
+
+/**
+ * @def VECTORISE
+ * @brief une fonction compilée en trois versions, AVX-512, AVX2 et sans
+ * extension ; la meilleure pour le processeur est choisie au chargement du
+ * programme
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define VECTORISE                                                              \
+  __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define VECTORISE
+#endif
+
+/**
+ * @def MOTS_BITBOARD
+ * @brief le nombre de mots d'un bitboard : de quoi coder un plateau de
+ * NB_LIGNE_MAX lignes et NB_COLONNE_MAX colonnes, plus le bit libre de chaque
+ * colonne
+ */
+#define MOTS_BITBOARD 4
+
+/**
+ * @def MOTS_UTILES
+ * @brief le nombre de mots utilisés pour un plateau de L lignes et C colonnes
+ */
+#define MOTS_UTILES(L, C) ((((L) + 1) * (C) + 63) / 64)
+
+/**
+ * @struct bitboard_
+ * @brief Un ensemble de cases, un bit par case.
+ * @typedef Bitboard
+ * @brief Renommer bitboard_.
+ */
+typedef struct bitboard_ {
+  uint64_t mots[MOTS_BITBOARD]; //!< Les bits, mot de poids faible en premier
+} Bitboard;
+
+/**
+ * @brief Donne le bit d'une case.
+ *
+ * @param ligne le numéro de ligne de la case (0 en haut)
+ * @param colonne le numéro de colonne de la case
+ * @param L le nombre de lignes du plateau
+ * @return unsigned le numéro du bit
+ */
+OPERATION unsigned bitCase(unsigned ligne, unsigned colonne, unsigned L) {
+  return L - 1 - ligne + colonne * (L + 1);
+}
+
+/**
+ * @brief Inverse un bit : ajoute la case si elle n'y était pas, l'enlève
+ * sinon.
+ *
+ * @param b le bitboard
+ * @param i le numéro du bit
+ */
+OPERATION void bbInverser(Bitboard *b, unsigned i) {
+  b->mots[i / 64] ^= (uint64_t)1 << (i % 64);
+}
+
+/**
+ * @brief Indique si un bitboard contient une case.
+ *
+ * @param b le bitboard
+ * @param i le numéro du bit de la case
+ * @return true si le bit est à 1
+ * @return false sinon
+ */
+OPERATION bool bbContient(const Bitboard *b, unsigned i) {
+  return b->mots[i / 64] >> (i % 64) & 1;
+}
+
+/**
+ * @brief Décale un bitboard de d bits vers les bits de poids faible : la case
+ * du bit i + d passe au bit i.
+ *
+ * @param b le bitboard
+ * @param d le décalage
+ * @param n le nombre de mots utilisés
+ * @return Bitboard le bitboard décalé (mots au-delà de n à 0)
+ */
+OPERATION Bitboard bbDecaler(const Bitboard *b, unsigned d, unsigned n) {
+  Bitboard r = {{0}};
+  unsigned q = d / 64, s = d % 64;
+  for (unsigned i = 0; i + q < n; i++) {
+    r.mots[i] = b->mots[i + q] >> s;
+    if (s && i + q + 1 < n)
+      r.mots[i] |= b->mots[i + q + 1] << (64 - s);
+  }
+  return r;
+}
+
+/**
+ * @brief Calcule l'intersection de deux bitboards, dans le premier.
+ *
+ * @param a le premier bitboard, remplacé par l'intersection
+ * @param b le second bitboard
+ * @param n le nombre de mots utilisés
+ */
+OPERATION void bbEt(Bitboard *a, const Bitboard *b, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    a->mots[i] &= b->mots[i];
+}
+
+/**
+ * @brief Indique si un bitboard est vide.
+ *
+ * @param b le bitboard
+ * @param n le nombre de mots utilisés
+ * @return true s'il ne contient aucune case
+ * @return false sinon
+ */
+OPERATION bool bbVide(const Bitboard *b, unsigned n) {
+  uint64_t ou = 0;
+  for (unsigned i = 0; i < n; i++)
+    ou |= b->mots[i];
+  return ou == 0;
+}
+
+/**
+ * @brief Compte les cases d'un bitboard.
+ *
+ * @param b le bitboard
+ * @param n le nombre de mots utilisés
+ * @return unsigned le nombre de bits à 1
+ */
+OPERATION unsigned bbCompter(const Bitboard *b, unsigned n) {
+  unsigned nb = 0;
+  for (unsigned i = 0; i < n; i++)
+    nb += __builtin_popcountll(b->mots[i]);
+  return nb;
+}
+
+/**
+ * @brief Donne les cases libres d'un plateau.
+ *
+ * @param cases les cases du plateau
+ * @param pions les jetons des deux joueurs
+ * @param n le nombre de mots utilisés
+ * @return Bitboard les cases sans jeton
+ */
+OPERATION Bitboard bbLibres(const Bitboard *cases, const Bitboard pions[2],
+                            unsigned n) {
+  Bitboard r = {{0}};
+  for (unsigned i = 0; i < n; i++)
+    r.mots[i] = cases->mots[i] & ~(pions[0].mots[i] | pions[1].mots[i]);
+  return r;
+}
+
+/**
+ * @brief Extrait les bits d'une colonne.
+ *
+ * @param b le bitboard
+ * @param colonne le numéro de colonne
+ * @param L le nombre de lignes du plateau (au plus 63)
+ * @param n le nombre de mots utilisés
+ * @return uint64_t les L bits de la colonne, le bas au bit 0
+ */
+OPERATION uint64_t bbColonne(const Bitboard *b, unsigned colonne,
+                                 unsigned L, unsigned n) {
+  unsigned i = colonne * (L + 1), q = i / 64, s = i % 64;
+  uint64_t bits = b->mots[q] >> s;
+  if (n > 1 && s + L > 64)
+    bits |= b->mots[q + 1] << (64 - s);
+  return bits & (((uint64_t)1 << L) - 1);
+}
+
+/**
+ * @brief Inverse des cases d'une colonne, données comme par bbColonne.
+ *
+ * @param b le bitboard
+ * @param colonne le numéro de colonne
+ * @param L le nombre de lignes du plateau (au plus 63)
+ * @param n le nombre de mots utilisés
+ * @param bits les cases à inverser, le bas de la colonne au bit 0 (L bits au
+ * plus)
+ */
+OPERATION void bbInverserColonne(Bitboard *b, unsigned colonne, unsigned L,
+                                 unsigned n, uint64_t bits) {
+  unsigned i = colonne * (L + 1), q = i / 64, s = i % 64;
+  b->mots[q] ^= bits << s;
+  if (n > 1 && s + L > 64)
+    b->mots[q + 1] ^= bits >> (64 - s);
+}
+
+/**
+ * @def DIRECTIONS
+ * @brief le décalage d'une case à la suivante dans les quatre directions,
+ * pour un plateau de L lignes : vertical, horizontal et les deux diagonales
+ */
+#define DIRECTIONS(L) {1, (L) + 1, (L), (L) + 2}
+
+/**
+ * @typedef Quadruple
+ * @brief Quatre copies d'un bitboard, une par direction (voir DIRECTIONS) :
+ * q[i][k] est le mot i de la copie de la direction k, si bien que le même mot
+ * des quatre copies se suit en mémoire.
+ */
+typedef uint64_t Quadruple[MOTS_BITBOARD][4];
+
+/**
+ * @brief Copie un bitboard dans les quatre directions d'un quadruple.
+ *
+ * @param q le quadruple
+ * @param b le bitboard
+ * @param n le nombre de mots utilisés
+ */
+OPERATION void quadCopier(Quadruple q, const Bitboard *b, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned k = 0; k < 4; k++)
+      q[i][k] = b->mots[i];
+}
+
+/**
+ * @brief Décale chaque copie d'un quadruple de pas cases dans sa direction,
+ * comme bbDecaler (vers les bits de poids faible) si fort est faux, dans
+ * l'autre sens sinon.
+ *
+ * @param r le quadruple décalé (mots au-delà de n à 0)
+ * @param q le quadruple à décaler
+ * @param pas le nombre de cases
+ * @param d les décalages d'une case à la suivante (voir DIRECTIONS)
+ * @param fort true pour décaler vers les bits de poids fort
+ * @param n le nombre de mots utilisés
+ */
+OPERATION void quadDecaler(Quadruple r, const Quadruple q, unsigned pas,
+                           const unsigned d[4], bool fort, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned k = 0; k < 4; k++) {
+      unsigned e = pas * d[k], m = e / 64, s = e % 64;
+      uint64_t t = 0;
+      if (!fort && i + m < n) {
+        t = q[i + m][k] >> s;
+        if (s && i + m + 1 < n)
+          t |= q[i + m + 1][k] << (64 - s);
+      } else if (fort && i >= m) {
+        t = q[i - m][k] << s;
+        if (s && i >= m + 1)
+          t |= q[i - m - 1][k] >> (64 - s);
+      }
+      r[i][k] = t;
+    }
+}
+
+/**
+ * @brief Calcule l'intersection de deux quadruples, dans le premier.
+ *
+ * @param a le premier quadruple, remplacé par l'intersection
+ * @param b le second quadruple
+ * @param n le nombre de mots utilisés
+ */
+OPERATION void quadEt(Quadruple a, const Quadruple b, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned k = 0; k < 4; k++)
+      a[i][k] &= b[i][k];
+}
+
+/**
+ * @brief Cherche A cases alignées dans un bitboard, dans les quatre
+ * directions à la fois : chaque bit restant après les décalages et
+ * intersections commence k cases alignées, k doublant à chaque étape
+ * (log2(A) étapes), sans s'arrêter à la première direction trouvée.
+ *
+ * @param b le bitboard
+ * @param L le nombre de lignes du plateau
+ * @param A le nombre de cases à aligner
+ * @param n le nombre de mots utilisés
+ * @return true si au moins A cases sont alignées
+ * @return false sinon
+ */
+OPERATION bool bbAligne(const Bitboard *b, unsigned L, unsigned A, unsigned n) {
+  const unsigned d[4] = DIRECTIONS(L);
+  Quadruple m, t;
+  quadCopier(m, b, n);
+  unsigned k = 1; // les bits de m commencent k cases alignées
+  while (2 * k <= A) {
+    quadDecaler(t, m, k, d, false, n);
+    quadEt(m, t, n);
+    k *= 2;
+  }
+  if (k < A) {
+    quadDecaler(t, m, A - k, d, false, n);
+    quadEt(m, t, n);
+  }
+  uint64_t ou = 0;
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned l = 0; l < 4; l++)
+      ou |= m[i][l];
+  return ou != 0;
+}
+
+/**
+ * @brief Cherche les menaces d'un joueur : les cases libres où un de ses
+ * jetons compléterait un alignement de A cases (A - 1 jetons et une case
+ * libre), jouables ou non. Une case libre l'est si, dans une direction, elle
+ * est suivie de A - 1 - a jetons et précédée de a jetons : apres[b] garde les
+ * cases suivies de b jetons, avant celles précédées de a jetons.
+ *
+ * @param joueur les jetons du joueur
+ * @param libres les cases libres (voir bbLibres)
+ * @param L le nombre de lignes du plateau
+ * @param A le nombre de cases à aligner
+ * @param n le nombre de mots utilisés
+ * @return Bitboard les cases menacées
+ */
+OPERATION Bitboard bbMenaces(const Bitboard *joueur, const Bitboard *libres,
+                             unsigned L, unsigned A, unsigned n) {
+  const unsigned d[4] = DIRECTIONS(L);
+  Quadruple j, t, avant, menaces, apres[A];
+  quadCopier(j, joueur, n);
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned k = 0; k < 4; k++)
+      apres[0][i][k] = avant[i][k] = ~(uint64_t)0;
+  for (unsigned a = 1; a < A; a++) {
+    quadDecaler(t, j, a, d, false, n);
+    for (unsigned i = 0; i < n; i++)
+      for (unsigned k = 0; k < 4; k++)
+        apres[a][i][k] = apres[a - 1][i][k] & t[i][k];
+  }
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned k = 0; k < 4; k++)
+      menaces[i][k] = apres[A - 1][i][k];
+  for (unsigned a = 1; a < A; a++) { // a jetons avant la case
+    quadDecaler(t, j, a, d, true, n);
+    quadEt(avant, t, n);
+    for (unsigned i = 0; i < n; i++)
+      for (unsigned k = 0; k < 4; k++)
+        menaces[i][k] |= apres[A - 1 - a][i][k] & avant[i][k];
+  }
+  Bitboard r = {{0}};
+  for (unsigned i = 0; i < n; i++)
+    r.mots[i] = (menaces[i][0] | menaces[i][1] | menaces[i][2] |
+                 menaces[i][3]) &
+                libres->mots[i];
+  return r;
+}
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file cache.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Cache LRU (le moins récemment utilisé est supprimé en premier) des
+ * résultats d'analyse : à une clé de position sont associés le meilleur coup,
+ * son score et la profondeur de la recherche qui les a calculés.
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "cache.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @def AUCUNE
+ * @brief indice représentant l'absence d'entrée (fin de liste)
+ */
+#define AUCUNE -1
+
+/**
+ * @struct entreeCache_
+ * @brief Une entrée du cache, chaînée dans son alvéole et dans la liste LRU.
+ * @typedef EntreeCache
+ * @brief Renommer entreeCache_.
+ */
+typedef struct entreeCache_ {
+  uint64_t cle;             //!< La clé de la position
+  int coup;                 //!< Le meilleur coup
+  int valeur;               //!< Le score du meilleur coup
+  unsigned char profondeur; //!< La profondeur de la recherche
+  int suivant;              //!< Entrée suivante dans la même alvéole
+  int prec;                 //!< Entrée utilisée plus récemment
+  int succ;                 //!< Entrée utilisée moins récemment
+} EntreeCache;
+
+/**
+ * @struct cache_
+ * @brief Une table de hachage par chaînage dont les entrées forment aussi une
+ * liste doublement chaînée, de la plus récemment utilisée à la plus ancienne.
+ */
+struct cache_ {
+  EntreeCache *entrees; //!< Les entrées (capacite cases)
+  int *alveoles;        //!< Tête de chaque alvéole (nbAlveoles cases)
+  unsigned capacite;    //!< Nombre maximal d'entrées
+  unsigned nbAlveoles;  //!< Nombre d'alvéoles, une puissance de 2
+  unsigned taille;      //!< Nombre d'entrées utilisées
+  int tete;             //!< Entrée la plus récemment utilisée
+  int queue;            //!< Entrée la moins récemment utilisée
+  StatsCache stats;     //!< Les compteurs d'utilisation
+};
+
+/**
+ * @brief Calcule l'alvéole d'une clé.
+ *
+ * @param cache le cache
+ * @param cle la clé
+ * @return unsigned l'indice de l'alvéole
+ */
+static unsigned alveole(Cache *cache, uint64_t cle) {
+  return (unsigned)((cle * 0x9E3779B97F4A7C15ULL) >> 32) &
+         (cache->nbAlveoles - 1);
+}
+
+/**
+ * @brief Retire une entrée de la liste LRU.
+ *
+ * @param cache le cache
+ * @param i l'indice de l'entrée
+ */
+static void detacher(Cache *cache, int i) {
+  EntreeCache *e = &cache->entrees[i];
+  if (e->prec != AUCUNE)
+    cache->entrees[e->prec].succ = e->succ;
+  else
+    cache->tete = e->succ;
+  if (e->succ != AUCUNE)
+    cache->entrees[e->succ].prec = e->prec;
+  else
+    cache->queue = e->prec;
+}
+
+/**
+ * @brief Place une entrée en tête de la liste LRU (la plus récente).
+ *
+ * @param cache le cache
+ * @param i l'indice de l'entrée
+ */
+static void enTete(Cache *cache, int i) {
+  EntreeCache *e = &cache->entrees[i];
+  e->prec = AUCUNE;
+  e->succ = cache->tete;
+  if (cache->tete != AUCUNE)
+    cache->entrees[cache->tete].prec = i;
+  cache->tete = i;
+  if (cache->queue == AUCUNE)
+    cache->queue = i;
+}
+
+/**
+ * @brief Cherche l'entrée d'une clé.
+ *
+ * @param cache le cache
+ * @param cle la clé
+ * @return int l'indice de l'entrée, AUCUNE si la clé n'est pas dans le cache
+ */
+static int trouver(Cache *cache, uint64_t cle) {
+  int i = cache->alveoles[alveole(cache, cle)];
+  while (i != AUCUNE && cache->entrees[i].cle != cle)
+    i = cache->entrees[i].suivant;
+  return i;
+}
+
+/**
+ * @brief Supprime l'entrée la moins récemment utilisée pour libérer sa place.
+ *
+ * @param cache le cache
+ * @return int l'indice de l'entrée libérée
+ */
+static int evincer(Cache *cache) {
+  int i = cache->queue;
+  assert(i != AUCUNE);
+  detacher(cache, i);
+  int *p = &cache->alveoles[alveole(cache, cache->entrees[i].cle)];
+  while (*p != i)
+    p = &cache->entrees[*p].suivant;
+  *p = cache->entrees[i].suivant;
+  cache->stats.evictions++;
+  return i;
+}
+
+/**
+ * @brief Crée un cache vide.
+ *
+ * @param capacite le nombre maximal d'entrées
+ * @return Cache* le cache, NULL en cas de problème d'allocation
+ */
+Cache *makeCache(unsigned capacite) {
+  assert(capacite > 0);
+  Cache *cache = malloc(sizeof(Cache));
+  if (!cache) {
+    perror("Problème d'allocation dans makeCache.");
+    return NULL;
+  }
+  cache->nbAlveoles = 1;
+  while (cache->nbAlveoles < capacite)
+    cache->nbAlveoles <<= 1;
+  cache->entrees = malloc(capacite * sizeof(EntreeCache));
+  cache->alveoles = malloc(cache->nbAlveoles * sizeof(int));
+  if (!cache->entrees || !cache->alveoles) {
+    perror("Problème d'allocation dans makeCache.");
+    destroyCache(cache);
+    return NULL;
+  }
+  cache->capacite = capacite;
+  viderCache(cache);
+  cache->stats = (StatsCache){0, 0, 0};
+  return cache;
+}
+
+/**
+ * @brief Cherche le résultat d'une position dans le cache. Le résultat n'est
+ * utilisable que s'il a été calculé avec une profondeur au moins égale à celle
+ * demandée.
+ *
+ * @param cache le cache
+ * @param cle la clé de la position
+ * @param profondeur la profondeur de recherche demandée
+ * @param coup le meilleur coup, renseigné en cas de succès
+ * @param valeur le score du meilleur coup, renseigné en cas de succès
+ * @return true si un résultat utilisable a été trouvé
+ * @return false sinon
+ */
+bool chercherCache(Cache *cache, uint64_t cle, unsigned char profondeur,
+                   int *coup, int *valeur) {
+  assert(cache);
+  int i = trouver(cache, cle);
+  if (i == AUCUNE || cache->entrees[i].profondeur < profondeur) {
+    cache->stats.echecs++;
+    return false;
+  }
+  detacher(cache, i);
+  enTete(cache, i);
+  *coup = cache->entrees[i].coup;
+  *valeur = cache->entrees[i].valeur;
+  cache->stats.succes++;
+  return true;
+}
+
+/**
+ * @brief Ajoute (ou met à jour) le résultat d'une position. Un résultat déjà
+ * présent n'est remplacé que par un résultat au moins aussi profond.
+ *
+ * @param cache le cache
+ * @param cle la clé de la position
+ * @param profondeur la profondeur de la recherche
+ * @param coup le meilleur coup
+ * @param valeur le score du meilleur coup
+ */
+void ajouterCache(Cache *cache, uint64_t cle, unsigned char profondeur,
+                  int coup, int valeur) {
+  assert(cache);
+  int i = trouver(cache, cle);
+  if (i != AUCUNE) {
+    detacher(cache, i);
+  } else {
+    if (cache->taille < cache->capacite)
+      i = cache->taille++;
+    else
+      i = evincer(cache);
+    unsigned a = alveole(cache, cle);
+    cache->entrees[i].cle = cle;
+    cache->entrees[i].profondeur = 0;
+    cache->entrees[i].suivant = cache->alveoles[a];
+    cache->alveoles[a] = i;
+  }
+  EntreeCache *e = &cache->entrees[i];
+  if (profondeur >= e->profondeur) {
+    e->coup = coup;
+    e->valeur = valeur;
+    e->profondeur = profondeur;
+  }
+  enTete(cache, i);
+}
+
+/**
+ * @brief Récupère les compteurs d'utilisation d'un cache.
+ *
+ * @param cache le cache
+ * @return StatsCache les compteurs
+ */
+StatsCache statsCache(Cache *cache) {
+  assert(cache);
+  return cache->stats;
+}
+
+/**
+ * @brief Vide un cache (les compteurs sont conservés).
+ *
+ * @param cache le cache
+ */
+void viderCache(Cache *cache) {
+  assert(cache);
+  for (unsigned i = 0; i < cache->nbAlveoles; i++)
+    cache->alveoles[i] = AUCUNE;
+  cache->taille = 0;
+  cache->tete = AUCUNE;
+  cache->queue = AUCUNE;
+}
+
+/**
+ * @brief Supprime un cache.
+ *
+ * @param cache le cache
+ */
+void destroyCache(Cache *cache) {
+  if (cache) {
+    free(cache->entrees);
+    free(cache->alveoles);
+  }
+  free(cache);
+}
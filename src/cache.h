@@ -0,0 +1,48 @@
+/**
+ * @file cache.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition du cache LRU des résultats d'analyse de positions.
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef CACHE_H
+/**
+ * @def CACHE_H
+ * @brief la garde
+ */
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @typedef Cache
+ * @brief Renommer cache_ (structure opaque).
+ */
+typedef struct cache_ Cache;
+
+/**
+ * @struct statsCache_
+ * @brief Les compteurs d'utilisation d'un cache.
+ * @typedef StatsCache
+ * @brief Renommer statsCache_.
+ */
+typedef struct statsCache_ {
+  unsigned long long succes;    //!< Recherches ayant trouvé un résultat utile
+  unsigned long long echecs;    //!< Recherches sans résultat utilisable
+  unsigned long long evictions; //!< Entrées supprimées faute de place
+} StatsCache;
+
+Cache *makeCache(unsigned);
+bool chercherCache(Cache *, uint64_t, unsigned char, int *, int *);
+void ajouterCache(Cache *, uint64_t, unsigned char, int, int);
+StatsCache statsCache(Cache *);
+void viderCache(Cache *);
+void destroyCache(Cache *);
+
+#endif
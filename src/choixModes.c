@@ -68,6 +68,28 @@ void choix_mode(char *mode) {
   assert(*mode == 'h' || *mode == 'a' || *mode == 'i' || *mode == 's');
 }
 
+/**
+ * @brief Dialogue avec l'utilisateur pour lui permettre de choisir les règles
+ * de la partie.
+ *
+ * @param regle un caractère, 's' pour les règles standard et 'p' pour la règle
+ * Pop Out
+ */
+void choix_regle(char *regle) {
+  printf("Choisissez les règles. Entrez :\n"
+         "'s' pour les règles standard\n"
+         "'p' pour la règle Pop Out (retirer un de ses jetons du bas d'une "
+         "colonne)\nVotre choix : ");
+  *regle = getchar();
+  while (*regle != 's' && *regle != 'p') {
+    clearBuffer();
+    printf("Entrée incorrecte. Veuillez réessayer : ");
+    *regle = getchar();
+  }
+  clearBuffer();
+  assert(*regle == 's' || *regle == 'p');
+}
+
 /**
  * @brief Dialogue avec l'utilisateur pour lui permettre de choisir le niveau de
  * l'IA avec lequel il souhaite jouer.
@@ -125,3 +147,21 @@ void choix_niveaux(char *niveau1, char *niveau2) {
   assert(*niveau1 == '1' || *niveau1 == '2' || *niveau1 == '3');
   assert(*niveau2 == '1' || *niveau2 == '2' || *niveau2 == '3');
 }
+
+/**
+ * @brief Dialogue avec l'utilisateur pour lui permettre de choisir si le score
+ * de chaque colonne est affiché pendant le tour des joueurs humains.
+ *
+ * @param indices un caractère, 'o' pour afficher les scores et 'n' sinon
+ */
+void choix_indices(char *indices) {
+  printf("Afficher le score de chaque colonne pendant votre tour ? (o/n) : ");
+  *indices = getchar();
+  while (*indices != 'o' && *indices != 'n') {
+    clearBuffer();
+    printf("Entrée incorrecte. Veuillez réessayer : ");
+    *indices = getchar();
+  }
+  clearBuffer();
+  assert(*indices == 'o' || *indices == 'n');
+}
@@ -20,7 +20,9 @@
 
 void choix_interface(char *);
 void choix_mode(char *);
+void choix_regle(char *);
 void choix_niveau(char *);
 void choix_niveaux(char *, char *);
+void choix_indices(char *);
 
 #endif
\ No newline at end of file
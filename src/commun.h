@@ -0,0 +1,58 @@
+/**
+ * @file commun.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Petites fonctions communes aux modules, aux outils, aux tests et aux
+ * bancs d'essai : l'horloge des mesures de durée et le générateur
+ * pseudo-aléatoire.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef COMMUN_H
+/**
+ * @def COMMUN_H
+ * @brief la garde
+ */
+#define COMMUN_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Donne le temps écoulé depuis un instant arbitraire, le même pour
+ * tous les threads (horloge monotone).
+ *
+ * @return uint64_t le temps en nanosecondes
+ */
+static inline uint64_t maintenant() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/**
+ * @brief Donne le temps de maintenant en secondes, pour les mesures longues.
+ *
+ * @return double le temps en secondes
+ */
+static inline double secondes() { return maintenant() * 1e-9; }
+
+/**
+ * @brief Tire un nombre pseudo-aléatoire (xorshift) : une graine donnée
+ * donne toujours la même suite.
+ *
+ * @param graine l'état du générateur, non nul
+ * @return uint64_t le nombre tiré, jamais nul
+ */
+static inline uint64_t tirer(uint64_t *graine) {
+  *graine ^= *graine << 13;
+  *graine ^= *graine >> 7;
+  *graine ^= *graine << 17;
+  return *graine;
+}
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "console.h"
+#include "ia.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -59,7 +60,7 @@ static void printPlateau(void *data, Puissance4 *game) {
   printf("\e[1;1H\e[2J");
   unsigned c, l;
   for (c = 0; c < NB_COLONNE; c++)
-    printf("  %u ", c + 1);
+    printf("%3u ", c + 1);
   printLigneIntermediaire();
 
   for (l = 0; l < NB_LIGNE; l++) {
@@ -70,10 +71,59 @@ static void printPlateau(void *data, Puissance4 *game) {
   }
 
   for (c = 0; c < NB_COLONNE; c++)
-    printf("  %u ", c + 1);
+    printf("%3u ", c + 1);
   printf("\n");
 }
 
+/**
+ * @brief Affiche une rangée de scores, une par colonne : G si le coup gagne,
+ * P s'il perd, - s'il est impossible. Le meilleur coup est indiqué par un ^
+ * sur la ligne suivante.
+ *
+ * @param a l'analyse de la position
+ * @param premier le premier coup de la rangée : 0 pour les ajouts,
+ * RETRAIT(0) pour les retraits
+ */
+static void printScores(const Analyse *a, int premier) {
+  for (int c = 0; c < NB_COLONNE; c++) {
+    int coup = premier + c;
+    if (!a->jouable[coup])
+      printf("  - ");
+    else if (a->scores[coup] >= VICTOIRE)
+      printf("  G ");
+    else if (a->scores[coup] <= -VICTOIRE)
+      printf("  P ");
+    else if (a->scores[coup] > 999)
+      printf("999 ");
+    else if (a->scores[coup] < -99)
+      printf("-99 ");
+    else
+      printf("%3d ", a->scores[coup]);
+  }
+  printf("\n");
+  for (int c = 0; c < NB_COLONNE; c++)
+    printf(premier + c == a->meilleur ? "  ^ " : "    ");
+  printf("\n");
+}
+
+/**
+ * @brief Affiche sous le plateau le score de chaque colonne pour le joueur
+ * courant (voir printScores). Avec la règle Pop Out, le score du retrait du
+ * jeton du bas de chaque colonne est affiché sur une seconde rangée.
+ *
+ * @param data les données de l'interface, en mode console : inutile
+ * @param game le jeu
+ */
+static void printIndices(void *data, Puissance4 *game) {
+  assert(game);
+  Analyse a = analyseColonnes(game, PROFONDEUR_INDICES);
+  printScores(&a, 0);
+  if (game->regle == POP_OUT) {
+    printf("Retraits :\n");
+    printScores(&a, RETRAIT(0));
+  }
+}
+
 /**
  * @brief Supprime ce qu'il y a dans le buffer de stdin.
  */
@@ -84,13 +134,44 @@ static void clearBuffer() {
 }
 
 /**
- * @brief Permet au joueur humain de jouer un pion.
+ * @brief Test si un coup saisi par le joueur humain est possible, sinon
+ * explique pourquoi.
+ *
+ * @param game le jeu
+ * @param coup le numéro de colonne saisi, négatif pour retirer un jeton (règle
+ * Pop Out)
+ * @return true si le coup est possible
+ * @return false sinon
+ */
+static bool coupPossible(Puissance4 *game, int coup) {
+  int colonne = (coup < 0) ? -coup : coup;
+  if (colonne < 1 || colonne > NB_COLONNE ||
+      (coup < 0 && game->regle != POP_OUT)) {
+    printf("Veuillez entrer un numéro de colonne valide, entre %d et %d: ", 1,
+           NB_COLONNE);
+    return false;
+  }
+  if (coup > 0 && testColonne(game->plateau, colonne - 1) == -1) {
+    printf("Cette colonne est pleine, veuillez en choisir une autre: ");
+    return false;
+  }
+  if (coup < 0 && !retraitPossible(game, colonne - 1)) {
+    printf("Le jeton du bas de cette colonne n'est pas à vous, veuillez en "
+           "choisir une autre: ");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Permet au joueur humain de jouer un pion : le numéro de sa colonne,
+ * ou son opposé pour retirer le jeton du bas de la colonne (règle Pop Out).
  *
  * @param game le jeu
- * @return unsigned la colonne où le joueur place un pion
+ * @return unsigned le coup du joueur (voir RETRAIT)
  */
 static unsigned playHumainConsole(Puissance4 *game) {
-  int coup = -1;
+  int coup = 0;
   assert(game);
   assert(game->courant);
   (game->courant->type == J1) ? (printf("Joueur 1 (X): "))
@@ -99,20 +180,14 @@ static unsigned playHumainConsole(Puissance4 *game) {
     printf("Entrée incorrecte. Veuillez réessayer: ");
     clearBuffer();
   }
-  while (coup < 1 || coup > NB_COLONNE ||
-         testColonne(game->plateau, coup - 1) == -1) {
-    if (coup < 1 || coup > NB_COLONNE) {
-      printf("Veuillez entrer un numéro de colonne valide, entre %d et %d: ", 1,
-             NB_COLONNE);
-    } else
-      printf("Cette colonne est pleine, veuillez en choisir une autre: ");
+  while (!coupPossible(game, coup)) {
     while (!scanf("%d", &coup)) {
       printf("Entrée incorrecte. Veuillez réessayer: ");
       clearBuffer();
     }
   }
   clearBuffer();
-  return coup - 1;
+  return (coup < 0) ? RETRAIT(-coup - 1) : coup - 1;
 }
 
 /**
@@ -165,6 +240,7 @@ userInterface *makeConsole() {
   ui->initAffichage = &printPlateau;
   ui->affichage = &printPlateau;
   ui->getProchainCoup = &prochainCoup;
+  ui->afficherIndices = &printIndices;
   ui->endAffichage = &finDePartie;
   ui->destroy = &destruction;
   return ui;
@@ -185,6 +261,7 @@ Joueur *makeHumainConsole(Type t) {
     return NULL;
   }
   j->type = t;
+  j->profondeur = 0;
   j->play = &playHumainConsole;
   return j;
 }
\ No newline at end of file
@@ -0,0 +1,536 @@
+/**
+ * @file donnees.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Les fichiers de données d'auto-jeu.
+ *
+ * Un fichier commence par un en-tête, suivi des enregistrements (Donnee) les
+ * uns après les autres : il se lit en le projetant en mémoire, comme un
+ * tableau. Les enregistrements ne sont qu'ajoutés à la fin : plusieurs
+ * threads peuvent écrire par le même écrivain, et plusieurs processus dans le
+ * même fichier (chaque écriture se fait sous verrou exclusif, flock). Pour
+ * répartir les données, chaque générateur peut aussi écrire son propre
+ * fichier. Après un arrêt brutal, l'enregistrement à moitié écrit est ignoré
+ * à la lecture et retiré à l'ouverture suivante par un écrivain.
+ *
+ * Les enregistrements ajoutés sont copiés dans un tampon ; un thread de
+ * l'écrivain écrit chaque tampon plein pendant que le suivant se remplit. Un
+ * ajout n'est jamais coupé entre deux tampons : ce qui n'entre plus dans le
+ * tampon part dans le suivant, et un ajout plus grand qu'un tampon est écrit
+ * directement, d'une seule écriture.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "donnees.h"
+#include "commun.h"
+#include "ia.h"
+#include "puissance_quatre.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @def VERSION
+ * @brief la version du format des fichiers de données
+ */
+#define VERSION 1
+
+/**
+ * @def TAILLE_TAMPON
+ * @brief le nombre d'enregistrements d'un tampon de l'écrivain
+ */
+#define TAILLE_TAMPON 4096
+
+/**
+ * @def OUVERTURE_DONNEES
+ * @brief le nombre de coups tirés au hasard au début de chaque partie
+ * d'auto-jeu, pour que les parties diffèrent
+ */
+#define OUVERTURE_DONNEES 4
+
+_Static_assert(sizeof(Donnee) == 24,
+               "un enregistrement de données doit tenir sur 24 octets");
+
+/**
+ * @struct entete_
+ * @brief L'en-tête d'un fichier de données, suivi de ses enregistrements.
+ * @typedef Entete
+ * @brief Renommer entete_.
+ */
+typedef struct entete_ {
+  char magie[4];      //!< "P4DA"
+  uint32_t version;   //!< VERSION
+  uint32_t geometrie; //!< CODE_GEOMETRIE
+  uint32_t taille;    //!< La taille d'un enregistrement
+} Entete;
+
+/**
+ * @struct ecrivain_
+ * @brief Un fichier de données ouvert en ajout. Des deux tampons, l'un se
+ * remplit pendant que le thread écrit l'autre.
+ */
+struct ecrivain_ {
+  int fd;                 //!< Le fichier, ouvert en ajout
+  pthread_t thread;       //!< Le thread qui écrit les tampons
+  pthread_mutex_t ajouts; //!< Le verrou des ajouts, un à la fois
+  pthread_mutex_t verrou; //!< Le verrou des échanges avec le thread
+  pthread_cond_t pret;    //!< Signalé quand un tampon est à écrire
+  pthread_cond_t libre;   //!< Signalé quand un tampon a été écrit
+  Donnee *tampons[2];     //!< Les tampons de TAILLE_TAMPON enregistrements
+  size_t nb[2];           //!< Le nombre d'enregistrements de chaque tampon
+  unsigned remplissage;   //!< Le tampon qui se remplit
+  bool aEcrire;           //!< true si l'autre tampon attend d'être écrit
+  bool fin;               //!< true quand l'écrivain est fermé
+  bool erreur;            //!< true si une écriture a échoué
+};
+
+/**
+ * @struct donnees_
+ * @brief Un fichier de données projeté en mémoire.
+ */
+struct donnees_ {
+  void *projection;      //!< Le fichier projeté
+  size_t taille;         //!< La taille de la projection
+  const Donnee *donnees; //!< Ses enregistrements
+  size_t nb;             //!< Leur nombre
+};
+
+/**
+ * @brief Écrit des octets à la fin du fichier, sous verrou exclusif pour
+ * qu'un autre processus n'intercale pas ses enregistrements.
+ *
+ * @param fd le fichier, ouvert en ajout
+ * @param octets les octets
+ * @param taille leur nombre
+ * @return true si tout a été écrit
+ * @return false sinon
+ */
+static bool ecrireFin(int fd, const void *octets, size_t taille) {
+  if (flock(fd, LOCK_EX) == -1)
+    return false;
+  size_t ecrits = 0;
+  while (ecrits < taille) {
+    ssize_t w = write(fd, (const char *)octets + ecrits, taille - ecrits);
+    if (w <= 0)
+      break;
+    ecrits += w;
+  }
+  flock(fd, LOCK_UN);
+  return ecrits == taille;
+}
+
+/**
+ * @brief Le thread d'un écrivain : écrit chaque tampon qu'on lui passe,
+ * jusqu'à la fermeture.
+ *
+ * @param arg l'écrivain
+ * @return void* NULL
+ */
+static void *ecrire(void *arg) {
+  Ecrivain *e = arg;
+  pthread_mutex_lock(&e->verrou);
+  for (;;) {
+    while (!e->aEcrire && !e->fin)
+      pthread_cond_wait(&e->pret, &e->verrou);
+    if (!e->aEcrire)
+      break;
+    unsigned i = 1 - e->remplissage;
+    pthread_mutex_unlock(&e->verrou); // les ajouts continuent pendant ce temps
+    bool ok = ecrireFin(e->fd, e->tampons[i], e->nb[i] * sizeof(Donnee));
+    if (!ok)
+      perror("Impossible d'écrire les données");
+    pthread_mutex_lock(&e->verrou);
+    e->erreur = e->erreur || !ok;
+    e->nb[i] = 0;
+    e->aEcrire = false;
+    pthread_cond_broadcast(&e->libre);
+  }
+  pthread_mutex_unlock(&e->verrou);
+  return NULL;
+}
+
+/**
+ * @brief Attend que le thread de l'écrivain ait écrit le tampon qu'on lui a
+ * passé (le verrou des ajouts doit être pris).
+ *
+ * @param e l'écrivain
+ * @return true si les écritures précédentes ont réussi
+ * @return false sinon
+ */
+static bool attendre(Ecrivain *e) {
+  pthread_mutex_lock(&e->verrou);
+  while (e->aEcrire)
+    pthread_cond_wait(&e->libre, &e->verrou);
+  bool ok = !e->erreur;
+  pthread_mutex_unlock(&e->verrou);
+  return ok;
+}
+
+/**
+ * @brief Passe le tampon rempli au thread de l'écrivain, après avoir attendu
+ * qu'il ait écrit le précédent (le verrou des ajouts doit être pris).
+ *
+ * @param e l'écrivain
+ * @return true si les écritures précédentes ont réussi
+ * @return false sinon
+ */
+static bool envoyer(Ecrivain *e) {
+  pthread_mutex_lock(&e->verrou);
+  while (e->aEcrire)
+    pthread_cond_wait(&e->libre, &e->verrou);
+  e->aEcrire = true;
+  e->remplissage = 1 - e->remplissage;
+  bool ok = !e->erreur;
+  pthread_cond_signal(&e->pret);
+  pthread_mutex_unlock(&e->verrou);
+  return ok;
+}
+
+/**
+ * @brief Prépare un fichier de données à recevoir des enregistrements : écrit
+ * l'en-tête d'un fichier vide, vérifie celui d'un fichier existant et retire
+ * l'enregistrement à moitié écrit qui le terminerait.
+ *
+ * @param fd le fichier, ouvert en lecture et en ajout
+ * @param chemin son nom, pour les messages
+ * @return true si des enregistrements peuvent y être ajoutés
+ * @return false sinon
+ */
+static bool preparer(int fd, const char *chemin) {
+  if (flock(fd, LOCK_EX) == -1) {
+    perror("Impossible de verrouiller les données");
+    return false;
+  }
+  struct stat s;
+  Entete attendu = {{'P', '4', 'D', 'A'}, VERSION, CODE_GEOMETRIE,
+                    sizeof(Donnee)},
+         lu;
+  bool ok = fstat(fd, &s) == 0;
+  if (ok && s.st_size == 0) {
+    ok = write(fd, &attendu, sizeof(attendu)) == sizeof(attendu);
+  } else if (ok) {
+    ok = pread(fd, &lu, sizeof(lu), 0) == sizeof(lu) &&
+         memcmp(&lu, &attendu, sizeof(lu)) == 0;
+    if (!ok)
+      fprintf(stderr, "%s n'est pas un fichier de données de ce plateau.\n",
+              chemin);
+    size_t reste = (s.st_size - sizeof(Entete)) % sizeof(Donnee);
+    if (ok && reste != 0) {
+      fprintf(stderr, "Fin du fichier de données abîmée, retirée : %s\n",
+              chemin);
+      ok = ftruncate(fd, s.st_size - reste) == 0;
+    }
+  }
+  flock(fd, LOCK_UN);
+  return ok;
+}
+
+/**
+ * @brief Ouvre un fichier de données du plateau de geometrie en ajout, créé
+ * s'il n'existe pas, et lance le thread qui l'écrit. Le plateau doit tenir sur
+ * un mot de bitboard (voir Lot).
+ *
+ * @param chemin le fichier
+ * @return Ecrivain* l'écrivain, NULL si le fichier ne peut pas être ouvert ou
+ * n'est pas un fichier de données de ce plateau, ou en cas de problème
+ * d'allocation
+ */
+Ecrivain *ouvrirEcrivain(const char *chemin) {
+  assert(chemin);
+  if (MOTS_UTILES(NB_LIGNE, NB_COLONNE) > 1) {
+    fprintf(stderr, "Données impossibles : le plateau %ux%u ne tient pas sur "
+                    "64 bits.\n",
+            NB_LIGNE, NB_COLONNE);
+    return NULL;
+  }
+  Ecrivain *e = calloc(1, sizeof(Ecrivain));
+  if (!e) {
+    perror("Problème d'allocation dans ouvrirEcrivain.");
+    return NULL;
+  }
+  e->tampons[0] = malloc(TAILLE_TAMPON * sizeof(Donnee));
+  e->tampons[1] = malloc(TAILLE_TAMPON * sizeof(Donnee));
+  if (!e->tampons[0] || !e->tampons[1]) {
+    perror("Problème d'allocation dans ouvrirEcrivain.");
+    free(e->tampons[0]);
+    free(e->tampons[1]);
+    free(e);
+    return NULL;
+  }
+  e->fd = open(chemin, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (e->fd == -1)
+    perror("Impossible d'ouvrir les données");
+  pthread_mutex_init(&e->ajouts, NULL);
+  pthread_mutex_init(&e->verrou, NULL);
+  pthread_cond_init(&e->pret, NULL);
+  pthread_cond_init(&e->libre, NULL);
+  if (e->fd == -1 || !preparer(e->fd, chemin) ||
+      pthread_create(&e->thread, NULL, &ecrire, e) != 0) {
+    if (e->fd != -1)
+      close(e->fd);
+    pthread_mutex_destroy(&e->ajouts);
+    pthread_mutex_destroy(&e->verrou);
+    pthread_cond_destroy(&e->pret);
+    pthread_cond_destroy(&e->libre);
+    free(e->tampons[0]);
+    free(e->tampons[1]);
+    free(e);
+    return NULL;
+  }
+  return e;
+}
+
+/**
+ * @brief Ajoute des enregistrements à la fin d'un fichier de données. Ils sont
+ * écrits par le thread de l'écrivain, tampon par tampon, ou directement s'ils
+ * ne tiennent pas dans un tampon ; ceux ajoutés par un même appel se suivent
+ * dans le fichier, même si d'autres processus y écrivent. Plusieurs threads
+ * peuvent ajouter en même temps.
+ *
+ * @param e l'écrivain
+ * @param donnees les enregistrements
+ * @param nb leur nombre
+ * @return true si les enregistrements sont pris
+ * @return false si une écriture précédente a échoué
+ */
+bool ajouterDonnees(Ecrivain *e, const Donnee *donnees, size_t nb) {
+  assert(e && (donnees || nb == 0));
+  pthread_mutex_lock(&e->ajouts); // le tampon qui se remplit est à l'ajout
+  bool ok = true;
+  if (nb > TAILLE_TAMPON - e->nb[e->remplissage]) { // ne pas couper l'ajout
+    if (e->nb[e->remplissage] > 0)
+      ok = envoyer(e);
+    if (ok && nb > TAILLE_TAMPON) { // après les tampons, pour garder l'ordre
+      ok = attendre(e);
+      if (ok && !ecrireFin(e->fd, donnees, nb * sizeof(Donnee))) {
+        perror("Impossible d'écrire les données");
+        pthread_mutex_lock(&e->verrou);
+        e->erreur = true;
+        pthread_mutex_unlock(&e->verrou);
+        ok = false;
+      }
+      nb = 0;
+    }
+  }
+  if (ok && nb > 0) {
+    unsigned r = e->remplissage;
+    memcpy(e->tampons[r] + e->nb[r], donnees, nb * sizeof(Donnee));
+    e->nb[r] += nb;
+    if (e->nb[r] == TAILLE_TAMPON)
+      ok = envoyer(e);
+  }
+  if (ok) {
+    pthread_mutex_lock(&e->verrou);
+    ok = !e->erreur;
+    pthread_mutex_unlock(&e->verrou);
+  }
+  pthread_mutex_unlock(&e->ajouts);
+  return ok;
+}
+
+/**
+ * @brief Écrit les derniers enregistrements, arrête le thread de l'écrivain et
+ * ferme le fichier.
+ *
+ * @param e l'écrivain, NULL si aucun
+ * @return true si tous les enregistrements ajoutés ont été écrits
+ * @return false sinon
+ */
+bool fermerEcrivain(Ecrivain *e) {
+  if (!e)
+    return true;
+  pthread_mutex_lock(&e->ajouts);
+  if (e->nb[e->remplissage] > 0)
+    envoyer(e);
+  pthread_mutex_unlock(&e->ajouts);
+  pthread_mutex_lock(&e->verrou);
+  e->fin = true;
+  pthread_cond_signal(&e->pret);
+  pthread_mutex_unlock(&e->verrou);
+  pthread_join(e->thread, NULL);
+  bool ok = !e->erreur;
+  if (close(e->fd) == -1) {
+    perror("Impossible d'écrire les données");
+    ok = false;
+  }
+  pthread_mutex_destroy(&e->ajouts);
+  pthread_mutex_destroy(&e->verrou);
+  pthread_cond_destroy(&e->pret);
+  pthread_cond_destroy(&e->libre);
+  free(e->tampons[0]);
+  free(e->tampons[1]);
+  free(e);
+  return ok;
+}
+
+/**
+ * @brief Joue un coup au hasard parmi les colonnes non pleines.
+ *
+ * @param game le jeu, en cours
+ * @param graine l'état du générateur (xorshift)
+ * @return unsigned la colonne
+ */
+static unsigned coupHasard(Puissance4 *game, uint64_t *graine) {
+  unsigned possibles[NB_COLONNE_MAX], nb = 0;
+  for (unsigned c = 0; c < NB_COLONNE; c++)
+    if (ligneLibre(game, c) != -1)
+      possibles[nb++] = c;
+  assert(nb > 0);
+  return possibles[tirer(graine) % nb];
+}
+
+/**
+ * @brief Fait jouer les IA contre elles-mêmes (voir meilleurCoup) aux règles
+ * standard et ajoute les positions de chaque partie, une fois finie, à un
+ * fichier de données. Les OUVERTURE_DONNEES premiers coups sont tirés au
+ * hasard et ne sont pas enregistrés.
+ *
+ * @param e l'écrivain
+ * @param parties le nombre de parties
+ * @param profondeur la profondeur des recherches
+ * @param graine la graine des premiers coups (non nulle)
+ * @return unsigned long le nombre de positions ajoutées
+ */
+unsigned long jouerDonnees(Ecrivain *e, unsigned long parties,
+                           unsigned char profondeur, uint64_t graine) {
+  assert(e && profondeur > 0 && graine);
+  Joueur j1 = {J1, profondeur, 0, NULL}, j2 = {J2, profondeur, 0, NULL};
+  Puissance4 *game = initPuissance4();
+  if (!game)
+    return 0;
+  game->j1 = &j1;
+  game->j2 = &j2;
+  game->regle = STANDARD;
+  Donnee partie[NB_LIGNE_MAX * NB_COLONNE_MAX];
+  unsigned long ajoutees = 0;
+  for (unsigned long p = 0; p < parties; p++) {
+    initGame(game);
+    changerJoueur(game); // J1 commence
+    unsigned nb = 0, coups = 0;
+    bool fin = false;
+    while (!fin) {
+      int c;
+      if (coups < OUVERTURE_DONNEES) {
+        c = coupHasard(game, &graine);
+      } else {
+        Couple meilleur = meilleurCoup(game, profondeur);
+        Type t = game->courant->type;
+        int score = meilleur.valeur;
+        c = meilleur.indice;
+        partie[nb++] = (Donnee){
+            game->pions[t - 1].mots[0],
+            game->pions[0].mots[0] | game->pions[1].mots[0],
+            score > INT16_MAX   ? INT16_MAX
+            : score < -INT16_MAX ? -INT16_MAX
+                                 : score,
+            c, 0, game->nb_jetons, profondeur, coups};
+      }
+      int l = ligneLibre(game, c);
+      assert(l != -1);
+      modifJeton(game, l, c, game->courant->type);
+      coups++;
+      fin = testEnd(game, l, c);
+      if (!fin)
+        changerJoueur(game);
+    }
+    // game->courant : le gagnant, NULL en cas d'égalité
+    for (unsigned i = 0; i < nb; i++) {
+      bool trait1 = partie[i].jetons % 2 == 0; // J1 au trait
+      if (game->courant)
+        partie[i].resultat =
+            (trait1 == (game->courant->type == J1)) ? 1 : -1;
+      partie[i].restants = coups - partie[i].restants;
+    }
+    if (!ajouterDonnees(e, partie, nb))
+      break;
+    ajoutees += nb;
+  }
+  free(game);
+  return ajoutees;
+}
+
+/**
+ * @brief Ouvre un fichier de données du plateau de geometrie en le projetant
+ * en mémoire. Un enregistrement en cours d'écriture à la fin est ignoré.
+ *
+ * @param chemin le fichier
+ * @return Donnees* les données, NULL si le fichier ne peut pas être ouvert ou
+ * n'est pas un fichier de données de ce plateau
+ */
+Donnees *ouvrirDonnees(const char *chemin) {
+  assert(chemin);
+  int fd = open(chemin, O_RDONLY);
+  if (fd == -1) {
+    perror("Impossible d'ouvrir les données");
+    return NULL;
+  }
+  struct stat s;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &s) == 0 && (size_t)s.st_size >= sizeof(Entete))
+    p = mmap(NULL, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "Données illisibles : %s\n", chemin);
+    return NULL;
+  }
+  const Entete *e = p;
+  if (memcmp(e->magie, "P4DA", 4) != 0 || e->version != VERSION ||
+      e->geometrie != CODE_GEOMETRIE || e->taille != sizeof(Donnee)) {
+    fprintf(stderr, "%s n'est pas un fichier de données de ce plateau.\n",
+            chemin);
+    munmap(p, s.st_size);
+    return NULL;
+  }
+  Donnees *d = malloc(sizeof(Donnees));
+  if (!d) {
+    perror("Problème d'allocation dans ouvrirDonnees.");
+    munmap(p, s.st_size);
+    return NULL;
+  }
+  madvise(p, s.st_size, MADV_SEQUENTIAL); // parcouru du début à la fin
+  d->projection = p;
+  d->taille = s.st_size;
+  d->donnees = (const Donnee *)(e + 1);
+  d->nb = (s.st_size - sizeof(Entete)) / sizeof(Donnee);
+  return d;
+}
+
+/**
+ * @brief Donne les enregistrements d'un fichier de données, tels qu'ils sont
+ * projetés (valables jusqu'à fermerDonnees).
+ *
+ * @param d les données
+ * @param nb renseigné avec le nombre d'enregistrements
+ * @return const Donnee* le premier enregistrement
+ */
+const Donnee *lireDonnees(const Donnees *d, size_t *nb) {
+  assert(d && nb);
+  *nb = d->nb;
+  return d->donnees;
+}
+
+/**
+ * @brief Ferme un fichier de données projeté.
+ *
+ * @param d les données, NULL si aucunes
+ */
+void fermerDonnees(Donnees *d) {
+  if (!d)
+    return;
+  munmap(d->projection, d->taille);
+  free(d);
+}
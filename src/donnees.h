@@ -0,0 +1,67 @@
+/**
+ * @file donnees.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fichiers de données d'auto-jeu : les positions de
+ * parties jouées par les IA contre elles-mêmes, avec le score et le meilleur
+ * coup de leur recherche et le résultat de la partie, en enregistrements de
+ * taille fixe (voir make donnees).
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef DONNEES_H
+/**
+ * @def DONNEES_H
+ * @brief la garde
+ */
+#define DONNEES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @struct donnee_
+ * @brief Une position d'auto-jeu, telle qu'elle est écrite dans les fichiers
+ * (24 octets). La position est codée comme dans les lots (voir Lot), sur un
+ * plateau qui tient sur un mot de bitboard ; les scores et résultats sont pour
+ * le joueur au trait.
+ * @typedef Donnee
+ * @brief Renommer donnee_.
+ */
+typedef struct donnee_ {
+  uint64_t joueur;    //!< Jetons du joueur au trait
+  uint64_t occupees;  //!< Jetons des deux joueurs
+  int16_t score;      //!< Score de la recherche (voir VICTOIRE)
+  int8_t coup;        //!< Meilleur coup de la recherche (la colonne)
+  int8_t resultat;    //!< Résultat de la partie : 1 gagnée, 0 nulle, -1 perdue
+  uint8_t jetons;     //!< Nombre de jetons
+  uint8_t profondeur; //!< Profondeur de la recherche
+  uint16_t restants;  //!< Nombre de coups joués ensuite jusqu'à la fin
+} Donnee;
+
+/**
+ * @typedef Ecrivain
+ * @brief Renommer ecrivain_ (structure opaque).
+ */
+typedef struct ecrivain_ Ecrivain;
+
+/**
+ * @typedef Donnees
+ * @brief Renommer donnees_ (structure opaque).
+ */
+typedef struct donnees_ Donnees;
+
+Ecrivain *ouvrirEcrivain(const char *);
+bool ajouterDonnees(Ecrivain *, const Donnee *, size_t);
+bool fermerEcrivain(Ecrivain *);
+unsigned long jouerDonnees(Ecrivain *, unsigned long, unsigned char, uint64_t);
+Donnees *ouvrirDonnees(const char *);
+const Donnee *lireDonnees(const Donnees *, size_t *);
+void fermerDonnees(Donnees *);
+
+#endif
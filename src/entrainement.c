@@ -0,0 +1,784 @@
+/**
+ * @file entrainement.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief L'entraînement du réseau d'évaluation.
+ *
+ * Les exemples sont tirés de parties jouées au hasard, à la tactique près
+ * (coup gagnant, parade, pas de jeton sous une menace adverse) : plusieurs
+ * threads jouent chacun leurs parties et résolvent par df-pn, avec leur
+ * propre solveur, une partie des positions rencontrées. Celles que df-pn ne
+ * résout pas dans son budget sont écartées.
+ *
+ * Le réseau est ensuite ajusté en flottants par descente de gradient (Adam)
+ * sur l'entropie croisée entre la probabilité de gain qu'il prédit (la
+ * sigmoïde de sa sortie) et le résultat exact : une régression logistique à
+ * travers les couches du réseau. Chaque lot d'exemples est partagé entre des
+ * threads qui extraient les entrées de leurs exemples et cumulent leur
+ * gradient. Les poids sont bornés pour tenir dans les entiers de Reseau, puis
+ * arrondis.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "entrainement.h"
+#include "commun.h"
+#include "ia.h"
+#include "preuve.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @def MAX_THREADS
+ * @brief le nombre maximal de threads
+ */
+#define MAX_THREADS 64
+
+/**
+ * @def TAILLE_PREUVE_EXEMPLES
+ * @brief le nombre d'entrées de la table de df-pn de chaque thread
+ */
+#define TAILLE_PREUVE_EXEMPLES (1 << 16)
+
+/**
+ * @def JETONS_MIN_EXEMPLE
+ * @brief le nombre minimal de jetons d'une position d'entraînement
+ */
+#define JETONS_MIN_EXEMPLE 6
+
+/**
+ * @def PROPORTION_EXEMPLES
+ * @brief une position sur PROPORTION_EXEMPLES en moyenne est résolue
+ */
+#define PROPORTION_EXEMPLES 3
+
+/**
+ * @def TAILLE_LOT_ENTRAINEMENT
+ * @brief le nombre d'exemples par pas de gradient
+ */
+#define TAILLE_LOT_ENTRAINEMENT 1024
+
+/**
+ * @def PART_VALIDATION
+ * @brief les exemples gardés pour la validation (1 sur PART_VALIDATION)
+ */
+#define PART_VALIDATION 10
+
+/**
+ * @def TAUX_APPRENTISSAGE
+ * @brief le pas d'Adam
+ */
+#define TAUX_APPRENTISSAGE 0.002f
+
+/**
+ * @def OUVERTURE_MATCH
+ * @brief le nombre de coups tirés au hasard au début de chaque partie d'un
+ * match
+ */
+#define OUVERTURE_MATCH 2
+
+/**
+ * @def NB_CASES_MAX
+ * @brief le nombre maximal de cases d'un plateau
+ */
+#define NB_CASES_MAX (NB_LIGNE_MAX * NB_COLONNE_MAX)
+
+/**
+ * @struct modele_
+ * @brief Les poids d'un réseau en flottants, aux valeurs réelles (voir
+ * Reseau), pendant l'entraînement. Sert aussi pour le gradient et les moments
+ * d'Adam, comme un tableau de NB_PARAMETRES flottants.
+ * @typedef Modele
+ * @brief Renommer modele_.
+ */
+typedef struct modele_ {
+  float w1[RESEAU_ENTREES_MAX][RESEAU_CACHEES]; //!< poids1
+  float b1[RESEAU_CACHEES];                     //!< biais1
+  float w2[RESEAU_SECONDE][2 * RESEAU_CACHEES]; //!< poids2
+  float b2[RESEAU_SECONDE];                     //!< biais2
+  float w3[RESEAU_SECONDE];                     //!< poids3
+  float b3;                                     //!< biais3
+} Modele;
+
+/**
+ * @def NB_PARAMETRES
+ * @brief le nombre de flottants d'un Modele
+ */
+#define NB_PARAMETRES (sizeof(Modele) / sizeof(float))
+
+/**
+ * @struct production_
+ * @brief La production d'exemples partagée par les threads.
+ * @typedef Production
+ * @brief Renommer production_.
+ */
+typedef struct production_ {
+  Exemple *exemples;               //!< Les exemples produits
+  unsigned long nb;                //!< Le nombre d'exemples voulus
+  atomic_ulong produits;           //!< Les exemples réservés par les threads
+  atomic_ulong parties;            //!< Les parties jouées
+  atomic_ulong ecartees;           //!< Les positions non résolues
+  unsigned long long budget;       //!< Le budget de df-pn par position
+  bool ok;                         //!< false en cas de problème d'allocation
+} Production;
+
+/**
+ * @struct producteur_
+ * @brief Le travail d'un thread de production.
+ * @typedef Producteur
+ * @brief Renommer producteur_.
+ */
+typedef struct producteur_ {
+  Production *production; //!< La production partagée
+  uint64_t graine;        //!< L'état du générateur du thread
+} Producteur;
+
+/**
+ * @struct calcul_
+ * @brief Le travail d'un thread de l'entraînement : des exemples dont il
+ * cumule la perte et, si demandé, le gradient.
+ * @typedef Calcul
+ * @brief Renommer calcul_.
+ */
+typedef struct calcul_ {
+  const Modele *modele;         //!< Les poids courants
+  const Exemple *exemples;      //!< Tous les exemples
+  const unsigned long *ordre;   //!< Les indices des exemples dans l'ordre
+  unsigned long debut;          //!< Le premier rang traité
+  unsigned long fin;            //!< Le rang suivant le dernier
+  unsigned epoque;              //!< L'époque (pour les symétries)
+  Modele *gradient;             //!< Le gradient cumulé, NULL si inutile
+  double perte;                 //!< La perte cumulée
+} Calcul;
+
+/**
+ * @brief Tire un flottant entre -borne et borne.
+ *
+ * @param graine l'état du générateur
+ * @param borne la borne
+ * @return float le flottant tiré
+ */
+static float tirerFlottant(uint64_t *graine, float borne) {
+  return borne * (2.0f * (float)(tirer(graine) >> 40) / (1 << 24) - 1.0f);
+}
+
+/**
+ * @brief Choisit le coup d'une partie d'entraînement : un coup gagnant s'il y
+ * en a, sinon la parade d'une menace de l'adversaire, sinon une colonne au
+ * hasard parmi celles qui ne lui offrent pas la case au-dessus d'une de ses
+ * menaces.
+ *
+ * @param game le jeu, en cours
+ * @param graine l'état du générateur
+ * @return unsigned la colonne jouée
+ */
+static unsigned choisirCoup(Puissance4 *game, uint64_t *graine) {
+  Type joueur = game->courant->type, adversaire = (joueur == J1) ? J2 : J1;
+  Bitboard gains = menaces(game, joueur), pertes = menaces(game, adversaire);
+  unsigned possibles[NB_COLONNE_MAX], nb = 0;
+  int parade = -1, libre = -1;
+  for (unsigned c = 0; c < NB_COLONNE; c++) {
+    int l = ligneLibre(game, c);
+    if (l == -1)
+      continue;
+    libre = c;
+    if (bbContient(&gains, bitCase(l, c, NB_LIGNE)))
+      return c;
+    if (bbContient(&pertes, bitCase(l, c, NB_LIGNE)))
+      parade = c;
+    else if (l == 0 || !bbContient(&pertes, bitCase(l - 1, c, NB_LIGNE)))
+      possibles[nb++] = c;
+  }
+  assert(libre != -1);
+  if (parade != -1)
+    return parade;
+  return nb ? possibles[tirer(graine) % nb] : (unsigned)libre;
+}
+
+/**
+ * @brief Joue des parties d'entraînement et en résout des positions jusqu'à
+ * ce que la production ait ses exemples.
+ *
+ * @param arg le travail du thread (Producteur *)
+ * @return void* NULL
+ */
+static void *produire(void *arg) {
+  Producteur *t = arg;
+  Production *p = t->production;
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *game = initPuissance4();
+  Preuve *preuve = makePreuve(TAILLE_PREUVE_EXEMPLES);
+  if (!game || !preuve) {
+    p->ok = false;
+    atomic_store(&p->produits, p->nb); // les autres threads s'arrêtent
+  } else {
+    game->j1 = &j1;
+    game->j2 = &j2;
+    game->regle = STANDARD;
+  }
+  while (game && preuve && atomic_load(&p->produits) < p->nb) {
+    atomic_fetch_add(&p->parties, 1);
+    initGame(game);
+    changerJoueur(game); // J1 commence
+    for (;;) {
+      unsigned c = choisirCoup(game, &t->graine);
+      int l = ligneLibre(game, c);
+      modifJeton(game, l, c, game->courant->type);
+      if (testEnd(game, l, c))
+        break;
+      changerJoueur(game);
+      if (game->nb_jetons < JETONS_MIN_EXEMPLE ||
+          tirer(&t->graine) % PROPORTION_EXEMPLES != 0)
+        continue;
+      Resultat r = prouver(preuve, game, p->budget, NULL, NULL);
+      if (r == INCONNU) {
+        atomic_fetch_add(&p->ecartees, 1);
+        continue;
+      }
+      unsigned long i = atomic_fetch_add(&p->produits, 1);
+      if (i >= p->nb)
+        break;
+      Type courant = game->courant->type;
+      p->exemples[i] = (Exemple){game->pions[(courant == J1) ? 1 : 0],
+                                 game->pions[courant - 1],
+                                 (r == GAGNE) ? PERDU
+                                 : (r == PERDU) ? GAGNE
+                                                : NUL};
+    }
+  }
+  free(game);
+  destroyPreuve(preuve);
+  return NULL;
+}
+
+/**
+ * @brief Produit des exemples d'entraînement sur le plateau de geometrie :
+ * chaque thread joue ses parties et résout par df-pn certaines de leurs
+ * positions (voir choisirCoup).
+ *
+ * @param exemples le tableau des exemples
+ * @param nb le nombre d'exemples voulus
+ * @param nbThreads le nombre de threads (de 1 à MAX_THREADS)
+ * @param budget le nombre maximal de positions développées par df-pn pour
+ * résoudre une position (les positions non résolues sont écartées)
+ * @param graine la graine des parties (non nulle)
+ * @param journal où écrire le bilan, NULL si aucun
+ * @return unsigned long le nombre d'exemples produits, nb sauf en cas de
+ * problème d'allocation
+ */
+unsigned long genererExemples(Exemple *exemples, unsigned long nb,
+                              unsigned nbThreads, unsigned long long budget,
+                              uint64_t graine, FILE *journal) {
+  assert(exemples && graine);
+  assert(nbThreads >= 1 && nbThreads <= MAX_THREADS);
+  Production p = {exemples, nb, 0, 0, 0, budget, true};
+  Producteur taches[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+  bool lance[MAX_THREADS];
+  for (unsigned i = 0; i < nbThreads; i++) {
+    taches[i] = (Producteur){&p, graine};
+    for (unsigned k = 0; k <= i; k++) // des suites différentes
+      taches[i].graine ^= tirer(&graine);
+    if (!taches[i].graine)
+      taches[i].graine = 1;
+    lance[i] = (pthread_create(&threads[i], NULL, &produire, &taches[i]) == 0);
+    if (!lance[i])
+      produire(&taches[i]);
+  }
+  for (unsigned i = 0; i < nbThreads; i++)
+    if (lance[i])
+      pthread_join(threads[i], NULL);
+  if (!p.ok) {
+    fprintf(stderr, "Problème d'allocation dans genererExemples.\n");
+    return 0;
+  }
+  if (journal)
+    fprintf(journal, "%lu exemples tirés de %lu parties, %lu positions non "
+                     "résolues écartées\n",
+            nb, atomic_load(&p.parties), atomic_load(&p.ecartees));
+  return nb;
+}
+
+/**
+ * @brief Donne les entrées actives d'un exemple, pour chaque point de vue
+ * (voir Reseau).
+ *
+ * @param e l'exemple
+ * @param miroir true pour le plateau symétrique (gauche-droite)
+ * @param entrees les entrées du point de vue du joueur qui vient de jouer,
+ * puis de son adversaire
+ * @return unsigned le nombre d'entrées actives de chaque point de vue (le
+ * nombre de jetons)
+ */
+static unsigned extraire(const Exemple *e, bool miroir,
+                         uint16_t entrees[2][NB_CASES_MAX]) {
+  const unsigned L = NB_LIGNE, C = NB_COLONNE, n = L * C;
+  unsigned nb = 0;
+  for (unsigned p = 0; p < 2; p++) {
+    const Bitboard *b = p ? &e->adversaire : &e->joueur;
+    for (unsigned m = 0; m < MOTS_UTILES(L, C); m++)
+      for (uint64_t bits = b->mots[m]; bits; bits &= bits - 1) {
+        unsigned i = m * 64 + __builtin_ctzll(bits);
+        unsigned colonne = i / (L + 1), ligne = L - 1 - i % (L + 1);
+        if (miroir)
+          colonne = C - 1 - colonne;
+        unsigned c = ligne * C + colonne;
+        entrees[0][nb] = c + (p ? n : 0); // jeton du joueur de son point de vue
+        entrees[1][nb] = c + (p ? 0 : n);
+        nb++;
+      }
+  }
+  return nb;
+}
+
+/**
+ * @brief Borne une activation entre 0 et 1.
+ *
+ * @param x l'activation
+ * @return float l'activation bornée
+ */
+static inline float bornerFlottant(float x) {
+  return x < 0.0f ? 0.0f : x > 1.0f ? 1.0f : x;
+}
+
+/**
+ * @brief Donne la cible d'un résultat : la probabilité de gain.
+ *
+ * @param r le résultat
+ * @return float 1 pour un gain, 0.5 pour une nulle, 0 pour une perte
+ */
+static float cible(Resultat r) {
+  return (r == GAGNE) ? 1.0f : (r == NUL) ? 0.5f : 0.0f;
+}
+
+/**
+ * @brief Donne l'entropie croisée entre une cible et la sigmoïde d'une sortie,
+ * calculée sans débordement.
+ *
+ * @param sortie la sortie du réseau
+ * @param y la cible
+ * @return double la perte
+ */
+static double entropie(double sortie, double y) {
+  return fmax(sortie, 0.0) - sortie * y + log1p(exp(-fabs(sortie)));
+}
+
+/**
+ * @brief Calcule la sortie du modèle pour un exemple et, si demandé, ajoute au
+ * gradient celui de la perte.
+ *
+ * @param m le modèle
+ * @param e l'exemple
+ * @param miroir true pour le plateau symétrique
+ * @param g le gradient, NULL si inutile
+ * @return double la perte
+ */
+static double propager(const Modele *m, const Exemple *e, bool miroir,
+                       Modele *g) {
+  uint16_t entrees[2][NB_CASES_MAX];
+  unsigned nb = extraire(e, miroir, entrees);
+  float a[2 * RESEAU_CACHEES], x[2 * RESEAU_CACHEES];
+  for (unsigned p = 0; p < 2; p++) {
+    float *ap = a + p * RESEAU_CACHEES;
+    memcpy(ap, m->b1, sizeof(m->b1));
+    for (unsigned i = 0; i < nb; i++)
+      for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+        ap[k] += m->w1[entrees[p][i]][k];
+  }
+  for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+    x[k] = bornerFlottant(a[k]);
+  float s[RESEAU_SECONDE], h[RESEAU_SECONDE], sortie = m->b3;
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    s[j] = m->b2[j];
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      s[j] += m->w2[j][k] * x[k];
+    h[j] = bornerFlottant(s[j]);
+    sortie += m->w3[j] * h[j];
+  }
+  float y = cible(e->resultat);
+  if (!g)
+    return entropie(sortie, y);
+
+  float d = 1.0f / (1.0f + expf(-sortie)) - y, dx[2 * RESEAU_CACHEES] = {0};
+  g->b3 += d;
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    g->w3[j] += d * h[j];
+    if (s[j] <= 0.0f || s[j] >= 1.0f)
+      continue; // activation bornée : pas de gradient
+    float ds = d * m->w3[j];
+    g->b2[j] += ds;
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++) {
+      g->w2[j][k] += ds * x[k];
+      dx[k] += ds * m->w2[j][k];
+    }
+  }
+  for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+    if (a[k] <= 0.0f || a[k] >= 1.0f)
+      dx[k] = 0.0f;
+  for (unsigned p = 0; p < 2; p++) {
+    const float *dp = dx + p * RESEAU_CACHEES;
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      g->b1[k] += dp[k];
+    for (unsigned i = 0; i < nb; i++)
+      for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+        g->w1[entrees[p][i]][k] += dp[k];
+  }
+  return entropie(sortie, y);
+}
+
+/**
+ * @brief Cumule la perte et le gradient des exemples d'un thread. Un exemple
+ * sur deux, selon l'époque, est vu sur le plateau symétrique.
+ *
+ * @param arg le travail du thread (Calcul *)
+ * @return void* NULL
+ */
+static void *calculer(void *arg) {
+  Calcul *t = arg;
+  t->perte = 0;
+  if (t->gradient)
+    memset(t->gradient, 0, sizeof(Modele));
+  for (unsigned long i = t->debut; i < t->fin; i++)
+    t->perte += propager(t->modele, &t->exemples[t->ordre[i]],
+                         (i + t->epoque) % 2, t->gradient);
+  return NULL;
+}
+
+/**
+ * @brief Partage des exemples entre des threads (dans le thread appelant si
+ * un thread ne peut pas être créé) et cumule leur perte et leur gradient.
+ *
+ * @param taches les tâches, une par thread, dont le modèle, les exemples,
+ * l'ordre, l'époque et le gradient sont remplis
+ * @param nbThreads le nombre de threads
+ * @param debut le premier rang des exemples
+ * @param fin le rang suivant le dernier
+ * @return double la perte cumulée (le gradient est dans celui de la première
+ * tâche)
+ */
+static double partager(Calcul *taches, unsigned nbThreads, unsigned long debut,
+                       unsigned long fin) {
+  pthread_t threads[MAX_THREADS];
+  bool lance[MAX_THREADS];
+  for (unsigned i = 0; i < nbThreads; i++) {
+    taches[i].debut = debut + (fin - debut) * i / nbThreads;
+    taches[i].fin = debut + (fin - debut) * (i + 1) / nbThreads;
+    lance[i] =
+        (pthread_create(&threads[i], NULL, &calculer, &taches[i]) == 0);
+    if (!lance[i])
+      calculer(&taches[i]);
+  }
+  double perte = 0;
+  for (unsigned i = 0; i < nbThreads; i++) {
+    if (lance[i])
+      pthread_join(threads[i], NULL);
+    perte += taches[i].perte;
+    if (i > 0 && taches[0].gradient) {
+      float *g = (float *)taches[0].gradient;
+      const float *gi = (const float *)taches[i].gradient;
+      for (size_t k = 0; k < NB_PARAMETRES; k++)
+        g[k] += gi[k];
+    }
+  }
+  return perte;
+}
+
+/**
+ * @brief Borne les poids d'un modèle pour qu'ils tiennent dans les entiers de
+ * Reseau : la première couche de sorte que l'accumulateur ne déborde pas
+ * même sur un plateau plein, la sortie dans un octet signé.
+ *
+ * @param m le modèle
+ */
+static void bornerModele(Modele *m) {
+  const float b1 = 1.0f, b2 = 32767.0f / (1 << RESEAU_DECALAGE) - 1.0f,
+              b3 = 127.0f / (1 << RESEAU_DECALAGE);
+  for (unsigned e = 0; e < RESEAU_ENTREES_MAX; e++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      m->w1[e][k] = fmaxf(-b1, fminf(b1, m->w1[e][k]));
+  for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+    m->b1[k] = fmaxf(-b1, fminf(b1, m->b1[k]));
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      m->w2[j][k] = fmaxf(-b2, fminf(b2, m->w2[j][k]));
+    m->w3[j] = fmaxf(-b3, fminf(b3, m->w3[j]));
+  }
+}
+
+/**
+ * @brief Arrondit un poids réel à l'entier qui le représente.
+ *
+ * @param x le poids réel
+ * @param echelle la valeur entière d'un poids de 1
+ * @return long l'entier le plus proche de x x echelle
+ */
+static long arrondir(float x, float echelle) { return lroundf(x * echelle); }
+
+/**
+ * @brief Arrondit les poids d'un modèle borné (voir bornerModele) en ceux
+ * d'un réseau pour le plateau de geometrie.
+ *
+ * @param m le modèle
+ * @param r le réseau
+ */
+static void quantifier(const Modele *m, Reseau *r) {
+  const float un = RESEAU_UN, pas = 1 << RESEAU_DECALAGE;
+  memset(r, 0, sizeof(Reseau));
+  r->lignes = NB_LIGNE;
+  r->colonnes = NB_COLONNE;
+  for (unsigned e = 0; e < 2 * NB_LIGNE * NB_COLONNE; e++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      r->poids1[e][k] = arrondir(m->w1[e][k], un);
+  for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+    r->biais1[k] = arrondir(m->b1[k], un);
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      r->poids2[j][k] = arrondir(m->w2[j][k], pas);
+    r->biais2[j] = arrondir(m->b2[j], un * pas);
+    r->poids3[j] = arrondir(m->w3[j], pas);
+  }
+  r->biais3 = arrondir(m->b3, un * pas);
+}
+
+/**
+ * @brief Tire les poids initiaux d'un modèle : des activations d'abord au
+ * milieu de leurs bornes.
+ *
+ * @param m le modèle
+ * @param graine l'état du générateur
+ */
+static void initialiserModele(Modele *m, uint64_t *graine) {
+  memset(m, 0, sizeof(Modele));
+  for (unsigned e = 0; e < 2 * NB_LIGNE * NB_COLONNE; e++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      m->w1[e][k] = tirerFlottant(graine, 0.05f);
+  for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+    m->b1[k] = 0.5f;
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      m->w2[j][k] = tirerFlottant(graine, 0.125f);
+    m->b2[j] = 0.5f;
+    m->w3[j] = tirerFlottant(graine, 0.5f);
+  }
+}
+
+/**
+ * @brief Ajuste un réseau aux exemples : après un tirage des poids, chaque
+ * époque mélange les exemples d'entraînement et fait un pas d'Adam par lot de
+ * TAILLE_LOT_ENTRAINEMENT exemples. Un exemple sur PART_VALIDATION est gardé
+ * pour mesurer la perte sur des exemples non appris.
+ *
+ * @param r le réseau obtenu, pour le plateau de geometrie
+ * @param exemples les exemples
+ * @param nb le nombre d'exemples (au moins PART_VALIDATION)
+ * @param epoques le nombre de passages sur les exemples
+ * @param nbThreads le nombre de threads (de 1 à MAX_THREADS)
+ * @param journal où écrire la perte de chaque époque, NULL si aucun
+ * @return true si le réseau a été ajusté
+ * @return false en cas de problème d'allocation
+ */
+bool entrainerReseau(Reseau *r, const Exemple *exemples, unsigned long nb,
+                     unsigned epoques, unsigned nbThreads, FILE *journal) {
+  assert(r && exemples && nb >= PART_VALIDATION);
+  assert(nbThreads >= 1 && nbThreads <= MAX_THREADS);
+  Modele *m = malloc(sizeof(Modele)), *moments = calloc(2, sizeof(Modele));
+  Modele *gradients = malloc(nbThreads * sizeof(Modele));
+  unsigned long *ordre = malloc(nb * sizeof(unsigned long));
+  if (!m || !moments || !gradients || !ordre) {
+    perror("Problème d'allocation dans entrainerReseau.");
+    free(m);
+    free(moments);
+    free(gradients);
+    free(ordre);
+    return false;
+  }
+  uint64_t graine = 0x9E3779B97F4A7C15ULL;
+  initialiserModele(m, &graine);
+  unsigned long validation = nb / PART_VALIDATION, appris = nb - validation;
+  for (unsigned long i = 0; i < nb; i++) // la validation : les derniers
+    ordre[i] = i;
+  Calcul taches[MAX_THREADS];
+  for (unsigned i = 0; i < nbThreads; i++)
+    taches[i] = (Calcul){m, exemples, ordre, 0, 0, 0, &gradients[i], 0};
+
+  float *w = (float *)m, *m1 = (float *)moments, *m2 = (float *)(moments + 1);
+  const float *g = (const float *)gradients;
+  const float beta1 = 0.9f, beta2 = 0.999f;
+  float puissance1 = 1.0f, puissance2 = 1.0f;
+  for (unsigned epoque = 0; epoque < epoques; epoque++) {
+    for (unsigned long i = appris - 1; i > 0; i--) { // mélange
+      unsigned long j = tirer(&graine) % (i + 1), x = ordre[i];
+      ordre[i] = ordre[j];
+      ordre[j] = x;
+    }
+    double perte = 0;
+    for (unsigned long debut = 0; debut < appris;
+         debut += TAILLE_LOT_ENTRAINEMENT) {
+      unsigned long fin = debut + TAILLE_LOT_ENTRAINEMENT < appris
+                              ? debut + TAILLE_LOT_ENTRAINEMENT
+                              : appris;
+      for (unsigned i = 0; i < nbThreads; i++) {
+        taches[i].epoque = epoque;
+        taches[i].gradient = &gradients[i];
+      }
+      perte += partager(taches, nbThreads, debut, fin);
+      puissance1 *= beta1;
+      puissance2 *= beta2;
+      float pas = TAUX_APPRENTISSAGE * sqrtf(1.0f - puissance2) /
+                  (1.0f - puissance1),
+            moyenne = 1.0f / (float)(fin - debut);
+      for (size_t k = 0; k < NB_PARAMETRES; k++) {
+        float gk = g[k] * moyenne;
+        m1[k] = beta1 * m1[k] + (1.0f - beta1) * gk;
+        m2[k] = beta2 * m2[k] + (1.0f - beta2) * gk * gk;
+        w[k] -= pas * m1[k] / (sqrtf(m2[k]) + 1e-8f);
+      }
+      bornerModele(m);
+    }
+    for (unsigned i = 0; i < nbThreads; i++)
+      taches[i].gradient = NULL;
+    double perteValidation =
+        validation ? partager(taches, nbThreads, appris, nb) / validation : 0;
+    if (journal)
+      fprintf(journal, "époque %u : perte %.4f, validation %.4f\n",
+              epoque + 1, perte / appris, perteValidation);
+  }
+  quantifier(m, r);
+  free(m);
+  free(moments);
+  free(gradients);
+  free(ordre);
+  return true;
+}
+
+/**
+ * @brief Mesure la perte d'un réseau sur des exemples, en l'évaluant comme
+ * les IA (accumulateur et calcul en entiers, voir reseau.h).
+ *
+ * @param r le réseau, pour le plateau de geometrie
+ * @param exemples les exemples
+ * @param nb le nombre d'exemples
+ * @return double l'entropie croisée moyenne
+ */
+double perteReseau(const Reseau *r, const Exemple *exemples,
+                   unsigned long nb) {
+  assert(r && exemples && nb > 0);
+  const Reseau *avant = reseauActif;
+  if (!activerReseau(r))
+    return INFINITY;
+  double perte = 0;
+  for (unsigned long i = 0; i < nb; i++) {
+    uint16_t entrees[2][NB_CASES_MAX];
+    unsigned n = NB_LIGNE * NB_COLONNE;
+    unsigned jetons = extraire(&exemples[i], false, entrees);
+    Accumulateur acc;
+    initialiserAccumulateur(acc);
+    for (unsigned k = 0; k < jetons; k++) // J1 : le joueur qui vient de jouer
+      accumulerReseau(acc, entrees[0][k] % n, entrees[0][k] >= n, true);
+    perte += entropie((double)evaluerReseau(acc, 0) / RESEAU_POINTS,
+                      cible(exemples[i].resultat));
+  }
+  activerReseau(avant);
+  return perte / nb;
+}
+
+/**
+ * @brief Remet un jeu dans la position atteinte par des coups depuis le
+ * plateau vide, pour que l'accumulateur du réseau actif soit à jour.
+ *
+ * @param game le jeu
+ * @param coups les colonnes jouées
+ * @param nb le nombre de coups
+ */
+static void rejouer(Puissance4 *game, const unsigned *coups, unsigned nb) {
+  initGame(game);
+  changerJoueur(game); // J1 commence
+  for (unsigned i = 0; i < nb; i++) {
+    modifJeton(game, ligneLibre(game, coups[i]), coups[i],
+               game->courant->type);
+    changerJoueur(game);
+  }
+}
+
+/**
+ * @brief Fait jouer un réseau contre l'heuristique des IA, à la même
+ * profondeur, sur des parties aux règles standard. Les parties vont par deux
+ * : mêmes premiers coups (tirés au hasard), le réseau ayant J1 dans l'une et
+ * J2 dans l'autre. Les résultats des recherches sont oubliés à chaque coup
+ * (voir reinitialiserIA), puisqu'ils dépendent de l'évaluation.
+ *
+ * @param r le réseau, pour le plateau de geometrie
+ * @param parties le nombre de parties
+ * @param profondeur la profondeur des recherches
+ * @param graine la graine des premiers coups (non nulle)
+ * @param journal où écrire le bilan, NULL si aucun
+ * @return double le score du réseau : ses gains plus la moitié des nulles,
+ * divisés par le nombre de parties
+ */
+double matchReseau(const Reseau *r, unsigned parties, unsigned char profondeur,
+                   uint64_t graine, FILE *journal) {
+  assert(r && parties > 0 && graine);
+  const Reseau *avant = reseauActif;
+  Joueur j1 = {J1, profondeur, 0, NULL}, j2 = {J2, profondeur, 0, NULL};
+  Puissance4 *game = initPuissance4();
+  if (!game || !activerReseau(r)) {
+    free(game);
+    return 0;
+  }
+  game->j1 = &j1;
+  game->j2 = &j2;
+  game->regle = STANDARD;
+  unsigned coups[NB_CASES_MAX], gains = 0, nulles = 0, pertes = 0;
+  for (unsigned partie = 0; partie < parties; partie++) {
+    uint64_t ouverture = graine + partie / 2;
+    Type reseauJoue = (partie % 2 == 0) ? J1 : J2;
+    unsigned nb = 0;
+    bool fin = false;
+    activerReseau(NULL);
+    rejouer(game, coups, 0);
+    while (!fin) {
+      unsigned c;
+      if (nb < OUVERTURE_MATCH) {
+        c = tirer(&ouverture) % NB_COLONNE;
+      } else {
+        bool reseauAuTrait = game->courant->type == reseauJoue;
+        activerReseau(reseauAuTrait ? r : NULL);
+        if (reseauAuTrait)
+          rejouer(game, coups, nb);
+        reinitialiserIA();
+        c = meilleurCoup(game, profondeur).indice;
+      }
+      int l = ligneLibre(game, c);
+      assert(l != -1);
+      Type joueur = game->courant->type;
+      modifJeton(game, l, c, joueur);
+      coups[nb++] = c;
+      fin = testEnd(game, l, c);
+      if (!fin)
+        changerJoueur(game);
+      else if (!game->courant)
+        nulles++;
+      else if (joueur == reseauJoue)
+        gains++;
+      else
+        pertes++;
+    }
+  }
+  activerReseau(avant);
+  reinitialiserIA();
+  free(game);
+  if (journal)
+    fprintf(journal, "match contre l'heuristique : %u gagnées, %u nulles, "
+                     "%u perdues\n",
+            gains, nulles, pertes);
+  return (gains + nulles / 2.0) / parties;
+}
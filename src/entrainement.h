@@ -0,0 +1,50 @@
+/**
+ * @file entrainement.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de l'entraînement du réseau d'évaluation (voir make
+ * entrainement) : positions de parties jouées par le programme contre
+ * lui-même, résolues par df-pn, puis ajustement des poids du réseau.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ENTRAINEMENT_H
+/**
+ * @def ENTRAINEMENT_H
+ * @brief la garde
+ */
+#define ENTRAINEMENT_H
+
+#include "puissance_quatre.h"
+#include "reseau.h"
+#include "tablebase.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @struct exemple_
+ * @brief Une position d'entraînement sur le plateau de geometrie, aux règles
+ * standard, et son résultat exact.
+ * @typedef Exemple
+ * @brief Renommer exemple_.
+ */
+typedef struct exemple_ {
+  Bitboard joueur;     //!< Jetons du joueur qui vient de jouer
+  Bitboard adversaire; //!< Jetons de son adversaire, au trait
+  Resultat resultat;   //!< Le résultat pour le joueur qui vient de jouer
+} Exemple;
+
+unsigned long genererExemples(Exemple *, unsigned long, unsigned,
+                              unsigned long long, uint64_t, FILE *);
+bool entrainerReseau(Reseau *, const Exemple *, unsigned long, unsigned,
+                     unsigned, FILE *);
+double perteReseau(const Reseau *, const Exemple *, unsigned long);
+double matchReseau(const Reseau *, unsigned, unsigned char, uint64_t, FILE *);
+
+#endif
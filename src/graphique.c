@@ -12,6 +12,8 @@
  */
 
 #include "graphique.h"
+#include "ia.h"
+#include "trace.h"
 
 #include "../include/SDL2/SDL.h"
 #include <assert.h>
@@ -32,9 +34,35 @@
  * @brief La quantité de pixels deduite de la largeur de chaque case du tableau
  * pour pouvoir avec un espace a droite du plateau dans la fenêtre
  */
+/**
+ * @def ECHELLE_INDICES
+ * @brief Le score (en valeur absolue) à partir duquel une barre d'indice est
+ * complètement pleine ou vide
+ */
+/**
+ * @def INDICES_X
+ * @brief L'abscisse de la zone des indices, à droite du plateau
+ */
+/**
+ * @def INDICES_Y
+ * @brief L'ordonnée de la zone des indices
+ */
+/**
+ * @def INDICES_LARGEUR
+ * @brief La largeur de la zone des indices, partagée entre les colonnes
+ */
+/**
+ * @def INDICES_HAUTEUR
+ * @brief La hauteur de la zone des indices, celle d'une barre pleine
+ */
 #define WIDTH 1500
 #define HEIGHT 900
 #define PAS 50
+#define ECHELLE_INDICES 30
+#define INDICES_X (WIDTH - 320)
+#define INDICES_Y (HEIGHT - 620)
+#define INDICES_LARGEUR 300
+#define INDICES_HAUTEUR 100
 
 /**
  * @struct _SDLData
@@ -43,10 +71,10 @@
  * @brief Renommer _SDLData
  */
 typedef struct _SDLData {
-  SDL_Renderer *renderer;                         //!< Pointeur sur le renderer
-  SDL_Window *window;                             //!< Pointeur sur la fenêtre
-  SDL_Texture *tab_texture[NB_LIGNE][NB_COLONNE]; //!< Pointeur sur le tableau
-                                                  //!< des textures
+  SDL_Renderer *renderer; //!< Pointeur sur le renderer
+  SDL_Window *window;     //!< Pointeur sur la fenêtre
+  /** Pointeur sur le tableau des textures */
+  SDL_Texture *tab_texture[NB_LIGNE_MAX][NB_COLONNE_MAX];
   SDL_Texture *tour1; //!< Pointeur sur l'image pour le tour du joueur 1
   SDL_Texture *tour2; //!< Pointeur sur l'image pour le tour du joueur 2
 } SDLData;
@@ -75,7 +103,7 @@ static int setRendererColor(SDL_Renderer *renderer, SDL_Color color) {
  * @param tab_texture Pointeur sur le tableau des textures
  */
 static void destroySDL(SDL_Window *window, SDL_Renderer *renderer,
-                       SDL_Texture *tab_texture[NB_LIGNE][NB_COLONNE]) {
+                       SDL_Texture *tab_texture[NB_LIGNE_MAX][NB_COLONNE_MAX]) {
   if (NULL != tab_texture) {
     for (int i = 0; i < NB_LIGNE; i++) {
       for (int j = 0; j < NB_COLONNE; j++) {
@@ -99,6 +127,7 @@ static void destroySDL(SDL_Window *window, SDL_Renderer *renderer,
  */
 static void destroyData(void *data) {
   SDLData *d = (SDLData *)data;
+  definirInterruption(rechercheIA(), NULL, NULL);
   if (d) {
     if (d->tour1 != NULL) {
       SDL_DestroyTexture(d->tour1);
@@ -210,7 +239,7 @@ static int init(SDL_Window **window, SDL_Renderer **renderer, int w, int h) {
  * @param data Le pointeur sur la data de la SDL (window, renderer, tab_texture)
  * @param game Le pointeur sur le jeu
  */
-static void initPlateauGraphique(void *data, Puissance4 *game) {
+static void dessinerPlateau(void *data, Puissance4 *game) {
   // afficher le plateau
   SDLData *d = (SDLData *)data;
   int grid_cell_width = (WIDTH / NB_COLONNE) - PAS;
@@ -259,10 +288,38 @@ static void initPlateauGraphique(void *data, Puissance4 *game) {
 }
 
 /**
- * @brief Permet au joueur humain en mode graphique de jouer un pion.
+ * @brief Affiche le plateau en début de partie (voir dessinerPlateau), en
+ * mesurant la durée de l'affichage si une trace est en cours.
+ *
+ * @param data Le pointeur sur la data de la SDL (window, renderer, tab_texture)
+ * @param game Le pointeur sur le jeu
+ */
+static void initPlateauGraphique(void *data, Puissance4 *game) {
+  uint64_t debut = debutTrace();
+  dessinerPlateau(data, game);
+  finTrace("initPlateauGraphique", debut, SANS_VALEUR);
+}
+
+/**
+ * @brief Attend le prochain événement SDL, en mesurant la durée de l'attente
+ * si une trace est en cours.
+ *
+ * @param event l'événement reçu
+ * @return int 1 en cas de succès, 0 en cas d'erreur
+ */
+static int attendreEvenement(SDL_Event *event) {
+  uint64_t debut = debutTrace();
+  int res = SDL_WaitEvent(event);
+  finTrace("SDL_WaitEvent", debut, SANS_VALEUR);
+  return res;
+}
+
+/**
+ * @brief Permet au joueur humain en mode graphique de jouer un pion : un clic
+ * droit retire le jeton du bas de la colonne (règle Pop Out).
  *
  * @param game le jeu
- * @return unsigned la colonne où le joueur place un pion
+ * @return unsigned le coup du joueur (voir RETRAIT)
  */
 static unsigned playHumainGraphique(Puissance4 *game) {
   int coup = 0;
@@ -272,14 +329,19 @@ static unsigned playHumainGraphique(Puissance4 *game) {
   SDL_Event event;
   SDL_bool joue = SDL_FALSE;
   while (!joue) {
-    SDL_WaitEvent(&event);
+    attendreEvenement(&event);
     if (event.type == SDL_QUIT) {
       game->rageQuit = true;
       return coup;
     }
     if (event.type == SDL_MOUSEBUTTONUP && event.button.x < width_plateau) {
       coup = (event.button.x) / (grid_cell_width);
-      if (testColonne(game->plateau, coup) != -1) {
+      if (event.button.button == SDL_BUTTON_RIGHT) {
+        if (retraitPossible(game, coup)) {
+          coup = RETRAIT(coup);
+          joue = SDL_TRUE;
+        }
+      } else if (testColonne(game->plateau, coup) != -1) {
         joue = SDL_TRUE;
       }
     }
@@ -319,74 +381,158 @@ static int draw_circle(SDL_Renderer *renderer, int x, int y, int radius,
 }
 
 /**
- * @brief Permet de mettre a jour la fenêtre lorsqu'un coup est joué
+ * @brief Permet d'effacer la zone des indices, à droite du plateau
+ *
+ * @param renderer Le pointeur sur le renderer
+ * @return int 0 si tout s'est bien passé, -1 sinon
+ */
+static int effacerIndices(SDL_Renderer *renderer) {
+  SDL_Rect zone = {INDICES_X, INDICES_Y, INDICES_LARGEUR, INDICES_HAUTEUR};
+  if (SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255) < 0)
+    return -1;
+  if (SDL_RenderFillRect(renderer, &zone) < 0)
+    return -1;
+  return 0;
+}
+
+/**
+ * @brief Permet d'afficher, à droite du plateau, une barre par colonne dont la
+ * hauteur représente le score du coup pour le joueur courant. Le meilleur
+ * coup est en vert, les coups impossibles n'ont pas de barre. Avec la règle
+ * Pop Out, les barres des retraits forment une seconde rangée, sous celle des
+ * ajouts. Les barres se partagent la zone des indices, quel que soit le
+ * nombre de colonnes.
  *
  * @param data Le pointeur sur la data de la SDL (window, renderer, tab_texture)
  * @param game Le pointeur sur le jeu
  */
-static void updateGraphique(void *data, Puissance4 *game) {
+static void afficherIndices(void *data, Puissance4 *game) {
   SDLData *d = (SDLData *)data;
+  SDL_Color gris = {150, 150, 150, 255};
+  SDL_Color vert = {40, 160, 60, 255};
+  Analyse a = analyseColonnes(game, PROFONDEUR_INDICES);
+  int pas = INDICES_LARGEUR / NB_COLONNE; // une barre et son espace
+  int rangee = INDICES_HAUTEUR / (NB_COUPS(game) / NB_COLONNE);
+
+  if (0 != effacerIndices(d->renderer)) {
+    fprintf(stderr, "Erreur de effacerIndices : %s", SDL_GetError());
+    game->rageQuit = true;
+    return;
+  }
+  for (int coup = 0; coup < NB_COUPS(game); coup++) {
+    if (!a.jouable[coup])
+      continue;
+    int c = coup % NB_COLONNE;
+    int bas = INDICES_Y + (coup / NB_COLONNE + 1) * rangee; // bas de la rangée
+    int score = a.scores[coup];
+    if (score > ECHELLE_INDICES)
+      score = ECHELLE_INDICES;
+    if (score < -ECHELLE_INDICES)
+      score = -ECHELLE_INDICES;
+    // 4 pixels au moins, et autant d'espace au-dessus de la barre
+    int h = 4 + (score + ECHELLE_INDICES) * (rangee - 8) /
+                    (2 * ECHELLE_INDICES);
+    SDL_Rect barre = {INDICES_X + c * pas, bas - h, pas - pas / 6, h};
+    SDL_Color couleur = (coup == a.meilleur) ? vert : gris;
+    if (0 != SDL_SetRenderDrawColor(d->renderer, couleur.r, couleur.g,
+                                    couleur.b, couleur.a) ||
+        0 != SDL_RenderFillRect(d->renderer, &barre)) {
+      fprintf(stderr, "Erreur de SDL_RenderFillRect : %s", SDL_GetError());
+      game->rageQuit = true;
+      return;
+    }
+  }
+  SDL_RenderPresent(d->renderer);
+}
+
+/**
+ * @brief Indique si l'utilisateur a demandé la fermeture de la fenêtre, sans
+ * retirer l'événement de la file. Appelée régulièrement pendant la recherche
+ * de l'IA, qui s'arrête alors aussitôt.
+ *
+ * @param data inutilisé
+ * @return true si la fenêtre doit être fermée
+ * @return false sinon
+ */
+static bool fenetreFermee(void *data) {
+  SDL_PumpEvents();
+  return SDL_HasEvent(SDL_QUIT);
+}
+
+/**
+ * @brief Permet de dessiner une case du plateau : un cercle de la couleur de
+ * son jeton, ou la case vide
+ *
+ * @param d Le pointeur sur la data de la SDL (window, renderer, tab_texture)
+ * @param game Le pointeur sur le jeu
+ * @param ligne Le numéro de ligne de la case
+ * @param colonne Le numéro de colonne de la case
+ * @return int 0 si tout s'est bien passé, -1 sinon
+ */
+static int dessinerCase(SDLData *d, Puissance4 *game, unsigned ligne,
+                        unsigned colonne) {
   int grid_cell_width = (WIDTH / NB_COLONNE) - PAS;
   int grid_cell_height = HEIGHT / NB_LIGNE;
   SDL_Color blanc = {255, 255, 255, 255};
   SDL_Color jaune = {227, 195, 16, 255};
   SDL_Color rouge = {222, 61, 40, 255};
-  SDL_Rect rect = {(game->colonne * grid_cell_width) + 5,
-                   (game->ligne * grid_cell_height) + 5, grid_cell_width - 10,
+  SDL_Rect rect = {(colonne * grid_cell_width) + 5,
+                   (ligne * grid_cell_height) + 5, grid_cell_width - 10,
                    grid_cell_height - 10};
+  Type jeton = game->plateau[ligne][colonne];
 
-  if (0 != SDL_SetRenderTarget(d->renderer,
-                               d->tab_texture[game->ligne][game->colonne])) {
+  if (0 != SDL_SetRenderTarget(d->renderer, d->tab_texture[ligne][colonne])) {
     fprintf(stderr, "Erreur de SDL_SetRenderTarget : %s", SDL_GetError());
-    game->rageQuit = true;
-    return;
+    return -1;
   }
   if (0 != setRendererColor(d->renderer, blanc)) {
     fprintf(stderr, "Erreur de setRendererColor : %s", SDL_GetError());
+    return -1;
+  }
+  if (jeton != VIDE &&
+      0 != draw_circle(d->renderer, 250, 250, 240,
+                       (jeton == J1) ? rouge : jaune)) {
+    fprintf(stderr, "Erreur de draw_circle : %s", SDL_GetError());
+    return -1;
+  }
+  if (0 != SDL_SetRenderTarget(d->renderer, NULL)) {
+    fprintf(stderr, "Erreur de SDL_SetRenderTarget : %s", SDL_GetError());
+    return -1;
+  }
+  if (0 != SDL_RenderCopy(d->renderer, d->tab_texture[ligne][colonne], NULL,
+                          &rect)) {
+    fprintf(stderr, "Erreur de RenderCopy : %s", SDL_GetError());
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Permet de mettre a jour la fenêtre lorsqu'un coup est joué : la case
+ * du jeton ajouté, ou toute la colonne après un retrait (règle Pop Out)
+ *
+ * @param data Le pointeur sur la data de la SDL (window, renderer, tab_texture)
+ * @param game Le pointeur sur le jeu
+ */
+static void dessinerCoup(void *data, Puissance4 *game) {
+  SDLData *d = (SDLData *)data;
+
+  if (fenetreFermee(NULL)) { // aussi entre deux coups des IA
     game->rageQuit = true;
     return;
   }
-  switch (game->plateau[game->ligne][game->colonne]) {
-  case J1:
-    if (0 != draw_circle(d->renderer, 250, 250, 240, rouge)) {
-      fprintf(stderr, "Erreur de draw_circle : %s", SDL_GetError());
-      game->rageQuit = true;
-      return;
-    }
-    if (0 != SDL_SetRenderTarget(d->renderer, NULL)) {
-      fprintf(stderr, "Erreur de SDL_SetRenderTarget : %s", SDL_GetError());
+  // un retrait fait descendre tous les jetons de la colonne
+  for (unsigned l = game->retrait ? 0 : game->ligne; l <= game->ligne; l++) {
+    if (0 != dessinerCase(d, game, l, game->colonne)) {
       game->rageQuit = true;
       return;
     }
-    if (0 != SDL_RenderCopy(d->renderer,
-                            d->tab_texture[game->ligne][game->colonne], NULL,
-                            &rect)) {
-      fprintf(stderr, "Erreur de RenderCopy : %s", SDL_GetError());
-      game->rageQuit = true;
-      return;
-    }
-    break;
-  case J2:
-    if (0 != draw_circle(d->renderer, 250, 250, 240, jaune)) {
-      fprintf(stderr, "Erreur de draw_circle : %s", SDL_GetError());
-      game->rageQuit = true;
-      return;
-    }
-    if (0 != SDL_SetRenderTarget(d->renderer, NULL)) {
-      fprintf(stderr, "Erreur de SDL_SetRenderTarget : %s", SDL_GetError());
-      game->rageQuit = true;
-      return;
-    }
-    if (0 != SDL_RenderCopy(d->renderer,
-                            d->tab_texture[game->ligne][game->colonne], NULL,
-                            &rect)) {
-      fprintf(stderr, "Erreur de RenderCopy : %s", SDL_GetError());
-      game->rageQuit = true;
-      return;
-    }
-    break;
-  case VIDE:
-    break;
+  }
+
+  if (game->indices && 0 != effacerIndices(d->renderer)) {
+    fprintf(stderr, "Erreur de effacerIndices : %s", SDL_GetError());
+    game->rageQuit = true;
+    return;
   }
 
   SDL_Rect rectTour = {WIDTH - 270, HEIGHT - 850, 200, 200};
@@ -415,6 +561,19 @@ static void updateGraphique(void *data, Puissance4 *game) {
   SDL_Delay(100);
 }
 
+/**
+ * @brief Met à jour la fenêtre lorsqu'un coup est joué (voir dessinerCoup), en
+ * mesurant la durée de l'affichage si une trace est en cours.
+ *
+ * @param data Le pointeur sur la data de la SDL (window, renderer, tab_texture)
+ * @param game Le pointeur sur le jeu
+ */
+static void updateGraphique(void *data, Puissance4 *game) {
+  uint64_t debut = debutTrace();
+  dessinerCoup(data, game);
+  finTrace("updateGraphique", debut, game->colonne);
+}
+
 /**
  * @brief Permet de faire l'affichage de fin de partie
  *
@@ -567,7 +726,7 @@ static bool endAffichage(void *data, Puissance4 *game) {
   SDL_bool action = SDL_FALSE;
 
   while (!action) {
-    SDL_WaitEvent(&event);
+    attendreEvenement(&event);
     if (event.type == SDL_QUIT) {
       action = SDL_TRUE;
       if (egalite) {
@@ -704,8 +863,10 @@ userInterface *makeGraphique() {
   ui->initAffichage = &initPlateauGraphique;
   ui->affichage = &updateGraphique;
   ui->getProchainCoup = &prochainCoup;
+  ui->afficherIndices = &afficherIndices;
   ui->destroy = &destroyData;
   ui->endAffichage = &endAffichage;
+  definirInterruption(rechercheIA(), &fenetreFermee, NULL);
 
   return ui;
 }
@@ -725,6 +886,7 @@ Joueur *makeHumainGraphique(Type t) {
     return NULL;
   }
   j->type = t;
+  j->profondeur = 0;
   j->play = &playHumainGraphique;
   return j;
 }
\ No newline at end of file
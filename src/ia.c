@@ -13,44 +13,200 @@
  */
 
 #include "ia.h"
+#include "archive.h"
+#include "commun.h"
+#include "preuve.h"
+#include "reseau.h"
+#include "tablebase.h"
+#include "trace.h"
+#include "transposition.h"
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/**
+ * @def STAT
+ * @brief exécute une instruction de mesure, sauf si le programme est compilé
+ * sans statistiques (SANS_STATS défini)
+ */
+#ifdef SANS_STATS
+#define STAT(instruction)
+#else
+#define STAT(instruction)                                                      \
+  do {                                                                         \
+    instruction;                                                               \
+  } while (0)
+#endif
 
 /**
  * @def MAX
  * @brief la valeur maximale d'une évaluation = partie gagnée
  */
-#define MAX 10000
+#define MAX VICTOIRE
 
 /**
- * @struct couple_
- * @brief Un couple indice de la colonne et sa valeur associée.
- * @typedef Couple
- * @brief Renommer un couple_.
+ * @def TAILLE_CACHE
+ * @brief nombre de positions dont le résultat est gardé dans le cache
  */
-typedef struct couple_ {
-  int indice; //!< indice de la colonne
-  int valeur; //!< valeur associée à la colonne
-} Couple;
+#define TAILLE_CACHE 4096
 
 /**
- * @brief Évalue une case. Heuristique : si la case appartient au joueur courant
+ * @def TAILLE_TRANSPOSITION
+ * @brief nombre d'entrées par défaut de la table de transposition (8 octets
+ * chacune : 16 Mo, voir dimensionnerTableIA)
+ */
+#define TAILLE_TRANSPOSITION (1 << 21)
+
+/**
+ * @def TAILLE_PREUVE
+ * @brief le nombre d'entrées de la table de df-pn
+ */
+#define TAILLE_PREUVE (1 << 18)
+
+/**
+ * @def FENETRE_ASPIRATION
+ * @brief la demi-largeur initiale de la fenêtre autour du score de l'itération
+ * précédente (doublée à chaque échec)
+ */
+#define FENETRE_ASPIRATION 2
+
+/**
+ * @def INTERVALLE_CONTROLE
+ * @brief nombre de positions visitées entre deux contrôles de l'échéance et
+ * de la fonction d'interruption d'une recherche
+ */
+#define INTERVALLE_CONTROLE 4096
+
+/**
+ * @struct recherche_
+ * @brief Le contexte d'une recherche : permet de l'arrêter à tout moment
+ * (depuis n'importe quel thread) et d'en connaître le meilleur coup trouvé
+ * jusqu'ici.
+ */
+struct recherche_ {
+  atomic_bool arret;               //!< true si un arrêt a été demandé
+  atomic_uint_fast64_t meilleur;   //!< Meilleur coup connu (coup et score)
+  atomic_uint profondeur;          //!< Profondeur de la dernière itération
+  unsigned duree;                  //!< Durée maximale en ms, 0 si aucune
+  uint64_t echeance;               //!< Fin de la recherche en cours (ns)
+  Algorithme algorithme;           //!< L'algorithme de recherche
+  unsigned long long budget;       //!< Positions développées par df-pn
+  bool (*interruption)(void *);    //!< Appelée régulièrement, true pour arrêter
+  void *donnees;                   //!< Les données passées à interruption
+  unsigned long noeuds;            //!< Positions visitées (pour les contrôles)
+#ifndef SANS_STATS
+  StatsRecherche stats;            //!< Les statistiques de la recherche
+  uint64_t debut;                  //!< Début de la recherche (ns)
+  unsigned iteration;              //!< Profondeur de l'itération en cours
+#endif
+};
+
+/**
+ * @brief Le cache des résultats d'analyse, partagé par toutes les IA (créé au
+ * premier makeIA).
+ */
+static Cache *cache = NULL;
+
+/**
+ * @brief La table de transposition, partagée par toutes les IA (créée au
+ * premier makeIA).
+ */
+static Transposition *transpo = NULL;
+
+/**
+ * @brief Le nombre d'entrées de la table de transposition créée par makeIA.
+ */
+static unsigned long entreesTranspo = TAILLE_TRANSPOSITION;
+
+/**
+ * @brief La distance des coups étudiés par les recherches aux colonnes non
+ * vides (voir colonnesCandidates), 0 pour étudier toutes les colonnes.
+ */
+static unsigned voisinage = 0;
+
+/**
+ * @brief Le nom de la table de transposition partagée par les processus de la
+ * machine, NULL pour une table propre au processus (voir partagerTableIA).
+ */
+static char *nomPartage = NULL;
+
+/**
+ * @brief La table des finales consultée par les IA, NULL si aucune.
+ */
+static TableFinale *finale = NULL;
+
+/**
+ * @brief L'archive où les IA gardent leurs résultats d'un processus à
+ * l'autre, NULL si aucune.
+ */
+static Archive *archive = NULL;
+
+/**
+ * @brief Le réseau d'évaluation chargé pour les IA (voir chargerReseauIA),
+ * NULL si aucun.
+ */
+static Reseau *reseau = NULL;
+
+/**
+ * @brief Le solveur df-pn des IA (algorithme DFPN). Une seule recherche à la
+ * fois l'utilise : la réflexion est arrêtée avant chaque recherche.
+ */
+static Preuve *preuve = NULL;
+
+/**
+ * @brief Le journal des recherches de playIA (une ligne JSON par coup), NULL
+ * si elles ne sont pas journalisées.
+ */
+static FILE *journal = NULL;
+
+/**
+ * @brief Le contexte des recherches lancées par playIA et les fonctions
+ * d'analyse (dans le thread principal).
+ */
+static Recherche principale = {.duree = 0,
+                                .algorithme = ALGORITHME_DEFAUT,
+                                .budget = BUDGET_PREUVE,
+                                .interruption = NULL};
+
+/**
+ * @struct reflexion_
+ * @brief La réflexion pendant le tour d'un joueur humain : un thread calcule
+ * à l'avance les réponses de l'IA à chaque coup possible de l'humain, ce qui
+ * remplit le cache et la table de transposition.
+ */
+static struct reflexion_ {
+  pthread_t thread;    //!< Le thread qui réfléchit
+  bool actif;          //!< true si le thread a été lancé et pas encore attendu
+  Puissance4 position; //!< La position où l'humain doit jouer (une copie)
+  Recherche recherche; //!< Le contexte des recherches du thread
+} reflexion = {.actif = false, .recherche = {.budget = BUDGET_PREUVE}};
+
+/**
+ * @brief Évalue une case. Heuristique : si la case appartient au joueur donné
  * alors elle est évaluée à 2, si elle est vide à 1 et 0 sinon. 0 si la case
  * n'est pas dans le plateau.
  *
- * @param game le jeu
+ * @param plateau le plateau de jeu
+ * @param type le joueur pour qui la case est évaluée
  * @param ligne le numéro de la ligne de la case à évaluer
  * @param colonne le numéro de la colonne à évaluer
- * @return unsigned
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @return unsigned la valeur de la case
  */
-unsigned valeurCase(Puissance4 game, unsigned ligne, unsigned colonne) {
-  if (ligne < 0 || ligne >= NB_LIGNE || colonne < 0 || colonne >= NB_COLONNE)
+NOYAU unsigned valeur(Plateau plateau, Type type, unsigned ligne,
+                      unsigned colonne, unsigned L, unsigned C) {
+  if (ligne >= L || colonne >= C) // en dehors, y compris ligne ou colonne -1
     return 0;
-  if (game.plateau[ligne][colonne] == VIDE)
+  if (plateau[ligne][colonne] == VIDE)
     return 1;
-  else if (game.plateau[ligne][colonne] == game.courant->type)
+  else if (plateau[ligne][colonne] == type)
     return 2;
   return 0;
 }
@@ -59,81 +215,490 @@ unsigned valeurCase(Puissance4 game, unsigned ligne, unsigned colonne) {
  * @brief Calcule le score d'une case en fonction de toutes les cases autour
  * (distance de 1) de celle-ci.
  *
- * @param game le jeu
+ * @param plateau le plateau de jeu
+ * @param type le joueur pour qui la case est évaluée
  * @param ligne le numéro de ligne de la case
  * @param colonne le numéro de colonne de la case
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
  * @return unsigned le score de la case
  */
-unsigned autour(Puissance4 game, unsigned ligne, unsigned colonne) {
-  assert(ligne >= 0 && ligne < NB_LIGNE);
-  assert(colonne >= 0 && colonne < NB_COLONNE);
+NOYAU unsigned voisins(Plateau plateau, Type type, unsigned ligne,
+                       unsigned colonne, unsigned L, unsigned C) {
+  assert(ligne >= 0 && ligne < L);
+  assert(colonne >= 0 && colonne < C);
   unsigned som = 0;
-  som += valeurCase(game, ligne - 1, colonne - 1);
-  som += valeurCase(game, ligne - 1, colonne);
-  som += valeurCase(game, ligne - 1, colonne + 1);
-  som += valeurCase(game, ligne, colonne - 1);
-  som += valeurCase(game, ligne, colonne + 1);
-  som += valeurCase(game, ligne + 1, colonne - 1);
-  som += valeurCase(game, ligne + 1, colonne);
-  som += valeurCase(game, ligne + 1, colonne + 1);
+  som += valeur(plateau, type, ligne - 1, colonne - 1, L, C);
+  som += valeur(plateau, type, ligne - 1, colonne, L, C);
+  som += valeur(plateau, type, ligne - 1, colonne + 1, L, C);
+  som += valeur(plateau, type, ligne, colonne - 1, L, C);
+  som += valeur(plateau, type, ligne, colonne + 1, L, C);
+  som += valeur(plateau, type, ligne + 1, colonne - 1, L, C);
+  som += valeur(plateau, type, ligne + 1, colonne, L, C);
+  som += valeur(plateau, type, ligne + 1, colonne + 1, L, C);
   return som;
 }
 
 /**
- * @brief Evaluer le score du Joueur courant
+ * @brief Évalue le score d'un joueur : la somme des scores de ses cases.
  *
- * @param game le jeu
+ * @param plateau le plateau de jeu
+ * @param type le joueur
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
  * @return unsigned le score du joueur
  */
-unsigned scoreJoueur(Puissance4 game) {
-  assert(game.courant->type != VIDE);
+NOYAU unsigned score(Plateau plateau, Type type, unsigned L, unsigned C) {
+  assert(type != VIDE);
   unsigned som = 0;
-  for (int i = 0; i < NB_LIGNE; i++) {
-    for (int j = 0; j < NB_COLONNE; j++) {
-      if (game.plateau[i][j] == game.courant->type) {
-        som += autour(game, i, j);
+  for (unsigned i = 0; i < L; i++) {
+    for (unsigned j = 0; j < C; j++) {
+      if (plateau[i][j] == type) {
+        som += voisins(plateau, type, i, j, L, C);
       }
     }
   }
   return som;
 }
 
+/**
+ * @brief Compte, pour les jetons d'un joueur, les voisins dans une direction
+ * (dans les deux sens) : 4 pour chaque paire de jetons voisins du joueur (2
+ * pour chacun des deux), 1 pour chaque jeton voisin d'une case libre.
+ *
+ * @param joueur les jetons du joueur
+ * @param libres les cases libres
+ * @param d le décalage d'une case à sa voisine dans la direction
+ * @param n le nombre de mots utilisés
+ * @return unsigned le score du joueur dans la direction
+ */
+NOYAU unsigned voisinsDirection(const Bitboard *joueur, const Bitboard *libres,
+                                unsigned d, unsigned n) {
+  Bitboard paires = bbDecaler(joueur, d, n), apres = paires;
+  Bitboard avant = bbDecaler(libres, d, n);
+  bbEt(&paires, joueur, n);
+  bbEt(&apres, libres, n);
+  bbEt(&avant, joueur, n);
+  return 4 * bbCompter(&paires, n) + bbCompter(&apres, n) +
+         bbCompter(&avant, n);
+}
+
+/**
+ * @brief Évalue le score d'un joueur d'après les bitboards : le même que score,
+ * en comptant les voisins direction par direction sur tout le plateau à la
+ * fois plutôt que case par case (plus rapide sur les grands plateaux).
+ *
+ * @param game le jeu
+ * @param type le joueur
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @return unsigned le score du joueur
+ */
+NOYAU unsigned scoreBitboard(Puissance4 *game, Type type, unsigned L,
+                             unsigned C) {
+  assert(type != VIDE);
+  unsigned n = MOTS_UTILES(L, C);
+  Bitboard libres = bbLibres(&geometrie.cases, game->pions, n);
+  const Bitboard *joueur = &game->pions[type - 1];
+  return voisinsDirection(joueur, &libres, 1, n)        // vertical
+         + voisinsDirection(joueur, &libres, L + 1, n)  // horizontal
+         + voisinsDirection(joueur, &libres, L, n)      // diagonal
+         + voisinsDirection(joueur, &libres, L + 2, n); // diagonal
+}
+
+/**
+ * @brief Évalue une case. Heuristique : si la case appartient au joueur courant
+ * alors elle est évaluée à 2, si elle est vide à 1 et 0 sinon. 0 si la case
+ * n'est pas dans le plateau.
+ *
+ * @param game le jeu
+ * @param ligne le numéro de la ligne de la case à évaluer
+ * @param colonne le numéro de la colonne à évaluer
+ * @return unsigned
+ */
+unsigned valeurCase(Puissance4 game, unsigned ligne, unsigned colonne) {
+  return valeur(game.plateau, game.courant->type, ligne, colonne, NB_LIGNE,
+                NB_COLONNE);
+}
+
+/**
+ * @brief Calcule le score d'une case en fonction de toutes les cases autour
+ * (distance de 1) de celle-ci.
+ *
+ * @param game le jeu
+ * @param ligne le numéro de ligne de la case
+ * @param colonne le numéro de colonne de la case
+ * @return unsigned le score de la case
+ */
+unsigned autour(Puissance4 game, unsigned ligne, unsigned colonne) {
+  return voisins(game.plateau, game.courant->type, ligne, colonne, NB_LIGNE,
+                 NB_COLONNE);
+}
+
+/**
+ * @brief Evaluer le score du Joueur courant
+ *
+ * @param game le jeu
+ * @return unsigned le score du joueur
+ */
+unsigned scoreJoueur(Puissance4 game) {
+  return score(game.plateau, game.courant->type, NB_LIGNE, NB_COLONNE);
+}
+
+/**
+ * @def EVALUATION
+ * @brief définit la fonction d'évaluation evaluation##nom pour une géométrie
+ * (voir FORMES) : le score du joueur qui vient de jouer moins celui du joueur
+ * courant, d'après les bitboards quand ils ont plusieurs mots
+ */
+#define EVALUATION(nom, L, C, A)                                               \
+  static int evaluation##nom(Puissance4 *game) {                               \
+    Type courant = game->courant->type;                                        \
+    Type precedent = (courant == J1) ? J2 : J1;                                \
+    if (MOTS_UTILES(L, C) > 1)                                                 \
+      return (int)scoreBitboard(game, precedent, L, C) -                       \
+             (int)scoreBitboard(game, courant, L, C);                          \
+    return (int)score(game->plateau, precedent, L, C) -                        \
+           (int)score(game->plateau, courant, L, C);                           \
+  }
+
+FORMES(EVALUATION)
+EVALUATION(Generique, NB_LIGNE, NB_COLONNE, NB_ALIGNE)
+
+/**
+ * @def ADRESSE_EVALUATION
+ * @brief l'adresse de la fonction d'évaluation d'une géométrie
+ */
+#define ADRESSE_EVALUATION(nom, L, C, A) &evaluation##nom,
+
+/**
+ * @brief Les fonctions d'évaluation, dans l'ordre de FORMES, puis la version
+ * générique (voir Geometrie.forme).
+ */
+static int (*const evaluations[NB_FORMES + 1])(Puissance4 *) = {
+    FORMES(ADRESSE_EVALUATION) &evaluationGenerique};
+
 /**
  * @brief Fonction d'évaluation du plateau. (pour le joueur qui n'est pas le
  * courant car on change de joueur avant l'appel récursif dans minimax mais on
  * évalue au début de cette même fonction pour le joueur qui vient de jouer)
+ * Si un réseau d'évaluation est actif (voir reseau.h), c'est lui qui évalue, à
+ * partir de l'accumulateur tenu à jour par modifJeton.
  *
  * @param game le jeu
  * @return int la valeur associée pour un joueur au plateau
  */
 int evaluation(Puissance4 *game) {
   assert(game);
-  int val;
-  changerJoueur(game);
-  val = scoreJoueur(*game);
-  changerJoueur(game);
-  val -= scoreJoueur(*game);
-  return val;
+  assert(game->courant);
+  if (reseauActif) {
+    unsigned precedent = (game->courant->type == J1) ? 1 : 0;
+    int valeur = evaluerReseau(game->accumulateur, precedent);
+    // seules les parties gagnées valent MAX
+    return valeur >= MAX ? MAX - 1 : valeur <= -MAX ? -MAX + 1 : valeur;
+  }
+  return evaluations[geometrie.forme](game);
+}
+
+/**
+ * @brief Indique si la recherche doit s'arrêter.
+ *
+ * @param r le contexte de la recherche
+ * @return true si un arrêt a été demandé
+ * @return false sinon
+ */
+static bool arretDemande(Recherche *r) {
+  return atomic_load_explicit(&r->arret, memory_order_relaxed);
+}
+
+/**
+ * @brief Contrôle régulier d'une recherche : demande son arrêt si l'échéance
+ * est dépassée ou si la fonction d'interruption le demande.
+ *
+ * @param r le contexte de la recherche
+ */
+static void controler(Recherche *r) {
+  if ((r->echeance && maintenant() >= r->echeance) ||
+      (r->interruption && r->interruption(r->donnees)))
+    atomic_store(&r->arret, true);
+}
+
+/**
+ * @brief Rend public le meilleur coup connu d'une recherche.
+ *
+ * @param r le contexte de la recherche
+ * @param c le coup et son score pour le joueur courant
+ */
+static void publier(Recherche *r, Couple c) {
+  atomic_store(&r->meilleur,
+               ((uint64_t)(uint32_t)c.valeur << 32) | (uint32_t)c.indice);
+}
+
+/**
+ * @brief Calcule l'ordre dans lequel essayer les coups : le coup donné en
+ * premier (en général celui de la table de transposition), puis du centre vers
+ * les bords, les coups au centre étant le plus souvent les meilleurs. Avec la
+ * règle Pop Out, les retraits suivent les ajouts, dans le même ordre.
+ *
+ * @param ordre le tableau à remplir
+ * @param premier le coup à essayer en premier, -1 si aucun
+ * @param nb le nombre de coups (voir NB_COUPS)
+ */
+static void ordonner(int ordre[NB_COUPS_MAX], int premier, int nb) {
+  int n = 0;
+  if (premier != -1)
+    ordre[n++] = premier;
+  for (int k = 0; k < nb; k++) {
+    int rang = (k < NB_COLONNE) ? k : k - NB_COLONNE, retrait = k - rang;
+    // centre, gauche du centre, droite du centre...
+    int c = retrait + NB_COLONNE / 2 +
+            ((rang % 2) ? -(rang + 1) / 2 : rang / 2);
+    if (c != premier)
+      ordre[n++] = c;
+  }
+  assert(n == nb);
+}
+
+/**
+ * @brief Donne le coup symétrique (gauche-droite) d'un coup.
+ *
+ * @param coup le coup (voir RETRAIT), -1 si aucun
+ * @return int le même coup dans la position symétrique, -1 si aucun
+ */
+static int symetrique(int coup) {
+  if (coup == -1)
+    return -1;
+  if (coup < NB_COLONNE)
+    return NB_COLONNE - 1 - coup;
+  return 3 * NB_COLONNE - 1 - coup; // retrait
 }
 
 /**
- * @brief Fonction récursive pour déterminer le meilleur coup.
+ * @brief Donne la case d'un coup du joueur courant : celle où son jeton
+ * arrive, ou celle, en bas de la colonne, du jeton qu'il retire.
  *
  * @param game le jeu
+ * @param coup le coup (voir RETRAIT)
+ * @param candidates les colonnes où chercher (voir colonnesCandidates)
+ * @return int la ligne de la case, -1 si le coup est impossible ou hors des
+ * colonnes candidates
+ */
+static int caseCoup(Puissance4 *game, int coup, uint32_t candidates) {
+  if (coup < NB_COLONNE)
+    return (candidates >> coup & 1) ? ligneLibre(game, coup) : -1;
+  int c = coup - NB_COLONNE;
+  return ((candidates >> c & 1) && retraitPossible(game, c)) ? NB_LIGNE - 1
+                                                             : -1;
+}
+
+/**
+ * @brief Place en tête, dans l'ordre de ordonner, les coups qui complètent un
+ * alignement du joueur courant, puis ceux qui occupent une case où son
+ * adversaire en compléterait un (voir menaces), et donne la case de chaque
+ * coup (voir caseCoup).
+ *
+ * @param game le jeu
+ * @param ordre les coups, réordonnés
+ * @param lignes la ligne de la case de chaque coup de ordre, -1 si le coup est
+ * impossible ou hors des colonnes candidates
+ * @param nb le nombre de coups
+ * @param candidates les colonnes où chercher (voir colonnesCandidates)
+ */
+static void prioriser(Puissance4 *game, int ordre[NB_COUPS_MAX],
+                      int lignes[NB_COUPS_MAX], int nb, uint32_t candidates) {
+  Type courant = game->courant->type, adversaire = (courant == J1) ? J2 : J1;
+  Bitboard gains = menaces(game, courant), parades = menaces(game, adversaire);
+  unsigned n = MOTS_UTILES(NB_LIGNE, NB_COLONNE);
+  bool rien = bbVide(&gains, n) && bbVide(&parades, n);
+  int coups[NB_COUPS_MAX], cases[NB_COUPS_MAX], rangs[NB_COUPS_MAX];
+  for (int k = 0; k < nb; k++) {
+    coups[k] = ordre[k];
+    cases[k] = caseCoup(game, ordre[k], candidates);
+    rangs[k] = 2;
+    if (!rien && cases[k] != -1 && ordre[k] < NB_COLONNE) {
+      unsigned bit = bitCase(cases[k], ordre[k], NB_LIGNE);
+      rangs[k] = bbContient(&gains, bit)     ? 0
+                 : bbContient(&parades, bit) ? 1
+                                             : 2;
+    }
+  }
+  int m = 0;
+  for (int rang = rien ? 2 : 0; rang <= 2; rang++)
+    for (int k = 0; k < nb; k++)
+      if (rangs[k] == rang) {
+        ordre[m] = coups[k];
+        lignes[m++] = cases[k];
+      }
+  assert(m == nb);
+}
+
+/**
+ * @brief Joue un coup du joueur courant pendant une recherche.
+ *
+ * @param game le jeu
+ * @param coup le coup (voir RETRAIT)
+ * @param ligne la ligne de sa case (voir caseCoup)
+ */
+static void jouer(Puissance4 *game, int coup, int ligne) {
+  if (coup < NB_COLONNE)
+    modifJeton(game, ligne, coup, game->courant->type);
+  else
+    retirerJeton(game, coup - NB_COLONNE);
+}
+
+/**
+ * @brief Annule un coup du joueur courant joué par jouer, en temps constant :
+ * un retrait est annulé en remettant le jeton sous sa colonne.
+ *
+ * @param game le jeu
+ * @param coup le coup (voir RETRAIT)
+ * @param ligne la ligne de sa case (voir caseCoup)
+ */
+static void dejouer(Puissance4 *game, int coup, int ligne) {
+  if (coup < NB_COLONNE)
+    modifJeton(game, ligne, coup, VIDE);
+  else
+    remettreJeton(game, coup - NB_COLONNE, game->courant->type);
+}
+
+/**
+ * @brief Test si le coup que le joueur courant vient de jouer termine la
+ * partie (voir testEnd, testEndRetrait). Le joueur courant peut être mis à
+ * NULL, comme par testEnd.
+ *
+ * @param game le jeu, après le coup
+ * @param coup le coup (voir RETRAIT)
+ * @param ligne la ligne de sa case (voir caseCoup)
+ * @return true si la partie est terminée
+ * @return false sinon
+ */
+static bool coupFinal(Puissance4 *game, int coup, int ligne) {
+  if (coup < NB_COLONNE)
+    return testEnd(game, ligne, coup);
+  return gagnantRetrait(game, game->courant->type) != VIDE ||
+         game->retraits >= RETRAITS_MAX;
+}
+
+static Couple minimax(Recherche *, Puissance4 *, unsigned, int, int, int);
+
+/**
+ * @brief Donne le score d'un résultat exact.
+ *
+ * @param res le résultat pour le joueur courant (pas INCONNU)
+ * @return int le score pour le joueur courant
+ */
+static int valeurResultat(Resultat res) {
+  assert(res != INCONNU);
+  return (res == GAGNE) ? MAX : (res == PERDU) ? -MAX : 0;
+}
+
+/**
+ * @brief La fonction d'interruption de df-pn : contrôle la recherche comme
+ * minimax (échéance, fonction d'interruption, demande d'arrêt).
+ *
+ * @param donnees le contexte de la recherche
+ * @return true si la recherche doit s'arrêter
+ */
+static bool interrompre(void *donnees) {
+  Recherche *r = donnees;
+  controler(r);
+  return arretDemande(r);
+}
+
+/**
+ * @brief Résout une position par df-pn, dans la limite du budget de la
+ * recherche.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param colonne le coup qui vient d'être joué, -1 si aucun (comme minimax)
+ * @return Resultat le résultat exact pour le joueur courant, INCONNU si le
+ * budget ne suffit pas ou si la recherche est arrêtée
+ */
+static Resultat resoudre(Recherche *r, Puissance4 *game, int colonne) {
+  if (colonne != -1) {
+    int ligne = ligneLibre(game, colonne) + 1;
+    Joueur *tmp = game->courant;
+    if (testEnd(game, ligne, colonne)) {
+      bool nulle = !game->courant;
+      game->courant = tmp;
+      return nulle ? NUL : PERDU; // sinon l'adversaire vient de gagner
+    }
+  }
+  if (!preuve || game->regle == POP_OUT || arretDemande(r))
+    return INCONNU; // df-pn ne connaît que les règles standard
+#ifndef SANS_STATS
+  unsigned long long avant = statsPreuve(preuve).noeuds;
+#endif
+  uint64_t debut = debutTrace();
+  Resultat res = prouver(preuve, game, r->budget, &interrompre, r);
+  finTrace("prouver", debut, res);
+  STAT(r->stats.preuves += statsPreuve(preuve).noeuds - avant);
+  return res;
+}
+
+/**
+ * @brief Recherche la valeur d'un coup qui vient d'être joué. Avec une fenêtre
+ * nulle, on vérifie seulement que le coup n'est pas meilleur que alpha : il
+ * n'est recherché avec la fenêtre complète que s'il l'est.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu, après le coup
+ * @param profondeur la profondeur de la position avant le coup
+ * @param colonne la colonne jouée
+ * @param alpha la valeur déjà garantie au joueur qui vient de jouer
+ * @param beta la valeur déjà garantie à son adversaire
+ * @param nulle true pour essayer d'abord une fenêtre nulle
+ * @return int la valeur du coup pour le joueur qui vient de jouer
+ */
+static int explorer(Recherche *r, Puissance4 *game, unsigned profondeur,
+                    int colonne, int alpha, int beta, bool nulle) {
+  if (!nulle)
+    return -minimax(r, game, profondeur - 1, colonne, -beta, -alpha).valeur;
+  int valeur =
+      -minimax(r, game, profondeur - 1, colonne, -alpha - 1, -alpha).valeur;
+  if (valeur > alpha && valeur < beta && !arretDemande(r))
+    valeur = -minimax(r, game, profondeur - 1, colonne, -beta, -alpha).valeur;
+  return valeur;
+}
+
+/**
+ * @brief Fonction récursive pour déterminer le meilleur coup : recherche
+ * alpha-beta (forme negamax) utilisant la table de transposition. Seules les
+ * valeurs strictement comprises entre alpha et beta sont exactes : une valeur
+ * inférieure ou égale à alpha est une borne supérieure et une valeur supérieure
+ * ou égale à beta une borne inférieure. Avec PVS, les coups après le premier
+ * sont d'abord recherchés avec une fenêtre nulle.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
  * @param profondeur la profondeur pour la récursivité
- * @param colonne la dernière colonne jouée
+ * @param colonne le dernier coup joué (voir RETRAIT)
+ * @param alpha la valeur déjà garantie au joueur courant
+ * @param beta la valeur déjà garantie à l'adversaire (au-delà, il évitera
+ * cette position)
  * @return Couple un couple contenant le meilleur coup : l'indice de la colonne
- * du meilleur coup et la valeur du meilleur coup
+ * du meilleur coup et sa valeur pour le joueur courant
  */
-static Couple minimax(Puissance4 *game, unsigned profondeur, int colonne) {
+static Couple minimax(Recherche *r, Puissance4 *game, unsigned profondeur,
+                      int colonne, int alpha, int beta) {
   assert(game);
-  assert(colonne == -1 || (colonne >= 0 && colonne < NB_COLONNE));
-  Couple res;
-  int ligne;
-  int bestColonne = -1;
-  int bestValeur = MAX + 1;
-  if (colonne != -1) { // premier appel : pas encore de coup joué
-    ligne = testColonne(game->plateau, colonne);
+  assert(colonne == -1 || (colonne >= 0 && colonne < NB_COUPS(game)));
+  if (arretDemande(r))
+    return (Couple){colonne, 0};
+  STAT(r->stats.noeuds++;
+       if (r->iteration - profondeur > r->stats.profondeurMax)
+         r->stats.profondeurMax = r->iteration - profondeur);
+  if (colonne != -1 && colonne >= NB_COLONNE) {
+    // retrait : tout le plateau a pu changer, pour les deux joueurs
+    Type joueur = (game->courant->type == J1) ? J2 : J1;
+    Type gagnant = gagnantRetrait(game, joueur);
+    if (gagnant != VIDE)
+      return (Couple){colonne, (gagnant == joueur) ? -MAX : MAX};
+    if (game->retraits >= RETRAITS_MAX) // égalité
+      return (Couple){colonne, 0};
+  } else if (colonne != -1) { // premier appel : pas encore de coup joué
+    int ligne = ligneLibre(game, colonne);
     ligne++; // le coup qu'on vient de jouer
     assert(ligne >= 0 && ligne < NB_LIGNE);
     Joueur *tmp = game->courant;
@@ -142,45 +707,827 @@ static Couple minimax(Puissance4 *game, unsigned profondeur, int colonne) {
         game->courant = tmp;
         return (Couple){colonne, 0};
       }
-      return (Couple){colonne, MAX};
+      return (Couple){colonne, -MAX}; // l'adversaire vient de gagner
+    }
+  }
+
+  // une position et sa symétrique ont la même valeur : même entrée
+  bool miroir;
+  uint64_t cle = cleCanonique(game, &miroir);
+  if (finale && game->regle == STANDARD &&
+      game->nb_jetons >= jetonsTableFinale(finale)) {
+    Resultat res = sonderTableFinale(finale, cle);
+    if (res != INCONNU) { // résultat exact, quelle que soit la profondeur
+      STAT(r->stats.finales++);
+      return (Couple){colonne, valeurResultat(res)};
     }
   }
 
   if (profondeur == 0) { // fin de la recherche en profondeur
-    return (Couple){colonne, evaluation(game)};
+    STAT(r->stats.feuilles++);
+    // evaluation évalue pour le joueur qui vient de jouer
+    return (Couple){colonne, -evaluation(game)};
   }
 
-  for (int i = 0; i < NB_COLONNE; i++) {
-    ligne = testColonne(game->plateau, i);
-    if (ligne != -1) { // on peut jouer dans cette colonne
-      modifJeton(game, ligne, i, game->courant->type); // do
+  if (++r->noeuds % INTERVALLE_CONTROLE == 0)
+    controler(r);
+
+  int alphaInitial = alpha;
+  int coupTable = -1, valeurTable;
+  unsigned char profondeurTable;
+  Borne borne;
+  STAT(if (transpo) r->stats.sondages++);
+  if (transpo && sonderTransposition(transpo, cle, &coupTable, &valeurTable,
+                                     &profondeurTable, &borne)) {
+    STAT(r->stats.succes++);
+    if (miroir)
+      coupTable = symetrique(coupTable);
+    if (profondeurTable >= profondeur) {
+      if (borne == INFERIEURE && valeurTable > alpha)
+        alpha = valeurTable;
+      else if (borne == SUPERIEURE && valeurTable < beta)
+        beta = valeurTable;
+      if (borne == EXACTE || alpha >= beta) {
+        STAT(r->stats.coupuresTable++);
+        return (Couple){coupTable, valeurTable};
+      }
+    }
+  }
+
+  int ordre[NB_COUPS_MAX], lignes[NB_COUPS_MAX], nb = NB_COUPS(game);
+  ordonner(ordre, coupTable, nb);
+  prioriser(game, ordre, lignes, nb, colonnesCandidates(game, voisinage));
+  int bestColonne = -1;
+  int bestValeur = -MAX - 1;
+  for (int k = 0; k < nb; k++) {
+    int i = ordre[k];
+    int ligne = lignes[k];
+    if (ligne != -1) { // on peut jouer ce coup
+      jouer(game, i, ligne); // do
       changerJoueur(game);
-      res = minimax(game, profondeur - 1, i);
-      int valeur_courante = -res.valeur;
-      if (valeur_courante < bestValeur) {
-        bestValeur = valeur_courante;
+      if (transpo && profondeur > 1) // la suite consultera la table
+        prefetcherTransposition(transpo, cleCanonique(game, NULL));
+      int valeur = explorer(r, game, profondeur, i, alpha, beta,
+                            r->algorithme == PVS && bestColonne != -1);
+      changerJoueur(game);
+      dejouer(game, i, ligne); // undo
+      if (arretDemande(r)) // résultat incomplet : ne pas le stocker
+        return (Couple){bestColonne, bestValeur};
+      if (valeur > bestValeur) {
+        bestValeur = valeur;
         bestColonne = i;
       }
-      changerJoueur(game);
-      modifJeton(game, ligne, i, VIDE); // undo
+      if (bestValeur > alpha)
+        alpha = bestValeur;
+      if (alpha >= beta) { // l'adversaire évitera cette position
+        STAT(r->stats.coupures[k]++);
+        break;
+      }
     }
   }
+  if (transpo)
+    stockerTransposition(transpo, cle, profondeur,
+                         miroir ? symetrique(bestColonne) : bestColonne,
+                         bestValeur,
+                         bestValeur <= alphaInitial ? SUPERIEURE
+                         : bestValeur >= beta       ? INFERIEURE
+                                                    : EXACTE);
   return (Couple){bestColonne, bestValeur};
 }
 
 /**
- * @brief Sélectionne la colonne à jouer par l'IA.
+ * @brief Une recherche à la racine : essaie chaque coup en commençant par le
+ * meilleur de l'itération précédente. Chaque coup dont la valeur dépasse alpha
+ * est publié dès qu'il est complètement calculé, si bien qu'une itération
+ * interrompue profite quand même au meilleur coup connu.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de l'itération
+ * @param precedent le meilleur coup de l'itération précédente, -1 si aucun
+ * @param alpha la borne inférieure de la fenêtre
+ * @param beta la borne supérieure de la fenêtre
+ * @return Couple le meilleur coup et sa valeur pour le joueur courant, exacte
+ * si elle est strictement entre alpha et beta (indice -1 si la recherche a été
+ * interrompue avant la fin du premier coup)
+ */
+static Couple racine(Recherche *r, Puissance4 *game, unsigned profondeur,
+                     int precedent, int alpha, int beta) {
+  int ordre[NB_COUPS_MAX], nb = NB_COUPS(game);
+  ordonner(ordre, precedent, nb);
+  uint32_t candidates = colonnesCandidates(game, voisinage);
+  Couple best = {-1, -MAX - 1};
+  int a = alpha;
+  STAT(r->iteration = profondeur; r->stats.noeuds++; r->stats.iterations++);
+  for (int k = 0; k < nb && a < beta; k++) {
+    int i = ordre[k];
+    int ligne = caseCoup(game, i, candidates);
+    if (ligne == -1)
+      continue;
+    jouer(game, i, ligne);
+    changerJoueur(game);
+    int valeur = explorer(r, game, profondeur, i, a, beta,
+                          r->algorithme == PVS && best.indice != -1);
+    changerJoueur(game);
+    dejouer(game, i, ligne);
+    if (arretDemande(r))
+      return best;
+    if (valeur > best.valeur) {
+      best = (Couple){i, valeur};
+      if (valeur > alpha)
+        publier(r, best);
+    }
+    if (best.valeur > a)
+      a = best.valeur;
+  }
+  if (transpo) {
+    bool miroir;
+    uint64_t cle = cleCanonique(game, &miroir);
+    stockerTransposition(transpo, cle, profondeur,
+                         miroir ? symetrique(best.indice) : best.indice,
+                         best.valeur,
+                         best.valeur <= alpha  ? SUPERIEURE
+                         : best.valeur >= beta ? INFERIEURE
+                                               : EXACTE);
+  }
+  return best;
+}
+
+/**
+ * @brief Une itération de MTD(f) : des recherches à fenêtre nulle autour d'une
+ * estimation du score, chacune indiquant s'il est au-dessus ou en dessous,
+ * jusqu'à ce que les bornes se rejoignent. Les positions déjà vues sont
+ * retrouvées dans la table de transposition.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de l'itération
+ * @param estimation le résultat de l'itération précédente
+ * @return Couple le meilleur coup et sa valeur exacte pour le joueur courant
+ */
+static Couple mtdf(Recherche *r, Puissance4 *game, unsigned profondeur,
+                   Couple estimation) {
+  int bas = -MAX - 1, haut = MAX + 1;
+  int f = estimation.valeur;
+  Couple best = {-1, 0}, c = estimation;
+  while (bas < haut && !arretDemande(r)) {
+    int b = (f == bas) ? f + 1 : f;
+    c = racine(r, game, profondeur,
+               (best.indice != -1) ? best.indice : estimation.indice, b - 1, b);
+    f = c.valeur;
+    if (f < b) {
+      haut = f;
+    } else {
+      bas = f;
+      best = c;
+    }
+  }
+  if (best.indice == -1) // aucun coup n'atteint l'estimation
+    best.indice = c.indice;
+  best.valeur = f;
+  return best;
+}
+
+/**
+ * @brief Une itération avec fenêtre d'aspiration : les scores variant peu
+ * d'une itération à l'autre de même parité (l'évaluation avantage le joueur
+ * qui vient de jouer), on cherche d'abord avec une fenêtre étroite autour du
+ * score de l'avant-dernière itération, qui coupe davantage de branches. Si le
+ * score en sort, la fenêtre est élargie de ce côté et la racine recherchée de
+ * nouveau.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de l'itération
+ * @param coup le meilleur coup de l'itération précédente
+ * @param estimation le score de l'avant-dernière itération
+ * @return Couple le meilleur coup et sa valeur exacte pour le joueur courant
+ */
+static Couple aspiration(Recherche *r, Puissance4 *game, unsigned profondeur,
+                         int coup, int estimation) {
+  int delta = FENETRE_ASPIRATION;
+  int alpha = estimation - delta, beta = estimation + delta;
+  if (alpha < -MAX - 1)
+    alpha = -MAX - 1;
+  if (beta > MAX + 1)
+    beta = MAX + 1;
+  for (;;) {
+    Couple c = racine(r, game, profondeur, coup, alpha, beta);
+    if (arretDemande(r) || (c.valeur > alpha && c.valeur < beta))
+      return c;
+    delta *= 2;
+    if (c.valeur <= alpha) {
+      STAT(r->stats.echecsBas++);
+      alpha = (alpha - delta < -MAX - 1) ? -MAX - 1 : alpha - delta;
+    } else {
+      STAT(r->stats.echecsHaut++);
+      beta = (beta + delta > MAX + 1) ? MAX + 1 : beta + delta;
+      coup = c.indice; // le coup qui a dépassé la fenêtre
+    }
+  }
+}
+
+/**
+ * @brief Recherche par approfondissement itératif : une recherche complète à
+ * la profondeur 1, puis 2... jusqu'à la profondeur demandée. Chaque itération
+ * commence par le meilleur coup de la précédente, et le meilleur coup connu
+ * reste disponible si la recherche est arrêtée.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de la dernière itération
+ * @return Couple le meilleur coup connu et son score pour le joueur courant
+ */
+static Couple approfondir(Recherche *r, Puissance4 *game,
+                          unsigned char profondeur) {
+  assert(game);
+  assert(game->courant);
+  assert(profondeur > 0);
+  // coup de secours, légal, si rien n'est calculé : celui de la table ou le
+  // plus central
+  Couple res = {-1, 0};
+  int ordre[NB_COUPS_MAX], nb = NB_COUPS(game);
+  int coupTable = -1, valeur;
+  unsigned char p;
+  Borne borne;
+  bool miroir;
+  uint64_t cle = cleCanonique(game, &miroir);
+  if (transpo &&
+      sonderTransposition(transpo, cle, &coupTable, &valeur, &p, &borne) &&
+      miroir)
+    coupTable = symetrique(coupTable);
+  ordonner(ordre, coupTable, nb);
+  for (int k = 0; k < nb && res.indice == -1; k++)
+    if (caseCoup(game, ordre[k], UINT32_MAX) != -1)
+      res.indice = ordre[k];
+  assert(res.indice != -1);
+  publier(r, res);
+  atomic_store(&r->profondeur, 0);
+  if (r->algorithme == DFPN) {
+    Resultat resultat = resoudre(r, game, -1);
+    if (resultat != INCONNU) { // exact : inutile d'approfondir
+      res = (Couple){coupPreuve(preuve), valeurResultat(resultat)};
+      publier(r, res);
+      atomic_store(&r->profondeur, profondeur);
+      return res;
+    }
+  }
+  int avantDernier = 0; // le score de l'itération d - 2
+
+  for (unsigned d = 1; d <= profondeur && !arretDemande(r); d++) {
+    uint64_t debut = debutTrace();
+    Couple iteration;
+    if (r->algorithme == MTDF)
+      iteration = mtdf(r, game, d, res);
+    else if (d > 2)
+      iteration = aspiration(r, game, d, res.indice, avantDernier);
+    else
+      iteration = racine(r, game, d, res.indice, -MAX - 1, MAX + 1);
+    finTrace("iteration", debut, d);
+    if (arretDemande(r))
+      break;
+    if (d > 1)
+      avantDernier = res.valeur;
+    res = iteration;
+    publier(r, res);
+    atomic_store(&r->profondeur, d);
+    if (res.valeur >= MAX || res.valeur <= -MAX) // issue forcée trouvée
+      break;
+  }
+  return meilleurCoupCourant(r);
+}
+
+#ifndef SANS_STATS
+/**
+ * @brief Remet à zéro les statistiques d'une recherche qui commence.
+ *
+ * @param r le contexte de la recherche
+ */
+static void debuterStats(Recherche *r) {
+  r->stats = (StatsRecherche){0};
+  r->iteration = 0;
+  r->debut = maintenant();
+}
+
+/**
+ * @brief Complète les statistiques d'une recherche qui se termine.
+ *
+ * @param r le contexte de la recherche
+ */
+static void terminerStats(Recherche *r) {
+  r->stats.profondeur = profondeurAtteinte(r);
+  r->stats.duree = (maintenant() - r->debut) / 1e9;
+  r->stats.nps = (r->stats.duree > 0) ? r->stats.noeuds / r->stats.duree : 0;
+}
+
+/**
+ * @brief Ajoute au journal la ligne JSON d'un coup de l'IA.
+ *
+ * @param game le jeu, avant le coup
+ * @param coup le coup joué et son score
+ * @param s les statistiques de la recherche
+ */
+static void journaliser(Puissance4 *game, Couple coup, StatsRecherche *s) {
+  unsigned pions = 0;
+  for (int l = 0; l < NB_LIGNE; l++)
+    for (int c = 0; c < NB_COLONNE; c++)
+      pions += (game->plateau[l][c] != VIDE);
+  fprintf(journal,
+          "{\"coup\":%u,\"joueur\":%d,\"niveau\":%u,\"colonne\":%d,"
+          "\"score\":%d,\"noeuds\":%llu,\"feuilles\":%llu,"
+          "\"sondages\":%llu,\"succes\":%llu,\"coupures_table\":%llu,"
+          "\"finales\":%llu,\"preuves\":%llu,\"coupures\":[",
+          pions + 1, (game->courant == game->j1) ? 1 : 2,
+          game->courant->profondeur, coup.indice, coup.valeur, s->noeuds,
+          s->feuilles, s->sondages, s->succes, s->coupuresTable, s->finales,
+          s->preuves);
+  for (int k = 0; k < NB_COUPS(game); k++)
+    fprintf(journal, "%s%llu", k ? "," : "", s->coupures[k]);
+  fprintf(journal,
+          "],\"iterations\":%u,\"echecs_bas\":%u,\"echecs_haut\":%u,"
+          "\"profondeur\":%u,\"profondeur_max\":%u,\"duree_ms\":%.3f,"
+          "\"nps\":%.0f}\n",
+          s->iterations, s->echecsBas, s->echecsHaut, s->profondeur,
+          s->profondeurMax, s->duree * 1e3, s->nps);
+  fflush(journal); // une ligne complète même si le programme est tué
+}
+#endif
+
+/**
+ * @brief Donne la clé d'une position dans l'archive : sa clé mélangée (par ou
+ * exclusif, donc de façon réversible) à la géométrie, au voisinage des
+ * recherches et au réseau d'évaluation, pour qu'une archive serve à plusieurs
+ * géométries et évaluations sans confondre leurs résultats. Celles du plateau
+ * standard, cherchées dans toutes les colonnes avec l'heuristique, gardent
+ * leur clé.
+ *
+ * @param cle la clé canonique de la position, ou sa clé dans l'archive
+ * @return uint64_t sa clé dans l'archive, ou la clé canonique
+ */
+static uint64_t cleArchive(uint64_t cle) {
+  if (geometrie.forme == 0 && voisinage == 0 && !reseau)
+    return cle;
+  uint64_t sel = (CODE_GEOMETRIE ^ (uint64_t)voisinage << 32) *
+                 0x9E3779B97F4A7C15ULL;
+  if (reseau)
+    sel ^= empreinteReseau(reseau);
+  return cle ^ sel ^ (sel >> 29);
+}
+
+/**
+ * @brief Détermine le meilleur coup du joueur courant. Le résultat est d'abord
+ * cherché dans le cache (une position et sa symétrique partagent la même
+ * entrée) puis, s'il n'y est pas ou a été calculé moins profondément, calculé
+ * par approfondissement itératif et ajouté au cache si la recherche n'a pas été
+ * arrêtée.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de la recherche
+ * @return Couple le meilleur coup et son score pour le joueur courant
+ */
+static Couple chercherMeilleurCoup(Recherche *r, Puissance4 *game,
+                                  unsigned char profondeur) {
+  assert(game);
+  assert(game->courant);
+  r->noeuds = 0;
+  r->echeance = r->duree ? maintenant() + r->duree * 1000000ULL : 0;
+  STAT(debuterStats(r));
+  if (transpo) // les entrées des recherches précédentes sont moins utiles
+    vieillirTransposition(transpo);
+  bool miroir;
+  uint64_t cle = cleCanonique(game, &miroir);
+  Couple res;
+  if ((cache &&
+       chercherCache(cache, cle, profondeur, &res.indice, &res.valeur)) ||
+      (archive &&
+       chercherArchive(archive, cleArchive(cle), profondeur, &res.indice,
+                       &res.valeur))) {
+    if (miroir)
+      res.indice = symetrique(res.indice);
+    publier(r, res);
+    atomic_store(&r->profondeur, profondeur);
+  } else {
+    res = approfondir(r, game, profondeur);
+    int coup = miroir ? symetrique(res.indice) : res.indice;
+    if (cache && !arretDemande(r))
+      ajouterCache(cache, cle, profondeur, coup, res.valeur);
+    if (archive && !arretDemande(r))
+      ajouterArchive(archive, cleArchive(cle), profondeur, coup, res.valeur);
+  }
+  STAT(terminerStats(r));
+  return res;
+}
+
+/**
+ * @brief Le corps du thread de réflexion : calcule, à la profondeur de l'IA,
+ * la réponse à chaque coup possible de l'humain, en commençant par le coup
+ * prévu par la dernière recherche de l'IA. S'arrête dès qu'un arrêt est
+ * demandé.
+ *
+ * @param arg inutilisé
+ * @return void* NULL
+ */
+static void *reflechir(void *arg) {
+  Puissance4 *pos = &reflexion.position;
+  Recherche *r = &reflexion.recherche;
+  Joueur *ia = (pos->courant == pos->j1) ? pos->j2 : pos->j1;
+  int ordre[NB_COUPS_MAX], nb = NB_COUPS(pos);
+  int prevu = -1, valeur;
+  unsigned char profondeur;
+  Borne borne;
+  bool miroir;
+  uint64_t cle = cleCanonique(pos, &miroir);
+  if (sonderTransposition(transpo, cle, &prevu, &valeur, &profondeur, &borne) &&
+      miroir)
+    prevu = symetrique(prevu);
+  ordonner(ordre, prevu, nb);
+
+  for (int k = 0; k < nb && !arretDemande(r); k++) {
+    int coup = ordre[k];
+    int ligne = caseCoup(pos, coup, UINT32_MAX);
+    if (ligne == -1)
+      continue;
+    Joueur *humain = pos->courant;
+    jouer(pos, coup, ligne);
+    if (!coupFinal(pos, coup, ligne)) {
+      pos->courant = ia;
+      chercherMeilleurCoup(r, pos, ia->profondeur);
+    }
+    pos->courant = humain;
+    dejouer(pos, coup, ligne);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Lance la réflexion sur la position enregistrée dans reflexion.
+ */
+static void demarrerReflexion() {
+  assert(!reflexion.actif);
+  reflexion.actif =
+      (pthread_create(&reflexion.thread, NULL, &reflechir, NULL) == 0);
+}
+
+/**
+ * @brief Arrête la réflexion en cours et attend la fin du thread : après
+ * l'appel, le cache et la table de transposition ne sont plus utilisés que par
+ * le thread appelant. L'arrêt est ensuite retiré, pour la réflexion suivante.
+ *
+ * @return true si une réflexion était en cours
+ * @return false sinon
+ */
+static bool arreterReflexion() {
+  if (!reflexion.actif)
+    return false;
+  arreterRecherche(&reflexion.recherche);
+  pthread_join(reflexion.thread, NULL);
+  atomic_store(&reflexion.recherche.arret, false);
+  reflexion.actif = false;
+  return true;
+}
+
+/**
+ * @brief Lance la réflexion pendant le tour de l'adversaire, si c'est un
+ * humain et que le coup de l'IA ne termine pas la partie.
+ *
+ * @param game le jeu, avant le coup de l'IA
+ * @param coup le coup joué par l'IA (voir RETRAIT)
+ */
+static void lancerReflexion(Puissance4 *game, int coup) {
+  Joueur *adversaire = (game->courant == game->j1) ? game->j2 : game->j1;
+  if (adversaire->profondeur != 0 || !transpo)
+    return;
+  Puissance4 *pos = &reflexion.position;
+  *pos = *game;
+  int ligne = caseCoup(pos, coup, UINT32_MAX);
+  jouer(pos, coup, ligne);
+  if (coupFinal(pos, coup, ligne))
+    return;
+  pos->courant = adversaire;
+  reflexion.recherche.algorithme = game->courant->algorithme;
+  demarrerReflexion();
+}
+
+/**
+ * @brief Crée un contexte de recherche, sans échéance ni fonction
+ * d'interruption.
+ *
+ * @return Recherche* le contexte, NULL en cas de problème d'allocation
+ */
+Recherche *makeRecherche() {
+  Recherche *r = malloc(sizeof(Recherche));
+  if (!r) {
+    perror("Problème d'allocation dans makeRecherche.");
+    return NULL;
+  }
+  atomic_init(&r->arret, false);
+  atomic_init(&r->meilleur, 0);
+  atomic_init(&r->profondeur, 0);
+  r->duree = 0;
+  r->algorithme = ALGORITHME_DEFAUT;
+  r->budget = BUDGET_PREUVE;
+  r->echeance = 0;
+  r->interruption = NULL;
+  r->donnees = NULL;
+  r->noeuds = 0;
+  return r;
+}
+
+/**
+ * @brief Donne le contexte des recherches de playIA et des fonctions
+ * d'analyse, pour pouvoir les arrêter ou leur fixer une échéance.
+ *
+ * @return Recherche* le contexte
+ */
+Recherche *rechercheIA() { return &principale; }
+
+/**
+ * @brief Demande l'arrêt de la recherche en cours. Peut être appelée depuis
+ * n'importe quel thread ; la recherche rend alors le meilleur coup connu. Si
+ * aucune recherche n'est en cours, c'est la suivante du contexte qui s'arrête
+ * dès son départ : l'arrêt n'est retiré qu'à la fin d'une recherche.
+ *
+ * @param r le contexte de la recherche
+ */
+void arreterRecherche(Recherche *r) {
+  assert(r);
+  atomic_store(&r->arret, true);
+}
+
+/**
+ * @brief Fixe la durée maximale des recherches d'un contexte.
+ *
+ * @param r le contexte
+ * @param duree la durée en millisecondes, 0 pour ne pas limiter la durée
+ */
+void definirEcheance(Recherche *r, unsigned duree) {
+  assert(r);
+  r->duree = duree;
+}
+
+/**
+ * @brief Fixe une fonction appelée régulièrement pendant les recherches d'un
+ * contexte (dans le thread qui recherche) : si elle renvoie true, la
+ * recherche s'arrête.
+ *
+ * @param r le contexte
+ * @param interruption la fonction, NULL pour aucune
+ * @param donnees les données passées à la fonction
+ */
+void definirInterruption(Recherche *r, bool (*interruption)(void *),
+                         void *donnees) {
+  assert(r);
+  r->interruption = interruption;
+  r->donnees = donnees;
+}
+
+/**
+ * @brief Choisit l'algorithme des recherches d'un contexte.
+ *
+ * @param r le contexte
+ * @param algorithme l'algorithme
+ */
+void definirAlgorithme(Recherche *r, Algorithme algorithme) {
+  assert(r);
+  r->algorithme = algorithme;
+}
+
+/**
+ * @brief Fixe le nombre maximal de positions développées par df-pn (algorithme
+ * DFPN) pour résoudre une position, avant de revenir à alpha-beta.
+ *
+ * @param r le contexte
+ * @param budget le nombre de positions (BUDGET_PREUVE par défaut)
+ */
+void definirBudget(Recherche *r, unsigned long long budget) {
+  assert(r);
+  r->budget = budget;
+}
+
+/**
+ * @brief Donne le meilleur coup connu de la recherche en cours (ou de la
+ * dernière). Peut être appelée depuis n'importe quel thread.
+ *
+ * @param r le contexte de la recherche
+ * @return Couple le coup, toujours légal une fois la recherche lancée, et son
+ * score pour le joueur qui doit jouer
+ */
+Couple meilleurCoupCourant(Recherche *r) {
+  assert(r);
+  uint64_t m = atomic_load(&r->meilleur);
+  return (Couple){(int32_t)(uint32_t)m, (int32_t)(uint32_t)(m >> 32)};
+}
+
+/**
+ * @brief Donne la profondeur de la dernière itération terminée de la
+ * recherche en cours (ou de la dernière).
+ *
+ * @param r le contexte de la recherche
+ * @return unsigned char la profondeur
+ */
+unsigned char profondeurAtteinte(Recherche *r) {
+  assert(r);
+  return atomic_load(&r->profondeur);
+}
+
+/**
+ * @brief Donne les statistiques de la dernière recherche d'un contexte (à lire
+ * une fois la recherche terminée, dans le thread qui l'a lancée).
+ *
+ * @param r le contexte de la recherche
+ * @return StatsRecherche les statistiques, à 0 dans un programme compilé sans
+ * statistiques
+ */
+StatsRecherche statsRecherche(Recherche *r) {
+  assert(r);
+#ifdef SANS_STATS
+  return (StatsRecherche){0};
+#else
+  return r->stats;
+#endif
+}
+
+/**
+ * @brief Supprime un contexte de recherche.
+ *
+ * @param r le contexte
+ */
+void destroyRecherche(Recherche *r) { free(r); }
+
+/**
+ * @brief Lance une recherche du meilleur coup du joueur courant avec un
+ * contexte donné (voir chercherMeilleurCoup). Une réflexion en cours est
+ * suspendue le temps de la recherche. Un arrêt demandé avant l'appel (voir
+ * arreterRecherche) est pris en compte : la recherche rend aussitôt un coup
+ * légal. L'arrêt est retiré à la fin de la recherche.
+ *
+ * @param r le contexte de la recherche
+ * @param game le jeu
+ * @param profondeur la profondeur de la recherche
+ * @return Couple le meilleur coup et son score pour le joueur courant
+ */
+Couple rechercher(Recherche *r, Puissance4 *game, unsigned char profondeur) {
+  assert(r);
+  bool reprendre = arreterReflexion();
+  Couple res = chercherMeilleurCoup(r, game, profondeur);
+  atomic_store(&r->arret, false); // l'arrêt demandé visait cette recherche
+  if (reprendre)
+    demarrerReflexion();
+  return res;
+}
+
+/**
+ * @brief Analyse une position : détermine le meilleur coup du joueur courant
+ * (voir rechercher), avec le contexte des IA.
+ *
+ * @param game le jeu
+ * @param profondeur la profondeur de la recherche
+ * @return Couple le meilleur coup et son score pour le joueur courant
+ */
+Couple meilleurCoup(Puissance4 *game, unsigned char profondeur) {
+  return rechercher(&principale, game, profondeur);
+}
+
+/**
+ * @brief Analyse tous les coups d'une position en une seule recherche :
+ * chaque coup possible est évalué par minimax, la table de transposition étant
+ * partagée entre les coups (une position atteinte depuis plusieurs coups
+ * n'est calculée qu'une fois). Avec l'algorithme DFPN (voir
+ * definirAlgorithme sur rechercheIA), chaque colonne est d'abord résolue par
+ * df-pn. Le meilleur coup est ajouté au cache. Une réflexion en cours est
+ * suspendue le temps de l'analyse. Avec la règle Pop Out, les retraits sont
+ * analysés comme les ajouts de jetons.
+ *
+ * @param game le jeu
+ * @param profondeur la profondeur de la recherche (au moins 1)
+ * @return Analyse le score exact de chaque coup possible pour le joueur
+ * courant et le meilleur coup (voir RETRAIT)
+ */
+Analyse analyseColonnes(Puissance4 *game, unsigned char profondeur) {
+  assert(game);
+  assert(game->courant);
+  assert(profondeur > 0);
+  bool reprendre = arreterReflexion();
+  Recherche *r = &principale;
+  r->echeance = r->duree ? maintenant() + r->duree * 1000000ULL : 0;
+  STAT(debuterStats(r); r->iteration = profondeur);
+  if (transpo)
+    vieillirTransposition(transpo);
+  Analyse a;
+  a.meilleur = -1;
+  for (int i = 0; i < NB_COUPS(game); i++) {
+    int ligne = caseCoup(game, i, UINT32_MAX);
+    a.jouable[i] = (ligne != -1);
+    a.scores[i] = 0;
+    if (!a.jouable[i])
+      continue;
+    jouer(game, i, ligne);
+    changerJoueur(game);
+    Resultat resultat = (r->algorithme == DFPN && i < NB_COLONNE)
+                            ? resoudre(r, game, i)
+                            : INCONNU;
+    if (resultat != INCONNU)
+      a.scores[i] = -valeurResultat(resultat);
+    else // fenêtre complète : valeur exacte
+      a.scores[i] =
+          -minimax(r, game, profondeur - 1, i, -MAX - 1, MAX + 1).valeur;
+    changerJoueur(game);
+    dejouer(game, i, ligne);
+    if (a.meilleur == -1 || a.scores[i] > a.scores[a.meilleur])
+      a.meilleur = i;
+  }
+  if (cache && a.meilleur != -1 && !arretDemande(r)) {
+    bool miroir;
+    uint64_t cle = cleCanonique(game, &miroir);
+    ajouterCache(cache, cle, profondeur,
+                 miroir ? symetrique(a.meilleur) : a.meilleur,
+                 a.scores[a.meilleur]);
+  }
+  STAT(atomic_store(&r->profondeur, arretDemande(r) ? 0 : profondeur);
+       terminerStats(r));
+  atomic_store(&r->arret, false);
+  if (reprendre)
+    demarrerReflexion();
+  return a;
+}
+
+/**
+ * @brief Sélectionne la colonne à jouer par l'IA. La réflexion menée pendant
+ * le tour de l'humain est arrêtée (sa réponse est souvent déjà dans le cache)
+ * puis une nouvelle est lancée pour le tour suivant. La recherche peut être
+ * arrêtée (voir rechercheIA) : le meilleur coup connu est alors joué.
  *
  * @param game le jeu
  * @return unsigned la colonne où l'IA place un pion
  */
 static unsigned playIA(Puissance4 *game) {
   assert(game);
-  Couple res = minimax(game, game->courant->profondeur, -1);
-  assert(res.indice >= 0 && res.indice < NB_COLONNE);
+  uint64_t debut = debutTrace();
+  arreterReflexion();
+  principale.algorithme = game->courant->algorithme;
+  Couple res = chercherMeilleurCoup(&principale, game, game->courant->profondeur);
+  atomic_store(&principale.arret, false);
+  assert(res.indice >= 0 && res.indice < NB_COUPS(game));
+  STAT(if (journal) journaliser(game, res, &principale.stats));
+  lancerReflexion(game, res.indice);
+  finTrace("playIA", debut, res.indice);
   return (unsigned)res.indice;
 }
 
+/**
+ * @brief Range un résultat de l'archive dans la table de transposition.
+ *
+ * @param table la table (Transposition *)
+ * @param cle la clé de la position dans l'archive (voir cleArchive)
+ * @param profondeur la profondeur de la recherche
+ * @param coup le meilleur coup dans la position canonique
+ * @param valeur la valeur exacte pour le joueur courant
+ */
+static void rechauffer(void *table, uint64_t cle, unsigned char profondeur,
+                       int coup, int valeur) {
+  stockerTransposition(table, cleArchive(cle), profondeur, coup, valeur,
+                       EXACTE);
+}
+
+/**
+ * @brief Donne le sel des clés de la table de transposition des IA (voir
+ * salerTransposition) : ce dont dépendent leurs résultats en plus de la
+ * position et du plateau (la table des finales, le réseau d'évaluation et le
+ * voisinage des recherches). Les processus qui partagent une table n'y
+ * confondent ainsi que des résultats comparables.
+ *
+ * @return uint64_t le sel, 0 sans table des finales ni réseau, avec toutes
+ * les colonnes
+ */
+static uint64_t selTranspo() {
+  uint64_t sel = finale ? empreinteTableFinale(finale) : 0;
+  if (reseau) // pas un simple ou exclusif : les deux empreintes sont impaires
+    sel = (sel + empreinteReseau(reseau)) * 0x9E3779B97F4A7C15ULL;
+  if (voisinage)
+    sel = (sel + voisinage) * 0x9E3779B97F4A7C15ULL;
+  return sel;
+}
+
+/**
+ * @brief Crée la table de transposition des IA : partagée si un nom a été
+ * donné, propre au processus sinon. Les résultats de l'archive y sont rangés,
+ * pour que les recherches partent de ce que les processus précédents ont
+ * trouvé.
+ *
+ * @return Transposition* la table, NULL en cas de problème
+ */
+static Transposition *creerTranspo() {
+  Transposition *t = nomPartage
+                         ? makeTranspositionPartagee(nomPartage, entreesTranspo)
+                         : makeTransposition(entreesTranspo);
+  if (t)
+    salerTransposition(t, selTranspo());
+  if (t && archive)
+    parcourirArchive(archive, &rechauffer, t);
+  return t;
+}
+
 /**
  * @brief Crée un joueur IA.
  *
@@ -210,6 +1557,263 @@ Joueur *makeIA(Type t, char niveau) {
     break;
   }
   j->profondeur = niveau;
+  j->algorithme = ALGORITHME_DEFAUT;
   j->play = &playIA;
+  // sans cache ni table, l'IA joue quand même
+  if (!cache)
+    cache = makeCache(TAILLE_CACHE);
+  if (!transpo)
+    transpo = creerTranspo();
+  if (!preuve)
+    preuve = makePreuve(TAILLE_PREUVE);
   return j;
+}
+
+/**
+ * @brief Récupère les compteurs d'utilisation du cache des IA.
+ *
+ * @return StatsCache les compteurs (à 0 si aucun cache n'a été créé)
+ */
+StatsCache statsCacheIA() {
+  if (!cache)
+    return (StatsCache){0, 0, 0};
+  return statsCache(cache);
+}
+
+/**
+ * @brief Journalise les recherches de playIA : une ligne JSON par coup
+ * (numéro du coup, joueur, colonne, score et statistiques de la recherche)
+ * est ajoutée à la fin d'un fichier. Sans effet dans un programme compilé
+ * sans statistiques.
+ *
+ * @param chemin le fichier, NULL pour arrêter de journaliser
+ * @return true si le fichier a pu être ouvert (ou chemin vaut NULL)
+ * @return false sinon
+ */
+bool journaliserIA(const char *chemin) {
+  if (journal) {
+    fclose(journal);
+    journal = NULL;
+  }
+#ifndef SANS_STATS
+  if (chemin) {
+    journal = fopen(chemin, "a");
+    if (!journal) {
+      perror("Impossible d'ouvrir le journal de l'IA");
+      return false;
+    }
+  }
+#endif
+  return true;
+}
+
+/**
+ * @brief Charge la table des finales consultée par les IA (voir tablebase.h),
+ * à la place de la précédente. Une réflexion en cours est arrêtée.
+ *
+ * @param chemin le fichier de la table, NULL pour ne plus en consulter
+ * @return true si la table a pu être ouverte (ou chemin vaut NULL)
+ * @return false sinon
+ */
+bool chargerTableIA(const char *chemin) {
+  arreterReflexion();
+  if (!finale && !chemin) // rien ne change (la table partagée est gardée)
+    return true;
+  fermerTableFinale(finale);
+  finale = chemin ? ouvrirTableFinale(chemin) : NULL;
+  if (cache) // les résultats changent avec la table
+    viderCache(cache);
+  if (transpo) { // une table partagée est gardée : seul le sel change
+    viderTransposition(transpo);
+    salerTransposition(transpo, selTranspo());
+  }
+  return !chemin || finale;
+}
+
+/**
+ * @brief Change la taille de la table de transposition des IA : la table est
+ * recréée vide (la réflexion en cours est arrêtée), ou le sera au prochain
+ * makeIA. Au-delà de quelques centaines de Mo, les pages énormes (voir
+ * memoire.h) évitent la plupart des défauts de TLB.
+ *
+ * @param mo la taille en Mo, arrondie à la puissance de 2 inférieure
+ * @return true si la table a pu être allouée
+ * @return false sinon (les IA jouent alors sans table)
+ */
+bool dimensionnerTableIA(unsigned long mo) {
+  assert(mo > 0);
+  entreesTranspo = (mo << 20) / 8;
+  if (!transpo)
+    return true;
+  arreterReflexion();
+  destroyTransposition(transpo);
+  transpo = creerTranspo();
+  return transpo;
+}
+
+/**
+ * @brief Limite les coups étudiés par les recherches des IA aux colonnes
+ * proches des jetons déjà joués (voir colonnesCandidates), ce qui réduit
+ * beaucoup le nombre de coups par position sur les grands plateaux. Les
+ * résultats déjà calculés, qui en dépendent, sont oubliés (voir
+ * reinitialiserIA ; ceux d'une table partagée ne sont plus vus, voir
+ * selTranspo). analyseColonnes donne toujours un score à chaque colonne
+ * jouable, et df-pn étudie toujours toutes les colonnes.
+ *
+ * @param distance la distance maximale en colonnes aux colonnes non vides, 0
+ * pour toutes les colonnes (par défaut)
+ */
+void definirVoisinageIA(unsigned distance) {
+  voisinage = distance;
+  reinitialiserIA();
+  if (transpo)
+    salerTransposition(transpo, selTranspo());
+}
+
+/**
+ * @brief Partage la table de transposition des IA avec les autres processus
+ * de la machine qui utilisent le même nom : une position résolue par l'un
+ * l'est pour tous. La table est ouverte (ou créée, de la taille donnée par
+ * dimensionnerTableIA) à la place de la précédente, la réflexion en cours
+ * étant arrêtée, ou le sera au prochain makeIA. Les processus qui ne
+ * consultent pas la même table des finales n'y voient pas les résultats des
+ * autres (voir selTranspo). Elle n'est jamais vidée par ses processus.
+ *
+ * @param nom le nom du segment de mémoire partagée ("/nom"), NULL pour
+ * revenir à une table propre au processus
+ * @return true si la table a pu être ouverte
+ * @return false sinon (les IA jouent alors sans table)
+ */
+bool partagerTableIA(const char *nom) {
+  free(nomPartage);
+  nomPartage = NULL;
+  if (nom) {
+    nomPartage = malloc(strlen(nom) + 1);
+    if (!nomPartage) {
+      perror("Problème d'allocation dans partagerTableIA.");
+      return false;
+    }
+    strcpy(nomPartage, nom);
+  }
+  if (!transpo)
+    return true;
+  arreterReflexion();
+  destroyTransposition(transpo);
+  transpo = creerTranspo();
+  return transpo;
+}
+
+/**
+ * @brief Affiche la taille de la table de transposition des IA, les pages
+ * obtenues pour elle et son nom si elle est partagée (rien si elle n'a pas
+ * été créée).
+ *
+ * @param f le fichier où écrire
+ */
+void afficherMemoireIA(FILE *f) {
+  if (!transpo)
+    return;
+  fprintf(f, "Table de transposition : %llu Mo, %s",
+          octetsTransposition(transpo) >> 20,
+          nomModePages(modeTransposition(transpo)));
+  if (nomTransposition(transpo))
+    fprintf(f, ", partagée (%s)", nomTransposition(transpo));
+  fprintf(f, "\n");
+}
+
+/**
+ * @brief Ouvre l'archive où les IA gardent le résultat de leurs recherches
+ * (voir archive.h), à la place de la précédente : ces résultats sont repris
+ * par les processus suivants, dans la table de transposition et à la racine
+ * des recherches. La réflexion en cours est arrêtée.
+ *
+ * @param chemin le fichier de l'archive, NULL pour ne plus en utiliser
+ * @return true si l'archive a pu être ouverte (ou chemin vaut NULL)
+ * @return false sinon
+ */
+bool chargerArchiveIA(const char *chemin) {
+  arreterReflexion();
+  fermerArchive(archive);
+  archive = chemin ? ouvrirArchive(chemin) : NULL;
+  if (archive && transpo)
+    parcourirArchive(archive, &rechauffer, transpo);
+  return !chemin || archive;
+}
+
+/**
+ * @brief Charge le réseau qui remplace l'heuristique dans les évaluations des
+ * IA (voir reseau.h), à la place du précédent. La réflexion en cours est
+ * arrêtée et les résultats déjà calculés, qui en dépendent, sont oubliés (ceux
+ * d'une table partagée et de l'archive ne sont plus vus, voir selTranspo et
+ * cleArchive). Les parties doivent être recommencées (voir initGame).
+ *
+ * @param chemin le fichier des poids, fait pour le plateau de geometrie, NULL
+ * pour revenir à l'heuristique
+ * @return true si le réseau a pu être chargé (ou chemin vaut NULL)
+ * @return false sinon (les IA gardent l'heuristique)
+ */
+bool chargerReseauIA(const char *chemin) {
+  arreterReflexion();
+  if (!reseau && !chemin)
+    return true;
+  Reseau *nouveau = chemin ? lireReseau(chemin) : NULL;
+  if (nouveau && !activerReseau(nouveau)) {
+    free(nouveau);
+    nouveau = NULL;
+  }
+  if (!nouveau)
+    activerReseau(NULL);
+  free(reseau);
+  reseau = nouveau;
+  reinitialiserIA(); // la table partagée est gardée : seul le sel change
+  if (transpo)
+    salerTransposition(transpo, selTranspo());
+  return !chemin || reseau;
+}
+
+/**
+ * @brief Arrête la réflexion en cours et attend la fin de son thread, par
+ * exemple quand la partie est finie ou avant de libérer les joueurs, que le
+ * thread lit dans sa copie de la position.
+ */
+void arreterReflexionIA() { arreterReflexion(); }
+
+/**
+ * @brief Arrête la réflexion en cours puis vide le cache, la table de
+ * transposition (sauf si elle est partagée) et celle de df-pn : les
+ * recherches suivantes repartent de zéro, ou de la table partagée.
+ */
+void reinitialiserIA() {
+  arreterReflexion();
+  if (cache)
+    viderCache(cache);
+  if (transpo)
+    viderTransposition(transpo);
+  if (preuve)
+    viderPreuve(preuve);
+}
+
+/**
+ * @brief Supprime ce qui a été alloué pour les IA (le cache, la table de
+ * transposition, qui reste pour les autres processus si elle est partagée, et
+ * le solveur df-pn, le réseau d'évaluation) et ferme le journal, la table des
+ * finales et l'archive, après avoir arrêté la réflexion en cours.
+ */
+void cleanIA() {
+  arreterReflexion();
+  journaliserIA(NULL);
+  fermerTableFinale(finale); // sans rien vider : tout est supprimé ensuite
+  finale = NULL;
+  chargerArchiveIA(NULL);
+  activerReseau(NULL); // sans reinitialiserIA : tout est supprimé ensuite
+  free(reseau);
+  reseau = NULL;
+  destroyCache(cache);
+  cache = NULL;
+  destroyTransposition(transpo);
+  transpo = NULL;
+  free(nomPartage);
+  nomPartage = NULL;
+  destroyPreuve(preuve);
+  preuve = NULL;
 }
\ No newline at end of file
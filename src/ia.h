@@ -17,12 +17,146 @@
  */
 #define IA_H
 
+#include "cache.h"
 #include "puissance_quatre.h"
 
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @def VICTOIRE
+ * @brief le score d'une partie gagnée
+ */
+/**
+ * @def PROFONDEUR_INDICES
+ * @brief la profondeur de l'analyse affichée aux joueurs humains
+ */
+#define VICTOIRE 10000
+#define PROFONDEUR_INDICES 5
+
+/**
+ * @struct couple_
+ * @brief Un couple indice de la colonne et sa valeur associée.
+ * @typedef Couple
+ * @brief Renommer un couple_.
+ */
+typedef struct couple_ {
+  int indice; //!< indice de la colonne
+  int valeur; //!< valeur associée à la colonne
+} Couple;
+
+/**
+ * @enum algorithme_
+ * @brief Les algorithmes de recherche des IA. Les trois premiers donnent le
+ * même score en visitant plus ou moins de positions.
+ * @typedef Algorithme
+ * @brief Renommer algorithme_.
+ */
+typedef enum algorithme_ {
+  ALPHABETA, //!< alpha-beta, chaque coup avec la fenêtre complète
+  PVS, /*!< Principal Variation Search : les coups après le premier sont
+            seulement comparés au meilleur (fenêtre nulle), puis recherchés de
+            nouveau s'ils sont meilleurs */
+  MTDF, /*!< MTD(f) : une suite de recherches à fenêtre nulle qui encadrent le
+            score, en s'appuyant sur la table de transposition */
+  DFPN  /*!< df-pn : la position est d'abord résolue par nombres de preuve
+            (voir preuve.h), dans la limite du budget ; le score est alors
+            exact (VICTOIRE, 0 ou -VICTOIRE). Sinon, alpha-beta */
+} Algorithme;
+
+/**
+ * @def BUDGET_PREUVE
+ * @brief le nombre de positions développées par défaut par df-pn avant de
+ * revenir à alpha-beta
+ */
+#define BUDGET_PREUVE (1 << 20)
+
+/**
+ * @def ALGORITHME_DEFAUT
+ * @brief l'algorithme des IA créées par makeIA (le plus rapide, voir make
+ * bench)
+ */
+#define ALGORITHME_DEFAUT PVS
+
+/**
+ * @typedef Recherche
+ * @brief Renommer recherche_ (structure opaque) : le contexte d'une recherche.
+ */
+typedef struct recherche_ Recherche;
+
+/**
+ * @struct statsRecherche_
+ * @brief Les statistiques d'une recherche, toutes à 0 si le programme est
+ * compilé sans statistiques (make STATS=0).
+ * @typedef StatsRecherche
+ * @brief Renommer statsRecherche_.
+ */
+typedef struct statsRecherche_ {
+  unsigned long long noeuds;        //!< positions visitées
+  unsigned long long feuilles;      //!< positions évaluées
+  unsigned long long sondages;      //!< consultations de la table
+  unsigned long long succes;        //!< positions trouvées dans la table
+  unsigned long long coupuresTable; //!< recherches évitées grâce à la table
+  unsigned long long finales; //!< positions trouvées dans la table des finales
+  unsigned long long preuves; //!< positions développées par df-pn
+  /**
+   * coupures beta selon le rang du coup qui les provoque (0 : le premier coup
+   * essayé)
+   */
+  unsigned long long coupures[NB_COUPS_MAX];
+  unsigned iterations; //!< recherches à la racine (re-recherches comprises)
+  unsigned echecsBas;  //!< re-recherches : score sous la fenêtre d'aspiration
+  unsigned echecsHaut; //!< re-recherches : score au-dessus de la fenêtre
+  unsigned profondeur;    //!< profondeur de la dernière itération terminée
+  unsigned profondeurMax; //!< profondeur de la position la plus profonde
+  double duree;           //!< durée en secondes
+  double nps;             //!< positions visitées par seconde
+} StatsRecherche;
+
+/**
+ * @struct analyse_
+ * @brief Le résultat de l'analyse de tous les coups d'une position, indexés
+ * comme les coups (voir RETRAIT) : les retraits de la règle Pop Out suivent
+ * les ajouts.
+ * @typedef Analyse
+ * @brief Renommer analyse_.
+ */
+typedef struct analyse_ {
+  bool jouable[NB_COUPS_MAX]; //!< true si le coup est possible
+  int scores[NB_COUPS_MAX];   //!< score de chaque coup (joueur courant)
+  int meilleur;               //!< le meilleur coup, -1 si aucun
+} Analyse;
+
 unsigned valeurCase(Puissance4, unsigned, unsigned);
 unsigned autour(Puissance4, unsigned, unsigned);
 unsigned scoreJoueur(Puissance4);
 int evaluation(Puissance4 *);
+Recherche *makeRecherche();
+Recherche *rechercheIA();
+void arreterRecherche(Recherche *);
+void definirEcheance(Recherche *, unsigned);
+void definirInterruption(Recherche *, bool (*)(void *), void *);
+void definirAlgorithme(Recherche *, Algorithme);
+void definirBudget(Recherche *, unsigned long long);
+Couple meilleurCoupCourant(Recherche *);
+unsigned char profondeurAtteinte(Recherche *);
+StatsRecherche statsRecherche(Recherche *);
+void destroyRecherche(Recherche *);
+Couple rechercher(Recherche *, Puissance4 *, unsigned char);
+Couple meilleurCoup(Puissance4 *, unsigned char);
+Analyse analyseColonnes(Puissance4 *, unsigned char);
 Joueur *makeIA(Type, char);
+StatsCache statsCacheIA();
+bool journaliserIA(const char *);
+bool chargerTableIA(const char *);
+bool chargerArchiveIA(const char *);
+bool chargerReseauIA(const char *);
+bool dimensionnerTableIA(unsigned long);
+void definirVoisinageIA(unsigned);
+bool partagerTableIA(const char *);
+void afficherMemoireIA(FILE *);
+void arreterReflexionIA();
+void reinitialiserIA();
+void cleanIA();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,261 @@
+/**
+ * @file latence.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Histogrammes de latence des coups des IA, par profondeur et par
+ * phase de la partie. Chaque histogramme a des cases de largeur relative
+ * constante (à la manière de HdrHistogram) : les percentiles sont connus à
+ * 1,6 % près quelle que soit la durée, sans garder toutes les mesures.
+ * @version 0.1
+ * @date 2023-02-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "latence.h"
+#include "commun.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @def BITS_PRECISION
+ * @brief chaque puissance de 2 est découpée en 2^BITS_PRECISION cases
+ */
+#define BITS_PRECISION 6
+
+/**
+ * @def NB_CASES
+ * @brief le nombre de cases d'un histogramme : les durées au-delà de 2^41 µs
+ * (plus de trois semaines) sont comptées dans la dernière
+ */
+#define NB_CASES ((41 - BITS_PRECISION + 1) << BITS_PRECISION)
+
+/**
+ * @struct histogramme_
+ * @brief Un histogramme de durées en microsecondes.
+ */
+struct histogramme_ {
+  unsigned long long cases[NB_CASES]; //!< Le nombre de mesures de chaque case
+  unsigned long long nb;              //!< Le nombre total de mesures
+  uint64_t max;                       //!< La plus grande mesure
+};
+
+/**
+ * @brief Les histogrammes des coups des IA, par profondeur et par phase de la
+ * partie (créés à la première mesure).
+ */
+static Histogramme *latences[NB_PROFONDEURS][NB_PHASES];
+
+/**
+ * @brief Donne la case d'une durée : les 2^(BITS_PRECISION+1) premières
+ * valeurs ont chacune leur case, puis chaque puissance de 2 est découpée en
+ * 2^BITS_PRECISION cases de même largeur.
+ *
+ * @param v la durée
+ * @return unsigned la case
+ */
+static unsigned indiceCase(uint64_t v) {
+  if (v < (2u << BITS_PRECISION))
+    return v;
+  unsigned e = 63 - __builtin_clzll(v) - BITS_PRECISION;
+  unsigned i = (e << BITS_PRECISION) + (v >> e);
+  return (i < NB_CASES) ? i : NB_CASES - 1;
+}
+
+/**
+ * @brief Donne la plus grande durée comptée dans une case.
+ *
+ * @param i la case
+ * @return uint64_t la durée
+ */
+static uint64_t finCase(unsigned i) {
+  if (i < (2u << BITS_PRECISION))
+    return i;
+  unsigned e = (i >> BITS_PRECISION) - 1;
+  uint64_t m = i - ((uint64_t)e << BITS_PRECISION);
+  return ((m + 1) << e) - 1;
+}
+
+/**
+ * @brief Crée un histogramme vide.
+ *
+ * @return Histogramme* l'histogramme, NULL en cas de problème d'allocation
+ */
+Histogramme *makeHistogramme() {
+  Histogramme *h = calloc(1, sizeof(Histogramme));
+  if (!h)
+    perror("Problème d'allocation dans makeHistogramme.");
+  return h;
+}
+
+/**
+ * @brief Ajoute une mesure à un histogramme.
+ *
+ * @param h l'histogramme
+ * @param v la durée
+ */
+void ajouterHistogramme(Histogramme *h, uint64_t v) {
+  assert(h);
+  h->cases[indiceCase(v)]++;
+  h->nb++;
+  if (v > h->max)
+    h->max = v;
+}
+
+/**
+ * @brief Donne le nombre de mesures d'un histogramme.
+ *
+ * @param h l'histogramme
+ * @return unsigned long long le nombre de mesures
+ */
+unsigned long long nbHistogramme(Histogramme *h) {
+  assert(h);
+  return h->nb;
+}
+
+/**
+ * @brief Donne un percentile d'un histogramme : la durée en dessous de
+ * laquelle se trouvent p % des mesures (arrondie à la fin de sa case).
+ *
+ * @param h l'histogramme
+ * @param p le percentile, entre 0 et 100 (100 donne le maximum exact)
+ * @return uint64_t la durée, 0 si l'histogramme est vide
+ */
+uint64_t percentileHistogramme(Histogramme *h, double p) {
+  assert(h);
+  assert(p >= 0 && p <= 100);
+  if (h->nb == 0)
+    return 0;
+  unsigned long long rang = (unsigned long long)(p / 100 * h->nb + 0.5);
+  if (rang == 0)
+    rang = 1;
+  unsigned long long cumul = 0;
+  for (unsigned i = 0; i < NB_CASES; i++) {
+    cumul += h->cases[i];
+    if (cumul >= rang)
+      return (finCase(i) < h->max) ? finCase(i) : h->max;
+  }
+  return h->max;
+}
+
+/**
+ * @brief Ajoute toutes les mesures d'un histogramme à un autre.
+ *
+ * @param h l'histogramme qui reçoit les mesures
+ * @param autre l'histogramme ajouté
+ */
+void fusionnerHistogramme(Histogramme *h, Histogramme *autre) {
+  assert(h && autre);
+  for (unsigned i = 0; i < NB_CASES; i++)
+    h->cases[i] += autre->cases[i];
+  h->nb += autre->nb;
+  if (autre->max > h->max)
+    h->max = autre->max;
+}
+
+/**
+ * @brief Supprime un histogramme.
+ *
+ * @param h l'histogramme
+ */
+void destroyHistogramme(Histogramme *h) { free(h); }
+
+/**
+ * @brief Marque le début d'un coup d'une IA.
+ *
+ * @return uint64_t l'instant du début en nanosecondes (voir maintenant)
+ */
+uint64_t debutLatence() { return maintenant(); }
+
+/**
+ * @brief Enregistre la durée d'un coup d'une IA.
+ *
+ * @param profondeur la profondeur de l'IA (son niveau)
+ * @param coup le nombre de jetons sur le plateau avant le coup
+ * @param debut l'instant du début, donné par debutLatence
+ */
+void finLatence(unsigned profondeur, unsigned coup, uint64_t debut) {
+  uint64_t duree = debutLatence() - debut;
+  if (profondeur >= NB_PROFONDEURS)
+    profondeur = NB_PROFONDEURS - 1;
+  unsigned phase = coup / TRANCHE_COUPS;
+  assert(phase < NB_PHASES);
+  if (!latences[profondeur][phase])
+    latences[profondeur][phase] = makeHistogramme();
+  if (latences[profondeur][phase])
+    ajouterHistogramme(latences[profondeur][phase], duree / 1000);
+}
+
+/**
+ * @brief Donne l'histogramme des durées des coups (en microsecondes) d'une
+ * profondeur dans une phase de la partie.
+ *
+ * @param profondeur la profondeur de l'IA
+ * @param phase la phase (les coups de phase * TRANCHE_COUPS à
+ * (phase + 1) * TRANCHE_COUPS - 1)
+ * @return Histogramme* l'histogramme, NULL si aucun coup n'a été mesuré
+ */
+Histogramme *histogrammeLatence(unsigned profondeur, unsigned phase) {
+  assert(profondeur < NB_PROFONDEURS);
+  assert(phase < NB_PHASES);
+  return latences[profondeur][phase];
+}
+
+/**
+ * @brief Affiche une ligne du rapport des latences.
+ *
+ * @param f le fichier où écrire
+ * @param profondeur la profondeur de l'IA
+ * @param phase la description de la phase
+ * @param h l'histogramme
+ */
+static void afficherLigne(FILE *f, unsigned profondeur, const char *phase,
+                          Histogramme *h) {
+  fprintf(f, "%10u  %-7s %7llu %9.2f %9.2f %9.2f %9.2f\n", profondeur, phase,
+          h->nb, percentileHistogramme(h, 50) / 1e3,
+          percentileHistogramme(h, 90) / 1e3,
+          percentileHistogramme(h, 99) / 1e3, h->max / 1e3);
+}
+
+/**
+ * @brief Affiche le rapport des latences des coups des IA : p50, p90, p99 et
+ * maximum en millisecondes, par profondeur et par phase de la partie, puis
+ * pour toute la partie.
+ *
+ * @param f le fichier où écrire
+ */
+void afficherLatences(FILE *f) {
+  fprintf(f, "Latence des coups des IA (ms)\n"
+             "profondeur  coups      nombre       p50       p90       p99"
+             "       max\n");
+  for (unsigned p = 0; p < NB_PROFONDEURS; p++) {
+    Histogramme total = {{0}, 0, 0};
+    for (unsigned ph = 0; ph < NB_PHASES; ph++) {
+      if (!latences[p][ph])
+        continue;
+      char phase[16];
+      unsigned fin = (ph + 1) * TRANCHE_COUPS;
+      if (fin > NB_LIGNE * NB_COLONNE)
+        fin = NB_LIGNE * NB_COLONNE;
+      snprintf(phase, sizeof(phase), "%u-%u", ph * TRANCHE_COUPS + 1, fin);
+      afficherLigne(f, p, phase, latences[p][ph]);
+      fusionnerHistogramme(&total, latences[p][ph]);
+    }
+    if (total.nb)
+      afficherLigne(f, p, "tous", &total);
+  }
+}
+
+/**
+ * @brief Supprime toutes les mesures des coups des IA.
+ */
+void viderLatences() {
+  for (unsigned p = 0; p < NB_PROFONDEURS; p++)
+    for (unsigned ph = 0; ph < NB_PHASES; ph++) {
+      destroyHistogramme(latences[p][ph]);
+      latences[p][ph] = NULL;
+    }
+}
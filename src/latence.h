@@ -0,0 +1,62 @@
+/**
+ * @file latence.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des histogrammes de latence des coups des IA.
+ * @version 0.1
+ * @date 2023-02-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef LATENCE_H
+/**
+ * @def LATENCE_H
+ * @brief la garde
+ */
+#define LATENCE_H
+
+#include "puissance_quatre.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @def TRANCHE_COUPS
+ * @brief le nombre de coups de chaque phase de la partie
+ */
+/**
+ * @def NB_PHASES
+ * @brief le nombre de phases de la partie
+ */
+/**
+ * @def NB_PROFONDEURS
+ * @brief les profondeurs (niveaux des IA) dont la latence est mesurée vont de
+ * 0 à NB_PROFONDEURS - 1
+ */
+#define TRANCHE_COUPS 10
+#define NB_PHASES                                                              \
+  ((NB_LIGNE_MAX * NB_COLONNE_MAX + TRANCHE_COUPS - 1) / TRANCHE_COUPS)
+#define NB_PROFONDEURS 16
+
+/**
+ * @typedef Histogramme
+ * @brief Renommer histogramme_ (structure opaque).
+ */
+typedef struct histogramme_ Histogramme;
+
+Histogramme *makeHistogramme();
+void ajouterHistogramme(Histogramme *, uint64_t);
+unsigned long long nbHistogramme(Histogramme *);
+uint64_t percentileHistogramme(Histogramme *, double);
+void fusionnerHistogramme(Histogramme *, Histogramme *);
+void destroyHistogramme(Histogramme *);
+
+uint64_t debutLatence();
+void finLatence(unsigned, unsigned, uint64_t);
+Histogramme *histogrammeLatence(unsigned, unsigned);
+void afficherLatences(FILE *);
+void viderLatences();
+
+#endif
@@ -0,0 +1,289 @@
+/**
+ * @file lot.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Lots de parties : les règles de puissance_quatre.c appliquées à
+ * toutes les parties d'un lot à la fois. Les boucles sur les parties sont sans
+ * branchement selon les données, pour que le compilateur les traite plusieurs
+ * parties par instruction (voir VECTORISE).
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "lot.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "puissance_quatre.h"
+
+/**
+ * @def BLOC
+ * @brief le nombre de parties traitées ensemble, étape par étape, par
+ * gagnantsLot et coupsLegauxLot
+ */
+#define BLOC 64
+
+/**
+ * @def ALIGNEMENT
+ * @brief l'alignement des tableaux d'un lot en octets (une ligne de cache)
+ */
+#define ALIGNEMENT 64
+
+/**
+ * @brief Compte les bits à 1 d'un mot par additions et décalages : sans
+ * instruction dédiée, le compilateur peut le faire pour plusieurs mots à la
+ * fois.
+ *
+ * @param x le mot
+ * @return uint64_t le nombre de bits à 1
+ */
+OPERATION uint64_t compter(uint64_t x) {
+  x -= (x >> 1) & 0x5555555555555555ULL;
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  x += x >> 8;
+  x += x >> 16;
+  x += x >> 32;
+  return x & 0x7F;
+}
+
+/**
+ * @brief Donne les cases d'une ligne du plateau, sur un mot.
+ *
+ * @param ligne le numéro de ligne (0 en haut)
+ * @return uint64_t un bit par colonne
+ */
+static uint64_t masqueLigne(unsigned ligne) {
+  uint64_t m = 0;
+  for (unsigned c = 0; c < NB_COLONNE; c++)
+    m |= (uint64_t)1 << bitCase(ligne, c, NB_LIGNE);
+  return m;
+}
+
+/**
+ * @brief Crée un lot de parties vides.
+ *
+ * @param nb le nombre de parties
+ * @return Lot* le lot, NULL si le plateau ne tient pas sur un mot ou en cas
+ * de problème d'allocation
+ */
+Lot *makeLot(unsigned nb) {
+  assert(nb > 0);
+  if (MOTS_UTILES(NB_LIGNE, NB_COLONNE) > 1) {
+    fprintf(stderr, "Lot impossible : le plateau %ux%u ne tient pas sur 64 "
+                    "bits.\n",
+            NB_LIGNE, NB_COLONNE);
+    return NULL;
+  }
+  Lot *lot = malloc(sizeof(Lot));
+  if (!lot) {
+    perror("Problème d'allocation dans makeLot.");
+    return NULL;
+  }
+  size_t taille = ((size_t)nb * sizeof(uint64_t) + ALIGNEMENT - 1) /
+                  ALIGNEMENT * ALIGNEMENT;
+  lot->nb = nb;
+  lot->joueur = aligned_alloc(ALIGNEMENT, taille);
+  lot->occupees = aligned_alloc(ALIGNEMENT, taille);
+  if (!lot->joueur || !lot->occupees) {
+    perror("Problème d'allocation dans makeLot.");
+    destroyLot(lot);
+    return NULL;
+  }
+  viderLot(lot);
+  return lot;
+}
+
+/**
+ * @brief Recommence toutes les parties d'un lot : plateaux vides, J1 au trait.
+ *
+ * @param lot le lot
+ */
+void viderLot(Lot *lot) {
+  assert(lot);
+  memset(lot->joueur, 0, lot->nb * sizeof(uint64_t));
+  memset(lot->occupees, 0, lot->nb * sizeof(uint64_t));
+}
+
+/**
+ * @brief Remplace une partie d'un lot par la position d'un jeu (par exemple
+ * une ouverture) : game->courant y est le joueur au trait, comme dans minimax.
+ *
+ * @param lot le lot
+ * @param i l'indice de la partie dans le lot
+ * @param game le jeu, aux règles standard, où J1 a commencé
+ */
+void placerLot(Lot *lot, unsigned i, Puissance4 *game) {
+  assert(lot && game && game->courant);
+  assert(i < lot->nb);
+  assert(MOTS_UTILES(NB_LIGNE, NB_COLONNE) == 1);
+  assert((game->courant->type == J1) == (game->nb_jetons % 2 == 0));
+  lot->joueur[i] = game->pions[game->courant->type - 1].mots[0];
+  lot->occupees[i] = game->pions[0].mots[0] | game->pions[1].mots[0];
+}
+
+/**
+ * @brief Joue un coup dans chaque partie d'un lot : le jeton tombe dans la
+ * colonne, puis l'adversaire est au trait. L'addition du bas de la colonne
+ * aux jetons fait apparaître la première case libre, comme ligneLibre.
+ *
+ * @param lot le lot
+ * @param coups la colonne jouée dans chaque partie, qui doit être possible
+ * (voir coupsLegauxLot), ou COUP_PASSE pour laisser la partie telle quelle
+ */
+VECTORISE void jouerLot(Lot *lot, const uint8_t *coups) {
+  assert(lot && coups);
+  const unsigned L = NB_LIGNE, C = NB_COLONNE;
+  uint64_t *restrict joueur = lot->joueur, *restrict occupees = lot->occupees;
+  for (unsigned i = 0; i < lot->nb; i++) {
+    uint64_t joue = -(uint64_t)(coups[i] < C);
+    unsigned colonne = coups[i] < C ? coups[i] : 0;
+    uint64_t bas = ((uint64_t)1 << (colonne * (L + 1))) & joue;
+    joueur[i] ^= occupees[i] & joue; // les jetons de l'adversaire
+    occupees[i] |= occupees[i] + bas;
+  }
+}
+
+/**
+ * @brief Cherche dans chaque partie d'un lot un alignement du joueur qui vient
+ * de jouer, comme bbAligne : les étapes de la recherche sont faites pour
+ * BLOC parties à la fois.
+ *
+ * @param lot le lot
+ * @param gagnants pour chaque partie, 1 si le joueur qui vient de jouer a
+ * aligné NB_ALIGNE jetons, 0 sinon
+ */
+VECTORISE void gagnantsLot(const Lot *lot, uint8_t *gagnants) {
+  assert(lot && gagnants);
+  const unsigned L = NB_LIGNE, A = NB_ALIGNE;
+  const unsigned directions[4] = DIRECTIONS(L);
+  for (unsigned debut = 0; debut < lot->nb; debut += BLOC) {
+    unsigned nb = lot->nb - debut < BLOC ? lot->nb - debut : BLOC;
+    const uint64_t *restrict joueur = lot->joueur + debut;
+    const uint64_t *restrict occupees = lot->occupees + debut;
+    uint64_t precedent[BLOC], m[BLOC], aligne[BLOC];
+    for (unsigned j = 0; j < nb; j++) {
+      precedent[j] = joueur[j] ^ occupees[j];
+      aligne[j] = 0;
+    }
+    for (unsigned i = 0; i < 4; i++) {
+      unsigned d = directions[i], k = 1; // m commence k cases alignées
+      for (unsigned j = 0; j < nb; j++)
+        m[j] = precedent[j];
+      for (; 2 * k <= A; k *= 2)
+        for (unsigned j = 0; j < nb; j++)
+          m[j] &= m[j] >> (k * d);
+      if (k < A)
+        for (unsigned j = 0; j < nb; j++)
+          m[j] &= m[j] >> ((A - k) * d);
+      for (unsigned j = 0; j < nb; j++)
+        aligne[j] |= m[j];
+    }
+    for (unsigned j = 0; j < nb; j++)
+      gagnants[debut + j] = aligne[j] != 0;
+  }
+}
+
+/**
+ * @brief Donne les coups possibles de chaque partie d'un lot : les colonnes
+ * dont la case du haut est libre.
+ *
+ * @param lot le lot
+ * @param coups pour chaque partie, le bit c à 1 si la colonne c n'est pas
+ * pleine (0 quand le plateau est plein)
+ */
+VECTORISE void coupsLegauxLot(const Lot *lot, uint32_t *coups) {
+  assert(lot && coups);
+  const unsigned L = NB_LIGNE, C = NB_COLONNE;
+  const uint64_t hauts = masqueLigne(0);
+  for (unsigned debut = 0; debut < lot->nb; debut += BLOC) {
+    unsigned nb = lot->nb - debut < BLOC ? lot->nb - debut : BLOC;
+    const uint64_t *restrict occupees = lot->occupees + debut;
+    uint64_t libres[BLOC], masque[BLOC];
+    for (unsigned j = 0; j < nb; j++) {
+      libres[j] = ~occupees[j] & hauts;
+      masque[j] = 0;
+    }
+    for (unsigned c = 0; c < C; c++) {
+      unsigned s = bitCase(0, c, L);
+      for (unsigned j = 0; j < nb; j++)
+        masque[j] |= (libres[j] >> s & 1) << c;
+    }
+    for (unsigned j = 0; j < nb; j++)
+      coups[debut + j] = (uint32_t)masque[j];
+  }
+}
+
+/**
+ * @brief Compte les voisins des jetons d'un joueur dans une direction, comme
+ * voisinsDirection dans ia.c.
+ *
+ * @param joueur les jetons du joueur
+ * @param libres les cases libres
+ * @param d le décalage d'une case à la suivante dans la direction
+ * @return uint64_t 4 par paire de jetons, 1 par jeton à côté d'une case libre
+ */
+OPERATION uint64_t voisins(uint64_t joueur, uint64_t libres, unsigned d) {
+  uint64_t apres = joueur >> d;
+  return 4 * compter(apres & joueur) + compter(apres & libres) +
+         compter(libres >> d & joueur);
+}
+
+/**
+ * @brief Compte les voisins des jetons d'un joueur dans les quatre directions
+ * (le score de scoreBitboard dans ia.c).
+ *
+ * @param joueur les jetons du joueur
+ * @param libres les cases libres
+ * @param L le nombre de lignes du plateau
+ * @return uint64_t le score du joueur
+ */
+OPERATION uint64_t scoreLot(uint64_t joueur, uint64_t libres, unsigned L) {
+  return voisins(joueur, libres, 1)        // vertical
+         + voisins(joueur, libres, L + 1)  // horizontal
+         + voisins(joueur, libres, L)      // diagonal
+         + voisins(joueur, libres, L + 2); // diagonal
+}
+
+/**
+ * @brief Évalue chaque partie d'un lot comme evaluation dans ia.c : le score
+ * du joueur qui vient de jouer moins celui du joueur au trait.
+ *
+ * @param lot le lot
+ * @param scores l'évaluation de chaque partie
+ */
+VECTORISE void evaluerLot(const Lot *lot, int *scores) {
+  assert(lot && scores);
+  const unsigned L = NB_LIGNE;
+  const uint64_t cases = geometrie.cases.mots[0];
+  const uint64_t *restrict joueur = lot->joueur;
+  const uint64_t *restrict occupees = lot->occupees;
+  const unsigned nb = lot->nb; // scores pourrait sinon modifier lot->nb
+  for (unsigned i = 0; i < nb; i++) {
+    uint64_t libres = cases & ~occupees[i];
+    uint64_t precedent = joueur[i] ^ occupees[i];
+    scores[i] = (int)scoreLot(precedent, libres, L) -
+                (int)scoreLot(joueur[i], libres, L);
+  }
+}
+
+/**
+ * @brief Détruit un lot.
+ *
+ * @param lot le lot (NULL accepté)
+ */
+void destroyLot(Lot *lot) {
+  if (!lot)
+    return;
+  free(lot->joueur);
+  free(lot->occupees);
+  free(lot);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file lot.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des lots de parties : de nombreuses parties avancées
+ * ensemble (pour produire des parties d'entraînement), rangées en tableaux de
+ * bitboards, chaque opération traitant toutes les parties du lot à la fois.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef LOT_H
+/**
+ * @def LOT_H
+ * @brief la garde
+ */
+#define LOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "puissance_quatre.h"
+
+/**
+ * @def COUP_PASSE
+ * @brief le coup qui laisse une partie du lot telle quelle (partie finie)
+ */
+#define COUP_PASSE UINT8_MAX
+
+/**
+ * @struct lot_
+ * @brief Des parties aux règles standard sur le plateau de geometrie, qui doit
+ * tenir sur un mot de bitboard ((lignes + 1) x colonnes <= 64). Chaque partie
+ * est codée par deux mots rangés dans deux tableaux : les jetons du joueur au
+ * trait et ceux des deux joueurs (voir bitboard.h). J1 commence : le joueur
+ * au trait est J1 quand le nombre de jetons est pair.
+ * @typedef Lot
+ * @brief Renommer lot_.
+ */
+typedef struct lot_ {
+  unsigned nb;        //!< Nombre de parties
+  uint64_t *joueur;   //!< Jetons du joueur au trait, une case par partie
+  uint64_t *occupees; //!< Jetons des deux joueurs, une case par partie
+} Lot;
+
+Lot *makeLot(unsigned);
+void viderLot(Lot *);
+void placerLot(Lot *, unsigned, Puissance4 *);
+void jouerLot(Lot *, const uint8_t *);
+void gagnantsLot(const Lot *, uint8_t *);
+void coupsLegauxLot(const Lot *, uint32_t *);
+void evaluerLot(const Lot *, int *);
+void destroyLot(Lot *);
+
+#endif
@@ -14,11 +14,104 @@
 #include "console.h"
 #include "graphique.h"
 #include "ia.h"
+#include "latence.h"
+#include "memoire.h"
 #include "puissance_quatre.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+/**
+ * @def VARIABLE_JOURNAL
+ * @brief la variable d'environnement donnant le fichier où journaliser les
+ * recherches des IA
+ */
+#define VARIABLE_JOURNAL "PUISSANCE4_JOURNAL"
+
+/**
+ * @def VARIABLE_TRACE
+ * @brief la variable d'environnement donnant le fichier où écrire la trace
+ * (format Chrome) des recherches et des affichages
+ */
+#define VARIABLE_TRACE "PUISSANCE4_TRACE"
+
+/**
+ * @def VARIABLE_LATENCES
+ * @brief la variable d'environnement qui, si elle est définie, fait afficher à
+ * la fin du programme la latence des coups des IA
+ */
+#define VARIABLE_LATENCES "PUISSANCE4_LATENCES"
+
+/**
+ * @def VARIABLE_TABLE
+ * @brief la variable d'environnement donnant la table des finales consultée
+ * par les IA (voir make tablebase)
+ */
+#define VARIABLE_TABLE "PUISSANCE4_TABLE"
+
+/**
+ * @def VARIABLE_TRANSPOSITION
+ * @brief la variable d'environnement donnant la taille en Mo de la table de
+ * transposition des IA
+ */
+#define VARIABLE_TRANSPOSITION "PUISSANCE4_TRANSPOSITION"
+
+/**
+ * @def VARIABLE_ARCHIVE
+ * @brief la variable d'environnement donnant l'archive où les IA gardent le
+ * résultat de leurs recherches d'une partie à l'autre
+ */
+#define VARIABLE_ARCHIVE "PUISSANCE4_ARCHIVE"
+
+/**
+ * @def VARIABLE_PAGES_NORMALES
+ * @brief la variable d'environnement qui, si elle est définie, interdit les
+ * pages énormes pour les tables des IA
+ */
+#define VARIABLE_PAGES_NORMALES "PUISSANCE4_PAGES_NORMALES"
+
+/**
+ * @def VARIABLE_PARTAGE
+ * @brief la variable d'environnement donnant le nom ("/nom") de la table de
+ * transposition partagée par les processus de la machine
+ */
+#define VARIABLE_PARTAGE "PUISSANCE4_PARTAGE"
+
+/**
+ * @def VARIABLE_PLATEAU
+ * @brief la variable d'environnement donnant la géométrie des parties :
+ * "lignesxcolonnesxalignés", par exemple "7x9x4" (6x7x4 par défaut)
+ */
+#define VARIABLE_PLATEAU "PUISSANCE4_PLATEAU"
+
+/**
+ * @def VARIABLE_RESEAU
+ * @brief la variable d'environnement donnant le fichier des poids du réseau
+ * qui remplace l'heuristique des IA (fait pour le plateau des parties)
+ */
+#define VARIABLE_RESEAU "PUISSANCE4_RESEAU"
+
+/**
+ * @def VARIABLE_VOISINAGE
+ * @brief la variable d'environnement donnant la distance maximale, en
+ * colonnes, des coups étudiés par les IA aux jetons déjà joués (toutes les
+ * colonnes par défaut), pour les grands plateaux
+ */
+#define VARIABLE_VOISINAGE "PUISSANCE4_VOISINAGE"
+
+/**
+ * @brief Libère ce qui a été alloué pour les IA et les mesures, en affichant
+ * si demandé la latence des coups des IA.
+ */
+static void terminer() {
+  cleanIA();
+  terminerTrace();
+  if (getenv(VARIABLE_LATENCES))
+    afficherLatences(stdout);
+  viderLatences();
+}
+
 /**
  * @brief Fonction principale du jeu du puissance 4.
  *
@@ -26,22 +119,56 @@
  * problème
  */
 int main() {
-  char interface, mode, niveau, niveau2;
+  char interface, mode, regle, niveau, niveau2, indices = 'n';
   printf("\e[1;1H\e[2J");
   printf("PUISSANCE QUATRE\n");
 
   choix_interface(&interface);
   choix_mode(&mode);
+  choix_regle(&regle);
   if (mode == 'i' || mode == 'a') {
     choix_niveau(&niveau);
   } else if (mode == 's') {
     choix_niveaux(&niveau, &niveau2);
   }
+  if (mode != 's')
+    choix_indices(&indices);
 
   userInterface *ui = NULL;
   Puissance4 *game = initPuissance4();
   if (!game)
     goto Quitter;
+  game->indices = (indices == 'o');
+  game->regle = (regle == 'p') ? POP_OUT : STANDARD;
+  if (getenv(VARIABLE_PLATEAU)) { // avant tout ce qui dépend du plateau
+    unsigned lignes, colonnes, aligne;
+    if (sscanf(getenv(VARIABLE_PLATEAU), "%ux%ux%u", &lignes, &colonnes,
+               &aligne) != 3 ||
+        !definirGeometrie(lignes, colonnes, aligne)) {
+      fprintf(stderr, "%s invalide : %s\n", VARIABLE_PLATEAU,
+              getenv(VARIABLE_PLATEAU));
+      goto Quitter;
+    }
+  }
+  if (getenv(VARIABLE_VOISINAGE) && atoi(getenv(VARIABLE_VOISINAGE)) > 0)
+    definirVoisinageIA(atoi(getenv(VARIABLE_VOISINAGE)));
+  if (getenv(VARIABLE_JOURNAL))
+    journaliserIA(getenv(VARIABLE_JOURNAL)); // on joue même sans journal
+  if (getenv(VARIABLE_TRACE))
+    demarrerTrace(getenv(VARIABLE_TRACE));
+  if (getenv(VARIABLE_TABLE))
+    chargerTableIA(getenv(VARIABLE_TABLE)); // les IA jouent aussi sans
+  if (getenv(VARIABLE_PAGES_NORMALES))
+    autoriserPagesEnormes(false);
+  if (getenv(VARIABLE_TRANSPOSITION) &&
+      atol(getenv(VARIABLE_TRANSPOSITION)) > 0)
+    dimensionnerTableIA(atol(getenv(VARIABLE_TRANSPOSITION)));
+  if (getenv(VARIABLE_PARTAGE))
+    partagerTableIA(getenv(VARIABLE_PARTAGE));
+  if (getenv(VARIABLE_ARCHIVE))
+    chargerArchiveIA(getenv(VARIABLE_ARCHIVE)); // les IA jouent aussi sans
+  if (getenv(VARIABLE_RESEAU))
+    chargerReseauIA(getenv(VARIABLE_RESEAU)); // sinon, l'heuristique
 
   if (interface == 'c') {
     ui = makeConsole();
@@ -91,15 +218,18 @@ int main() {
   }
   if (!game->j1 || !game->j2)
     goto Quitter;
+  afficherMemoireIA(stderr);
 
   launchGame(game, ui);
   if (game->rageQuit)
     goto Quitter;
 
+  terminer(); // avant clean : la réflexion des IA lit encore les joueurs
   clean(game, ui);
   return EXIT_SUCCESS;
 
 Quitter:
+  terminer();
   clean(game, ui);
   return EXIT_FAILURE;
 }
\ No newline at end of file
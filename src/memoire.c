@@ -0,0 +1,349 @@
+/**
+ * @file memoire.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Allocation des grandes tables.
+ *
+ * Une table de plusieurs Go consultée au hasard rate presque à chaque accès
+ * le TLB (le cache des traductions d'adresses) quand elle est faite de pages
+ * de 4 Ko ; avec des pages de 2 Mo, 512 fois moins de traductions suffisent.
+ * L'allocation essaie donc, dans l'ordre : les pages énormes réservées par
+ * l'administrateur (MAP_HUGETLB, voir /proc/sys/vm/nr_hugepages), les pages
+ * énormes transparentes (madvise MADV_HUGEPAGE, si le noyau les autorise),
+ * et se contente sinon de pages normales.
+ *
+ * Le noyau place une page sur le nœud NUMA du processeur qui l'écrit le
+ * premier : la table est donc mise à zéro par plusieurs threads, répartis sur
+ * les processeurs, pour que ses pages soient réparties sur tous les nœuds
+ * plutôt qu'entassées sur celui du thread qui l'a créée.
+ *
+ * Une table peut aussi être partagée entre processus : elle est alors un
+ * segment de mémoire partagée POSIX nommé (shm_open), créé par le premier
+ * processus qui le demande et projeté tel quel par les suivants.
+ * @version 0.1
+ * @date 2023-03-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#define _GNU_SOURCE // pthread_setaffinity_np
+
+#include "memoire.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @def TAILLE_PAGE_ENORME
+ * @brief la taille d'une page énorme, en octets
+ */
+#define TAILLE_PAGE_ENORME (2UL << 20)
+
+/**
+ * @def TRANCHE_MIN
+ * @brief la plus petite part de la table mise à zéro par un thread, en octets
+ * (en dessous, créer un thread coûte plus qu'il ne rapporte)
+ */
+#define TRANCHE_MIN (32UL << 20)
+
+/**
+ * @def ATTENTE_MAX
+ * @brief le nombre maximal d'attentes de 1 ms pendant que le créateur d'un
+ * segment partagé lui donne sa taille
+ */
+#define ATTENTE_MAX 1000
+
+/**
+ * @brief true si les pages énormes peuvent être demandées.
+ */
+static bool enormes = true;
+
+/**
+ * @struct tranche_
+ * @brief La part de la table mise à zéro par un thread.
+ * @typedef Tranche
+ * @brief Renommer tranche_.
+ */
+typedef struct tranche_ {
+  char *debut;      //!< Le premier octet
+  size_t taille;    //!< Le nombre d'octets
+  unsigned cpu;     //!< Le processeur où mettre le thread
+  pthread_t thread; //!< Le thread
+} Tranche;
+
+/**
+ * @brief Autorise ou interdit les pages énormes pour les tables allouées
+ * ensuite (pour comparer, ou si le système les gère mal).
+ *
+ * @param autoriser false pour n'allouer que des pages normales
+ */
+void autoriserPagesEnormes(bool autoriser) { enormes = autoriser; }
+
+/**
+ * @brief Donne le nombre de threads à qui confier la mise à zéro d'une table :
+ * un par processeur en ligne.
+ *
+ * @return unsigned le nombre de threads (au moins 1)
+ */
+unsigned threadsPages() {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return (n > 0) ? n : 1;
+}
+
+/**
+ * @brief Calcule la taille réellement projetée pour une table : les tables
+ * d'au moins une page énorme sont arrondies à un nombre entier de pages
+ * énormes.
+ *
+ * @param taille la taille demandée, en octets
+ * @return size_t la taille projetée
+ */
+static size_t arrondir(size_t taille) {
+  if (taille < TAILLE_PAGE_ENORME)
+    return taille;
+  return (taille + TAILLE_PAGE_ENORME - 1) & ~(TAILLE_PAGE_ENORME - 1);
+}
+
+/**
+ * @brief Indique si le noyau donne des pages énormes transparentes à qui les
+ * demande (madvise réussit même quand elles sont désactivées).
+ *
+ * @param reglage le fichier du réglage (mémoire anonyme ou partagée)
+ * @return true si elles ne sont pas désactivées
+ * @return false sinon
+ */
+static bool transparentesActives(const char *reglage) {
+  FILE *f = fopen(reglage, "r");
+  if (!f)
+    return false;
+  char ligne[128] = "";
+  bool actives = fgets(ligne, sizeof(ligne), f) &&
+                 !strstr(ligne, "[never]") && !strstr(ligne, "[deny]");
+  fclose(f);
+  return actives;
+}
+
+/**
+ * @brief Projette des pages normales alignées sur une page énorme, condition
+ * pour que le noyau puisse les remplacer par des pages énormes transparentes.
+ *
+ * @param taille la taille, multiple de TAILLE_PAGE_ENORME
+ * @return void* les pages, MAP_FAILED en cas d'échec
+ */
+static void *projeterAligne(size_t taille) {
+  char *p = mmap(NULL, taille + TAILLE_PAGE_ENORME, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    return MAP_FAILED;
+  size_t avant = -(uintptr_t)p & (TAILLE_PAGE_ENORME - 1);
+  if (avant)
+    munmap(p, avant);
+  munmap(p + avant + taille, TAILLE_PAGE_ENORME - avant);
+  return p + avant;
+}
+
+/**
+ * @brief Met à zéro une tranche, depuis un thread placé sur son processeur.
+ *
+ * @param arg la tranche (Tranche *)
+ * @return void* NULL
+ */
+static void *effacerTranche(void *arg) {
+  Tranche *t = arg;
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(t->cpu, &cpus);
+  // sans placement, les pages vont où le système a mis le thread
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  memset(t->debut, 0, t->taille);
+  return NULL;
+}
+
+/**
+ * @brief Met à zéro une table en la partageant entre plusieurs threads,
+ * placés chacun sur un processeur : à la première écriture, chaque page est
+ * placée sur le nœud NUMA du thread qui l'écrit. Une table trop petite, ou un
+ * thread qui ne peut être créé, est mis à zéro par le thread appelant.
+ *
+ * @param debut la table
+ * @param taille sa taille, en octets
+ * @param nbThreads le nombre de threads souhaité (voir threadsPages)
+ */
+void effacerPages(void *debut, size_t taille, unsigned nbThreads) {
+  if (nbThreads > taille / TRANCHE_MIN)
+    nbThreads = taille / TRANCHE_MIN;
+  if (nbThreads <= 1) {
+    memset(debut, 0, taille);
+    return;
+  }
+  Tranche tranches[nbThreads];
+  size_t part = (taille / nbThreads) & ~(size_t)(TAILLE_PAGE_ENORME - 1);
+  unsigned nbCpus = threadsPages();
+  for (unsigned i = 0; i < nbThreads; i++) {
+    tranches[i].debut = (char *)debut + i * part;
+    tranches[i].taille = (i == nbThreads - 1) ? taille - i * part : part;
+    tranches[i].cpu = i % nbCpus;
+    if (pthread_create(&tranches[i].thread, NULL, &effacerTranche,
+                       &tranches[i]) != 0) {
+      // celle-ci et les suivantes sont faites ici
+      memset(tranches[i].debut, 0, taille - i * part);
+      nbThreads = i;
+    }
+  }
+  for (unsigned i = 0; i < nbThreads; i++)
+    pthread_join(tranches[i].thread, NULL);
+}
+
+/**
+ * @brief Alloue une grande table mise à zéro, avec les meilleures pages
+ * disponibles (voir le début du fichier). L'échec des pages énormes n'est pas
+ * une erreur : on passe simplement au mode suivant.
+ *
+ * @param taille la taille, en octets (au moins 1)
+ * @param nbThreads le nombre de threads qui mettent la table à zéro
+ * @param mode le mode obtenu, renseigné en cas de succès (peut être NULL)
+ * @return void* la table, alignée sur 64 octets, NULL en cas de problème
+ * d'allocation
+ */
+void *allouerPages(size_t taille, unsigned nbThreads, ModePages *mode) {
+  size_t projetee = arrondir(taille);
+  void *p = MAP_FAILED;
+  ModePages obtenu = PAGES_NORMALES;
+  if (enormes && projetee >= TAILLE_PAGE_ENORME) {
+    p = mmap(NULL, projetee, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    obtenu = PAGES_ENORMES;
+    if (p == MAP_FAILED) { // aucune page réservée : pages transparentes ?
+      p = projeterAligne(projetee);
+      obtenu = (p != MAP_FAILED &&
+                transparentesActives(
+                    "/sys/kernel/mm/transparent_hugepage/enabled") &&
+                madvise(p, projetee, MADV_HUGEPAGE) == 0)
+                   ? PAGES_TRANSPARENTES
+                   : PAGES_NORMALES;
+    }
+  }
+  if (p == MAP_FAILED) {
+    p = mmap(NULL, projetee, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    obtenu = PAGES_NORMALES;
+  }
+  if (p == MAP_FAILED) {
+    perror("Problème d'allocation dans allouerPages.");
+    return NULL;
+  }
+  // les pages projetées sont déjà nulles, mais pas encore placées
+  effacerPages(p, projetee, nbThreads);
+  if (mode)
+    *mode = obtenu;
+  return p;
+}
+
+/**
+ * @brief Projette un segment de mémoire partagée nommé, créé mis à zéro s'il
+ * n'existe pas encore. Un segment existant garde sa taille : celle du
+ * créateur, que l'on attend s'il ne l'a pas encore fixée.
+ *
+ * @param nom le nom du segment ("/nom", voir shm_open)
+ * @param taille la taille souhaitée en octets, remplacée par celle du segment
+ * @param creee renseigné à true si le segment vient d'être créé
+ * @param mode les pages obtenues, renseignées en cas de succès (peut être
+ * NULL)
+ * @return void* le segment, aligné sur une page, NULL en cas de problème
+ */
+void *projeterPagesPartagees(const char *nom, size_t *taille, bool *creee,
+                             ModePages *mode) {
+  int fd = shm_open(nom, O_RDWR | O_CREAT | O_EXCL, 0600);
+  *creee = (fd != -1);
+  if (*creee) {
+    *taille = arrondir(*taille);
+    if (ftruncate(fd, *taille) == -1) {
+      perror("Problème de dimensionnement dans projeterPagesPartagees.");
+      close(fd);
+      shm_unlink(nom);
+      return NULL;
+    }
+  } else if (errno == EEXIST && (fd = shm_open(nom, O_RDWR, 0)) != -1) {
+    struct stat s = {0};
+    for (int i = 0; fstat(fd, &s) == 0 && s.st_size == 0 && i < ATTENTE_MAX;
+         i++)
+      nanosleep(&(struct timespec){0, 1000000}, NULL);
+    *taille = s.st_size;
+  }
+  if (fd == -1 || *taille == 0) {
+    perror("Impossible d'ouvrir la mémoire partagée");
+    if (fd != -1)
+      close(fd);
+    return NULL;
+  }
+  void *p = mmap(NULL, *taille, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    perror("Problème d'allocation dans projeterPagesPartagees.");
+    return NULL;
+  }
+  ModePages obtenu = PAGES_NORMALES;
+  if (enormes && *taille >= TAILLE_PAGE_ENORME &&
+      transparentesActives(
+          "/sys/kernel/mm/transparent_hugepage/shmem_enabled") &&
+      madvise(p, *taille, MADV_HUGEPAGE) == 0)
+    obtenu = PAGES_TRANSPARENTES;
+  if (*creee) // les pages vont sur les nœuds de tous les processeurs
+    effacerPages(p, *taille, threadsPages());
+  if (mode)
+    *mode = obtenu;
+  return p;
+}
+
+/**
+ * @brief Supprime le nom d'un segment de mémoire partagée : les processus qui
+ * l'ont projeté le gardent, le prochain projeterPagesPartagees en crée un
+ * nouveau.
+ *
+ * @param nom le nom du segment
+ * @return true si le segment existait
+ * @return false sinon
+ */
+bool supprimerPagesPartagees(const char *nom) { return shm_unlink(nom) == 0; }
+
+/**
+ * @brief Libère une table allouée par allouerPages, ou projetée par
+ * projeterPagesPartagees (le segment partagé reste pour les autres
+ * processus).
+ *
+ * @param debut la table (peut être NULL)
+ * @param taille la taille demandée à l'allocation (ou celle du segment), en
+ * octets
+ */
+void libererPages(void *debut, size_t taille) {
+  if (debut)
+    munmap(debut, arrondir(taille));
+}
+
+/**
+ * @brief Donne le nom d'un mode de pages, pour l'afficher.
+ *
+ * @param mode le mode
+ * @return const char* son nom
+ */
+const char *nomModePages(ModePages mode) {
+  switch (mode) {
+  case PAGES_ENORMES:
+    return "pages énormes (hugetlbfs)";
+  case PAGES_TRANSPARENTES:
+    return "pages énormes transparentes";
+  default:
+    return "pages normales";
+  }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file memoire.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de l'allocation des grandes tables (transposition, df-pn) :
+ * pages énormes quand le système en donne, pages initialisées par plusieurs
+ * threads, mémoire partagée entre processus.
+ * @version 0.1
+ * @date 2023-03-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef MEMOIRE_H
+/**
+ * @def MEMOIRE_H
+ * @brief la garde
+ */
+#define MEMOIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @enum modePages_
+ * @brief Les pages obtenues pour une table, de la meilleure à la moins bonne.
+ * @typedef ModePages
+ * @brief Renommer modePages_.
+ */
+typedef enum modePages_ {
+  PAGES_ENORMES,       //!< Pages de 2 Mo réservées (MAP_HUGETLB)
+  PAGES_TRANSPARENTES, //!< Pages de 2 Mo à la demande (madvise MADV_HUGEPAGE)
+  PAGES_NORMALES       //!< Pages de 4 Ko
+} ModePages;
+
+void autoriserPagesEnormes(bool);
+unsigned threadsPages();
+void *allouerPages(size_t, unsigned, ModePages *);
+void effacerPages(void *, size_t, unsigned);
+void *projeterPagesPartagees(const char *, size_t *, bool *, ModePages *);
+bool supprimerPagesPartagees(const char *);
+void libererPages(void *, size_t);
+const char *nomModePages(ModePages);
+
+#endif
@@ -0,0 +1,522 @@
+/**
+ * @file preuve.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Le solveur par nombres de preuve en profondeur d'abord (df-pn).
+ *
+ * Le joueur qui doit jouer à la racine (l'attaquant) cherche à atteindre un
+ * but : gagner, puis, si c'est impossible, ne pas perdre. Chaque position
+ * porte deux nombres du point de vue du joueur qui doit y jouer : phi, le
+ * nombre minimal de positions à résoudre pour prouver qu'il atteint son but
+ * (celui de l'attaquant ou, pour le défenseur, empêcher celui de
+ * l'attaquant), et delta, le nombre minimal pour prouver qu'il n'y arrive
+ * pas. phi vaut 0 quand le but est prouvé, delta vaut 0 quand il est réfuté.
+ * La recherche descend toujours vers la suite la plus facile à résoudre, tant
+ * que les nombres restent sous les seuils fixés par le parent, ce qui
+ * concentre l'effort sur les lignes forcées : une victoire tactique est
+ * prouvée sans examiner les coups de l'adversaire qui ne changent rien.
+ *
+ * Les nombres sont gardés dans une table de taille fixe. Quand une case est
+ * pleine, l'entrée qui a demandé le moins de travail est remplacée ; quand la
+ * table est presque pleine, le ramasse-miettes libère les entrées les moins
+ * coûteuses à recalculer. Comme celle de la table de transposition, sa
+ * mémoire vient de allouerPages (memoire.h).
+ * @version 0.1
+ * @date 2023-02-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "preuve.h"
+#include "memoire.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @def INFINI
+ * @brief un nombre de preuve infini : le but est réfuté (phi) ou prouvé
+ * (delta)
+ */
+#define INFINI UINT32_MAX
+
+/**
+ * @def TAILLE_CASE
+ * @brief le nombre d'entrées d'une case de la table
+ */
+#define TAILLE_CASE 4
+
+/**
+ * @def REMPLISSAGE_COLLECTE
+ * @brief le remplissage (en pourcentage) qui déclenche le ramasse-miettes
+ */
+#define REMPLISSAGE_COLLECTE 90
+
+/**
+ * @def REMPLISSAGE_APRES
+ * @brief le remplissage (en pourcentage) visé par le ramasse-miettes
+ */
+#define REMPLISSAGE_APRES 50
+
+/**
+ * @def INTERVALLE_CONTROLE
+ * @brief le nombre de positions développées entre deux appels à la fonction
+ * d'interruption
+ */
+#define INTERVALLE_CONTROLE 4096
+
+/**
+ * @def BIT_TENIR
+ * @brief le bit d'une clé indiquant que le but est de ne pas perdre (libre
+ * dans les clés des positions)
+ */
+#define BIT_TENIR ((uint64_t)1 << 62)
+
+/**
+ * @def BIT_ATTAQUANT_J2
+ * @brief le bit d'une clé indiquant que l'attaquant est J2
+ */
+#define BIT_ATTAQUANT_J2 ((uint64_t)1 << 61)
+
+/**
+ * @def MELANGE_TENIR
+ * @brief remplace BIT_TENIR quand les clés des positions occupent ses bits
+ * (grands plateaux) : mélangé à la clé, il ne la distingue plus que par
+ * hachage
+ */
+#define MELANGE_TENIR 0x6A09E667F3BCC908ULL
+
+/**
+ * @def MELANGE_ATTAQUANT_J2
+ * @brief remplace BIT_ATTAQUANT_J2 comme MELANGE_TENIR remplace BIT_TENIR
+ */
+#define MELANGE_ATTAQUANT_J2 0x3C6EF372FE94F82BULL
+
+/**
+ * @struct entreePreuve_
+ * @brief Une entrée de la table.
+ * @typedef EntreePreuve
+ * @brief Renommer entreePreuve_.
+ */
+typedef struct entreePreuve_ {
+  uint64_t cle;     //!< La clé (position et but), 0 si l'entrée est vide
+  uint32_t phi;     //!< Preuve du but du joueur courant
+  uint32_t delta;   //!< Réfutation du but du joueur courant
+  uint64_t travail; //!< Positions développées pour calculer ces nombres
+} EntreePreuve;
+
+/**
+ * @struct preuve_
+ * @brief Un solveur : sa table et l'état de la recherche en cours.
+ */
+struct preuve_ {
+  EntreePreuve *entrees;        //!< Les entrées, par cases de TAILLE_CASE
+  unsigned long masque;         //!< Nombre de cases - 1 (puissance de 2)
+  Type attaquant;               //!< Le joueur courant de la racine
+  bool tenir;                   //!< true si le but est de ne pas perdre
+  uint64_t bits;                //!< Les bits du but mélangés aux clés
+  unsigned long long limite;    //!< Valeur de stats.noeuds qui arrête
+  bool arret;                   //!< true si la recherche doit s'arrêter
+  bool (*interruption)(void *); //!< Appelée régulièrement, true pour arrêter
+  void *donnees;                //!< Les données passées à interruption
+  int coup;                     //!< Le coup de la racine du dernier résultat
+  StatsPreuve stats;            //!< Les compteurs
+};
+
+/**
+ * @brief Crée un solveur dont la table est vide.
+ *
+ * @param nbEntrees le nombre d'entrées de la table, arrondi à la puissance de
+ * 2 inférieure (au moins TAILLE_CASE)
+ * @return Preuve* le solveur, NULL en cas de problème d'allocation
+ */
+Preuve *makePreuve(unsigned long nbEntrees) {
+  assert(nbEntrees > 0);
+  Preuve *p = malloc(sizeof(Preuve));
+  if (!p) {
+    perror("Problème d'allocation dans makePreuve.");
+    return NULL;
+  }
+  unsigned long n = 1;
+  while (n * 2 * TAILLE_CASE <= nbEntrees)
+    n *= 2;
+  p->entrees = allouerPages(n * TAILLE_CASE * sizeof(EntreePreuve),
+                            threadsPages(), NULL);
+  if (!p->entrees) {
+    free(p);
+    return NULL;
+  }
+  p->masque = n - 1;
+  p->coup = -1;
+  p->stats = (StatsPreuve){0};
+  p->stats.capacite = n * TAILLE_CASE;
+  return p;
+}
+
+/**
+ * @brief Donne la case d'une clé.
+ *
+ * @param p le solveur
+ * @param cle la clé
+ * @return EntreePreuve* la première entrée de la case
+ */
+static EntreePreuve *caseCle(Preuve *p, uint64_t cle) {
+  // les bits hauts (dernières colonnes, but) sont d'abord repliés sur les bits
+  // bas : sinon ils ne changeraient pas les bits retenus du produit
+  uint64_t h = (cle ^ (cle >> 32)) * 0x9E3779B97F4A7C15ULL;
+  return &p->entrees[((h >> 32) & p->masque) * TAILLE_CASE];
+}
+
+/**
+ * @brief Cherche les nombres d'une position.
+ *
+ * @param p le solveur
+ * @param cle la clé de la position (avec les bits du but)
+ * @param phi renseigné en cas de succès
+ * @param delta renseigné en cas de succès
+ * @return true si la position a été trouvée
+ * @return false sinon
+ */
+static bool sonder(Preuve *p, uint64_t cle, uint32_t *phi, uint32_t *delta) {
+  EntreePreuve *e = caseCle(p, cle);
+  for (int i = 0; i < TAILLE_CASE; i++) {
+    if (e[i].cle == cle) {
+      *phi = e[i].phi;
+      *delta = e[i].delta;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Le ramasse-miettes : libère les entrées qui ont demandé le moins de
+ * travail, jusqu'à ramener le remplissage à REMPLISSAGE_APRES. Le seuil est
+ * choisi d'après la répartition des travaux par puissance de 2.
+ *
+ * @param p le solveur
+ */
+static void collecter(Preuve *p) {
+  unsigned long long repartition[65] = {0};
+  unsigned long capacite = p->stats.capacite;
+  for (unsigned long i = 0; i < capacite; i++)
+    if (p->entrees[i].cle)
+      repartition[64 - __builtin_clzll(p->entrees[i].travail | 1)]++;
+  unsigned long aLiberer =
+      p->stats.occupees - capacite / 100 * REMPLISSAGE_APRES;
+  unsigned seuil = 0; // on libère les travaux < 2^seuil
+  for (unsigned long long n = 0; seuil < 64 && n < aLiberer; seuil++)
+    n += repartition[seuil + 1];
+  for (unsigned long i = 0; i < capacite; i++) {
+    EntreePreuve *e = &p->entrees[i];
+    if (e->cle && (seuil >= 64 || e->travail < ((uint64_t)1 << seuil))) {
+      e->cle = 0;
+      p->stats.occupees--;
+      p->stats.liberees++;
+    }
+  }
+  p->stats.collectes++;
+}
+
+/**
+ * @brief Stocke les nombres d'une position. Si la case est pleine, l'entrée
+ * qui a demandé le moins de travail est remplacée.
+ *
+ * @param p le solveur
+ * @param cle la clé de la position (avec les bits du but)
+ * @param phi la preuve du but du joueur courant
+ * @param delta la réfutation du but du joueur courant
+ * @param travail les positions développées pour les calculer
+ */
+static void stocker(Preuve *p, uint64_t cle, uint32_t phi, uint32_t delta,
+                    uint64_t travail) {
+  if (p->stats.occupees * 100 >= p->stats.capacite * REMPLISSAGE_COLLECTE)
+    collecter(p);
+  EntreePreuve *e = caseCle(p, cle), *cible = NULL;
+  for (int i = 0; i < TAILLE_CASE && !cible; i++)
+    if (e[i].cle == cle)
+      cible = &e[i];
+  for (int i = 0; i < TAILLE_CASE && !cible; i++)
+    if (!e[i].cle) {
+      cible = &e[i];
+      p->stats.occupees++;
+    }
+  if (!cible) {
+    cible = &e[0];
+    for (int i = 1; i < TAILLE_CASE; i++)
+      if (e[i].travail < cible->travail)
+        cible = &e[i];
+    p->stats.remplacees++;
+  }
+  cible->cle = cle;
+  cible->phi = phi;
+  cible->delta = delta;
+  cible->travail = travail;
+}
+
+/**
+ * @brief Donne le travail déjà stocké pour une position.
+ *
+ * @param p le solveur
+ * @param cle la clé de la position (avec les bits du but)
+ * @return uint64_t le travail, 0 si la position n'est pas dans la table
+ */
+static uint64_t travailStocke(Preuve *p, uint64_t cle) {
+  EntreePreuve *e = caseCle(p, cle);
+  for (int i = 0; i < TAILLE_CASE; i++)
+    if (e[i].cle == cle)
+      return e[i].travail;
+  return 0;
+}
+
+/**
+ * @brief Additionne des nombres de preuve : la somme reste finie tant
+ * qu'aucun terme n'est infini.
+ *
+ * @param a le premier nombre
+ * @param b le second nombre
+ * @return uint32_t la somme
+ */
+static uint32_t ajouter(uint32_t a, uint32_t b) {
+  if (a == INFINI || b == INFINI)
+    return INFINI;
+  uint64_t s = (uint64_t)a + b;
+  return (s >= INFINI) ? INFINI - 1 : s;
+}
+
+/**
+ * @brief Indique si le joueur qui doit jouer une position nulle y atteint son
+ * but.
+ *
+ * @param p le solveur
+ * @param type le joueur qui doit jouer
+ * @return true si la nulle lui suffit
+ */
+static bool nulleSuffit(Preuve *p, Type type) {
+  // l'attaquant se contente de la nulle s'il veut seulement ne pas perdre, le
+  // défenseur s'il veut l'empêcher de gagner
+  return (type == p->attaquant) ? p->tenir : !p->tenir;
+}
+
+/**
+ * @brief Développe une position jusqu'à ce que phi ou delta atteigne son
+ * seuil (ou que la recherche soit arrêtée), et stocke ses nombres.
+ *
+ * @param p le solveur
+ * @param game le jeu, dans la position à développer (non terminale)
+ * @param seuilPhi le seuil de phi
+ * @param seuilDelta le seuil de delta
+ * @param phi la preuve du but du joueur courant, calculée
+ * @param delta la réfutation du but du joueur courant, calculée
+ * @return int le coup le plus prometteur : un coup qui atteint le but si
+ * phi vaut 0
+ */
+static int developper(Preuve *p, Puissance4 *game, uint32_t seuilPhi,
+                      uint32_t seuilDelta, uint32_t *phi, uint32_t *delta) {
+  unsigned long long debut = p->stats.noeuds++;
+  if (p->stats.noeuds >= p->limite ||
+      (p->interruption && p->stats.noeuds % INTERVALLE_CONTROLE == 0 &&
+       p->interruption(p->donnees)))
+    p->arret = true;
+
+  // les suites, du centre vers les bords
+  int colonnes[NB_COLONNE_MAX], lignes[NB_COLONNE_MAX];
+  uint64_t cles[NB_COLONNE_MAX];
+  uint32_t phis[NB_COLONNE_MAX], deltas[NB_COLONNE_MAX];
+  bool terminales[NB_COLONNE_MAX];
+  int nb = 0;
+  for (int k = 0; k < NB_COLONNE; k++) {
+    int c = NB_COLONNE / 2 + ((k % 2) ? -(k + 1) / 2 : k / 2);
+    int l = ligneLibre(game, c);
+    if (l == -1)
+      continue;
+    colonnes[nb] = c;
+    lignes[nb] = l;
+    modifJeton(game, l, c, game->courant->type);
+    changerJoueur(game);
+    Joueur *suivant = game->courant;
+    terminales[nb] = testEnd(game, l, c);
+    if (terminales[nb]) {
+      if (!game->courant) { // nulle
+        game->courant = suivant;
+        bool suffit = nulleSuffit(p, suivant->type);
+        phis[nb] = suffit ? 0 : INFINI;
+        deltas[nb] = suffit ? INFINI : 0;
+      } else { // le joueur qui vient de jouer atteint son but, quel qu'il soit
+        phis[nb] = INFINI;
+        deltas[nb] = 0;
+      }
+    } else {
+      cles[nb] = cleCanonique(game, NULL) ^ p->bits;
+      if (!sonder(p, cles[nb], &phis[nb], &deltas[nb]))
+        phis[nb] = deltas[nb] = 1;
+    }
+    changerJoueur(game);
+    modifJeton(game, l, c, VIDE);
+    nb++;
+  }
+  assert(nb > 0);
+
+  int meilleur;
+  for (;;) {
+    // relus à chaque tour : une transposition a pu les changer
+    for (int i = 0; i < nb; i++)
+      if (!terminales[i])
+        sonder(p, cles[i], &phis[i], &deltas[i]);
+    *phi = INFINI;
+    *delta = 0;
+    meilleur = 0;
+    uint32_t second = INFINI;
+    for (int i = 0; i < nb; i++) {
+      *delta = ajouter(*delta, phis[i]);
+      if (deltas[i] < *phi) {
+        second = *phi;
+        *phi = deltas[i];
+        meilleur = i;
+      } else if (deltas[i] < second) {
+        second = deltas[i];
+      }
+    }
+    if (*phi >= seuilPhi || *delta >= seuilDelta || p->arret)
+      break;
+    // le meilleur coup est développé tant qu'il reste le meilleur et que les
+    // nombres de la position restent sous leurs seuils
+    uint64_t s = (uint64_t)seuilDelta - *delta + phis[meilleur];
+    uint32_t seuilPhiSuite = (seuilDelta == INFINI || s >= INFINI) ? INFINI : s;
+    uint32_t seuilDeltaSuite =
+        (seuilPhi < ajouter(second, 1)) ? seuilPhi : ajouter(second, 1);
+    int c = colonnes[meilleur], l = lignes[meilleur];
+    modifJeton(game, l, c, game->courant->type);
+    changerJoueur(game);
+    developper(p, game, seuilPhiSuite, seuilDeltaSuite, &phis[meilleur],
+               &deltas[meilleur]);
+    changerJoueur(game);
+    modifJeton(game, l, c, VIDE);
+  }
+
+  uint64_t cle = cleCanonique(game, NULL) ^ p->bits;
+  stocker(p, cle, *phi, *delta,
+          travailStocke(p, cle) + p->stats.noeuds - debut);
+  return colonnes[meilleur];
+}
+
+/**
+ * @brief Cherche si le joueur courant atteint un but, dans la limite des
+ * positions restantes.
+ *
+ * @param p le solveur
+ * @param game le jeu
+ * @param tenir true si le but est de ne pas perdre, false pour gagner
+ * @param coup le coup trouvé, si le but est atteint
+ * @return int 1 si le but est prouvé, 0 s'il est réfuté, -1 si la recherche
+ * a été arrêtée avant
+ */
+static int chercherBut(Preuve *p, Puissance4 *game, bool tenir, int *coup) {
+  p->tenir = tenir;
+  if (BITS_COLONNE * NB_COLONNE <= 61) // les bits du but sont libres
+    p->bits = (tenir ? BIT_TENIR : 0) |
+              (p->attaquant == J2 ? BIT_ATTAQUANT_J2 : 0);
+  else
+    p->bits = (tenir ? MELANGE_TENIR : 0) ^
+              (p->attaquant == J2 ? MELANGE_ATTAQUANT_J2 : 0);
+  uint32_t phi, delta;
+  do {
+    *coup = developper(p, game, INFINI, INFINI, &phi, &delta);
+  } while (phi != 0 && delta != 0 && !p->arret);
+  if (phi == 0)
+    return 1;
+  return (delta == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Résout une position : cherche d'abord une victoire forcée du joueur
+ * courant, puis, s'il n'y en a pas, s'il peut éviter la défaite. La table est
+ * gardée d'un appel à l'autre.
+ *
+ * @param p le solveur
+ * @param game le jeu, dans une position non terminale (elle est restaurée)
+ * @param budget le nombre maximal de positions développées
+ * @param interruption appelée régulièrement, la recherche s'arrête si elle
+ * renvoie true (NULL si aucune)
+ * @param donnees les données passées à interruption
+ * @return Resultat le résultat pour le joueur courant, INCONNU si le budget
+ * est épuisé ou la recherche interrompue avant
+ */
+Resultat prouver(Preuve *p, Puissance4 *game, unsigned long long budget,
+                 bool (*interruption)(void *), void *donnees) {
+  assert(p);
+  assert(game);
+  assert(game->courant);
+  p->attaquant = game->courant->type;
+  p->limite = (budget > ULLONG_MAX - p->stats.noeuds) ? ULLONG_MAX
+                                                      : p->stats.noeuds + budget;
+  p->arret = (budget == 0);
+  p->interruption = interruption;
+  p->donnees = donnees;
+  p->coup = -1;
+  int coup;
+  int gagne = p->arret ? -1 : chercherBut(p, game, false, &coup);
+  if (gagne == 1) {
+    p->coup = coup;
+    return GAGNE;
+  }
+  if (gagne == -1)
+    return INCONNU;
+  int tient = chercherBut(p, game, true, &coup);
+  if (tient == -1)
+    return INCONNU;
+  p->coup = coup; // tous les coups perdent si tient vaut 0
+  return tient ? NUL : PERDU;
+}
+
+/**
+ * @brief Donne le coup du joueur courant trouvé par le dernier appel à
+ * prouver : un coup gagnant (GAGNE), un coup qui assure la nulle (NUL) ou un
+ * coup quelconque (PERDU).
+ *
+ * @param p le solveur
+ * @return int la colonne, -1 si le résultat était INCONNU
+ */
+int coupPreuve(Preuve *p) {
+  assert(p);
+  return p->coup;
+}
+
+/**
+ * @brief Donne les compteurs d'un solveur.
+ *
+ * @param p le solveur
+ * @return StatsPreuve les compteurs
+ */
+StatsPreuve statsPreuve(Preuve *p) {
+  assert(p);
+  return p->stats;
+}
+
+/**
+ * @brief Vide la table d'un solveur (les compteurs sont gardés).
+ *
+ * @param p le solveur
+ */
+void viderPreuve(Preuve *p) {
+  assert(p);
+  effacerPages(p->entrees, p->stats.capacite * sizeof(EntreePreuve),
+               threadsPages());
+  p->stats.occupees = 0;
+}
+
+/**
+ * @brief Supprime un solveur.
+ *
+ * @param p le solveur
+ */
+void destroyPreuve(Preuve *p) {
+  if (p)
+    libererPages(p->entrees, p->stats.capacite * sizeof(EntreePreuve));
+  free(p);
+}
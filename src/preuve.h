@@ -0,0 +1,55 @@
+/**
+ * @file preuve.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition du solveur par nombres de preuve (df-pn) : détermine si le
+ * joueur courant gagne, perd ou fait nul quoi que fasse l'adversaire.
+ * @version 0.1
+ * @date 2023-02-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef PREUVE_H
+/**
+ * @def PREUVE_H
+ * @brief la garde
+ */
+#define PREUVE_H
+
+#include "puissance_quatre.h"
+#include "tablebase.h"
+
+#include <stdbool.h>
+
+/**
+ * @struct statsPreuve_
+ * @brief Les compteurs d'un solveur, cumulés depuis sa création.
+ * @typedef StatsPreuve
+ * @brief Renommer statsPreuve_.
+ */
+typedef struct statsPreuve_ {
+  unsigned long long noeuds;     //!< Positions développées
+  unsigned long long collectes;  //!< Passages du ramasse-miettes
+  unsigned long long liberees;   //!< Entrées libérées par le ramasse-miettes
+  unsigned long long remplacees; //!< Entrées écrasées faute de place
+  unsigned long occupees;        //!< Entrées occupées de la table
+  unsigned long capacite;        //!< Nombre d'entrées de la table
+} StatsPreuve;
+
+/**
+ * @typedef Preuve
+ * @brief Renommer preuve_ (structure opaque).
+ */
+typedef struct preuve_ Preuve;
+
+Preuve *makePreuve(unsigned long);
+Resultat prouver(Preuve *, Puissance4 *, unsigned long long, bool (*)(void *),
+                 void *);
+int coupPreuve(Preuve *);
+StatsPreuve statsPreuve(Preuve *);
+void viderPreuve(Preuve *);
+void destroyPreuve(Preuve *);
+
+#endif
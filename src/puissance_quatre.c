@@ -12,12 +12,35 @@
  */
 
 #include "puissance_quatre.h"
+#include "ia.h"
+#include "latence.h"
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/**
+ * @struct noyaux_
+ * @brief Les fonctions les plus appelées par les recherches, compilées pour
+ * une géométrie.
+ * @typedef Noyaux
+ * @brief Renommer noyaux_.
+ */
+typedef struct noyaux_ {
+  bool (*testAlign)(Plateau, unsigned, unsigned, int, int); //!< testAlign
+  bool (*testEnd)(Puissance4 *, unsigned, unsigned);        //!< testEnd
+  void (*modifJeton)(Puissance4 *, unsigned, unsigned, Type); //!< modifJeton
+  int (*testColonne)(Plateau, unsigned);                    //!< testColonne
+  int (*ligneLibre)(Puissance4 *, unsigned);                //!< ligneLibre
+  void (*decaler)(Puissance4 *, unsigned, Type);            //!< retirerJeton
+  Type (*gagnantRetrait)(Puissance4 *, Type);               //!< gagnantRetrait
+  Bitboard (*menaces)(Puissance4 *, Type);                  //!< menaces
+} Noyaux;
+
+Geometrie geometrie = {6, 7, 4, 0, true, {{0xFDFBF7EFDFBFULL}}};
+
 /**
  * @brief Test l'alignement de jetons à partir d'une case dans une direction
  * donnée (horizontale, verticale, diagonale dans une sens et dans l'autre)
@@ -27,87 +50,152 @@
  * @param colonne le numéro de la colonne de la case
  * @param deplaL le déplacement en ligne à effectuer
  * @param deplaC le déplacemement en colonne à effectuer
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de jetons alignés pour gagner
  * @return true si l'alignement est supérieur ou égal au nombre de jetons pour
  * gagner (puissance 4 = 4)
  * @return false sinon
  */
-bool testAlign(Plateau plateau, unsigned ligne, unsigned colonne, int deplaL,
-               int deplaC) {
-  assert(ligne >= 0 && ligne < NB_LIGNE);
-  assert(colonne >= 0 && colonne < NB_COLONNE);
+NOYAU bool alignement(Plateau plateau, unsigned ligne, unsigned colonne,
+                      int deplaL, int deplaC, int L, int C, unsigned A) {
+  assert(ligne >= 0 && ligne < L);
+  assert(colonne >= 0 && colonne < C);
   assert(deplaL == 1 || deplaL == -1 || deplaL == 0);
   assert(deplaC == 1 || deplaC == -1 || deplaC == 0);
   Type valeur = plateau[ligne][colonne];
   assert(valeur == J1 || valeur == J2);
   unsigned nb_aligne = 1;
   int l = ligne, c = colonne;
-  while (nb_aligne < NB_ALIGNE && l + deplaL >= 0 && l + deplaL < NB_LIGNE &&
-         c + deplaC >= 0 && c + deplaC < NB_COLONNE &&
+  while (nb_aligne < A && l + deplaL >= 0 && l + deplaL < L &&
+         c + deplaC >= 0 && c + deplaC < C &&
          plateau[l + deplaL][c + deplaC] == valeur) {
     l += deplaL;
     c += deplaC;
     nb_aligne++;
   }
-  if (nb_aligne >= NB_ALIGNE)
+  if (nb_aligne >= A)
     return true;
   l = ligne;
   c = colonne;
-  while (nb_aligne < NB_ALIGNE && l - deplaL >= 0 && l - deplaL < NB_LIGNE &&
-         c - deplaC >= 0 && c - deplaC < NB_COLONNE &&
+  while (nb_aligne < A && l - deplaL >= 0 && l - deplaL < L &&
+         c - deplaC >= 0 && c - deplaC < C &&
          plateau[l - deplaL][c - deplaC] == valeur) {
     l -= deplaL;
     c -= deplaC;
     nb_aligne++;
   }
-  return (nb_aligne >= NB_ALIGNE);
+  return (nb_aligne >= A);
 }
 
 /**
  * @brief Test si la partie est terminée (égalité ou victoire) à partir du
- * dernier jeton joué (seule manière de gagner)
+ * dernier jeton joué (seule manière de gagner). Les alignements sont cherchés
+ * dans le bitboard du joueur du dernier jeton : la partie s'arrêtant au
+ * premier alignement, le seul possible passe par ce jeton.
  *
  * @param game le jeu
  * @param l le numéro de ligne du dernier jeton ajouté
  * @param c le numéro de colonne du dernier jeton ajouté
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de jetons alignés pour gagner
  * @return true si la partie est terminée
  * @return false sinon
  */
-bool testEnd(Puissance4 *game, unsigned l, unsigned c) {
+NOYAU bool finPartie(Puissance4 *game, unsigned l, unsigned c, int L, int C,
+                     unsigned A) {
   assert(game);
   assert(game->plateau[l][c] == J1 || game->plateau[l][c] == J2);
-  if (testAlign(game->plateau, l, c, 0, 1)      // horizontal
-      || testAlign(game->plateau, l, c, 1, 0)   // vertical
-      || testAlign(game->plateau, l, c, 1, 1)   // diagonal
-      || testAlign(game->plateau, l, c, 1, -1)) // diagonal
-    return true;                                // joueur courant a gagné
-  if (game->nb_jetons == (NB_COLONNE * NB_LIGNE)) {
+  if (bbAligne(&game->pions[game->plateau[l][c] - 1], L, A, MOTS_UTILES(L, C)))
+    return true; // joueur courant a gagné
+  if (game->nb_jetons == (unsigned)(C * L)) {
     game->courant = NULL; // pour l'affichage en fin de partie
     return true;
   } // égalité
   return false;
 }
 
+/**
+ * @brief Donne un bit de la clé d'une position. Quand la clé ne tient pas sur
+ * 63 bits (grands plateaux), chaque bit est remplacé par un nombre
+ * pseudo-aléatoire : la clé devient une empreinte (hachage de Zobrist), qui
+ * identifie la position sauf collision improbable.
+ *
+ * @param h le numéro du bit
+ * @param exacte true si la clé tient sur 63 bits
+ * @return uint64_t le bit, ou le nombre qui le remplace (bit 63 à 0)
+ */
+NOYAU uint64_t bitCle(unsigned h, bool exacte) {
+  if (exacte)
+    return (uint64_t)1 << h;
+  uint64_t z = (h + 1) * 0x9E3779B97F4A7C15ULL; // splitmix64
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (z ^ (z >> 31)) >> 1;
+}
+
+/**
+ * @brief Calcule la modification à apporter (par ou exclusif) à la clé d'une
+ * colonne pour ajouter ou enlever un jeton. Dans la clé, chaque colonne est
+ * codée sur BITS_COLONNE bits : un bit à 1 pour chaque jeton de J1 (en partant
+ * du bas) puis un bit sentinelle au-dessus du dernier jeton. Ajouter un jeton
+ * déplace la sentinelle d'un cran vers le haut.
+ *
+ * @param ligne le numéro de ligne du jeton
+ * @param colonne le numéro de colonne du jeton dans la clé
+ * @param type le type du jeton ajouté ou enlevé
+ * @param L le nombre de lignes du plateau
+ * @param exacte true si la clé tient sur 63 bits
+ * @return uint64_t la modification de la clé
+ */
+NOYAU uint64_t deltaCle(unsigned ligne, unsigned colonne, Type type, int L,
+                        bool exacte) {
+  unsigned h = L - 1 - ligne + colonne * (L + 1);
+  uint64_t delta = bitCle(h + 1, exacte);
+  if (type == J2)
+    delta ^= bitCle(h, exacte);
+  return delta;
+}
+
 /**
  * @brief Ajoute ou enlève un jeton du type précisé dans la case précisée.
+ * Les clés du plateau et de son symétrique, le bitboard du joueur du jeton,
+ * les colonnes non vides et, si le réseau d'évaluation est actif, son
+ * accumulateur sont mis à jour.
  *
  * @param game le jeu
  * @param ligne le numéro de ligne de la case
  * @param colonne le numéro de colonne de la case
  * @param type le type de jeton à ajouter (peut être vide si c'est à enlever)
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
  */
-void modifJeton(Puissance4 *game, unsigned ligne, unsigned colonne, Type type) {
+NOYAU void modification(Puissance4 *game, unsigned ligne, unsigned colonne,
+                        Type type, int L, int C) {
   assert(game);
   assert(game->courant != NULL);
-  assert(ligne >= 0 && ligne < NB_LIGNE);
-  assert(colonne >= 0 && colonne < NB_COLONNE);
+  assert(ligne >= 0 && ligne < L);
+  assert(colonne >= 0 && colonne < C);
+  bool exacte = (L + 1) * C < 64;
+  Type jeton = type;
   if (type != VIDE) {
     assert(game->plateau[ligne][colonne] == VIDE);
     game->nb_jetons++;
   } else {
     assert(game->plateau[ligne][colonne] != VIDE);
+    jeton = game->plateau[ligne][colonne];
     game->nb_jetons--;
   }
   game->plateau[ligne][colonne] = type;
+  bbInverser(&game->pions[jeton - 1], bitCase(ligne, colonne, L));
+  if (ligne == L - 1) // jeton du bas : la colonne devient vide ou non vide
+    game->occupees ^= (uint32_t)1 << colonne;
+  game->cle ^= deltaCle(ligne, colonne, jeton, L, exacte);
+  game->cleMiroir ^= deltaCle(ligne, C - 1 - colonne, jeton, L, exacte);
+  if (reseauActif)
+    accumulerReseau(game->accumulateur, ligne * C + colonne, jeton - 1,
+                    type != VIDE);
 }
 
 /**
@@ -115,18 +203,469 @@ void modifJeton(Puissance4 *game, unsigned ligne, unsigned colonne, Type type) {
  *
  * @param plateau le plateau de jeu
  * @param c le numéro de colonne
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
  * @return int -1 si la colonne est pleine, sinon le numéro de ligne de la
  * première case libre
  */
-int testColonne(Plateau plateau, unsigned c) {
-  assert(c >= 0 && c < NB_COLONNE);
-  for (int i = NB_LIGNE - 1; i >= 0; i--) {
+NOYAU int chute(Plateau plateau, unsigned c, int L, int C) {
+  assert(c >= 0 && c < C);
+  for (int i = L - 1; i >= 0; i--) {
     if (plateau[i][c] == VIDE)
       return i;
   }
   return -1;
 }
 
+/**
+ * @brief Donne la première case libre d'une colonne d'après les bitboards :
+ * les jetons d'une colonne étant empilés depuis le bas, leur nombre est celui
+ * des bits à 1 consécutifs en partant du bas de la colonne.
+ *
+ * @param game le jeu
+ * @param c le numéro de colonne
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @return int -1 si la colonne est pleine, sinon le numéro de ligne de la
+ * première case libre
+ */
+NOYAU int arrivee(Puissance4 *game, unsigned c, int L, int C) {
+  assert(c >= 0 && c < C);
+  unsigned n = MOTS_UTILES(L, C);
+  uint64_t occupees = bbColonne(&game->pions[0], c, L, n) |
+                      bbColonne(&game->pions[1], c, L, n);
+  int hauteur = __builtin_ctzll(~occupees);
+  return hauteur < L ? L - 1 - hauteur : -1;
+}
+
+/**
+ * @brief Calcule la modification à apporter (par ou exclusif) à la clé pour
+ * changer le code d'une colonne (voir deltaCle).
+ *
+ * @param bits les bits du code de la colonne qui changent
+ * @param colonne le numéro de colonne dans la clé
+ * @param L le nombre de lignes du plateau
+ * @param exacte true si la clé tient sur 63 bits
+ * @return uint64_t la modification de la clé
+ */
+NOYAU uint64_t deltaColonne(uint64_t bits, unsigned colonne, int L,
+                            bool exacte) {
+  if (exacte)
+    return bits << (colonne * (L + 1));
+  uint64_t delta = 0;
+  for (; bits; bits &= bits - 1)
+    delta ^= bitCle(__builtin_ctzll(bits) + colonne * (L + 1), exacte);
+  return delta;
+}
+
+/**
+ * @brief Met à jour l'accumulateur du réseau d'évaluation après le décalage
+ * d'une colonne : seules les cases dont le jeton a changé sont modifiées.
+ *
+ * @param game le jeu, après le décalage
+ * @param colonne le numéro de colonne
+ * @param avant les cases de la colonne avant le décalage, de haut en bas
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ */
+NOYAU void accumulerColonne(Puissance4 *game, unsigned colonne,
+                            const Type *avant, int L, int C) {
+  for (int l = 0; l < L; l++) {
+    Type apres = game->plateau[l][colonne];
+    if (apres == avant[l])
+      continue;
+    if (avant[l] != VIDE)
+      accumulerReseau(game->accumulateur, l * C + colonne, avant[l] - 1, false);
+    if (apres != VIDE)
+      accumulerReseau(game->accumulateur, l * C + colonne, apres - 1, true);
+  }
+}
+
+/**
+ * @brief Décale une colonne d'une case vers le bas ou vers le haut : retire
+ * le jeton du bas, ou en remet un sous les autres. Le code de la colonne dans
+ * la clé (jetons de J1 puis sentinelle, voir deltaCle) est décalé de même, et
+ * les bitboards d'un bit pour chaque joueur : quelques opérations, quelle que
+ * soit la hauteur de la colonne. Seules les cases occupées du tableau sont
+ * recopiées, et seules celles qui changent sont reportées dans l'accumulateur
+ * du réseau d'évaluation s'il est actif.
+ *
+ * @param game le jeu
+ * @param colonne le numéro de colonne
+ * @param type VIDE pour retirer le jeton du bas, sinon le type du jeton remis
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ */
+NOYAU void decalage(Puissance4 *game, unsigned colonne, Type type, int L,
+                    int C) {
+  assert(colonne >= 0 && colonne < C);
+  unsigned n = MOTS_UTILES(L, C);
+  bool exacte = (L + 1) * C < 64;
+  uint64_t j1 = bbColonne(&game->pions[0], colonne, L, n);
+  uint64_t j2 = bbColonne(&game->pions[1], colonne, L, n);
+  int hauteur = __builtin_ctzll(~(j1 | j2));
+  uint64_t code = j1 | (uint64_t)1 << hauteur, decale;
+  Type avant[NB_LIGNE_MAX];
+  if (reseauActif)
+    for (int l = 0; l < L; l++)
+      avant[l] = game->plateau[l][colonne];
+  if (type == VIDE) {
+    assert(hauteur > 0);
+    decale = code >> 1;
+    bbInverserColonne(&game->pions[0], colonne, L, n, j1 ^ j1 >> 1);
+    bbInverserColonne(&game->pions[1], colonne, L, n, j2 ^ j2 >> 1);
+    for (int l = L - 1; l > L - hauteur; l--)
+      game->plateau[l][colonne] = game->plateau[l - 1][colonne];
+    game->plateau[L - hauteur][colonne] = VIDE;
+    if (hauteur == 1)
+      game->occupees ^= (uint32_t)1 << colonne;
+    game->nb_jetons--;
+    game->retraits++;
+  } else {
+    assert(hauteur < L);
+    decale = code << 1 | (type == J1);
+    bbInverserColonne(&game->pions[0], colonne, L, n,
+                      j1 ^ (j1 << 1 | (type == J1)));
+    bbInverserColonne(&game->pions[1], colonne, L, n,
+                      j2 ^ (j2 << 1 | (type == J2)));
+    for (int l = L - 1 - hauteur; l < L - 1; l++)
+      game->plateau[l][colonne] = game->plateau[l + 1][colonne];
+    game->plateau[L - 1][colonne] = type;
+    if (hauteur == 0)
+      game->occupees ^= (uint32_t)1 << colonne;
+    game->nb_jetons++;
+    game->retraits--;
+  }
+  game->cle ^= deltaColonne(code ^ decale, colonne, L, exacte);
+  game->cleMiroir ^= deltaColonne(code ^ decale, C - 1 - colonne, L, exacte);
+  if (reseauActif)
+    accumulerColonne(game, colonne, avant, L, C);
+}
+
+/**
+ * @brief Donne le gagnant après un retrait. Un retrait déplace tous les jetons
+ * de sa colonne : plusieurs alignements peuvent apparaître à la fois, pour les
+ * deux joueurs, et c'est tout le plateau qui est vérifié (quelques opérations
+ * par direction sur les bitboards).
+ *
+ * @param game le jeu, après le retrait
+ * @param joueur le joueur qui a retiré un jeton
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de jetons alignés pour gagner
+ * @return Type joueur s'il a un alignement (même si son adversaire en a un
+ * aussi), sinon son adversaire s'il en a un, sinon VIDE
+ */
+NOYAU Type gagnant(Puissance4 *game, Type joueur, int L, int C, unsigned A) {
+  assert(joueur == J1 || joueur == J2);
+  unsigned n = MOTS_UTILES(L, C);
+  Type adversaire = (joueur == J1) ? J2 : J1;
+  if (bbAligne(&game->pions[joueur - 1], L, A, n))
+    return joueur;
+  if (bbAligne(&game->pions[adversaire - 1], L, A, n))
+    return adversaire;
+  return VIDE;
+}
+
+/**
+ * @brief Cherche les menaces d'un joueur (voir bbMenaces).
+ *
+ * @param game le jeu
+ * @param joueur le joueur
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de jetons alignés pour gagner
+ * @return Bitboard les cases libres où un jeton du joueur compléterait un
+ * alignement
+ */
+NOYAU Bitboard casesMenacees(Puissance4 *game, Type joueur, int L, int C,
+                             unsigned A) {
+  assert(joueur == J1 || joueur == J2);
+  unsigned n = MOTS_UTILES(L, C);
+  Bitboard libres = bbLibres(&geometrie.cases, game->pions, n);
+  return bbMenaces(&game->pions[joueur - 1], &libres, L, A, n);
+}
+
+/**
+ * @def SPECIALISER
+ * @brief définit les versions des noyaux pour une géométrie : testAlign##nom,
+ * testEnd##nom, modifJeton##nom, testColonne##nom, ligneLibre##nom,
+ * decaler##nom, gagnantRetrait##nom et menaces##nom. Ceux qui cherchent des
+ * alignements dans les quatre directions à la fois sont compilés pour
+ * plusieurs jeux d'instructions (voir VECTORISE).
+ */
+#define SPECIALISER(nom, L, C, A)                                              \
+  static bool testAlign##nom(Plateau plateau, unsigned ligne,                  \
+                             unsigned colonne, int deplaL, int deplaC) {       \
+    return alignement(plateau, ligne, colonne, deplaL, deplaC, L, C, A);       \
+  }                                                                            \
+  VECTORISE static bool testEnd##nom(Puissance4 *game, unsigned l,             \
+                                     unsigned c) {                             \
+    return finPartie(game, l, c, L, C, A);                                     \
+  }                                                                            \
+  static void modifJeton##nom(Puissance4 *game, unsigned ligne,                \
+                              unsigned colonne, Type type) {                   \
+    modification(game, ligne, colonne, type, L, C);                            \
+  }                                                                            \
+  static int testColonne##nom(Plateau plateau, unsigned c) {                   \
+    return chute(plateau, c, L, C);                                            \
+  }                                                                            \
+  static int ligneLibre##nom(Puissance4 *game, unsigned c) {                   \
+    return arrivee(game, c, L, C);                                             \
+  }                                                                            \
+  static void decaler##nom(Puissance4 *game, unsigned colonne, Type type) {    \
+    decalage(game, colonne, type, L, C);                                       \
+  }                                                                            \
+  VECTORISE static Type gagnantRetrait##nom(Puissance4 *game, Type joueur) {   \
+    return gagnant(game, joueur, L, C, A);                                     \
+  }                                                                            \
+  VECTORISE static Bitboard menaces##nom(Puissance4 *game, Type joueur) {      \
+    return casesMenacees(game, joueur, L, C, A);                               \
+  }
+
+FORMES(SPECIALISER)
+SPECIALISER(Generique, NB_LIGNE, NB_COLONNE, NB_ALIGNE)
+
+/**
+ * @def NOYAUX
+ * @brief les noyaux d'une géométrie, définis par SPECIALISER
+ */
+#define NOYAUX(nom, L, C, A)                                                   \
+  {&testAlign##nom, &testEnd##nom, &modifJeton##nom, &testColonne##nom,       \
+   &ligneLibre##nom, &decaler##nom, &gagnantRetrait##nom, &menaces##nom},
+
+/**
+ * @brief Les noyaux de chaque géométrie, dans l'ordre de FORMES, puis les
+ * noyaux génériques.
+ */
+static const Noyaux noyaux[NB_FORMES + 1] = {
+    FORMES(NOYAUX) NOYAUX(Generique, NB_LIGNE, NB_COLONNE, NB_ALIGNE)};
+
+/**
+ * @def DIMENSIONS
+ * @brief les dimensions d'une géométrie de FORMES
+ */
+#define DIMENSIONS(nom, L, C, A) {L, C, A},
+
+/**
+ * @brief Les lignes, colonnes et pions à aligner de chaque géométrie, dans
+ * l'ordre de FORMES.
+ */
+static const unsigned dimensions[NB_FORMES][3] = {FORMES(DIMENSIONS)};
+
+/**
+ * @brief Les noyaux de la géométrie courante, choisis par definirGeometrie.
+ */
+static const Noyaux *noyau = &noyaux[0];
+
+/**
+ * @brief Test l'alignement de jetons à partir d'une case dans une direction
+ * donnée (horizontale, verticale, diagonale dans une sens et dans l'autre)
+ *
+ * @param plateau le plateau de jeu
+ * @param ligne le numéro de la ligne de la case
+ * @param colonne le numéro de la colonne de la case
+ * @param deplaL le déplacement en ligne à effectuer
+ * @param deplaC le déplacemement en colonne à effectuer
+ * @return true si l'alignement est supérieur ou égal au nombre de jetons pour
+ * gagner (puissance 4 = 4)
+ * @return false sinon
+ */
+bool testAlign(Plateau plateau, unsigned ligne, unsigned colonne, int deplaL,
+               int deplaC) {
+  return noyau->testAlign(plateau, ligne, colonne, deplaL, deplaC);
+}
+
+/**
+ * @brief Test si la partie est terminée (égalité ou victoire) à partir du
+ * dernier jeton joué (seule manière de gagner)
+ *
+ * @param game le jeu
+ * @param l le numéro de ligne du dernier jeton ajouté
+ * @param c le numéro de colonne du dernier jeton ajouté
+ * @return true si la partie est terminée
+ * @return false sinon
+ */
+bool testEnd(Puissance4 *game, unsigned l, unsigned c) {
+  return noyau->testEnd(game, l, c);
+}
+
+/**
+ * @brief Ajoute ou enlève un jeton du type précisé dans la case précisée.
+ * Les clés du plateau et de son symétrique sont mises à jour.
+ *
+ * @param game le jeu
+ * @param ligne le numéro de ligne de la case
+ * @param colonne le numéro de colonne de la case
+ * @param type le type de jeton à ajouter (peut être vide si c'est à enlever)
+ */
+void modifJeton(Puissance4 *game, unsigned ligne, unsigned colonne, Type type) {
+  noyau->modifJeton(game, ligne, colonne, type);
+}
+
+/**
+ * @brief Test si la colonne demandée est pleine.
+ *
+ * @param plateau le plateau de jeu
+ * @param c le numéro de colonne
+ * @return int -1 si la colonne est pleine, sinon le numéro de ligne de la
+ * première case libre
+ */
+int testColonne(Plateau plateau, unsigned c) {
+  return noyau->testColonne(plateau, c);
+}
+
+/**
+ * @brief Donne la première case libre d'une colonne, d'après les bitboards
+ * tenus à jour par modifJeton (plus rapide que testColonne sur les grands
+ * plateaux : quelques opérations, quel que soit le nombre de lignes).
+ *
+ * @param game le jeu
+ * @param c le numéro de colonne
+ * @return int -1 si la colonne est pleine, sinon le numéro de ligne de la
+ * première case libre
+ */
+int ligneLibre(Puissance4 *game, unsigned c) {
+  return noyau->ligneLibre(game, c);
+}
+
+/**
+ * @brief Test si le joueur courant peut retirer le jeton du bas d'une colonne
+ * (règle Pop Out) : il faut que ce soit un des siens.
+ *
+ * @param game le jeu
+ * @param c le numéro de colonne
+ * @return true si le retrait est possible
+ * @return false sinon (règles standard, colonne vide ou jeton de l'adversaire)
+ */
+bool retraitPossible(Puissance4 *game, unsigned c) {
+  assert(game);
+  assert(game->courant);
+  assert(c >= 0 && c < NB_COLONNE);
+  return game->regle == POP_OUT &&
+         game->plateau[NB_LIGNE - 1][c] == game->courant->type;
+}
+
+/**
+ * @brief Retire le jeton du bas d'une colonne, les jetons au-dessus descendant
+ * d'une case (règle Pop Out). Comme modifJeton, met à jour les clés, les
+ * bitboards et les colonnes non vides, et compte le retrait.
+ *
+ * @param game le jeu
+ * @param c le numéro de colonne (non vide)
+ */
+void retirerJeton(Puissance4 *game, unsigned c) {
+  assert(game);
+  noyau->decaler(game, c, VIDE);
+}
+
+/**
+ * @brief Annule un retrait : remet un jeton en bas d'une colonne, les jetons
+ * au-dessus remontant d'une case. Sert aux recherches, pour revenir à la
+ * position d'avant le retrait.
+ *
+ * @param game le jeu
+ * @param c le numéro de colonne (non pleine)
+ * @param type le type du jeton retiré (J1 ou J2)
+ */
+void remettreJeton(Puissance4 *game, unsigned c, Type type) {
+  assert(game);
+  assert(type == J1 || type == J2);
+  noyau->decaler(game, c, type);
+}
+
+/**
+ * @brief Donne le gagnant après un retrait : toute la colonne retirée a bougé,
+ * si bien que plusieurs alignements, des deux joueurs, peuvent apparaître.
+ * Celui qui retire gagne s'il a un alignement, même si son adversaire en a un
+ * aussi.
+ *
+ * @param game le jeu, après le retrait
+ * @param joueur le joueur qui a retiré un jeton
+ * @return Type le gagnant, VIDE si personne n'a d'alignement
+ */
+Type gagnantRetrait(Puissance4 *game, Type joueur) {
+  assert(game);
+  return noyau->gagnantRetrait(game, joueur);
+}
+
+/**
+ * @brief Donne les menaces d'un joueur : les cases libres où un de ses jetons
+ * compléterait un alignement, qu'on puisse y jouer tout de suite ou non.
+ *
+ * @param game le jeu
+ * @param joueur le joueur
+ * @return Bitboard les cases menacées (voir bitboard.h)
+ */
+Bitboard menaces(Puissance4 *game, Type joueur) {
+  assert(game);
+  return noyau->menaces(game, joueur);
+}
+
+/**
+ * @brief Test si la partie est terminée après un retrait du joueur courant (le
+ * pendant de testEnd). Si son adversaire a gagné, il devient le joueur courant
+ * ; après RETRAITS_MAX retraits, la partie est nulle.
+ *
+ * @param game le jeu
+ * @return true si la partie est terminée
+ * @return false sinon
+ */
+bool testEndRetrait(Puissance4 *game) {
+  assert(game);
+  assert(game->courant);
+  Type g = gagnantRetrait(game, game->courant->type);
+  if (g != VIDE) {
+    if (g != game->courant->type)
+      changerJoueur(game); // pour l'affichage en fin de partie
+    return true;
+  }
+  if (game->retraits >= RETRAITS_MAX) {
+    game->courant = NULL; // égalité
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Choisit la géométrie des parties suivantes, et les versions des
+ * fonctions les plus appelées compilées pour elle (voir FORMES). À appeler au
+ * démarrage, avant de créer les joueurs : les tables des IA dépendent de la
+ * géométrie. Le réseau d'évaluation, s'il est fait pour un autre plateau,
+ * n'est plus utilisé.
+ *
+ * @param lignes le nombre de lignes (de 1 à NB_LIGNE_MAX)
+ * @param colonnes le nombre de colonnes (de 1 à NB_COLONNE_MAX)
+ * @param aligne le nombre de pions alignés pour gagner (au moins 2, au plus
+ * la plus grande dimension)
+ * @return true si la géométrie est choisie
+ * @return false si elle est invalide (la géométrie courante est gardée)
+ */
+bool definirGeometrie(unsigned lignes, unsigned colonnes, unsigned aligne) {
+  if (lignes < 1 || lignes > NB_LIGNE_MAX || colonnes < 1 ||
+      colonnes > NB_COLONNE_MAX || aligne < 2 ||
+      (aligne > lignes && aligne > colonnes)) {
+    fprintf(stderr, "Géométrie invalide : %u lignes, %u colonnes, %u alignés\n",
+            lignes, colonnes, aligne);
+    return false;
+  }
+  unsigned forme = 0;
+  while (forme < NB_FORMES && (dimensions[forme][0] != lignes ||
+                               dimensions[forme][1] != colonnes ||
+                               dimensions[forme][2] != aligne))
+    forme++;
+  geometrie = (Geometrie){lignes, colonnes, aligne, forme,
+                          (lignes + 1) * colonnes < 64, {{0}}};
+  for (unsigned l = 0; l < lignes; l++)
+    for (unsigned c = 0; c < colonnes; c++)
+      bbInverser(&geometrie.cases, bitCase(l, c, lignes));
+  noyau = &noyaux[forme];
+  if (reseauActif && (reseauActif->lignes != lignes ||
+                      reseauActif->colonnes != colonnes))
+    activerReseau(NULL);
+  return true;
+}
+
 /**
  * @brief Inverser le joueur courant.
  *
@@ -143,7 +682,7 @@ void changerJoueur(Puissance4 *game) {
 
 /**
  * @brief Pour recommencer une partie : le plateau à vide et le nombre de jetons
- * à 0
+ * à 0 (et l'accumulateur du réseau d'évaluation à ses biais s'il est actif)
  *
  * @param game le jeu
  */
@@ -155,29 +694,50 @@ void initGame(Puissance4 *game) {
     }
   }
   game->nb_jetons = 0;
+  game->pions[0] = game->pions[1] = (Bitboard){{0}};
+  game->occupees = 0;
+  game->retrait = false;
+  game->retraits = 0;
   game->courant = game->j2;
+  game->cle = 0;
+  for (int j = 0; j < NB_COLONNE; j++)
+    game->cle ^= bitCle(j * BITS_COLONNE, geometrie.cleExacte); // sentinelle
+  game->cleMiroir = game->cle;
+  if (reseauActif)
+    initialiserAccumulateur(game->accumulateur);
 }
 
 /**
  * @brief Récupère le prochain coup à jouer, sans tenir compte du type du joueur
- * (humain ou IA).
+ * (humain ou IA) : un jeton à ajouter ou, avec la règle Pop Out, à retirer
+ * (voir RETRAIT). La durée des coups des IA est mesurée (voir latence.h).
  *
  * @param game le jeu
  */
 void prochainCoup(Puissance4 *game) {
   assert(game);
   assert(game->courant);
+  uint64_t debut = debutLatence();
   unsigned coup = game->courant->play(game);
-  assert(coup >= 0 && coup < NB_COLONNE);
-  game->colonne = coup;
-  game->ligne = testColonne(game->plateau, coup);
-  assert(game->ligne != -1);
+  if (game->courant->profondeur != 0)
+    finLatence(game->courant->profondeur, game->nb_jetons, debut);
+  assert(coup >= 0 && coup < NB_COUPS(game));
+  game->retrait = (coup >= NB_COLONNE);
+  game->colonne = coup % NB_COLONNE;
+  if (game->retrait) {
+    assert(retraitPossible(game, game->colonne));
+    game->ligne = NB_LIGNE - 1;
+  } else {
+    game->ligne = ligneLibre(game, coup);
+    assert(game->ligne != -1);
+  }
 }
 
 /**
- * @brief Lance une partie, tant qu'elle n'est pas terminée, permet de jouer.
- * Lorsque la partie se termine, permet de relancer une nouvelle partie. Gère
- * aussi les rageQuit (fermeture de la fenetre en mode interface graphique)
+ * @brief Lance une partie, tant qu'elle n'est pas terminée, permet de jouer,
+ * selon les règles de la partie (standard ou Pop Out). Lorsque la partie se
+ * termine, permet de relancer une nouvelle partie. Gère aussi les rageQuit
+ * (fermeture de la fenetre en mode interface graphique)
  *
  * @param game le jeu
  * @param ui l'interface graphique
@@ -193,19 +753,97 @@ jouer:
     return;
   do {
     changerJoueur(game);
+    if (game->indices && game->courant->profondeur == 0)
+      ui->afficherIndices(ui->data, game);
     ui->getProchainCoup(game);
     if (game->rageQuit)
-      return;
-    modifJeton(game, game->ligne, game->colonne, game->courant->type);
+      break;
+    if (game->retrait)
+      retirerJeton(game, game->colonne);
+    else
+      modifJeton(game, game->ligne, game->colonne, game->courant->type);
     ui->affichage(ui->data, game);
     if (game->rageQuit)
-      return;
-  } while (!(testEnd(game, game->ligne, game->colonne)));
+      break;
+  } while (!(game->retrait ? testEndRetrait(game)
+                           : testEnd(game, game->ligne, game->colonne)));
+  arreterReflexionIA(); // plus de réponse à préparer : la partie est finie
+  if (game->rageQuit)
+    return;
   rejouer = ui->endAffichage(ui->data, game);
   if (rejouer)
     goto jouer;
 }
 
+/**
+ * @brief Donne la clé d'une position : la clé des jetons du plateau (tenue à
+ * jour par modifJeton) dont le bit de poids fort est à 1 si le joueur courant
+ * est J2. Avec la règle Pop Out, elle est mélangée à une empreinte du nombre
+ * de retraits restant avant la nulle (voir RETRAITS_MAX) : ses positions n'ont
+ * pas la même valeur qu'avec les règles standard, ni d'un nombre de retraits
+ * à l'autre quand la nulle est à portée de la recherche. Les tables des IA, le
+ * cache et l'archive ne confondent donc pas ces positions.
+ *
+ * @param game le jeu
+ * @param miroir true pour la clé de la position symétrique (gauche-droite)
+ * @return uint64_t la clé, unique pour chaque position aux règles standard
+ * (une empreinte si elle ne tient pas sur 63 bits, voir bitCle, ou avec la
+ * règle Pop Out)
+ */
+uint64_t clePosition(Puissance4 *game, bool miroir) {
+  assert(game);
+  uint64_t cle = miroir ? game->cleMiroir : game->cle;
+  if (game->courant && game->courant->type == J2)
+    cle |= (uint64_t)1 << 63;
+  if (game->regle == POP_OUT) {
+    uint64_t restants = RETRAITS_MAX - game->retraits;
+    // bit 63 à 0 : garde le joueur courant
+    cle ^= (0x5D588B656C078965ULL + restants * 0x9E3779B97F4A7C15ULL) >> 1;
+  }
+  return cle;
+}
+
+/**
+ * @brief Calcule la clé canonique d'une position : la plus petite entre sa clé
+ * et celle de sa position symétrique, qui ont la même valeur.
+ *
+ * @param game le jeu
+ * @param miroir mis à true si la clé canonique est celle de la position
+ * symétrique (les colonnes sont alors à inverser), peut être NULL
+ * @return uint64_t la clé canonique
+ */
+uint64_t cleCanonique(Puissance4 *game, bool *miroir) {
+  uint64_t cle = clePosition(game, false);
+  uint64_t cleM = clePosition(game, true);
+  if (miroir)
+    *miroir = cleM < cle;
+  return cleM < cle ? cleM : cle;
+}
+
+/**
+ * @brief Donne les colonnes où chercher les coups sur les grands plateaux :
+ * celles à au plus distance colonnes d'une colonne non vide. Un coup gagnant
+ * complète un alignement dont la case voisine est occupée : à partir d'une
+ * distance de 1, les menaces immédiates des deux joueurs sont toujours
+ * candidates. Les colonnes non vides étant tenues à jour par modifJeton, il
+ * n'en coûte que quelques décalages.
+ *
+ * @param game le jeu
+ * @param distance la distance maximale en colonnes, 0 pour toutes les colonnes
+ * @return uint32_t les colonnes candidates, pleines comprises (bit c pour la
+ * colonne c), toutes si le plateau est vide
+ */
+uint32_t colonnesCandidates(Puissance4 *game, unsigned distance) {
+  assert(game);
+  uint32_t toutes = ((uint32_t)1 << NB_COLONNE) - 1;
+  if (distance == 0 || game->occupees == 0)
+    return toutes;
+  uint32_t candidates = game->occupees;
+  for (unsigned d = 0; d < distance && candidates != toutes; d++)
+    candidates = (candidates | candidates << 1 | candidates >> 1) & toutes;
+  return candidates;
+}
+
 /**
  * @brief Crée un jeu du puissance 4.
  *
@@ -218,6 +856,8 @@ Puissance4 *initPuissance4() {
     return NULL;
   }
   game->rageQuit = false;
+  game->indices = false;
+  game->regle = STANDARD;
   return game;
 }
 
@@ -17,23 +17,126 @@
  */
 #define PUISSANCE_QUATRE_H
 
+#include "bitboard.h"
+#include "reseau.h"
+
 #include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @def NB_LIGNE_MAX
+ * @brief nombre maximal de lignes d'un plateau
+ */
+/**
+ * @def NB_COLONNE_MAX
+ * @brief nombre maximal de colonnes d'un plateau
+ */
+#define NB_LIGNE_MAX 15
+#define NB_COLONNE_MAX 15
 
 /**
  * @def NB_LIGNE
- * @brief nombre de ligne dans le plateau
+ * @brief nombre de ligne dans le plateau (voir definirGeometrie)
  */
 /**
  * @def NB_COLONNE
- * @brief nombre de colonne dans le plateau
+ * @brief nombre de colonne dans le plateau (voir definirGeometrie)
  */
 /**
  * @def NB_ALIGNE
- * @brief nombre de pions alignés pour gagner
+ * @brief nombre de pions alignés pour gagner (voir definirGeometrie)
+ */
+#define NB_LIGNE (geometrie.lignes)
+#define NB_COLONNE (geometrie.colonnes)
+#define NB_ALIGNE (geometrie.aligne)
+
+/**
+ * @def BITS_COLONNE
+ * @brief nombre de bits utilisés pour coder une colonne dans la clé d'une
+ * position (un bit par case et un bit sentinelle)
+ */
+#define BITS_COLONNE (NB_LIGNE + 1)
+
+/**
+ * @def CODE_GEOMETRIE
+ * @brief la géométrie courante sur 32 bits, pour reconnaître les tables et
+ * fichiers qui en dépendent
+ */
+#define CODE_GEOMETRIE ((NB_LIGNE << 16) | (NB_COLONNE << 8) | NB_ALIGNE)
+
+/**
+ * @def NB_COUPS_MAX
+ * @brief nombre maximal de coups d'une position : ajouter un jeton dans une
+ * colonne, ou retirer celui du bas d'une colonne (voir RETRAIT)
+ */
+#define NB_COUPS_MAX (2 * NB_COLONNE_MAX)
+
+/**
+ * @def RETRAIT
+ * @brief le coup qui retire le jeton du bas d'une colonne (règle Pop Out) :
+ * les coups de 0 à NB_COLONNE - 1 ajoutent un jeton dans leur colonne, les
+ * suivants retirent celui du bas de la leur
+ */
+#define RETRAIT(colonne) (NB_COLONNE + (colonne))
+
+/**
+ * @def RETRAITS_MAX
+ * @brief nombre de retraits (règle Pop Out) au-delà duquel la partie est nulle,
+ * les retraits pouvant faire revenir indéfiniment les mêmes positions
+ */
+#define RETRAITS_MAX (NB_LIGNE * NB_COLONNE)
+
+/**
+ * @def FORMES
+ * @brief Les géométries courantes, F(nom, lignes, colonnes, aligne) : les
+ * fonctions les plus appelées par les recherches sont compilées pour chacune
+ * (les dimensions sont alors des constantes), les autres géométries utilisent
+ * une version générique. La première est le plateau standard.
+ */
+#define FORMES(F)                                                              \
+  F(6x7, 6, 7, 4) F(7x8, 7, 8, 4) F(7x9, 7, 9, 4) F(6x9, 6, 9, 5)            \
+      F(10x10, 10, 10, 4) F(15x15, 15, 15, 5)
+
+/**
+ * @def NOYAU
+ * @brief une fonction générique, paramétrée par les dimensions du plateau,
+ * dont le code est recopié dans la version de chaque géométrie de FORMES (les
+ * dimensions y deviennent des constantes)
+ */
+#define NOYAU static inline __attribute__((always_inline))
+
+/**
+ * @def COMPTER_FORME
+ * @brief compte une géométrie de FORMES
+ */
+#define COMPTER_FORME(nom, lignes, colonnes, aligne) +1
+
+/**
+ * @def NB_FORMES
+ * @brief le nombre de géométries de FORMES, et la forme des autres
  */
-#define NB_LIGNE 6
-#define NB_COLONNE 7
-#define NB_ALIGNE 4
+#define NB_FORMES (0 FORMES(COMPTER_FORME))
+
+/**
+ * @struct geometrie_
+ * @brief Les dimensions du plateau et le nombre de pions à aligner, choisis au
+ * démarrage (voir definirGeometrie).
+ * @typedef Geometrie
+ * @brief Renommer geometrie_.
+ */
+typedef struct geometrie_ {
+  unsigned lignes;   //!< Nombre de lignes du plateau
+  unsigned colonnes; //!< Nombre de colonnes du plateau
+  unsigned aligne;   //!< Nombre de pions alignés pour gagner
+  unsigned forme;    //!< Indice dans FORMES, NB_FORMES si aucune
+  bool cleExacte;    //!< true si la clé d'une position tient sur 63 bits
+  Bitboard cases;    //!< Les cases du plateau (voir bitboard.h)
+} Geometrie;
+
+/**
+ * @brief La géométrie des parties, le plateau standard par défaut.
+ */
+extern Geometrie geometrie;
 
 /**
  * @enum type_
@@ -47,11 +150,30 @@ typedef enum type_ {
   J2    //!< Représente une case qui est occupée par J2
 } Type;
 
+/**
+ * @enum regle_
+ * @brief Les règles d'une partie.
+ * @typedef Regle
+ * @brief Renommer regle_.
+ */
+typedef enum regle_ {
+  STANDARD, //!< Règles standard : chaque coup ajoute un jeton
+  POP_OUT   /*!< Un joueur peut aussi retirer un de ses jetons du bas d'une
+                colonne, les jetons au-dessus descendant d'une case */
+} Regle;
+
+/**
+ * @def NB_COUPS
+ * @brief le nombre de coups d'une partie (voir RETRAIT)
+ */
+#define NB_COUPS(game) ((game)->regle == POP_OUT ? 2 * NB_COLONNE : NB_COLONNE)
+
 /**
  * @typedef Plateau
- * @brief Un tableau à 2 dimensions de Type.
+ * @brief Un tableau à 2 dimensions de Type, dont seules les NB_LIGNE premières
+ * lignes et NB_COLONNE premières colonnes sont utilisées.
  */
-typedef Type Plateau[NB_LIGNE][NB_COLONNE];
+typedef Type Plateau[NB_LIGNE_MAX][NB_COLONNE_MAX];
 
 /**
  * @typedef Joueur
@@ -75,6 +197,16 @@ typedef struct p4_ {
   unsigned colonne;   //!< coordonnée du dernier coup : sa colonne
   unsigned nb_jetons; //!< Nombre de jetons sur le plateau
   bool rageQuit;      //!< Booléen en cas de rage quit en mode graphique
+  bool indices;       //!< Afficher le score de chaque colonne aux humains
+  uint64_t cle;       //!< Clé des jetons du plateau, tenue à jour par modifJeton
+  uint64_t cleMiroir; //!< Clé des jetons du plateau symétrique (gauche-droite)
+  Bitboard pions[2];  //!< Jetons de J1 puis de J2, tenus à jour par modifJeton
+  uint32_t occupees;  //!< Colonnes non vides (bit c pour la colonne c)
+  Regle regle;        //!< Les règles de la partie
+  bool retrait;       //!< true si le dernier coup retire un jeton (Pop Out)
+  unsigned retraits;  //!< Nombre de retraits depuis le début de la partie
+  Accumulateur accumulateur; /*!< Première couche du réseau d'évaluation,
+                                tenue à jour par modifJeton s'il est actif */
 } Puissance4;
 
 /**
@@ -84,7 +216,9 @@ typedef struct p4_ {
 struct joueur_ {
   Type type;                /*!< Pour savoir si le joueur est un J1 ou un J2 */
   unsigned char profondeur; /*!<  Si le joueur est une IA, correspond à son
-                                niveau de difficulté */
+                                niveau de difficulté, 0 pour un humain */
+  unsigned char algorithme; /*!< Si le joueur est une IA, son algorithme de
+                                recherche (voir ia.h) */
   unsigned (*play)(Puissance4 *); /*!< Pointeur de fonction : jouer, récupérer
                                       le coup souhaité. */
 };
@@ -106,6 +240,10 @@ typedef struct ui_ {
   void (*getProchainCoup)(
       Puissance4 *game); /*!< Pointeur de fonction : récupère le prochain coup
                             du joueur courant */
+  void (*afficherIndices)(
+      void *data,
+      Puissance4 *game); /*!<  Pointeur de fonction : affiche le score de
+                            chaque colonne au joueur humain courant */
   bool (*endAffichage)(
       void *data,
       Puissance4 *game); /*!<  Pointeur de fonction : affiche le jeu une fois la
@@ -118,11 +256,22 @@ bool testAlign(Plateau, unsigned, unsigned, int, int);
 bool testEnd(Puissance4 *, unsigned, unsigned);
 void modifJeton(Puissance4 *, unsigned, unsigned, Type);
 int testColonne(Plateau, unsigned);
+int ligneLibre(Puissance4 *, unsigned);
+bool retraitPossible(Puissance4 *, unsigned);
+void retirerJeton(Puissance4 *, unsigned);
+void remettreJeton(Puissance4 *, unsigned, Type);
+Type gagnantRetrait(Puissance4 *, Type);
+Bitboard menaces(Puissance4 *, Type);
+bool testEndRetrait(Puissance4 *);
 void changerJoueur(Puissance4 *game);
 void initGame(Puissance4 *);
 void prochainCoup(Puissance4 *);
 void launchGame(Puissance4 *, userInterface *);
 Puissance4 *initPuissance4();
 void clean(Puissance4 *, userInterface *);
+uint64_t clePosition(Puissance4 *, bool);
+uint64_t cleCanonique(Puissance4 *, bool *);
+uint32_t colonnesCandidates(Puissance4 *, unsigned);
+bool definirGeometrie(unsigned, unsigned, unsigned);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,266 @@
+/**
+ * @file reseau.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Le réseau de neurones d'évaluation : lecture et écriture de ses
+ * poids, mise à jour de la première couche jeton par jeton et calcul des
+ * couches suivantes. Les boucles sur les neurones sont faites pour que le
+ * compilateur traite plusieurs neurones par instruction (voir VECTORISE).
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "reseau.h"
+#include "puissance_quatre.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @def VERSION
+ * @brief la version du format des fichiers de poids
+ */
+#define VERSION 1
+
+/**
+ * @struct entete_
+ * @brief L'en-tête d'un fichier de poids, suivi de biais1, des 2 x lignes x
+ * colonnes premières lignes de poids1, de biais2, poids2, biais3 et poids3.
+ * @typedef Entete
+ * @brief Renommer entete_.
+ */
+typedef struct entete_ {
+  char magie[4];     //!< "P4RN"
+  uint32_t version;  //!< VERSION
+  uint32_t lignes;   //!< Lignes du plateau
+  uint32_t colonnes; //!< Colonnes du plateau
+  uint32_t cachees;  //!< RESEAU_CACHEES
+  uint32_t seconde;  //!< RESEAU_SECONDE
+} Entete;
+
+const Reseau *reseauActif = NULL;
+
+/**
+ * @brief Lit les poids d'un réseau.
+ *
+ * @param chemin le fichier des poids (voir ecrireReseau)
+ * @return Reseau* le réseau, NULL si le fichier n'a pu être lu ou n'est pas un
+ * fichier de poids de cette version, ou en cas de problème d'allocation
+ */
+Reseau *lireReseau(const char *chemin) {
+  assert(chemin);
+  Reseau *r = calloc(1, sizeof(Reseau));
+  if (!r) {
+    perror("Problème d'allocation dans lireReseau.");
+    return NULL;
+  }
+  FILE *f = fopen(chemin, "rb");
+  if (!f) {
+    perror("Impossible d'ouvrir le réseau");
+    free(r);
+    return NULL;
+  }
+  Entete e;
+  bool ok = fread(&e, sizeof(e), 1, f) == 1 &&
+            memcmp(e.magie, "P4RN", 4) == 0 && e.version == VERSION &&
+            e.cachees == RESEAU_CACHEES && e.seconde == RESEAU_SECONDE &&
+            e.lignes >= 1 && e.lignes <= NB_LIGNE_MAX && e.colonnes >= 1 &&
+            e.colonnes <= NB_COLONNE_MAX;
+  if (ok) {
+    size_t entrees = 2 * e.lignes * e.colonnes;
+    r->lignes = e.lignes;
+    r->colonnes = e.colonnes;
+    ok = fread(r->biais1, sizeof(r->biais1), 1, f) == 1 &&
+         fread(r->poids1, sizeof(r->poids1[0]), entrees, f) == entrees &&
+         fread(r->biais2, sizeof(r->biais2), 1, f) == 1 &&
+         fread(r->poids2, sizeof(r->poids2), 1, f) == 1 &&
+         fread(&r->biais3, sizeof(r->biais3), 1, f) == 1 &&
+         fread(r->poids3, sizeof(r->poids3), 1, f) == 1;
+  }
+  fclose(f);
+  if (!ok) {
+    fprintf(stderr, "%s n'est pas un réseau valide.\n", chemin);
+    free(r);
+    return NULL;
+  }
+  return r;
+}
+
+/**
+ * @brief Écrit les poids d'un réseau (voir Entete).
+ *
+ * @param r le réseau
+ * @param chemin le fichier des poids
+ * @return true si le fichier a été écrit
+ * @return false sinon
+ */
+bool ecrireReseau(const Reseau *r, const char *chemin) {
+  assert(r && chemin);
+  assert(2 * r->lignes * r->colonnes <= RESEAU_ENTREES_MAX);
+  FILE *f = fopen(chemin, "wb");
+  if (!f) {
+    perror("Impossible d'écrire le réseau");
+    return false;
+  }
+  Entete e = {{'P', '4', 'R', 'N'}, VERSION,        r->lignes,
+              r->colonnes,          RESEAU_CACHEES, RESEAU_SECONDE};
+  size_t entrees = 2 * r->lignes * r->colonnes;
+  bool ok = fwrite(&e, sizeof(e), 1, f) == 1 &&
+            fwrite(r->biais1, sizeof(r->biais1), 1, f) == 1 &&
+            fwrite(r->poids1, sizeof(r->poids1[0]), entrees, f) == entrees &&
+            fwrite(r->biais2, sizeof(r->biais2), 1, f) == 1 &&
+            fwrite(r->poids2, sizeof(r->poids2), 1, f) == 1 &&
+            fwrite(&r->biais3, sizeof(r->biais3), 1, f) == 1 &&
+            fwrite(r->poids3, sizeof(r->poids3), 1, f) == 1;
+  ok = fclose(f) == 0 && ok;
+  if (!ok)
+    perror("Impossible d'écrire le réseau");
+  return ok;
+}
+
+/**
+ * @brief Ajoute des octets à une empreinte (FNV-1a).
+ *
+ * @param h l'empreinte des octets précédents
+ * @param octets les octets
+ * @param taille leur nombre
+ * @return uint64_t l'empreinte avec ces octets
+ */
+static uint64_t empreinte(uint64_t h, const void *octets, size_t taille) {
+  for (size_t i = 0; i < taille; i++)
+    h = (h ^ ((const uint8_t *)octets)[i]) * 0x100000001B3ULL;
+  return h;
+}
+
+/**
+ * @brief Donne une empreinte des poids d'un réseau (ceux qu'écrit
+ * ecrireReseau) : deux réseaux différents ont presque sûrement des empreintes
+ * différentes.
+ *
+ * @param r le réseau
+ * @return uint64_t l'empreinte, jamais 0
+ */
+uint64_t empreinteReseau(const Reseau *r) {
+  assert(r);
+  uint64_t h = 0xCBF29CE484222325ULL;
+  h = empreinte(h, &r->lignes, sizeof(r->lignes));
+  h = empreinte(h, &r->colonnes, sizeof(r->colonnes));
+  h = empreinte(h, r->biais1, sizeof(r->biais1));
+  h = empreinte(h, r->poids1,
+                sizeof(r->poids1[0]) * 2 * r->lignes * r->colonnes);
+  h = empreinte(h, r->biais2, sizeof(r->biais2));
+  h = empreinte(h, r->poids2, sizeof(r->poids2));
+  h = empreinte(h, &r->biais3, sizeof(r->biais3));
+  h = empreinte(h, r->poids3, sizeof(r->poids3));
+  return h | 1;
+}
+
+/**
+ * @brief Choisit le réseau des évaluations, qui doit être celui du plateau de
+ * geometrie. Les parties doivent être recommencées (voir initGame) pour que
+ * leur accumulateur soit calculé.
+ *
+ * @param r le réseau, qui reste à l'appelant, NULL pour revenir à
+ * l'heuristique
+ * @return true si le réseau est choisi
+ * @return false s'il est fait pour un autre plateau (le précédent est gardé)
+ */
+bool activerReseau(const Reseau *r) {
+  if (r && (r->lignes != NB_LIGNE || r->colonnes != NB_COLONNE)) {
+    fprintf(stderr, "Réseau pour un plateau %ux%u, le plateau est %ux%u.\n",
+            r->lignes, r->colonnes, NB_LIGNE, NB_COLONNE);
+    return false;
+  }
+  reseauActif = r;
+  return true;
+}
+
+/**
+ * @brief Donne l'accumulateur d'un plateau vide : les biais de la première
+ * couche, pour les deux points de vue.
+ *
+ * @param acc l'accumulateur
+ */
+void initialiserAccumulateur(Accumulateur acc) {
+  assert(reseauActif);
+  memcpy(acc[0], reseauActif->biais1, sizeof(acc[0]));
+  memcpy(acc[1], reseauActif->biais1, sizeof(acc[1]));
+}
+
+/**
+ * @brief Ajoute ou enlève un jeton dans l'accumulateur : la ligne de poids1 de
+ * son entrée est ajoutée ou soustraite pour chaque point de vue.
+ *
+ * @param acc l'accumulateur
+ * @param indice la case du jeton (ligne x colonnes + colonne)
+ * @param joueur le joueur du jeton, 0 pour J1 et 1 pour J2
+ * @param ajout true si le jeton est ajouté, false s'il est enlevé
+ */
+VECTORISE void accumulerReseau(Accumulateur acc, unsigned indice,
+                               unsigned joueur, bool ajout) {
+  assert(reseauActif);
+  assert(joueur < 2);
+  unsigned n = reseauActif->lignes * reseauActif->colonnes;
+  assert(indice < n);
+  // l'entrée est celle d'un jeton du joueur de son point de vue, d'un jeton
+  // de l'adversaire de l'autre
+  const int16_t *restrict w1 = reseauActif->poids1[indice + joueur * n];
+  const int16_t *restrict w2 = reseauActif->poids1[indice + (1 - joueur) * n];
+  int16_t *restrict a1 = acc[0], *restrict a2 = acc[1];
+  if (ajout) {
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++) {
+      a1[k] += w1[k];
+      a2[k] += w2[k];
+    }
+  } else {
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++) {
+      a1[k] -= w1[k];
+      a2[k] -= w2[k];
+    }
+  }
+}
+
+/**
+ * @brief Borne une activation entre 0 et 1 (RESEAU_UN).
+ *
+ * @param x l'activation
+ * @return int32_t l'activation bornée
+ */
+static inline int32_t borner(int32_t x) {
+  return x < 0 ? 0 : x > RESEAU_UN ? RESEAU_UN : x;
+}
+
+/**
+ * @brief Évalue une position d'après son accumulateur : les activations de la
+ * première couche sont bornées, puis passent par les deux couches suivantes.
+ *
+ * @param acc l'accumulateur de la position
+ * @param joueur le joueur pour qui évaluer, 0 pour J1 et 1 pour J2
+ * @return int l'évaluation pour le joueur, RESEAU_POINTS par unité de sortie
+ */
+VECTORISE int evaluerReseau(const Accumulateur acc, unsigned joueur) {
+  assert(reseauActif);
+  assert(joueur < 2);
+  const Reseau *r = reseauActif;
+  int16_t entrees[2 * RESEAU_CACHEES];
+  for (unsigned k = 0; k < RESEAU_CACHEES; k++) {
+    entrees[k] = (int16_t)borner(acc[joueur][k]);
+    entrees[RESEAU_CACHEES + k] = (int16_t)borner(acc[1 - joueur][k]);
+  }
+  int32_t sortie = r->biais3;
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    int32_t somme = r->biais2[j]; // produits scalaires de paires de 16 bits
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      somme += r->poids2[j][k] * entrees[k];
+    sortie += r->poids3[j] * borner(somme >> RESEAU_DECALAGE);
+  }
+  return (int)((int64_t)sortie * RESEAU_POINTS /
+               (RESEAU_UN << RESEAU_DECALAGE));
+}
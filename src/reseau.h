@@ -0,0 +1,110 @@
+/**
+ * @file reseau.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition du réseau de neurones d'évaluation : un petit réseau en
+ * entiers qui remplace l'heuristique des IA quand ses poids sont chargés.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef RESEAU_H
+/**
+ * @def RESEAU_H
+ * @brief la garde
+ */
+#define RESEAU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @def RESEAU_CACHEES
+ * @brief le nombre de neurones de la première couche, pour chaque point de vue
+ */
+#define RESEAU_CACHEES 32
+
+/**
+ * @def RESEAU_SECONDE
+ * @brief le nombre de neurones de la deuxième couche
+ */
+#define RESEAU_SECONDE 32
+
+/**
+ * @def RESEAU_ENTREES_MAX
+ * @brief le nombre maximal d'entrées : une par case et par joueur sur le plus
+ * grand plateau (2 x NB_LIGNE_MAX x NB_COLONNE_MAX)
+ */
+#define RESEAU_ENTREES_MAX (2 * 15 * 15)
+
+/**
+ * @def RESEAU_UN
+ * @brief la valeur entière d'une activation de 1 (voir Reseau)
+ */
+#define RESEAU_UN 127
+
+/**
+ * @def RESEAU_DECALAGE
+ * @brief les poids des deux dernières couches sont des multiples de
+ * 1 / 2^RESEAU_DECALAGE (voir Reseau)
+ */
+#define RESEAU_DECALAGE 6
+
+/**
+ * @def RESEAU_POINTS
+ * @brief les points d'évaluation (voir evaluation dans ia.h) pour une sortie
+ * du réseau de 1
+ */
+#define RESEAU_POINTS 100
+
+/**
+ * @struct reseau_
+ * @brief Les poids d'un réseau, pour un plateau. Les entrées sont vues du
+ * point de vue d'un joueur : l'entrée c (ligne x colonnes + colonne) vaut 1 si
+ * la case c a un jeton du joueur, l'entrée lignes x colonnes + c si elle a un
+ * jeton de son adversaire. La première couche est calculée pour les deux
+ * points de vue (voir Accumulateur) ; la deuxième reçoit ses activations,
+ * bornées entre 0 et 1, pour le joueur puis pour son adversaire. La sortie
+ * estime la position pour le joueur (le logarithme du rapport de ses chances
+ * de gain et de perte). Tout est entier : les activations valent RESEAU_UN
+ * fois les vraies, comme les poids de la première couche et ses biais, les
+ * poids suivants 2^RESEAU_DECALAGE fois les vrais et les biais suivants
+ * RESEAU_UN x 2^RESEAU_DECALAGE fois.
+ * @typedef Reseau
+ * @brief Renommer reseau_.
+ */
+typedef struct reseau_ {
+  uint32_t lignes;                                    //!< Lignes du plateau
+  uint32_t colonnes;                                  //!< Colonnes du plateau
+  int16_t biais1[RESEAU_CACHEES];                     //!< Première couche
+  int16_t poids1[RESEAU_ENTREES_MAX][RESEAU_CACHEES]; //!< Une ligne par entrée
+  int32_t biais2[RESEAU_SECONDE];                     //!< Deuxième couche
+  int16_t poids2[RESEAU_SECONDE][2 * RESEAU_CACHEES]; //!< Une ligne par neurone
+  int32_t biais3;                                     //!< Sortie
+  int8_t poids3[RESEAU_SECONDE];                      //!< Un par neurone
+} Reseau;
+
+/**
+ * @typedef Accumulateur
+ * @brief La somme pondérée des entrées de la première couche, du point de vue
+ * de J1 puis de J2, tenue à jour à chaque jeton ajouté ou enlevé.
+ */
+typedef int16_t Accumulateur[2][RESEAU_CACHEES];
+
+/**
+ * @brief Le réseau utilisé par les IA, NULL pour l'heuristique.
+ */
+extern const Reseau *reseauActif;
+
+Reseau *lireReseau(const char *);
+bool ecrireReseau(const Reseau *, const char *);
+uint64_t empreinteReseau(const Reseau *);
+bool activerReseau(const Reseau *);
+void initialiserAccumulateur(Accumulateur);
+void accumulerReseau(Accumulateur, unsigned, unsigned, bool);
+int evaluerReseau(const Accumulateur, unsigned);
+
+#endif
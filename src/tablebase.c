@@ -0,0 +1,906 @@
+/**
+ * @file tablebase.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief La table des finales : génération et consultation.
+ *
+ * La génération énumère, couche par couche (une couche par nombre de jetons),
+ * toutes les positions atteignables depuis la position de départ, puis les
+ * résout à rebours : la dernière couche d'abord, chaque position ne dépendant
+ * que de la couche suivante. Chaque couche est partagée entre plusieurs
+ * threads et sauvegardée une fois résolue, si bien qu'une génération
+ * interrompue reprend à la première couche non sauvegardée.
+ *
+ * Le fichier produit est projeté en mémoire (mmap). Les positions y sont
+ * identifiées par leur clé canonique (voir cleCanonique) ; l'indice d'une
+ * position est son rang parmi les clés triées, ce qui numérote les positions
+ * de la table de 0 à n - 1 sans trou. Les clés sont compressées par blocs
+ * (écarts entre clés successives, sur un nombre variable d'octets) et les
+ * résultats rangés sur 2 bits, à l'indice de la position.
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "tablebase.h"
+#include "puissance_quatre.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @def NB_CASES
+ * @brief le nombre de cases du plateau
+ */
+#define NB_CASES (NB_LIGNE * NB_COLONNE)
+
+/**
+ * @def NB_CASES_MAX
+ * @brief le nombre maximal de cases d'un plateau
+ */
+#define NB_CASES_MAX (NB_LIGNE_MAX * NB_COLONNE_MAX)
+
+/**
+ * @def TAILLE_BLOC
+ * @brief le nombre de clés d'un bloc : une recherche décode au plus ce nombre
+ * de clés après la recherche dichotomique des blocs
+ */
+#define TAILLE_BLOC 64
+
+/**
+ * @def MAX_THREADS
+ * @brief le nombre maximal de threads de la génération
+ */
+#define MAX_THREADS 64
+
+/**
+ * @def VERSION
+ * @brief la version du format des fichiers
+ */
+#define VERSION 1
+
+/**
+ * @def MASQUE_SEGMENT
+ * @brief les bits d'une colonne dans une clé
+ */
+#define MASQUE_SEGMENT (((uint64_t)1 << BITS_COLONNE) - 1)
+
+/**
+ * @def BIT_J2
+ * @brief le bit d'une clé indiquant que J2 doit jouer
+ */
+#define BIT_J2 ((uint64_t)1 << 63)
+
+/**
+ * @struct entete_
+ * @brief L'en-tête du fichier, suivi des blocs, du flux des clés et des
+ * résultats.
+ * @typedef Entete
+ * @brief Renommer entete_.
+ */
+typedef struct entete_ {
+  char magie[4];       //!< "P4TF"
+  uint32_t version;    //!< VERSION
+  uint32_t lignes;     //!< NB_LIGNE
+  uint32_t colonnes;   //!< NB_COLONNE
+  uint32_t jetonsMin;  //!< Nombre minimal de jetons des positions
+  uint32_t tailleBloc; //!< TAILLE_BLOC
+  uint64_t nb;         //!< Nombre de positions
+  uint64_t nbBlocs;    //!< Nombre de blocs
+  uint64_t tailleFlux; //!< Taille du flux des clés en octets
+} Entete;
+
+/**
+ * @struct bloc_
+ * @brief Un bloc de clés : la première, puis les écarts dans le flux.
+ * @typedef Bloc
+ * @brief Renommer bloc_.
+ */
+typedef struct bloc_ {
+  uint64_t premiere; //!< La première clé du bloc
+  uint64_t decalage; //!< La position des écarts suivants dans le flux
+} Bloc;
+
+/**
+ * @struct tableFinale_
+ * @brief Une table des finales projetée en mémoire.
+ */
+struct tableFinale_ {
+  void *donnees;          //!< Le fichier projeté
+  size_t taille;          //!< Sa taille
+  const Entete *entete;   //!< L'en-tête
+  const Bloc *blocs;      //!< Les blocs
+  const uint8_t *flux;    //!< Le flux des écarts entre clés
+  const uint8_t *valeurs; //!< Les résultats, 4 par octet
+};
+
+/**
+ * @struct position_
+ * @brief Une position de la génération, sous forme de masques de bits (même
+ * disposition que les clés : BITS_COLONNE bits par colonne, du bas vers le
+ * haut).
+ * @typedef Position
+ * @brief Renommer position_.
+ */
+typedef struct position_ {
+  uint64_t j1;     //!< Les jetons de J1
+  uint64_t masque; //!< Les cases occupées
+  unsigned n;      //!< Le nombre de jetons (J1 joue quand il est pair)
+} Position;
+
+/**
+ * @struct couche_
+ * @brief Les positions d'une couche (même nombre de jetons), triées par clé.
+ * @typedef Couche
+ * @brief Renommer couche_.
+ */
+typedef struct couche_ {
+  uint64_t *cles;   //!< Les clés canoniques triées
+  uint8_t *valeurs; //!< Les résultats (Resultat), NULL avant la résolution
+  size_t nb;        //!< Le nombre de positions
+} Couche;
+
+/**
+ * @struct tache_
+ * @brief La part d'une couche traitée par un thread.
+ * @typedef Tache
+ * @brief Renommer tache_.
+ */
+typedef struct tache_ {
+  Couche *couche;         //!< La couche traitée
+  const Couche *suivante; //!< La couche suivante (résolue), pour la résolution
+  size_t debut;           //!< Première position traitée
+  size_t fin;             //!< Fin (exclue) des positions traitées
+  uint64_t *enfants;      //!< Les clés des positions suivantes (énumération)
+  size_t nb;              //!< Leur nombre
+  size_t capacite;        //!< La taille allouée
+  bool ok;                //!< false en cas de problème
+} Tache;
+
+/**
+ * @brief Donne le masque du bas de chaque colonne.
+ *
+ * @return uint64_t le masque
+ */
+static uint64_t bas() {
+  uint64_t b = 0;
+  for (int c = 0; c < NB_COLONNE; c++)
+    b |= (uint64_t)1 << (c * BITS_COLONNE);
+  return b;
+}
+
+/**
+ * @brief Calcule la clé d'une position (même codage que clePosition).
+ *
+ * @param p la position
+ * @return uint64_t la clé
+ */
+static uint64_t clePos(const Position *p) {
+  return p->j1 | (p->masque + bas()) | ((p->n % 2) ? BIT_J2 : 0);
+}
+
+/**
+ * @brief Calcule la clé de la position symétrique.
+ *
+ * @param cle la clé
+ * @return uint64_t la clé de la symétrique
+ */
+static uint64_t miroir(uint64_t cle) {
+  uint64_t m = cle & BIT_J2;
+  for (int c = 0; c < NB_COLONNE; c++)
+    m |= ((cle >> (c * BITS_COLONNE)) & MASQUE_SEGMENT)
+         << ((NB_COLONNE - 1 - c) * BITS_COLONNE);
+  return m;
+}
+
+/**
+ * @brief Calcule la clé canonique d'une position (la plus petite de la
+ * sienne et de celle de sa symétrique).
+ *
+ * @param p la position
+ * @return uint64_t la clé canonique
+ */
+static uint64_t canonique(const Position *p) {
+  uint64_t cle = clePos(p), m = miroir(cle);
+  return (m < cle) ? m : cle;
+}
+
+/**
+ * @brief Retrouve une position à partir de sa clé.
+ *
+ * @param cle la clé
+ * @param p la position
+ */
+static void decoder(uint64_t cle, Position *p) {
+  p->j1 = p->masque = 0;
+  p->n = 0;
+  for (int c = 0; c < NB_COLONNE; c++) {
+    uint64_t segment = (cle >> (c * BITS_COLONNE)) & MASQUE_SEGMENT;
+    unsigned h = 63 - __builtin_clzll(segment); // la sentinelle
+    uint64_t jetons = ((uint64_t)1 << h) - 1;
+    p->masque |= jetons << (c * BITS_COLONNE);
+    p->j1 |= (segment & jetons) << (c * BITS_COLONNE);
+    p->n += h;
+  }
+}
+
+/**
+ * @brief Indique si des jetons contiennent 4 jetons alignés.
+ *
+ * @param jetons les jetons d'un joueur
+ * @return true s'il y a 4 jetons alignés
+ * @return false sinon
+ */
+static bool aligne(uint64_t jetons) {
+  // vertical, horizontal et les deux diagonales : le bit libre au-dessus de
+  // chaque colonne empêche de passer d'une colonne à l'autre
+  const unsigned d[4] = {1, BITS_COLONNE, BITS_COLONNE - 1, BITS_COLONNE + 1};
+  for (int i = 0; i < 4; i++) {
+    uint64_t m = jetons & (jetons >> d[i]);
+    if (m & (m >> 2 * d[i]))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Joue dans une colonne.
+ *
+ * @param p la position
+ * @param c la colonne
+ * @return int 0 si la colonne est pleine (rien n'est joué), 1 si le coup est
+ * joué, 2 s'il est gagnant
+ */
+static int jouerPos(Position *p, int c) {
+  uint64_t colonne = (((uint64_t)1 << NB_LIGNE) - 1) << (c * BITS_COLONNE);
+  uint64_t nouveau = (p->masque + ((uint64_t)1 << (c * BITS_COLONNE))) & colonne;
+  if (!nouveau)
+    return 0;
+  bool j1 = (p->n % 2 == 0);
+  if (j1)
+    p->j1 |= nouveau;
+  p->masque |= nouveau;
+  p->n++;
+  return aligne(j1 ? p->j1 : p->masque ^ p->j1) ? 2 : 1;
+}
+
+/**
+ * @brief Indique si les tables des finales sont possibles avec la géométrie
+ * courante : les positions y sont retrouvées à partir de leur clé, qui doit
+ * être exacte, et les alignements sont de 4 jetons.
+ *
+ * @return true si elles le sont
+ * @return false sinon (message d'erreur écrit)
+ */
+static bool geometrieTable() {
+  if (geometrie.cleExacte && NB_ALIGNE == 4)
+    return true;
+  fprintf(stderr, "Pas de table des finales pour ce plateau (%ux%u, %u)\n",
+          NB_LIGNE, NB_COLONNE, NB_ALIGNE);
+  return false;
+}
+
+/**
+ * @brief Compare deux clés (pour qsort).
+ *
+ * @param a la première clé
+ * @param b la seconde clé
+ * @return int le signe de a - b
+ */
+static int comparer(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Trie des clés et supprime les doublons.
+ *
+ * @param cles les clés
+ * @param nb leur nombre
+ * @return size_t le nombre de clés distinctes
+ */
+static size_t trier(uint64_t *cles, size_t nb) {
+  if (nb == 0)
+    return 0;
+  qsort(cles, nb, sizeof(uint64_t), &comparer);
+  size_t n = 1;
+  for (size_t i = 1; i < nb; i++)
+    if (cles[i] != cles[n - 1])
+      cles[n++] = cles[i];
+  return n;
+}
+
+/**
+ * @brief Cherche une clé dans une couche.
+ *
+ * @param c la couche
+ * @param cle la clé
+ * @return long l'indice de la clé, -1 si elle n'y est pas
+ */
+static long chercher(const Couche *c, uint64_t cle) {
+  size_t bas = 0, haut = c->nb;
+  while (bas < haut) {
+    size_t milieu = bas + (haut - bas) / 2;
+    if (c->cles[milieu] < cle)
+      bas = milieu + 1;
+    else
+      haut = milieu;
+  }
+  return (bas < c->nb && c->cles[bas] == cle) ? (long)bas : -1;
+}
+
+/**
+ * @brief Le corps des threads de l'énumération : calcule les positions non
+ * terminales qui suivent une part de la couche, triées et sans doublons.
+ *
+ * @param arg la tâche
+ * @return void* NULL
+ */
+static void *enumerer(void *arg) {
+  Tache *t = arg;
+  for (size_t i = t->debut; i < t->fin && t->ok; i++) {
+    Position p;
+    decoder(t->couche->cles[i], &p);
+    for (int c = 0; c < NB_COLONNE; c++) {
+      Position e = p;
+      if (jouerPos(&e, c) != 1 || e.n == NB_CASES)
+        continue; // colonne pleine ou position terminale
+      if (t->nb == t->capacite) {
+        size_t capacite = t->capacite ? 2 * t->capacite : 1024;
+        uint64_t *enfants = realloc(t->enfants, capacite * sizeof(uint64_t));
+        if (!enfants) {
+          t->ok = false;
+          break;
+        }
+        t->enfants = enfants;
+        t->capacite = capacite;
+      }
+      t->enfants[t->nb++] = canonique(&e);
+    }
+  }
+  t->nb = trier(t->enfants, t->nb);
+  return NULL;
+}
+
+/**
+ * @brief Le corps des threads de la résolution : calcule le résultat d'une
+ * part de la couche à partir de la couche suivante.
+ *
+ * @param arg la tâche
+ * @return void* NULL
+ */
+static void *resoudre(void *arg) {
+  Tache *t = arg;
+  for (size_t i = t->debut; i < t->fin; i++) {
+    Position p;
+    decoder(t->couche->cles[i], &p);
+    Resultat res = PERDU;
+    for (int c = 0; c < NB_COLONNE && res != GAGNE; c++) {
+      Position e = p;
+      int coup = jouerPos(&e, c);
+      if (coup == 0)
+        continue;
+      if (coup == 2) {
+        res = GAGNE;
+      } else if (e.n == NB_CASES) {
+        res = NUL; // plateau plein, et res valait PERDU ou NUL
+      } else {
+        long j = chercher(t->suivante, canonique(&e));
+        if (j == -1) {
+          t->ok = false;
+          return NULL;
+        }
+        Resultat adverse = t->suivante->valeurs[j];
+        if (adverse == PERDU)
+          res = GAGNE;
+        else if (adverse == NUL)
+          res = NUL;
+      }
+    }
+    t->couche->valeurs[i] = res;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Partage une couche entre des threads qui exécutent une fonction
+ * (dans le thread appelant si un thread ne peut pas être créé).
+ *
+ * @param taches les tâches, une par thread
+ * @param nbThreads le nombre de threads
+ * @param couche la couche
+ * @param suivante la couche suivante
+ * @param f la fonction
+ */
+static void partager(Tache *taches, unsigned nbThreads, Couche *couche,
+                     const Couche *suivante, void *(*f)(void *)) {
+  pthread_t threads[MAX_THREADS];
+  bool lance[MAX_THREADS];
+  for (unsigned i = 0; i < nbThreads; i++) {
+    taches[i] = (Tache){couche,
+                        suivante,
+                        couche->nb * i / nbThreads,
+                        couche->nb * (i + 1) / nbThreads,
+                        NULL,
+                        0,
+                        0,
+                        true};
+    lance[i] = (pthread_create(&threads[i], NULL, f, &taches[i]) == 0);
+    if (!lance[i])
+      f(&taches[i]);
+  }
+  for (unsigned i = 0; i < nbThreads; i++)
+    if (lance[i])
+      pthread_join(threads[i], NULL);
+}
+
+/**
+ * @brief Calcule la couche qui suit une couche : les positions non terminales
+ * atteintes en un coup.
+ *
+ * @param couche la couche
+ * @param suivante la couche calculée
+ * @param nbThreads le nombre de threads
+ * @return true en cas de succès
+ * @return false en cas de problème d'allocation
+ */
+static bool coucheSuivante(Couche *couche, Couche *suivante,
+                           unsigned nbThreads) {
+  Tache taches[MAX_THREADS];
+  partager(taches, nbThreads, couche, NULL, &enumerer);
+  bool ok = true;
+  size_t total = 0;
+  for (unsigned i = 0; i < nbThreads; i++) {
+    ok = ok && taches[i].ok;
+    total += taches[i].nb;
+  }
+  suivante->cles = ok ? malloc((total ? total : 1) * sizeof(uint64_t)) : NULL;
+  suivante->valeurs = NULL;
+  suivante->nb = 0;
+  if (suivante->cles) {
+    // fusion des parts triées
+    size_t pos[MAX_THREADS] = {0};
+    for (;;) {
+      int min = -1;
+      for (unsigned i = 0; i < nbThreads; i++)
+        if (pos[i] < taches[i].nb &&
+            (min == -1 ||
+             taches[i].enfants[pos[i]] < taches[min].enfants[pos[min]]))
+          min = i;
+      if (min == -1)
+        break;
+      uint64_t cle = taches[min].enfants[pos[min]++];
+      if (suivante->nb == 0 || suivante->cles[suivante->nb - 1] != cle)
+        suivante->cles[suivante->nb++] = cle;
+    }
+  } else {
+    ok = false;
+  }
+  for (unsigned i = 0; i < nbThreads; i++)
+    free(taches[i].enfants);
+  return ok;
+}
+
+/**
+ * @brief Donne le nom du fichier de sauvegarde d'une couche.
+ *
+ * @param nom le nom calculé
+ * @param taille la taille de nom
+ * @param chemin le fichier de la table
+ * @param n le nombre de jetons de la couche
+ */
+static void nomCouche(char *nom, size_t taille, const char *chemin,
+                      unsigned n) {
+  snprintf(nom, taille, "%s.couche%u", chemin, n);
+}
+
+/**
+ * @brief Sauvegarde une couche résolue (dans un fichier temporaire renommé
+ * ensuite, pour qu'une sauvegarde interrompue ne soit jamais reprise).
+ *
+ * @param chemin le fichier de la table
+ * @param n le nombre de jetons de la couche
+ * @param c la couche
+ * @return true en cas de succès
+ * @return false sinon
+ */
+static bool sauverCouche(const char *chemin, unsigned n, const Couche *c) {
+  char nom[4096], tmp[4100];
+  nomCouche(nom, sizeof(nom), chemin, n);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", nom);
+  FILE *f = fopen(tmp, "wb");
+  if (!f)
+    return false;
+  uint64_t nb = c->nb;
+  bool ok = fwrite("P4TC", 1, 4, f) == 4 && fwrite(&nb, sizeof(nb), 1, f) == 1 &&
+            fwrite(c->cles, sizeof(uint64_t), c->nb, f) == c->nb &&
+            fwrite(c->valeurs, 1, c->nb, f) == c->nb;
+  ok = (fclose(f) == 0) && ok;
+  return ok && rename(tmp, nom) == 0;
+}
+
+/**
+ * @brief Reprend une couche résolue lors d'une génération précédente, si elle
+ * a été sauvegardée et contient exactement les mêmes positions.
+ *
+ * @param chemin le fichier de la table
+ * @param n le nombre de jetons de la couche
+ * @param c la couche (ses résultats sont lus)
+ * @return true si la couche a été reprise
+ * @return false sinon
+ */
+static bool reprendreCouche(const char *chemin, unsigned n, Couche *c) {
+  char nom[4096], magie[4];
+  nomCouche(nom, sizeof(nom), chemin, n);
+  FILE *f = fopen(nom, "rb");
+  if (!f)
+    return false;
+  uint64_t nb;
+  bool ok = fread(magie, 1, 4, f) == 4 && memcmp(magie, "P4TC", 4) == 0 &&
+            fread(&nb, sizeof(nb), 1, f) == 1 && nb == c->nb;
+  uint64_t *cles = ok ? malloc((nb ? nb : 1) * sizeof(uint64_t)) : NULL;
+  ok = cles && fread(cles, sizeof(uint64_t), nb, f) == nb &&
+       memcmp(cles, c->cles, nb * sizeof(uint64_t)) == 0 &&
+       fread(c->valeurs, 1, nb, f) == nb;
+  free(cles);
+  fclose(f);
+  return ok;
+}
+
+/**
+ * @brief Ajoute un entier au flux des clés, 7 bits par octet.
+ *
+ * @param flux le flux (agrandi si nécessaire)
+ * @param taille sa taille
+ * @param capacite sa taille allouée
+ * @param v l'entier
+ * @return true en cas de succès
+ * @return false en cas de problème d'allocation
+ */
+static bool ecrireVarint(uint8_t **flux, size_t *taille, size_t *capacite,
+                         uint64_t v) {
+  if (*taille + 10 > *capacite) { // au plus 10 octets par entier
+    uint8_t *f = realloc(*flux, 2 * *capacite + 10);
+    if (!f)
+      return false;
+    *flux = f;
+    *capacite = 2 * *capacite + 10;
+  }
+  while (v >= 0x80) {
+    (*flux)[(*taille)++] = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  (*flux)[(*taille)++] = v;
+  return true;
+}
+
+/**
+ * @brief Lit un entier du flux des clés.
+ *
+ * @param p la position dans le flux, avancée après l'entier
+ * @return uint64_t l'entier
+ */
+static uint64_t lireVarint(const uint8_t **p) {
+  uint64_t v = 0;
+  for (unsigned d = 0;; d += 7) {
+    uint8_t o = *(*p)++;
+    v |= (uint64_t)(o & 0x7F) << d;
+    if (!(o & 0x80))
+      return v;
+  }
+}
+
+/**
+ * @brief Écrit la table : les couches, fusionnées dans l'ordre des clés,
+ * compressées (voir le début du fichier).
+ *
+ * @param chemin le fichier
+ * @param couches les couches, indicées par leur nombre de jetons
+ * @param jetonsMin la première couche
+ * @return true en cas de succès
+ * @return false sinon
+ */
+static bool ecrireTable(const char *chemin, Couche *couches,
+                        unsigned jetonsMin) {
+  Entete e = {{'P', '4', 'T', 'F'}, VERSION, NB_LIGNE, NB_COLONNE, jetonsMin,
+              TAILLE_BLOC,          0,       0,        0};
+  for (unsigned n = jetonsMin; n < NB_CASES; n++)
+    e.nb += couches[n].nb;
+  e.nbBlocs = (e.nb + TAILLE_BLOC - 1) / TAILLE_BLOC;
+  Bloc *blocs = malloc((e.nbBlocs ? e.nbBlocs : 1) * sizeof(Bloc));
+  size_t taille = 0, capacite = e.nb + 16;
+  uint8_t *flux = malloc(capacite);
+  uint8_t *valeurs = calloc((e.nb + 3) / 4 + 1, 1);
+  bool ok = blocs && flux && valeurs;
+  size_t pos[NB_CASES_MAX + 1] = {0};
+  uint64_t precedente = 0;
+  for (uint64_t i = 0; ok && i < e.nb; i++) {
+    unsigned min = NB_CASES;
+    for (unsigned n = jetonsMin; n < NB_CASES; n++)
+      if (pos[n] < couches[n].nb &&
+          (min == NB_CASES ||
+           couches[n].cles[pos[n]] < couches[min].cles[pos[min]]))
+        min = n;
+    uint64_t cle = couches[min].cles[pos[min]];
+    valeurs[i / 4] |= couches[min].valeurs[pos[min]] << (2 * (i % 4));
+    pos[min]++;
+    if (i % TAILLE_BLOC == 0)
+      blocs[i / TAILLE_BLOC] = (Bloc){cle, taille};
+    else
+      ok = ecrireVarint(&flux, &taille, &capacite, cle - precedente);
+    precedente = cle;
+  }
+  e.tailleFlux = taille;
+
+  char tmp[4100];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", chemin);
+  FILE *f = ok ? fopen(tmp, "wb") : NULL;
+  if (f) {
+    ok = fwrite(&e, sizeof(e), 1, f) == 1 &&
+         fwrite(blocs, sizeof(Bloc), e.nbBlocs, f) == e.nbBlocs &&
+         fwrite(flux, 1, taille, f) == taille &&
+         fwrite(valeurs, 1, (e.nb + 3) / 4, f) == (e.nb + 3) / 4;
+    ok = (fclose(f) == 0) && ok && rename(tmp, chemin) == 0;
+  } else {
+    ok = false;
+  }
+  free(blocs);
+  free(flux);
+  free(valeurs);
+  return ok;
+}
+
+/**
+ * @brief Génère la table des finales : toutes les positions non terminales
+ * atteignables depuis une position de départ et ayant au moins jetonsMin
+ * jetons, avec leur résultat exact. Le nombre de positions croît très vite
+ * avec le nombre de cases vides : la position de départ doit être proche de la
+ * fin de partie. Les couches résolues sont sauvegardées à côté du fichier
+ * (chemin.coucheN) et reprises si la génération est relancée ; elles sont
+ * supprimées une fois la table écrite.
+ *
+ * @param coups les colonnes jouées (de 1 à 7) depuis le plateau vide
+ * @param jetonsMin le nombre minimal de jetons des positions de la table
+ * @param nbThreads le nombre de threads (1 à MAX_THREADS)
+ * @param chemin le fichier de la table
+ * @param progression où écrire l'avancement, NULL pour rien écrire
+ * @return true en cas de succès
+ * @return false sinon (coups invalides, problème d'allocation ou d'écriture)
+ */
+bool genererTableFinale(const char *coups, unsigned jetonsMin,
+                        unsigned nbThreads, const char *chemin,
+                        FILE *progression) {
+  assert(coups && chemin);
+  if (!geometrieTable())
+    return false;
+  if (nbThreads < 1)
+    nbThreads = 1;
+  if (nbThreads > MAX_THREADS)
+    nbThreads = MAX_THREADS;
+  Position depart = {0, 0, 0};
+  for (const char *c = coups; *c; c++) {
+    if (*c < '1' || *c >= '1' + NB_COLONNE || jouerPos(&depart, *c - '1') != 1 ||
+        depart.n == NB_CASES) {
+      fprintf(stderr, "Position de départ invalide ou terminale : %s\n", coups);
+      return false;
+    }
+  }
+
+  Couche couches[NB_CASES_MAX + 1];
+  memset(couches, 0, sizeof(couches));
+  uint64_t cle = canonique(&depart);
+  couches[depart.n].cles = malloc(sizeof(uint64_t));
+  bool ok = couches[depart.n].cles != NULL;
+  if (ok) {
+    couches[depart.n].cles[0] = cle;
+    couches[depart.n].nb = 1;
+  }
+  if (jetonsMin < depart.n)
+    jetonsMin = depart.n;
+
+  // énumération : seules les couches de la table sont gardées
+  for (unsigned n = depart.n; ok && n + 1 < NB_CASES; n++) {
+    ok = coucheSuivante(&couches[n], &couches[n + 1], nbThreads);
+    if (progression)
+      fprintf(progression, "couche %2u : %zu positions\n", n + 1,
+              couches[n + 1].nb);
+    if (n < jetonsMin) {
+      free(couches[n].cles);
+      couches[n].cles = NULL;
+      couches[n].nb = 0;
+    }
+  }
+
+  // résolution à rebours
+  for (unsigned n = NB_CASES - 1; ok && n >= jetonsMin; n--) {
+    Couche *c = &couches[n];
+    c->valeurs = malloc(c->nb ? c->nb : 1);
+    ok = (c->valeurs != NULL);
+    if (!ok)
+      break;
+    bool repris = reprendreCouche(chemin, n, c);
+    if (!repris) {
+      Tache taches[MAX_THREADS];
+      partager(taches, nbThreads, c, &couches[n + 1], &resoudre);
+      for (unsigned i = 0; i < nbThreads; i++)
+        ok = ok && taches[i].ok;
+      if (ok && !sauverCouche(chemin, n, c) && progression)
+        fprintf(progression, "couche %2u non sauvegardée\n", n);
+    }
+    if (progression)
+      fprintf(progression, "couche %2u %s\n", n, repris ? "reprise" : "résolue");
+    if (n == 0)
+      break;
+  }
+
+  if (ok)
+    ok = ecrireTable(chemin, couches, jetonsMin);
+  if (ok) {
+    for (unsigned n = jetonsMin; n < NB_CASES; n++) {
+      char nom[4096];
+      nomCouche(nom, sizeof(nom), chemin, n);
+      remove(nom);
+    }
+  } else {
+    fprintf(stderr, "Échec de la génération de la table %s\n", chemin);
+  }
+  for (unsigned n = 0; n <= NB_CASES; n++) {
+    free(couches[n].cles);
+    free(couches[n].valeurs);
+  }
+  return ok;
+}
+
+/**
+ * @brief Ouvre une table des finales en la projetant en mémoire.
+ *
+ * @param chemin le fichier
+ * @return TableFinale* la table, NULL si elle ne peut pas être ouverte ou n'est
+ * pas valide pour ce plateau
+ */
+TableFinale *ouvrirTableFinale(const char *chemin) {
+  assert(chemin);
+  if (!geometrieTable())
+    return NULL;
+  int fd = open(chemin, O_RDONLY);
+  if (fd == -1) {
+    perror("Impossible d'ouvrir la table des finales");
+    return NULL;
+  }
+  struct stat s;
+  void *donnees = MAP_FAILED;
+  if (fstat(fd, &s) == 0 && (size_t)s.st_size >= sizeof(Entete))
+    donnees = mmap(NULL, s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (donnees == MAP_FAILED) {
+    fprintf(stderr, "Table des finales illisible : %s\n", chemin);
+    return NULL;
+  }
+  const Entete *e = donnees;
+  size_t attendue = sizeof(Entete) + e->nbBlocs * sizeof(Bloc) + e->tailleFlux +
+                    (e->nb + 3) / 4;
+  if (memcmp(e->magie, "P4TF", 4) != 0 || e->version != VERSION ||
+      e->lignes != NB_LIGNE || e->colonnes != NB_COLONNE ||
+      e->tailleBloc != TAILLE_BLOC ||
+      e->nbBlocs != (e->nb + TAILLE_BLOC - 1) / TAILLE_BLOC ||
+      attendue != (size_t)s.st_size) {
+    fprintf(stderr, "Table des finales invalide : %s\n", chemin);
+    munmap(donnees, s.st_size);
+    return NULL;
+  }
+  // sondée au hasard : des pages énormes si le système de fichiers en donne
+  madvise(donnees, s.st_size, MADV_HUGEPAGE);
+  TableFinale *t = malloc(sizeof(TableFinale));
+  if (!t) {
+    perror("Problème d'allocation dans ouvrirTableFinale.");
+    munmap(donnees, s.st_size);
+    return NULL;
+  }
+  t->donnees = donnees;
+  t->taille = s.st_size;
+  t->entete = e;
+  t->blocs = (const Bloc *)(e + 1);
+  t->flux = (const uint8_t *)(t->blocs + e->nbBlocs);
+  t->valeurs = t->flux + e->tailleFlux;
+  return t;
+}
+
+/**
+ * @brief Cherche le résultat d'une position dans la table.
+ *
+ * @param t la table
+ * @param cle la clé canonique de la position (voir cleCanonique)
+ * @return Resultat le résultat pour le joueur qui doit jouer, INCONNU si la
+ * position n'est pas dans la table
+ */
+Resultat sonderTableFinale(TableFinale *t, uint64_t cle) {
+  assert(t);
+  const Entete *e = t->entete;
+  if (e->nb == 0 || cle < t->blocs[0].premiere)
+    return INCONNU;
+  // le dernier bloc commençant avant la clé
+  uint64_t bas = 0, haut = e->nbBlocs - 1;
+  while (bas < haut) {
+    uint64_t milieu = bas + (haut - bas + 1) / 2;
+    if (t->blocs[milieu].premiere <= cle)
+      bas = milieu;
+    else
+      haut = milieu - 1;
+  }
+  uint64_t rang = bas * TAILLE_BLOC;
+  uint64_t fin = (rang + TAILLE_BLOC < e->nb) ? rang + TAILLE_BLOC : e->nb;
+  uint64_t k = t->blocs[bas].premiere;
+  const uint8_t *p = t->flux + t->blocs[bas].decalage;
+  for (;;) {
+    if (k == cle)
+      return (t->valeurs[rang / 4] >> (2 * (rang % 4))) & 3;
+    if (k > cle || ++rang == fin)
+      return INCONNU;
+    k += lireVarint(&p);
+  }
+}
+
+/**
+ * @brief Donne le nombre minimal de jetons des positions de la table.
+ *
+ * @param t la table
+ * @return unsigned le nombre de jetons
+ */
+unsigned jetonsTableFinale(TableFinale *t) {
+  assert(t);
+  return t->entete->jetonsMin;
+}
+
+/**
+ * @brief Donne le nombre de positions de la table.
+ *
+ * @param t la table
+ * @return unsigned long long le nombre de positions
+ */
+unsigned long long tailleTableFinale(TableFinale *t) {
+  assert(t);
+  return t->entete->nb;
+}
+
+/**
+ * @brief Donne une empreinte de la table, tirée de son en-tête et de ses clés
+ * extrêmes : deux tables différentes ont presque sûrement des empreintes
+ * différentes.
+ *
+ * @param t la table
+ * @return uint64_t l'empreinte, jamais 0
+ */
+uint64_t empreinteTableFinale(TableFinale *t) {
+  assert(t);
+  const Entete *e = t->entete;
+  uint64_t mots[] = {e->jetonsMin, e->nb, e->tailleFlux,
+                     e->nb ? t->blocs[0].premiere : 0,
+                     e->nb ? t->blocs[e->nbBlocs - 1].premiere : 0};
+  uint64_t h = 0;
+  for (unsigned i = 0; i < sizeof(mots) / sizeof(mots[0]); i++) {
+    h = (h ^ mots[i]) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+  }
+  return h | 1;
+}
+
+/**
+ * @brief Ferme une table des finales.
+ *
+ * @param t la table
+ */
+void fermerTableFinale(TableFinale *t) {
+  if (!t)
+    return;
+  munmap(t->donnees, t->taille);
+  free(t);
+}
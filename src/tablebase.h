@@ -0,0 +1,54 @@
+/**
+ * @file tablebase.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de la table des finales : le résultat exact de toutes les
+ * positions atteignables depuis une position de départ, à partir d'un nombre
+ * de jetons donné.
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef TABLEBASE_H
+/**
+ * @def TABLEBASE_H
+ * @brief la garde
+ */
+#define TABLEBASE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @enum resultat_
+ * @brief Le résultat exact d'une position pour le joueur qui doit jouer.
+ * @typedef Resultat
+ * @brief Renommer resultat_.
+ */
+typedef enum resultat_ {
+  INCONNU, //!< La position n'est pas dans la table
+  PERDU,   //!< Le joueur qui doit jouer perd
+  NUL,     //!< Partie nulle
+  GAGNE    //!< Le joueur qui doit jouer gagne
+} Resultat;
+
+/**
+ * @typedef TableFinale
+ * @brief Renommer tableFinale_ (structure opaque).
+ */
+typedef struct tableFinale_ TableFinale;
+
+bool genererTableFinale(const char *, unsigned, unsigned, const char *,
+                        FILE *);
+TableFinale *ouvrirTableFinale(const char *);
+Resultat sonderTableFinale(TableFinale *, uint64_t);
+unsigned jetonsTableFinale(TableFinale *);
+unsigned long long tailleTableFinale(TableFinale *);
+uint64_t empreinteTableFinale(TableFinale *);
+void fermerTableFinale(TableFinale *);
+
+#endif
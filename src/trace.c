@@ -0,0 +1,244 @@
+/**
+ * @file trace.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Enregistrement de traces au format Chrome : chaque thread écrit ses
+ * événements dans son propre tampon circulaire, sans verrou, et les tampons
+ * sont écrits dans le fichier seulement à la fin de la trace, pour ne pas
+ * fausser les durées mesurées.
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "trace.h"
+#include "commun.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @def TAILLE_TAMPON
+ * @brief nombre d'événements gardés par thread (une puissance de 2) : au-delà,
+ * les plus anciens sont remplacés
+ */
+#define TAILLE_TAMPON (1 << 14)
+
+/**
+ * @struct evenement_
+ * @brief Un événement : une durée nommée.
+ * @typedef Evenement
+ * @brief Renommer evenement_.
+ */
+typedef struct evenement_ {
+  const char *nom; //!< Le nom (une chaîne constante, qui n'est pas copiée)
+  uint64_t debut;  //!< Le début en ns
+  uint64_t duree;  //!< La durée en ns
+  int valeur;      //!< Une valeur associée, SANS_VALEUR si aucune
+} Evenement;
+
+/**
+ * @struct tampon_
+ * @brief Le tampon circulaire des événements d'un thread. Un tampon libéré
+ * par un thread terminé est repris par le prochain thread créé, si bien que
+ * les threads de réflexion successifs partagent le même.
+ * @typedef Tampon
+ * @brief Renommer tampon_.
+ */
+typedef struct tampon_ {
+  Evenement evenements[TAILLE_TAMPON]; //!< Les événements
+  unsigned long long nb;               //!< Nombre d'événements écrits
+  unsigned numero;                     //!< Le numéro du thread dans la trace
+  atomic_bool utilise;                 //!< true si un thread l'utilise
+  struct tampon_ *suivant;             //!< Le tampon suivant dans la liste
+} Tampon;
+
+/**
+ * @brief true si une trace est en cours.
+ */
+static atomic_bool actif = false;
+
+/**
+ * @brief Le fichier où écrire la trace.
+ */
+static char *chemin = NULL;
+
+/**
+ * @brief L'instant de démarrage de la trace (ns).
+ */
+static uint64_t origine;
+
+/**
+ * @brief La liste de tous les tampons créés (on ajoute en tête, sans verrou).
+ */
+static _Atomic(Tampon *) tampons = NULL;
+
+/**
+ * @brief Le nombre de tampons créés.
+ */
+static atomic_uint nbTampons = 0;
+
+/**
+ * @brief Le tampon du thread courant.
+ */
+static _Thread_local Tampon *tampon = NULL;
+
+/**
+ * @brief La clé permettant de libérer le tampon d'un thread qui se termine.
+ */
+static pthread_key_t cle;
+
+/**
+ * @brief Pour créer la clé une seule fois.
+ */
+static pthread_once_t cleCreee = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Rend le tampon d'un thread qui se termine à la liste des tampons
+ * libres (ses événements sont gardés).
+ *
+ * @param t le tampon
+ */
+static void libererTampon(void *t) {
+  atomic_store(&((Tampon *)t)->utilise, false);
+}
+
+/**
+ * @brief Crée la clé des tampons.
+ */
+static void creerCle() { pthread_key_create(&cle, &libererTampon); }
+
+/**
+ * @brief Donne le tampon du thread courant : un tampon libre s'il y en a un,
+ * sinon un nouveau, ajouté à la liste.
+ *
+ * @return Tampon* le tampon, NULL en cas de problème d'allocation
+ */
+static Tampon *tamponCourant() {
+  if (tampon)
+    return tampon;
+  pthread_once(&cleCreee, &creerCle);
+  for (Tampon *t = atomic_load(&tampons); t; t = t->suivant) {
+    bool libre = false;
+    if (atomic_compare_exchange_strong(&t->utilise, &libre, true)) {
+      tampon = t;
+      break;
+    }
+  }
+  if (!tampon) {
+    Tampon *t = malloc(sizeof(Tampon));
+    if (!t) {
+      perror("Problème d'allocation dans tamponCourant.");
+      return NULL;
+    }
+    t->nb = 0;
+    t->numero = atomic_fetch_add(&nbTampons, 1) + 1;
+    atomic_init(&t->utilise, true);
+    t->suivant = atomic_load(&tampons);
+    while (!atomic_compare_exchange_weak(&tampons, &t->suivant, t))
+      ;
+    tampon = t;
+  }
+  pthread_setspecific(cle, tampon);
+  return tampon;
+}
+
+/**
+ * @brief Démarre une trace. Les événements seront écrits dans le fichier par
+ * terminerTrace, appelée au plus tard à la fin du programme.
+ *
+ * @param fichier le fichier où écrire la trace
+ * @return true si la trace a démarré
+ * @return false sinon (trace déjà en cours ou problème d'allocation)
+ */
+bool demarrerTrace(const char *fichier) {
+  assert(fichier);
+  if (atomic_load(&actif))
+    return false;
+  chemin = malloc(strlen(fichier) + 1);
+  if (!chemin) {
+    perror("Problème d'allocation dans demarrerTrace.");
+    return false;
+  }
+  strcpy(chemin, fichier);
+  static bool enregistree = false;
+  if (!enregistree)
+    enregistree = (atexit(&terminerTrace) == 0);
+  for (Tampon *t = atomic_load(&tampons); t; t = t->suivant)
+    t->nb = 0; // les événements d'une trace précédente
+  origine = maintenant();
+  atomic_store(&actif, true);
+  return true;
+}
+
+/**
+ * @brief Marque le début d'un événement.
+ *
+ * @return uint64_t l'instant du début, 0 si aucune trace n'est en cours
+ */
+uint64_t debutTrace() {
+  if (!atomic_load_explicit(&actif, memory_order_relaxed))
+    return 0;
+  return maintenant();
+}
+
+/**
+ * @brief Enregistre un événement dans le tampon du thread courant.
+ *
+ * @param nom le nom de l'événement (une chaîne constante)
+ * @param debut l'instant du début, donné par debutTrace
+ * @param valeur une valeur associée, SANS_VALEUR si aucune
+ */
+void finTrace(const char *nom, uint64_t debut, int valeur) {
+  if (!debut || !atomic_load_explicit(&actif, memory_order_relaxed))
+    return;
+  uint64_t fin = maintenant();
+  Tampon *t = tamponCourant();
+  if (!t)
+    return;
+  Evenement *e = &t->evenements[t->nb++ % TAILLE_TAMPON];
+  *e = (Evenement){nom, debut, fin - debut, valeur};
+}
+
+/**
+ * @brief Termine la trace en cours et l'écrit dans son fichier. Les autres
+ * threads ne doivent plus enregistrer d'événements (ils sont terminés).
+ */
+void terminerTrace() {
+  if (!atomic_exchange(&actif, false))
+    return;
+  FILE *f = fopen(chemin, "w");
+  if (!f) {
+    perror("Impossible d'écrire la trace");
+  } else {
+    fprintf(f, "{\"traceEvents\":[");
+    bool premier = true;
+    for (Tampon *t = atomic_load(&tampons); t; t = t->suivant) {
+      unsigned long long i = (t->nb > TAILLE_TAMPON) ? t->nb - TAILLE_TAMPON : 0;
+      for (; i < t->nb; i++) {
+        Evenement *e = &t->evenements[i % TAILLE_TAMPON];
+        if (e->debut < origine)
+          continue;
+        fprintf(f,
+                "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                "\"ts\":%.3f,\"dur\":%.3f",
+                premier ? "" : ",", e->nom, t->numero,
+                (e->debut - origine) / 1e3, e->duree / 1e3);
+        if (e->valeur != SANS_VALEUR)
+          fprintf(f, ",\"args\":{\"valeur\":%d}", e->valeur);
+        fprintf(f, "}");
+        premier = false;
+      }
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+  }
+  free(chemin);
+  chemin = NULL;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file trace.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de l'enregistrement de traces au format Chrome (à ouvrir
+ * dans chrome://tracing ou Perfetto).
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef TRACE_H
+/**
+ * @def TRACE_H
+ * @brief la garde
+ */
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @def SANS_VALEUR
+ * @brief la valeur d'un événement qui n'en a pas
+ */
+#define SANS_VALEUR -1
+
+bool demarrerTrace(const char *);
+uint64_t debutTrace();
+void finTrace(const char *, uint64_t, int);
+void terminerTrace();
+
+#endif
@@ -0,0 +1,494 @@
+/**
+ * @file transposition.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Table de transposition : garde le résultat des positions déjà
+ * calculées par minimax, pour ne pas recalculer une position atteinte par un
+ * autre ordre de coups.
+ *
+ * Les entrées sont compressées sur 8 octets et rangées par cases de 64
+ * octets, alignées sur les lignes de cache : une consultation ne lit qu'une
+ * ligne, que minimax demande au processeur de charger (prefetch) dès qu'un
+ * coup est joué, avant de descendre dans la position. Une position ne peut
+ * être rangée que dans sa case ; quand la case est pleine, l'entrée la moins
+ * utile (la moins profonde, les plus anciennes d'abord) est remplacée.
+ *
+ * Les entrées sont allouées par allouerPages (memoire.h) : pages énormes si
+ * possible, et mise à zéro répartie entre les processeurs.
+ *
+ * Une table peut être partagée par tous les processus d'une machine : elle
+ * est alors un segment de mémoire partagée nommé, précédé d'un en-tête (taille
+ * et génération communes). Il n'y a aucun verrou : une entrée est lue et
+ * écrite d'un seul accès atomique de 8 octets, si bien qu'un processus ne voit
+ * jamais une entrée à moitié écrite par un autre (au pire, deux écritures
+ * simultanées dans une case en perdent une, comme un remplacement). Une table
+ * partagée n'est jamais vidée, et chaque processus mélange ses clés à un sel
+ * (voir salerTransposition) : ceux dont les résultats ne sont pas comparables
+ * (une autre table des finales, par exemple) ne confondent pas leurs entrées.
+ * @version 0.1
+ * @date 2023-02-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "transposition.h"
+#include "memoire.h"
+#include "puissance_quatre.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @def TAILLE_LIGNE
+ * @brief la taille d'une ligne de cache, en octets
+ */
+#define TAILLE_LIGNE 64
+
+/**
+ * @def ENTREES_CASE
+ * @brief le nombre d'entrées d'une case (une ligne de cache)
+ */
+#define ENTREES_CASE (TAILLE_LIGNE / sizeof(EntreeTransposition))
+
+/**
+ * @def COUP_AUCUN
+ * @brief le coup stocké quand il n'y en a pas (-1)
+ */
+#define COUP_AUCUN 15
+
+/**
+ * @def NB_GENERATIONS
+ * @brief le nombre de générations distinguées (voir vieillirTransposition)
+ */
+#define NB_GENERATIONS 4
+
+/**
+ * @def VERSION_PARTAGE
+ * @brief la version du format d'une table partagée
+ */
+#define VERSION_PARTAGE 2
+
+/**
+ * @def ATTENTE_MAX
+ * @brief le nombre maximal d'attentes de 1 ms pendant que le créateur d'une
+ * table partagée écrit son en-tête
+ */
+#define ATTENTE_MAX 1000
+
+/**
+ * @struct entreeTransposition_
+ * @brief Une entrée de la table, sur 8 octets.
+ * @typedef EntreeTransposition
+ * @brief Renommer entreeTransposition_.
+ */
+typedef struct entreeTransposition_ {
+  uint32_t verification;    //!< Les bits de la clé qui ne donnent pas la case
+  int16_t valeur;           //!< La valeur pour le joueur courant
+  unsigned char profondeur; //!< La profondeur de la recherche
+  unsigned coup : 4;        //!< Le meilleur coup, COUP_AUCUN si aucun
+  unsigned borne : 2;       //!< La nature de la valeur + 1, 0 si libre
+  unsigned generation : 2;  //!< La génération du stockage
+} EntreeTransposition;
+
+_Static_assert(sizeof(EntreeTransposition) == 8,
+               "une entrée de la table doit tenir sur 8 octets");
+
+/**
+ * @struct enteteTransposition_
+ * @brief Ce que les processus qui partagent une table ont en commun, au début
+ * du segment (une ligne de cache).
+ * @typedef EnteteTransposition
+ * @brief Renommer enteteTransposition_.
+ */
+typedef struct enteteTransposition_ {
+  char magie[4];          //!< "P4TT"
+  uint32_t version;       //!< VERSION_PARTAGE
+  uint64_t nbCases;       //!< Le nombre de cases (puissance de 2)
+  uint32_t plateau;       //!< La géométrie des positions (CODE_GEOMETRIE)
+  atomic_uint generation; //!< La génération courante
+  atomic_bool prete;      //!< true quand le créateur a écrit l'en-tête
+} EnteteTransposition;
+
+_Static_assert(sizeof(EnteteTransposition) <= TAILLE_LIGNE,
+               "l'en-tête d'une table partagée tient sur une ligne");
+
+/**
+ * @struct transposition_
+ * @brief Une table de hachage par cases : chaque position a une case de
+ * ENTREES_CASE entrées, où elle peut occuper n'importe quelle entrée. Les
+ * entrées sont manipulées comme des mots de 8 octets (voir lire et ecrire).
+ */
+struct transposition_ {
+  uint64_t *entrees;           //!< Les entrées, alignées sur une ligne
+  unsigned long masque;        //!< Nombre de cases - 1 (puissance de 2)
+  EnteteTransposition *entete; //!< L'en-tête (locale si non partagée)
+  EnteteTransposition locale;  //!< L'en-tête d'une table non partagée
+  void *memoire;               //!< La mémoire allouée ou projetée
+  size_t octets;               //!< Sa taille
+  char *nom;                   //!< Le nom du segment partagé, NULL si aucun
+  ModePages mode;              //!< Les pages obtenues pour les entrées
+  uint64_t sel;                //!< Mélangé aux clés (voir salerTransposition)
+};
+
+/**
+ * @brief Lit une entrée d'un seul accès.
+ *
+ * @param mot l'entrée dans la table
+ * @return EntreeTransposition sa copie
+ */
+static EntreeTransposition lire(uint64_t *mot) {
+  uint64_t m = __atomic_load_n(mot, __ATOMIC_RELAXED);
+  EntreeTransposition e;
+  memcpy(&e, &m, sizeof(e));
+  return e;
+}
+
+/**
+ * @brief Écrit une entrée d'un seul accès.
+ *
+ * @param mot l'entrée dans la table
+ * @param e sa nouvelle valeur
+ */
+static void ecrire(uint64_t *mot, EntreeTransposition e) {
+  uint64_t m;
+  memcpy(&m, &e, sizeof(m));
+  __atomic_store_n(mot, m, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Mélange une clé : la case est donnée par les bits hauts du mélange,
+ * la vérification par les bits bas. Le mélange étant une bijection, deux
+ * positions ne se confondent que si les deux coïncident.
+ *
+ * @param cle la clé
+ * @return uint64_t la clé mélangée
+ */
+static uint64_t melanger(uint64_t cle) {
+  return (cle ^ (cle >> 29)) * 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * @brief Calcule la case d'une clé mélangée.
+ *
+ * @param table la table
+ * @param h la clé mélangée
+ * @return uint64_t* la première entrée de la case
+ */
+static uint64_t *caseCle(Transposition *table, uint64_t h) {
+  return &table->entrees[((h >> 32) & table->masque) * ENTREES_CASE];
+}
+
+/**
+ * @brief Calcule le nombre de cases d'une table.
+ *
+ * @param nbEntrees le nombre d'entrées souhaité
+ * @return unsigned long la plus grande puissance de 2 de cases qui ne dépasse
+ * pas nbEntrees (au moins une case)
+ */
+static unsigned long nombreCases(unsigned long nbEntrees) {
+  unsigned long n = 1;
+  while (n * 2 * ENTREES_CASE <= nbEntrees)
+    n *= 2;
+  return n;
+}
+
+/**
+ * @brief Crée une table de transposition vide.
+ *
+ * @param nbEntrees le nombre d'entrées, arrondi au multiple de ENTREES_CASE
+ * inférieur dont le quotient est une puissance de 2 (au moins une case)
+ * @return Transposition* la table, NULL en cas de problème d'allocation
+ */
+Transposition *makeTransposition(unsigned long nbEntrees) {
+  assert(nbEntrees > 0);
+  Transposition *table = malloc(sizeof(Transposition));
+  if (!table) {
+    perror("Problème d'allocation dans makeTransposition.");
+    return NULL;
+  }
+  unsigned long n = nombreCases(nbEntrees);
+  table->octets = n * TAILLE_LIGNE;
+  table->memoire = allouerPages(table->octets, threadsPages(), &table->mode);
+  if (!table->memoire) {
+    free(table);
+    return NULL;
+  }
+  table->entrees = table->memoire;
+  table->masque = n - 1;
+  table->nom = NULL;
+  table->sel = 0;
+  table->entete = &table->locale;
+  table->locale.nbCases = n;
+  atomic_init(&table->locale.generation, 0);
+  return table;
+}
+
+/**
+ * @brief Ouvre la table partagée de ce nom, ou la crée vide si aucun processus
+ * ne l'a encore fait. Une table existante garde la taille que lui a donnée
+ * son créateur.
+ *
+ * @param nom le nom du segment de mémoire partagée ("/nom", voir shm_open)
+ * @param nbEntrees le nombre d'entrées d'une table créée (voir
+ * makeTransposition)
+ * @return Transposition* la table, NULL si elle ne peut être ni ouverte ni
+ * créée
+ */
+Transposition *makeTranspositionPartagee(const char *nom,
+                                         unsigned long nbEntrees) {
+  assert(nom);
+  assert(nbEntrees > 0);
+  Transposition *table = malloc(sizeof(Transposition));
+  char *copie = malloc(strlen(nom) + 1);
+  if (!table || !copie) {
+    perror("Problème d'allocation dans makeTranspositionPartagee.");
+    free(table);
+    free(copie);
+    return NULL;
+  }
+  unsigned long n = nombreCases(nbEntrees);
+  bool creee;
+  table->octets = TAILLE_LIGNE + n * TAILLE_LIGNE;
+  table->memoire =
+      projeterPagesPartagees(nom, &table->octets, &creee, &table->mode);
+  EnteteTransposition *e = table->memoire;
+  if (e && creee) {
+    memcpy(e->magie, "P4TT", 4);
+    e->version = VERSION_PARTAGE;
+    e->nbCases = n;
+    e->plateau = CODE_GEOMETRIE;
+    atomic_init(&e->generation, 0);
+    atomic_store_explicit(&e->prete, true, memory_order_release);
+  }
+  for (int i = 0; e && !creee && i < ATTENTE_MAX &&
+                  !atomic_load_explicit(&e->prete, memory_order_acquire);
+       i++)
+    nanosleep(&(struct timespec){0, 1000000}, NULL);
+  if (e && (!atomic_load_explicit(&e->prete, memory_order_acquire) ||
+            memcmp(e->magie, "P4TT", 4) != 0 ||
+            e->version != VERSION_PARTAGE || e->plateau != CODE_GEOMETRIE ||
+            e->nbCases == 0 ||
+            (e->nbCases & (e->nbCases - 1)) != 0 ||
+            TAILLE_LIGNE + e->nbCases * TAILLE_LIGNE > table->octets)) {
+    fprintf(stderr, "Table de transposition partagée invalide : %s\n", nom);
+    libererPages(table->memoire, table->octets);
+    e = NULL;
+  }
+  if (!e) {
+    free(table);
+    free(copie);
+    return NULL;
+  }
+  strcpy(copie, nom);
+  table->nom = copie;
+  table->sel = 0;
+  table->entete = e;
+  table->entrees = (uint64_t *)((char *)e + TAILLE_LIGNE);
+  table->masque = e->nbCases - 1;
+  return table;
+}
+
+/**
+ * @brief Supprime le nom d'une table partagée : les processus qui l'ont
+ * ouverte la gardent, le prochain makeTranspositionPartagee en crée une
+ * nouvelle.
+ *
+ * @param nom le nom du segment de mémoire partagée
+ * @return true si la table existait
+ * @return false sinon
+ */
+bool supprimerTranspositionPartagee(const char *nom) {
+  assert(nom);
+  return supprimerPagesPartagees(nom);
+}
+
+/**
+ * @brief Donne le nom d'une table partagée.
+ *
+ * @param table la table
+ * @return const char* le nom de son segment, NULL si elle n'est pas partagée
+ */
+const char *nomTransposition(Transposition *table) {
+  assert(table);
+  return table->nom;
+}
+
+/**
+ * @brief Donne la taille d'une table.
+ *
+ * @param table la table
+ * @return unsigned long long la taille des entrées en octets
+ */
+unsigned long long octetsTransposition(Transposition *table) {
+  assert(table);
+  return (table->masque + 1ULL) * TAILLE_LIGNE;
+}
+
+/**
+ * @brief Donne les pages obtenues pour une table (voir memoire.h).
+ *
+ * @param table la table
+ * @return ModePages le mode des pages
+ */
+ModePages modeTransposition(Transposition *table) {
+  assert(table);
+  return table->mode;
+}
+
+/**
+ * @brief Donne le sel mélangé aux clés des positions par ce processus : deux
+ * processus qui partagent une table ne voient que les entrées de même sel.
+ * Les entrées rangées avec un autre sel restent, et seront remplacées comme
+ * les autres.
+ *
+ * @param table la table
+ * @param sel le sel, 0 pour garder les clés
+ */
+void salerTransposition(Transposition *table, uint64_t sel) {
+  assert(table);
+  table->sel = sel;
+}
+
+/**
+ * @brief Demande au processeur de charger la case d'une position, pour
+ * qu'elle soit en cache quand elle sera consultée.
+ *
+ * @param table la table
+ * @param cle la clé (canonique) de la position
+ */
+void prefetcherTransposition(Transposition *table, uint64_t cle) {
+  assert(table);
+  __builtin_prefetch(caseCle(table, melanger(cle ^ table->sel)));
+}
+
+/**
+ * @brief Cherche le résultat d'une position. C'est à l'appelant de vérifier
+ * que la profondeur et la borne le rendent utilisable ; le meilleur coup sert
+ * dans tous les cas à ordonner les coups.
+ *
+ * @param table la table
+ * @param cle la clé (canonique) de la position
+ * @param coup le meilleur coup (-1 si aucun), renseigné en cas de succès
+ * @param valeur la valeur pour le joueur courant, renseignée en cas de succès
+ * @param profondeur la profondeur de la recherche, renseignée en cas de succès
+ * @param borne la nature de la valeur, renseignée en cas de succès
+ * @return true si la position a été trouvée
+ * @return false sinon
+ */
+bool sonderTransposition(Transposition *table, uint64_t cle, int *coup,
+                         int *valeur, unsigned char *profondeur,
+                         Borne *borne) {
+  assert(table);
+  uint64_t h = melanger(cle ^ table->sel);
+  uint64_t *c = caseCle(table, h);
+  for (unsigned i = 0; i < ENTREES_CASE; i++) {
+    EntreeTransposition e = lire(&c[i]);
+    if (e.borne && e.verification == (uint32_t)h) {
+      *coup = (e.coup == COUP_AUCUN) ? -1 : (int)e.coup;
+      *valeur = e.valeur;
+      *profondeur = e.profondeur;
+      *borne = e.borne - 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Stocke le résultat d'une position, à la place de son résultat
+ * précédent s'il est dans la table, sinon d'une entrée libre de sa case,
+ * sinon de l'entrée la moins profonde (chaque génération d'écart compte
+ * comme 8 de profondeur en moins).
+ *
+ * @param table la table
+ * @param cle la clé (canonique) de la position
+ * @param profondeur la profondeur de la recherche
+ * @param coup le meilleur coup (-1 si aucun), oublié s'il ne tient pas sur les
+ * bits de l'entrée (retraits de la règle Pop Out des grands plateaux)
+ * @param valeur la valeur pour le joueur courant
+ * @param borne la nature de la valeur
+ */
+void stockerTransposition(Transposition *table, uint64_t cle,
+                          unsigned char profondeur, int coup, int valeur,
+                          Borne borne) {
+  assert(table);
+  assert(cle != 0);
+  assert(coup >= -1 && coup < NB_COUPS_MAX);
+  assert(valeur >= INT16_MIN && valeur <= INT16_MAX);
+  uint64_t h = melanger(cle ^ table->sel);
+  uint64_t *c = caseCle(table, h), *cible = NULL;
+  unsigned generation = atomic_load_explicit(&table->entete->generation,
+                                             memory_order_relaxed);
+  int pire = 0;
+  for (unsigned i = 0; i < ENTREES_CASE; i++) {
+    EntreeTransposition e = lire(&c[i]);
+    if (!e.borne || e.verification == (uint32_t)h) {
+      cible = &c[i];
+      break;
+    }
+    unsigned age = (generation - e.generation) % NB_GENERATIONS;
+    int utilite = e.profondeur - 8 * (int)age;
+    if (!cible || utilite < pire) {
+      cible = &c[i];
+      pire = utilite;
+    }
+  }
+  EntreeTransposition e = {0};
+  e.verification = (uint32_t)h;
+  e.valeur = valeur;
+  e.profondeur = profondeur;
+  e.coup = (coup == -1 || coup >= COUP_AUCUN) ? COUP_AUCUN : coup;
+  e.borne = borne + 1;
+  e.generation = generation % NB_GENERATIONS;
+  ecrire(cible, e);
+}
+
+/**
+ * @brief Commence une nouvelle génération : les entrées stockées avant sont
+ * remplacées en priorité. La génération d'une table partagée est commune à
+ * tous ses processus.
+ *
+ * @param table la table
+ */
+void vieillirTransposition(Transposition *table) {
+  assert(table);
+  atomic_fetch_add_explicit(&table->entete->generation, 1,
+                            memory_order_relaxed);
+}
+
+/**
+ * @brief Vide une table de transposition propre au processus. Une table
+ * partagée est laissée telle quelle : d'autres processus s'en servent (pour
+ * l'oublier, voir supprimerTranspositionPartagee ; pour ne plus voir ses
+ * entrées, voir salerTransposition).
+ *
+ * @param table la table
+ */
+void viderTransposition(Transposition *table) {
+  assert(table);
+  if (table->nom)
+    return;
+  effacerPages(table->entrees, octetsTransposition(table), threadsPages());
+  atomic_store_explicit(&table->entete->generation, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Supprime une table de transposition. Une table partagée reste pour
+ * les autres processus (voir supprimerTranspositionPartagee).
+ *
+ * @param table la table
+ */
+void destroyTransposition(Transposition *table) {
+  if (table) {
+    libererPages(table->memoire, table->octets);
+    free(table->nom);
+  }
+  free(table);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file transposition.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition de la table de transposition utilisée par minimax.
+ * @version 0.1
+ * @date 2023-02-12
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef TRANSPOSITION_H
+/**
+ * @def TRANSPOSITION_H
+ * @brief la garde
+ */
+#define TRANSPOSITION_H
+
+#include "memoire.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @enum borne_
+ * @brief La nature de la valeur stockée, une recherche alpha-beta ne donnant
+ * souvent qu'une borne de la valeur exacte.
+ * @typedef Borne
+ * @brief Renommer borne_.
+ */
+typedef enum borne_ {
+  EXACTE,     //!< La valeur est exacte
+  INFERIEURE, //!< La valeur exacte est supérieure ou égale (coupure beta)
+  SUPERIEURE  //!< La valeur exacte est inférieure ou égale (aucun coup > alpha)
+} Borne;
+
+/**
+ * @typedef Transposition
+ * @brief Renommer transposition_ (structure opaque).
+ */
+typedef struct transposition_ Transposition;
+
+Transposition *makeTransposition(unsigned long);
+Transposition *makeTranspositionPartagee(const char *, unsigned long);
+bool supprimerTranspositionPartagee(const char *);
+const char *nomTransposition(Transposition *);
+unsigned long long octetsTransposition(Transposition *);
+ModePages modeTransposition(Transposition *);
+void salerTransposition(Transposition *, uint64_t);
+void prefetcherTransposition(Transposition *, uint64_t);
+bool sonderTransposition(Transposition *, uint64_t, int *, int *,
+                         unsigned char *, Borne *);
+void stockerTransposition(Transposition *, uint64_t, unsigned char, int, int,
+                          Borne);
+void vieillirTransposition(Transposition *);
+void viderTransposition(Transposition *);
+void destroyTransposition(Transposition *);
+
+#endif
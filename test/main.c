@@ -14,8 +14,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "test_archive.h"
+#include "test_bitboard.h"
+#include "test_cache.h"
+#include "test_donnees.h"
+#include "test_entrainement.h"
 #include "test_ia.h"
+#include "test_latence.h"
+#include "test_lot.h"
+#include "test_memoire.h"
 #include "test_p4.h"
+#include "test_preuve.h"
+#include "test_reseau.h"
+#include "test_tablebase.h"
+#include "test_trace.h"
+#include "test_transposition.h"
 
 /**
  * @brief Fonction princiale pour lancer les tests unitaires.
@@ -27,7 +40,14 @@ int main() {
     return CU_get_error();
 
   CU_ErrorCode error =
-      CU_register_nsuites(2, getTestP4Suites(), getTestIASuites());
+      CU_register_nsuites(15, getTestP4Suites(), getTestIASuites(),
+                          getTestCacheSuites(), getTestTraceSuites(),
+                          getTestLatenceSuites(), getTestTablebaseSuites(),
+                          getTestPreuveSuites(), getTestMemoireSuites(),
+                          getTestTranspositionSuites(), getTestArchiveSuites(),
+                          getTestBitboardSuites(), getTestLotSuites(),
+                          getTestReseauSuites(), getTestEntrainementSuites(),
+                          getTestDonneesSuites());
 
   if (error != CUE_SUCCESS) {
     fprintf(stderr, "Problème: %s\n", CU_get_error_msg());
@@ -0,0 +1,174 @@
+/**
+ * @file test_archive.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier archive.
+ * @version 0.1
+ * @date 2023-03-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/archive.h"
+#include "../src/ia.h"
+#include "test_archive.h"
+#include "test_p4.h"
+
+/**
+ * @brief Un pointeur sur le jeu (extern : celui dans test_p4.c)
+ *
+ */
+extern Puissance4 *jeu;
+
+/**
+ * @def FICHIER_ARCHIVE
+ * @brief le fichier temporaire de l'archive
+ */
+#define FICHIER_ARCHIVE "test_archive.p4a"
+
+/**
+ * @def FICHIER_JOURNAL
+ * @brief le journal de l'archive temporaire
+ */
+#define FICHIER_JOURNAL FICHIER_ARCHIVE ".journal"
+
+/**
+ * @brief Vérifie le résultat archivé d'une position.
+ *
+ * @param a l'archive
+ * @param cle la clé de la position
+ * @param profondeur la profondeur demandée
+ * @param coup le coup attendu
+ * @param valeur la valeur attendue
+ * @return true si le résultat est trouvé, avec ce coup et cette valeur
+ * @return false sinon
+ */
+static bool archivee(Archive *a, uint64_t cle, unsigned char profondeur,
+                     int coup, int valeur) {
+  int c, v;
+  return chercherArchive(a, cle, profondeur, &c, &v) && c == coup &&
+         v == valeur;
+}
+
+/**
+ * @brief Compte les résultats parcourus.
+ *
+ * @param n le compteur (unsigned *)
+ */
+static void compter(void *n, uint64_t cle, unsigned char profondeur, int coup,
+                    int valeur) {
+  (*(unsigned *)n)++;
+}
+
+/**
+ * @brief Vérifie que les résultats survivent à la fermeture, à la compaction
+ * et à un journal abîmé, à la fin ou au milieu, le plus profond étant gardé.
+ */
+void test_archive(void) {
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_JOURNAL);
+  Archive *a = ouvrirArchive(FICHIER_ARCHIVE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  CU_ASSERT_TRUE(ajouterArchive(a, 42, 8, 3, -5));
+  CU_ASSERT_TRUE(ajouterArchive(a, 7, 4, 0, 12));
+  CU_ASSERT_TRUE(ajouterArchive(a, 42, 6, 1, 100)); // moins profond : ignoré
+  CU_ASSERT_TRUE(archivee(a, 42, 8, 3, -5));
+  CU_ASSERT_FALSE(archivee(a, 42, 9, 3, -5));
+  fermerArchive(a);
+
+  a = ouvrirArchive(FICHIER_ARCHIVE); // relu depuis le journal
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  CU_ASSERT_TRUE(archivee(a, 42, 8, 3, -5));
+  CU_ASSERT_TRUE(compacterArchive(a));
+  CU_ASSERT_EQUAL(statsArchive(a).indexees, 2);
+  CU_ASSERT_EQUAL(statsArchive(a).recentes, 0);
+  CU_ASSERT_TRUE(archivee(a, 7, 4, 0, 12));
+  CU_ASSERT_TRUE(ajouterArchive(a, 7, 10, 6, -1));
+  CU_ASSERT_TRUE(ajouterArchive(a, 1, 2, 2, 2));
+  CU_ASSERT_TRUE(compacterArchive(a));
+  CU_ASSERT_EQUAL(statsArchive(a).indexees, 3);
+  CU_ASSERT_TRUE(archivee(a, 7, 4, 6, -1));
+  CU_ASSERT_TRUE(ajouterArchive(a, 99, 3, 4, 9));
+  fermerArchive(a);
+
+  FILE *f = fopen(FICHIER_JOURNAL, "ab"); // un lot interrompu
+  CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+  fwrite("\x2a\0\0\0\0\0\0\0\x05", 9, 1, f);
+  fclose(f);
+  a = ouvrirArchive(FICHIER_ARCHIVE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  CU_ASSERT_TRUE(archivee(a, 99, 3, 4, 9));
+  CU_ASSERT_TRUE(ajouterArchive(a, 5, 1, 5, 5));
+  fermerArchive(a);
+  a = ouvrirArchive(FICHIER_ARCHIVE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  CU_ASSERT_TRUE(archivee(a, 5, 1, 5, 5));
+
+  f = fopen(FICHIER_JOURNAL, "ab"); // lot interrompu d'un autre processus
+  CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+  fwrite("\x2a\0\0\0\0\0\0\0\x05", 9, 1, f);
+  fclose(f);
+  CU_ASSERT_TRUE(ajouterArchive(a, 11, 2, 1, -3));
+  CU_ASSERT_TRUE(synchroniserArchive(a)); // écrit après le lot interrompu
+  fermerArchive(a);
+  a = ouvrirArchive(FICHIER_ARCHIVE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  CU_ASSERT_TRUE(archivee(a, 5, 1, 5, 5));
+  CU_ASSERT_TRUE(archivee(a, 11, 2, 1, -3));
+  unsigned n = 0;
+  parcourirArchive(a, &compter, &n);
+  CU_ASSERT_EQUAL(n, 6);
+  fermerArchive(a);
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_JOURNAL);
+}
+
+/**
+ * @brief Vérifie qu'une recherche archivée est reprise, sans recalcul, après
+ * la réouverture de l'archive.
+ */
+void test_archiveIA(void) {
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_JOURNAL);
+  Recherche *r = makeRecherche();
+  CU_ASSERT_TRUE(chargerArchiveIA(FICHIER_ARCHIVE));
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  reinitialiserIA();
+  Couple c = rechercher(r, jeu, 10);
+  CU_ASSERT_TRUE(chargerArchiveIA(NULL));
+  reinitialiserIA();
+  CU_ASSERT_TRUE(chargerArchiveIA(FICHIER_ARCHIVE));
+  Couple d = rechercher(r, jeu, 8);
+  CU_ASSERT_EQUAL(c.indice, d.indice);
+  CU_ASSERT_EQUAL(c.valeur, d.valeur);
+#ifndef SANS_STATS
+  CU_ASSERT_EQUAL(statsRecherche(r).noeuds, 0);
+#endif
+  chargerArchiveIA(NULL);
+  destroyRecherche(r);
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_JOURNAL);
+}
+
+static CU_TestInfo test_array_archive[] = {
+    {"vérifie l'écriture, la compaction et la reprise de l'archive",
+     test_archive},
+    {"vérifie la reprise des recherches archivées par les IA", test_archiveIA},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteArchive", initSuite, cleanSuite, NULL, NULL, test_array_archive},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Archive Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestArchiveSuites() { return suites; }
@@ -0,0 +1,20 @@
+/**
+ * @file test_archive.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier archive.
+ * @version 0.1
+ * @date 2023-03-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_ARCHIVE_H
+/**
+ * @def TEST_ARCHIVE_H
+ * @brief la garde
+ */
+#define TEST_ARCHIVE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestArchiveSuites();
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file test_bitboard.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier bitboard.
+ * @version 0.1
+ * @date 2023-03-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/bitboard.h"
+#include "../src/commun.h"
+#include "../src/puissance_quatre.h"
+#include "test_bitboard.h"
+
+/**
+ * @brief Vérifie les décalages d'un mot à l'autre et l'extraction d'une
+ * colonne à cheval sur deux mots.
+ */
+void test_bbDecaler(void) {
+  Bitboard b = {{0}};
+  bbInverser(&b, 200);
+  bbInverser(&b, 70);
+  Bitboard d = bbDecaler(&b, 10, MOTS_BITBOARD);
+  CU_ASSERT_EQUAL(d.mots[0], (uint64_t)1 << 60);
+  CU_ASSERT_EQUAL(d.mots[2], (uint64_t)1 << 62);
+  CU_ASSERT_EQUAL(d.mots[1] | d.mots[3], 0);
+  d = bbDecaler(&b, 130, MOTS_BITBOARD);
+  CU_ASSERT_EQUAL(d.mots[1], (uint64_t)1 << 6);
+  CU_ASSERT_EQUAL(d.mots[0] | d.mots[2] | d.mots[3], 0);
+  CU_ASSERT_EQUAL(bbCompter(&b, MOTS_BITBOARD), 2);
+  bbInverser(&b, 70);
+  CU_ASSERT_EQUAL(bbCompter(&b, MOTS_BITBOARD), 1);
+  CU_ASSERT_FALSE(bbVide(&b, MOTS_BITBOARD));
+  CU_ASSERT_TRUE(bbVide(&b, 3));
+
+  Bitboard c = {{0}}; // 10 lignes : la colonne 5 commence au bit 55
+  for (unsigned l = 9; l > 2; l--)
+    bbInverser(&c, bitCase(l, 5, 10));
+  CU_ASSERT_EQUAL(bbColonne(&c, 5, 10, 2), 0x7F);
+  CU_ASSERT_EQUAL(bbColonne(&c, 4, 10, 2), 0);
+  CU_ASSERT_EQUAL(bbColonne(&c, 6, 10, 2), 0);
+}
+
+/**
+ * @brief Vérifie la recherche d'alignements dans les quatre directions sur
+ * un plateau de 15 x 15 (4 mots), à cheval sur les mots, et qu'aucun
+ * alignement ne passe d'une colonne à la suivante.
+ */
+void test_bbAligne(void) {
+  const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+  for (int i = 0; i < 4; i++) {
+    Bitboard b = {{0}};
+    for (int k = 0; k < 5; k++) {
+      CU_ASSERT_FALSE(bbAligne(&b, 15, 5, 4));
+      bbInverser(&b, bitCase(9 + k * directions[i][0],
+                             5 + k * directions[i][1], 15));
+    }
+    CU_ASSERT_TRUE(bbAligne(&b, 15, 5, 4));
+    CU_ASSERT_FALSE(bbAligne(&b, 15, 6, 4));
+  }
+  Bitboard b = {{0}}; // haut de la colonne 3 et bas de la colonne 4
+  for (unsigned l = 0; l < 2; l++)
+    bbInverser(&b, bitCase(l, 3, 15));
+  for (unsigned l = 13; l < 15; l++)
+    bbInverser(&b, bitCase(l, 4, 15));
+  CU_ASSERT_FALSE(bbAligne(&b, 15, 4, 4));
+}
+
+/**
+ * @brief Vérifie les menaces de positions tirées au hasard (sans alignement)
+ * contre leur définition : les cases libres où un jeton de plus donne un
+ * alignement, sur des plateaux de 2 et 4 mots.
+ */
+void test_bbMenaces(void) {
+  const unsigned formes[2][3] = {{7, 9, 4}, {15, 15, 5}};
+  uint64_t graine = 0x2545F4914F6CDD1DULL;
+  for (unsigned f = 0; f < 2; f++) {
+    unsigned L = formes[f][0], C = formes[f][1], A = formes[f][2];
+    unsigned n = MOTS_UTILES(L, C), verifiees = 0, erreurs = 0;
+    CU_ASSERT_FATAL(definirGeometrie(L, C, A));
+    for (unsigned essai = 0; essai < 200; essai++) {
+      Bitboard pions[2] = {{{0}}, {{0}}};
+      for (unsigned c = 0; c < C; c++)
+        for (unsigned l = 0; l < L; l++) {
+          if (tirer(&graine) % 3) // deux cases sur trois occupées
+            bbInverser(&pions[graine % 3 - 1], bitCase(l, c, L));
+        }
+      if (bbAligne(&pions[0], L, A, n))
+        continue;
+      Bitboard libres = bbLibres(&geometrie.cases, pions, n);
+      Bitboard m = bbMenaces(&pions[0], &libres, L, A, n);
+      for (unsigned c = 0; c < C; c++)
+        for (unsigned l = 0; l < L; l++) {
+          unsigned i = bitCase(l, c, L);
+          Bitboard plus = pions[0];
+          bbInverser(&plus, i);
+          bool menace = bbContient(&libres, i) && bbAligne(&plus, L, A, n);
+          erreurs += bbContient(&m, i) != menace;
+        }
+      verifiees++;
+    }
+    CU_ASSERT_EQUAL(erreurs, 0);
+    CU_ASSERT_TRUE(verifiees > 20);
+  }
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+
+  Bitboard b = {{0}}, libres = geometrie.cases; // une seule case manque
+  for (unsigned c = 1; c < 4; c++) {
+    bbInverser(&b, bitCase(5, c, 6));
+    bbInverser(&libres, bitCase(5, c, 6));
+  }
+  Bitboard m = bbMenaces(&b, &libres, 6, 4, 1);
+  CU_ASSERT_EQUAL(m.mots[0], (uint64_t)1 << bitCase(5, 0, 6) |
+                                 (uint64_t)1 << bitCase(5, 4, 6));
+}
+
+/**
+ * @brief Joue une partie sur un plateau de 15 x 15 et vérifie à chaque coup
+ * que les bitboards donnent la même case libre que le plateau, et la fin de
+ * partie au coup gagnant seulement.
+ */
+void test_bitboardsPartie(void) {
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *jeu = initPuissance4();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(jeu);
+  CU_ASSERT_FATAL(definirGeometrie(15, 15, 5));
+  jeu->j1 = &j1;
+  jeu->j2 = &j2;
+  initGame(jeu);
+  bool fin = false;
+  unsigned coups = 0;
+  for (unsigned k = 0; !fin && k < 15 * 15; k++) {
+    changerJoueur(jeu);
+    unsigned c = (k * 7 + k / 15) % 15; // quelques colonnes en alternance
+    while (ligneLibre(jeu, c) == -1)
+      c = (c + 1) % 15;
+    int l = ligneLibre(jeu, c);
+    CU_ASSERT_EQUAL(l, testColonne(jeu->plateau, c));
+    modifJeton(jeu, l, c, jeu->courant->type);
+    bool aligne = testAlign(jeu->plateau, l, c, 0, 1) ||
+                  testAlign(jeu->plateau, l, c, 1, 0) ||
+                  testAlign(jeu->plateau, l, c, 1, 1) ||
+                  testAlign(jeu->plateau, l, c, 1, -1);
+    fin = testEnd(jeu, l, c);
+    CU_ASSERT_EQUAL(fin, aligne || jeu->nb_jetons == 15 * 15);
+    coups++;
+  }
+  CU_ASSERT_TRUE(fin);
+  CU_ASSERT_TRUE(coups > 9);
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+  free(jeu);
+}
+
+static CU_TestInfo test_array_bitboard[] = {
+    {"vérifie les décalages et les colonnes des bitboards", test_bbDecaler},
+    {"vérifie les alignements dans les bitboards", test_bbAligne},
+    {"vérifie les menaces dans les bitboards", test_bbMenaces},
+    {"vérifie les bitboards tenus à jour pendant une partie",
+     test_bitboardsPartie},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteBitboard", NULL, NULL, NULL, NULL, test_array_bitboard},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Bitboard Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestBitboardSuites() { return suites; }
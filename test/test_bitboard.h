@@ -0,0 +1,20 @@
+/**
+ * @file test_bitboard.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier bitboard.
+ * @version 0.1
+ * @date 2023-03-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_BITBOARD_H
+/**
+ * @def TEST_BITBOARD_H
+ * @brief la garde
+ */
+#define TEST_BITBOARD_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestBitboardSuites();
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file test_cache.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier cache.
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/cache.h"
+#include "test_cache.h"
+
+/**
+ * @brief Un cache de 3 entrées.
+ *
+ */
+static Cache *petitCache;
+
+/**
+ * @brief Initialise la suite : crée un cache de 3 entrées.
+ *
+ * @return int un code d'erreur ou de succès
+ */
+static int initSuiteCache(void) {
+  petitCache = makeCache(3);
+  if (!petitCache)
+    return CUE_NOMEMORY;
+  return CUE_SUCCESS;
+}
+
+/**
+ * @brief Nettoie la suite : supprime le cache.
+ *
+ * @return int un code de succès
+ */
+static int cleanSuiteCache(void) {
+  destroyCache(petitCache);
+  return CUE_SUCCESS;
+}
+
+/**
+ * @brief Vérifie qu'un résultat ajouté est retrouvé seulement si sa
+ * profondeur suffit.
+ *
+ */
+void test_profondeurCache(void) {
+  int coup, valeur;
+  CU_ASSERT_FALSE(chercherCache(petitCache, 1, 1, &coup, &valeur));
+  ajouterCache(petitCache, 1, 3, 4, 12);
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 3, &coup, &valeur));
+  CU_ASSERT_EQUAL(coup, 4);
+  CU_ASSERT_EQUAL(valeur, 12);
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 1, &coup, &valeur));
+  CU_ASSERT_FALSE(chercherCache(petitCache, 1, 5, &coup, &valeur));
+
+  // un résultat moins profond ne remplace pas un résultat plus profond
+  ajouterCache(petitCache, 1, 1, 2, -3);
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 3, &coup, &valeur));
+  CU_ASSERT_EQUAL(coup, 4);
+  ajouterCache(petitCache, 1, 5, 6, 7);
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 5, &coup, &valeur));
+  CU_ASSERT_EQUAL(coup, 6);
+  CU_ASSERT_EQUAL(valeur, 7);
+}
+
+/**
+ * @brief Vérifie que l'entrée la moins récemment utilisée est supprimée quand
+ * le cache est plein, et les compteurs.
+ *
+ */
+void test_evictionCache(void) {
+  int coup, valeur;
+  StatsCache avant = statsCache(petitCache);
+  ajouterCache(petitCache, 2, 1, 0, 0);
+  ajouterCache(petitCache, 3, 1, 0, 0);
+  // 1 est utilisée : 2 devient la moins récente
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 1, &coup, &valeur));
+  ajouterCache(petitCache, 4, 1, 0, 0);
+  CU_ASSERT_FALSE(chercherCache(petitCache, 2, 1, &coup, &valeur));
+  CU_ASSERT_TRUE(chercherCache(petitCache, 1, 1, &coup, &valeur));
+  CU_ASSERT_TRUE(chercherCache(petitCache, 3, 1, &coup, &valeur));
+  CU_ASSERT_TRUE(chercherCache(petitCache, 4, 1, &coup, &valeur));
+
+  StatsCache apres = statsCache(petitCache);
+  CU_ASSERT_EQUAL(apres.evictions - avant.evictions, 1);
+  CU_ASSERT_EQUAL(apres.succes - avant.succes, 4);
+  CU_ASSERT_EQUAL(apres.echecs - avant.echecs, 1);
+}
+
+static CU_TestInfo test_array_Cache[] = {
+    {"vérifie qu'un résultat n'est utilisé que si sa profondeur suffit",
+     test_profondeurCache},
+    {"vérifie la suppression de l'entrée la moins récemment utilisée",
+     test_evictionCache},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteCache", initSuiteCache, cleanSuiteCache, NULL, NULL,
+     test_array_Cache},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Cache Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestCacheSuites() { return suites; }
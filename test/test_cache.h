@@ -0,0 +1,20 @@
+/**
+ * @file test_cache.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier cache.
+ * @version 0.1
+ * @date 2023-02-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_CACHE_H
+/**
+ * @def TEST_CACHE_H
+ * @brief la garde
+ */
+#define TEST_CACHE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestCacheSuites();
+#endif
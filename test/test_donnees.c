@@ -0,0 +1,242 @@
+/**
+ * @file test_donnees.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier donnees.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "../src/donnees.h"
+#include "../src/ia.h"
+#include "../src/puissance_quatre.h"
+#include "test_donnees.h"
+
+/**
+ * @def FICHIER_DONNEES
+ * @brief le fichier temporaire des données
+ */
+#define FICHIER_DONNEES "test_donnees.p4d"
+
+/**
+ * @def NB_THREADS_TEST
+ * @brief le nombre de threads qui écrivent ensemble
+ */
+#define NB_THREADS_TEST 4
+
+/**
+ * @def NB_PAR_THREAD
+ * @brief le nombre d'enregistrements ajoutés par chaque thread (plus qu'un
+ * tampon de l'écrivain)
+ */
+#define NB_PAR_THREAD 5000
+
+/**
+ * @def TAILLE_AJOUT
+ * @brief le nombre d'enregistrements de chaque ajout, sauf pour le dernier
+ * thread qui ajoute tout d'un coup
+ */
+#define TAILLE_AJOUT 7
+
+/**
+ * @struct ajout_
+ * @brief Le travail d'un thread qui écrit.
+ * @typedef Ajout
+ * @brief Renommer ajout_.
+ */
+typedef struct ajout_ {
+  Ecrivain *ecrivain; //!< L'écrivain, partagé avec d'autres threads
+  uint64_t thread;    //!< Le numéro du thread, écrit dans ses enregistrements
+  unsigned taille;    //!< Le nombre d'enregistrements de chaque ajout
+  bool ok;            //!< true si tous les ajouts ont été pris
+} Ajout;
+
+/**
+ * @brief Ajoute NB_PAR_THREAD enregistrements numérotés, par ajouts de la
+ * taille du travail.
+ *
+ * @param arg le travail (Ajout *)
+ * @return void* NULL
+ */
+static void *ajouter(void *arg) {
+  Ajout *a = arg;
+  Donnee *t = malloc(a->taille * sizeof(Donnee));
+  a->ok = (t != NULL);
+  for (unsigned i = 0; i < NB_PAR_THREAD && t; i += a->taille) {
+    unsigned n = 0;
+    for (; n < a->taille && i + n < NB_PAR_THREAD; n++)
+      t[n] = (Donnee){a->thread, i + n, 0, 0, 0, 0, 0, 0};
+    a->ok = ajouterDonnees(a->ecrivain, t, n) && a->ok;
+  }
+  free(t);
+  return NULL;
+}
+
+/**
+ * @brief Donne la taille d'un fichier.
+ *
+ * @param chemin le fichier
+ * @return long sa taille, -1 s'il n'existe pas
+ */
+static long tailleFichier(const char *chemin) {
+  struct stat s;
+  return stat(chemin, &s) == 0 ? (long)s.st_size : -1;
+}
+
+/**
+ * @brief Vérifie les ajouts de plusieurs threads par deux écrivains du même
+ * fichier, comme deux processus (tous écrits, dans l'ordre de chaque thread,
+ * chaque ajout d'un seul tenant), la reprise d'un fichier existant,
+ * l'enregistrement à moitié écrit et les fichiers refusés.
+ */
+void test_donneesFichier(void) {
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+  remove(FICHIER_DONNEES);
+  Ecrivain *ecrivains[2] = {ouvrirEcrivain(FICHIER_DONNEES),
+                            ouvrirEcrivain(FICHIER_DONNEES)};
+  CU_ASSERT_FATAL(ecrivains[0] != NULL && ecrivains[1] != NULL);
+  pthread_t threads[NB_THREADS_TEST];
+  Ajout ajouts[NB_THREADS_TEST];
+  for (unsigned i = 0; i < NB_THREADS_TEST; i++) {
+    unsigned taille = (i == NB_THREADS_TEST - 1) ? NB_PAR_THREAD : TAILLE_AJOUT;
+    ajouts[i] = (Ajout){ecrivains[i % 2], i, taille, false};
+    CU_ASSERT_EQUAL(pthread_create(&threads[i], NULL, &ajouter, &ajouts[i]),
+                    0);
+  }
+  for (unsigned i = 0; i < NB_THREADS_TEST; i++) {
+    pthread_join(threads[i], NULL);
+    CU_ASSERT_TRUE(ajouts[i].ok);
+  }
+  CU_ASSERT_TRUE(fermerEcrivain(ecrivains[0]));
+  CU_ASSERT_TRUE(fermerEcrivain(ecrivains[1]));
+
+  Donnees *d = ouvrirDonnees(FICHIER_DONNEES);
+  CU_ASSERT_FATAL(d != NULL);
+  size_t nb;
+  const Donnee *t = lireDonnees(d, &nb);
+  CU_ASSERT_EQUAL(nb, NB_THREADS_TEST * NB_PAR_THREAD);
+  uint64_t suivant[NB_THREADS_TEST] = {0};
+  bool ordre = true, ensemble = true;
+  for (size_t i = 0; i < nb; i++) {
+    if (t[i].joueur >= NB_THREADS_TEST) {
+      ordre = false;
+      break;
+    }
+    ordre = ordre && t[i].occupees == suivant[t[i].joueur]++;
+    if (t[i].occupees % ajouts[t[i].joueur].taille != 0) // dans un ajout
+      ensemble = ensemble && i > 0 && t[i - 1].joueur == t[i].joueur;
+  }
+  CU_ASSERT_TRUE(ordre);
+  CU_ASSERT_TRUE(ensemble);
+  for (unsigned i = 0; i < NB_THREADS_TEST; i++)
+    CU_ASSERT_EQUAL(suivant[i], NB_PAR_THREAD);
+  fermerDonnees(d);
+
+  // reprise, puis enregistrement à moitié écrit
+  Ecrivain *e = ouvrirEcrivain(FICHIER_DONNEES);
+  CU_ASSERT_FATAL(e != NULL);
+  Donnee x = {12, 34, -5, 3, 1, 2, 4, 9};
+  CU_ASSERT_TRUE(ajouterDonnees(e, &x, 1));
+  CU_ASSERT_TRUE(fermerEcrivain(e));
+  long taille = tailleFichier(FICHIER_DONNEES);
+  FILE *f = fopen(FICHIER_DONNEES, "ab");
+  CU_ASSERT_FATAL(f != NULL);
+  fwrite(&x, 10, 1, f);
+  fclose(f);
+  d = ouvrirDonnees(FICHIER_DONNEES);
+  CU_ASSERT_FATAL(d != NULL);
+  t = lireDonnees(d, &nb);
+  CU_ASSERT_EQUAL(nb, NB_THREADS_TEST * NB_PAR_THREAD + 1);
+  CU_ASSERT_TRUE(t[nb - 1].joueur == 12 && t[nb - 1].occupees == 34 &&
+                 t[nb - 1].score == -5 && t[nb - 1].coup == 3 &&
+                 t[nb - 1].resultat == 1 && t[nb - 1].jetons == 2 &&
+                 t[nb - 1].profondeur == 4 && t[nb - 1].restants == 9);
+  fermerDonnees(d);
+  e = ouvrirEcrivain(FICHIER_DONNEES);
+  CU_ASSERT_PTR_NOT_NULL(e);
+  CU_ASSERT_TRUE(fermerEcrivain(e));
+  CU_ASSERT_EQUAL(tailleFichier(FICHIER_DONNEES), taille);
+
+  // autre plateau, plateau trop grand, fichier absent
+  CU_ASSERT_TRUE(definirGeometrie(5, 6, 4));
+  CU_ASSERT_PTR_NULL(ouvrirDonnees(FICHIER_DONNEES));
+  CU_ASSERT_PTR_NULL(ouvrirEcrivain(FICHIER_DONNEES));
+  CU_ASSERT_TRUE(definirGeometrie(7, 9, 4));
+  CU_ASSERT_PTR_NULL(ouvrirEcrivain(FICHIER_DONNEES));
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+  remove(FICHIER_DONNEES);
+  CU_ASSERT_PTR_NULL(ouvrirDonnees(FICHIER_DONNEES));
+}
+
+/**
+ * @brief Vérifie les positions de parties d'auto-jeu : des positions
+ * possibles, des coups jouables, des résultats et des fins de partie
+ * cohérents d'une position à l'autre d'une même partie.
+ */
+void test_donneesAutoJeu(void) {
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+  remove(FICHIER_DONNEES);
+  Ecrivain *e = ouvrirEcrivain(FICHIER_DONNEES);
+  CU_ASSERT_FATAL(e != NULL);
+  unsigned long ajoutees = jouerDonnees(e, 4, 3, 2023);
+  CU_ASSERT_TRUE(fermerEcrivain(e));
+  CU_ASSERT_TRUE(ajoutees > 0);
+
+  Donnees *d = ouvrirDonnees(FICHIER_DONNEES);
+  CU_ASSERT_FATAL(d != NULL);
+  size_t nb;
+  const Donnee *t = lireDonnees(d, &nb);
+  CU_ASSERT_EQUAL(nb, ajoutees);
+  unsigned parties = 0;
+  for (size_t i = 0; i < nb; i++) {
+    const Donnee *p = &t[i];
+    uint64_t haut = (uint64_t)1 << (p->coup * (NB_LIGNE + 1) + NB_LIGNE - 1);
+    CU_ASSERT_EQUAL(__builtin_popcountll(p->occupees), p->jetons);
+    CU_ASSERT_EQUAL(p->joueur & ~p->occupees, 0);
+    CU_ASSERT_EQUAL(__builtin_popcountll(p->joueur), p->jetons / 2);
+    CU_ASSERT_TRUE(p->coup >= 0 && p->coup < (int)NB_COLONNE);
+    CU_ASSERT_EQUAL(p->occupees & haut, 0); // colonne non pleine
+    CU_ASSERT_EQUAL(p->profondeur, 3);
+    CU_ASSERT_TRUE(p->resultat >= -1 && p->resultat <= 1);
+    CU_ASSERT_TRUE(p->restants >= 1);
+    if (p->restants == 1) { // le dernier coup de la partie
+      parties++;
+      CU_ASSERT_TRUE(p->resultat >= 0); // gagnant ou nul
+    }
+    if (i > 0 && t[i - 1].restants > 1) { // la même partie
+      CU_ASSERT_EQUAL(p->jetons, t[i - 1].jetons + 1);
+      CU_ASSERT_EQUAL(p->restants, t[i - 1].restants - 1);
+      CU_ASSERT_EQUAL(p->resultat, -t[i - 1].resultat);
+    }
+  }
+  CU_ASSERT_EQUAL(parties, 4);
+  fermerDonnees(d);
+  remove(FICHIER_DONNEES);
+}
+
+static CU_TestInfo test_array_donnees[] = {
+    {"vérifie l'écriture par plusieurs threads et la lecture",
+     test_donneesFichier},
+    {"vérifie les positions d'auto-jeu", test_donneesAutoJeu},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteDonnees", NULL, NULL, NULL, NULL, test_array_donnees},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Donnees Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestDonneesSuites() { return suites; }
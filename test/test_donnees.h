@@ -0,0 +1,20 @@
+/**
+ * @file test_donnees.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier donnees.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_DONNEES_H
+/**
+ * @def TEST_DONNEES_H
+ * @brief la garde
+ */
+#define TEST_DONNEES_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestDonneesSuites();
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file test_entrainement.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier entrainement.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/entrainement.h"
+#include "../src/ia.h"
+#include "../src/preuve.h"
+#include "../src/puissance_quatre.h"
+#include "test_entrainement.h"
+
+/**
+ * @def NB_EXEMPLES_TEST
+ * @brief le nombre d'exemples produits
+ */
+#define NB_EXEMPLES_TEST 200
+
+/**
+ * @def BUDGET_TEST
+ * @brief le budget de df-pn par exemple
+ */
+#define BUDGET_TEST 20000
+
+/**
+ * @brief Remet un jeu dans la position d'un exemple, l'adversaire au trait.
+ *
+ * @param game le jeu, dont les joueurs sont J1 et J2
+ * @param e l'exemple
+ * @return true si l'exemple est une position possible : les jetons ne se
+ * recouvrent pas, ne flottent pas et le joueur qui vient de jouer a autant de
+ * jetons que son adversaire ou un de plus
+ */
+static bool placerExemple(Puissance4 *game, const Exemple *e) {
+  unsigned n = MOTS_UTILES(NB_LIGNE, NB_COLONNE);
+  unsigned joueur = bbCompter(&e->joueur, n),
+           adversaire = bbCompter(&e->adversaire, n);
+  if (joueur != adversaire && joueur != adversaire + 1)
+    return false;
+  Type j = (joueur == adversaire) ? J2 : J1, a = (j == J1) ? J2 : J1;
+  initGame(game);
+  for (unsigned c = 0; c < NB_COLONNE; c++)
+    for (int l = NB_LIGNE - 1; l >= 0; l--) {
+      unsigned i = bitCase(l, c, NB_LIGNE);
+      bool pj = bbContient(&e->joueur, i), pa = bbContient(&e->adversaire, i);
+      if (pj && pa)
+        return false;
+      if (!pj && !pa)
+        continue;
+      if (ligneLibre(game, c) != l)
+        return false;
+      modifJeton(game, l, c, pj ? j : a);
+    }
+  game->courant = (a == J1) ? game->j1 : game->j2;
+  return game->nb_jetons == joueur + adversaire;
+}
+
+/**
+ * @brief Vérifie les exemples produits par plusieurs threads : des positions
+ * possibles, en cours, dont le résultat est celui que df-pn retrouve seul.
+ */
+void test_entrainementExemples(void) {
+  Exemple *exemples = malloc(NB_EXEMPLES_TEST * sizeof(Exemple));
+  CU_ASSERT_FATAL(exemples != NULL);
+  CU_ASSERT_EQUAL(genererExemples(exemples, NB_EXEMPLES_TEST, 2, BUDGET_TEST,
+                                  42, NULL),
+                  NB_EXEMPLES_TEST);
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *game = initPuissance4();
+  Preuve *p = makePreuve(1 << 16);
+  CU_ASSERT_FATAL(game != NULL && p != NULL);
+  game->j1 = &j1;
+  game->j2 = &j2;
+  unsigned resultats[4] = {0};
+  for (unsigned i = 0; i < NB_EXEMPLES_TEST; i++) {
+    CU_ASSERT_TRUE(placerExemple(game, &exemples[i]));
+    CU_ASSERT_TRUE(game->nb_jetons >= 6 &&
+                   game->nb_jetons < NB_LIGNE * NB_COLONNE);
+    Resultat r = prouver(p, game, 1 << 22, NULL, NULL);
+    Resultat attendu = (r == GAGNE) ? PERDU : (r == PERDU) ? GAGNE : r;
+    CU_ASSERT_EQUAL(exemples[i].resultat, attendu);
+    resultats[exemples[i].resultat]++;
+  }
+  CU_ASSERT_EQUAL(resultats[INCONNU], 0);
+  CU_ASSERT_TRUE(resultats[GAGNE] > 0 && resultats[PERDU] > 0);
+  destroyPreuve(p);
+  free(game);
+  free(exemples);
+}
+
+/**
+ * @brief Vérifie que l'entraînement apprend : la perte du réseau arrondi sur
+ * ses exemples passe nettement sous celle d'un réseau qui répond toujours
+ * 1/2 (ln 2), puis que le réseau joue un match.
+ */
+void test_entrainementReseau(void) {
+  Exemple *exemples = malloc(NB_EXEMPLES_TEST * sizeof(Exemple));
+  Reseau *r = malloc(sizeof(Reseau));
+  CU_ASSERT_FATAL(exemples != NULL && r != NULL);
+  CU_ASSERT_FATAL(genererExemples(exemples, NB_EXEMPLES_TEST, 2, BUDGET_TEST,
+                                  7, NULL) == NB_EXEMPLES_TEST);
+  CU_ASSERT_FATAL(entrainerReseau(r, exemples, NB_EXEMPLES_TEST, 40, 2, NULL));
+  CU_ASSERT_EQUAL(r->lignes, NB_LIGNE);
+  CU_ASSERT_EQUAL(r->colonnes, NB_COLONNE);
+  CU_ASSERT_TRUE(perteReseau(r, exemples, NB_EXEMPLES_TEST) < 0.9 * log(2));
+  CU_ASSERT_PTR_NULL(reseauActif); // perteReseau remet l'heuristique
+
+  double score = matchReseau(r, 2, 2, 1, NULL);
+  CU_ASSERT_TRUE(score >= 0 && score <= 1);
+  CU_ASSERT_PTR_NULL(reseauActif);
+  free(r);
+  free(exemples);
+}
+
+static CU_TestInfo test_array_entrainement[] = {
+    {"vérifie les exemples résolus par plusieurs threads",
+     test_entrainementExemples},
+    {"vérifie l'apprentissage et le match de contrôle",
+     test_entrainementReseau},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteEntrainement", NULL, NULL, NULL, NULL, test_array_entrainement},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Entrainement Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestEntrainementSuites() { return suites; }
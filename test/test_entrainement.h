@@ -0,0 +1,20 @@
+/**
+ * @file test_entrainement.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier entrainement.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_ENTRAINEMENT_H
+/**
+ * @def TEST_ENTRAINEMENT_H
+ * @brief la garde
+ */
+#define TEST_ENTRAINEMENT_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestEntrainementSuites();
+#endif
@@ -12,11 +12,19 @@
 #include <CUnit/Basic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "../src/ia.h"
+#include "../src/transposition.h"
 #include "test_ia.h"
 #include "test_p4.h"
 
+/**
+ * @def NOM_PARTAGE
+ * @brief le nom de la table de transposition partagée des tests
+ */
+#define NOM_PARTAGE "/puissance4_test_ia"
+
 /**
  * @brief Un pointeur sur le jeu (extern : celui dans test_p4.c)
  *
@@ -203,6 +211,358 @@ void test_evaluation(void) {
   CU_ASSERT_EQUAL(evaluation(jeu), 10);
 }
 
+/**
+ * @brief Vérifie que meilleurCoup donne des coups symétriques pour deux
+ * positions symétriques, la seconde étant trouvée dans le cache.
+ *
+ */
+void test_meilleurCoupSymetrique(void) {
+  Joueur *ia = makeIA(J1, '2');
+  CU_ASSERT_PTR_NOT_NULL(ia);
+  initGame(jeu);
+  modifJeton(jeu, NB_LIGNE - 1, 1, J1);
+  modifJeton(jeu, NB_LIGNE - 1, 2, J2);
+  jeu->courant = jeu->j1;
+  Couple c1 = meilleurCoup(jeu, 3);
+  CU_ASSERT(c1.indice >= 0 && c1.indice < NB_COLONNE);
+
+  StatsCache avant = statsCacheIA();
+  initGame(jeu);
+  modifJeton(jeu, NB_LIGNE - 1, NB_COLONNE - 2, J1);
+  modifJeton(jeu, NB_LIGNE - 1, NB_COLONNE - 3, J2);
+  jeu->courant = jeu->j1;
+  Couple c2 = meilleurCoup(jeu, 3);
+  CU_ASSERT_EQUAL(c2.indice, NB_COLONNE - 1 - c1.indice);
+  CU_ASSERT_EQUAL(c2.valeur, c1.valeur);
+  CU_ASSERT_EQUAL(statsCacheIA().succes, avant.succes + 1);
+
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie que analyseColonnes donne un score pour chaque colonne
+ * jouable, cohérent avec meilleurCoup.
+ *
+ */
+void test_analyseColonnes(void) {
+  Joueur *ia = makeIA(J1, '2');
+  initGame(jeu);
+  for (int l = NB_LIGNE - 1; l >= 0; l--) // colonne 7 pleine
+    modifJeton(jeu, l, 6, (l % 2) ? J2 : J1);
+  modifJeton(jeu, NB_LIGNE - 1, 0, J1);
+  modifJeton(jeu, NB_LIGNE - 1, 1, J1);
+  modifJeton(jeu, NB_LIGNE - 1, 2, J1);
+  modifJeton(jeu, NB_LIGNE - 2, 0, J2);
+  modifJeton(jeu, NB_LIGNE - 2, 1, J2);
+  jeu->courant = jeu->j1;
+
+  Analyse a = analyseColonnes(jeu, 3);
+  CU_ASSERT_FALSE(a.jouable[6]);
+  for (int c = 0; c < NB_COLONNE - 1; c++)
+    CU_ASSERT_TRUE(a.jouable[c]);
+  CU_ASSERT_EQUAL(a.meilleur, 3);
+  CU_ASSERT_EQUAL(a.scores[3], VICTOIRE);
+
+  reinitialiserIA();
+  Couple c = meilleurCoup(jeu, 3);
+  CU_ASSERT_EQUAL(c.indice, a.meilleur);
+  CU_ASSERT_EQUAL(c.valeur, a.scores[a.meilleur]);
+
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Fonction d'interruption des tests : compte ses appels et demande
+ * l'arrêt dès le premier.
+ *
+ * @param data un pointeur sur le compteur
+ * @return true toujours
+ */
+static bool interrompre(void *data) {
+  (*(int *)data)++;
+  return true;
+}
+
+/**
+ * @brief Vérifie qu'une recherche interrompue rend un coup légal, celui
+ * donné par meilleurCoupCourant, sans atteindre la profondeur demandée, et
+ * qu'un arrêt demandé avant la recherche n'est pas perdu.
+ */
+void test_rechercheInterrompue(void) {
+  Joueur *ia = makeIA(J1, '3');
+  initGame(jeu);
+  for (int l = NB_LIGNE - 1; l >= 0; l--) // colonne 4 pleine
+    modifJeton(jeu, l, 3, (l % 2) ? J2 : J1);
+  jeu->courant = jeu->j1;
+
+  Recherche *r = makeRecherche();
+  int appels = 0;
+  definirInterruption(r, &interrompre, &appels);
+  Couple c = rechercher(r, jeu, 14);
+  CU_ASSERT_EQUAL(appels, 1);
+  CU_ASSERT_TRUE(profondeurAtteinte(r) < 14);
+  CU_ASSERT_TRUE(c.indice >= 0 && c.indice < NB_COLONNE);
+  CU_ASSERT_NOT_EQUAL(testColonne(jeu->plateau, c.indice), -1);
+  CU_ASSERT_EQUAL(meilleurCoupCourant(r).indice, c.indice);
+
+  // arrêtée pendant la recherche : rien dans le cache
+  StatsCache avant = statsCacheIA();
+  definirInterruption(r, NULL, NULL);
+  Couple complet = rechercher(r, jeu, 2);
+  CU_ASSERT_EQUAL(statsCacheIA().succes, avant.succes);
+  CU_ASSERT_EQUAL(profondeurAtteinte(r), 2);
+  CU_ASSERT_NOT_EQUAL(testColonne(jeu->plateau, complet.indice), -1);
+
+  // arrêtée avant la recherche : le coup de repli, puis l'arrêt est retiré
+  reinitialiserIA();
+  arreterRecherche(r);
+  Couple repli = rechercher(r, jeu, 14);
+  CU_ASSERT_EQUAL(profondeurAtteinte(r), 0);
+  CU_ASSERT_TRUE(repli.indice >= 0 && repli.indice < NB_COLONNE);
+  CU_ASSERT_NOT_EQUAL(testColonne(jeu->plateau, repli.indice), -1);
+  rechercher(r, jeu, 2);
+  CU_ASSERT_EQUAL(profondeurAtteinte(r), 2);
+
+  destroyRecherche(r);
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie la cohérence des statistiques d'une recherche.
+ */
+void test_statsRecherche(void) {
+  Joueur *ia = makeIA(J1, '3');
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  Couple c = meilleurCoup(jeu, 6);
+  StatsRecherche s = statsRecherche(rechercheIA());
+  CU_ASSERT_NOT_EQUAL(testColonne(jeu->plateau, c.indice), -1);
+#ifdef SANS_STATS
+  CU_ASSERT_EQUAL(s.noeuds, 0);
+#else
+  unsigned long long coupures = 0;
+  for (int k = 0; k < NB_COLONNE; k++)
+    coupures += s.coupures[k];
+  CU_ASSERT_TRUE(s.noeuds > s.feuilles);
+  CU_ASSERT_TRUE(s.feuilles > 0);
+  CU_ASSERT_TRUE(s.succes <= s.sondages);
+  CU_ASSERT_TRUE(s.coupuresTable <= s.succes);
+  CU_ASSERT_TRUE(coupures > 0 && coupures < s.noeuds);
+  CU_ASSERT_EQUAL(s.profondeur, 6);
+  CU_ASSERT_EQUAL(s.profondeurMax, 6);
+  CU_ASSERT_TRUE(s.iterations >= s.profondeur);
+  CU_ASSERT_TRUE(s.echecsBas + s.echecsHaut <= s.iterations - s.profondeur);
+
+  // trouvé dans le cache : aucune position visitée
+  CU_ASSERT_EQUAL(meilleurCoup(jeu, 6).indice, c.indice);
+  CU_ASSERT_EQUAL(statsRecherche(rechercheIA()).noeuds, 0);
+#endif
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie que les algorithmes de recherche donnent le même score, avec
+ * des tables vides ou déjà remplies par un autre algorithme.
+ */
+void test_algorithmes(void) {
+  Joueur *ia = makeIA(J1, '3');
+  Recherche *r = makeRecherche();
+  const char *positions[] = {"", "44", "4453", "3521"};
+  for (unsigned p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+    initGame(jeu);
+    jeu->courant = jeu->j1;
+    for (const char *c = positions[p]; *c; c++) {
+      modifJeton(jeu, testColonne(jeu->plateau, *c - '1'), *c - '1',
+                 jeu->courant->type);
+      changerJoueur(jeu);
+    }
+    reinitialiserIA();
+    definirAlgorithme(r, ALPHABETA);
+    int score7 = rechercher(r, jeu, 7).valeur;
+    reinitialiserIA();
+    int score8 = rechercher(r, jeu, 8).valeur;
+    for (Algorithme a = PVS; a <= MTDF; a++) {
+      definirAlgorithme(r, a);
+      reinitialiserIA();
+      CU_ASSERT_EQUAL(rechercher(r, jeu, 7).valeur, score7);
+      CU_ASSERT_EQUAL(rechercher(r, jeu, 8).valeur, score8); // tables remplies
+    }
+  }
+  destroyRecherche(r);
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie l'évaluation et la recherche d'une victoire en un coup sur un
+ * plateau spécialisé (7 lignes, 9 colonnes) et sur un plateau générique (10
+ * lignes, 12 colonnes).
+ */
+void test_grandsPlateaux(void) {
+  const unsigned geometries[][2] = {{7, 9}, {10, 12}};
+  for (unsigned g = 0; g < 2; g++) {
+    CU_ASSERT_FATAL(definirGeometrie(geometries[g][0], geometries[g][1], 4));
+    Joueur *ia = makeIA(J1, '3');
+    initGame(jeu);
+    jeu->courant = jeu->j1;
+    for (int c = 2; c < 5; c++)
+      modifJeton(jeu, NB_LIGNE - 1, c, J1);
+    modifJeton(jeu, NB_LIGNE - 2, 2, J2);
+    modifJeton(jeu, NB_LIGNE - 2, 3, J2);
+
+    changerJoueur(jeu); // évaluation pour le joueur qui vient de jouer
+    int attendue = scoreJoueur(*jeu);
+    changerJoueur(jeu);
+    attendue -= scoreJoueur(*jeu);
+    CU_ASSERT_EQUAL(evaluation(jeu), attendue);
+
+    Couple c = meilleurCoup(jeu, 4);
+    CU_ASSERT_TRUE(c.indice == 1 || c.indice == 5);
+    CU_ASSERT_EQUAL(c.valeur, VICTOIRE);
+    free(ia);
+    cleanIA();
+  }
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie qu'avec un voisinage, l'IA joue près des jetons d'un plateau
+ * de 15 x 15 et trouve toujours la victoire en un coup. Ses résultats ne sont
+ * pas vus d'un processus sans voisinage qui partage la table.
+ */
+void test_voisinage(void) {
+  CU_ASSERT_FATAL(definirGeometrie(15, 15, 5));
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  Transposition *autre = makeTranspositionPartagee(NOM_PARTAGE, 1 << 16);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(autre); // d'un processus sans voisinage
+  CU_ASSERT_TRUE(partagerTableIA(NOM_PARTAGE));
+  definirVoisinageIA(1);
+  Joueur *ia = makeIA(J1, '3');
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  modifJeton(jeu, NB_LIGNE - 1, 10, J2);
+  Couple c = meilleurCoup(jeu, 4);
+  CU_ASSERT_TRUE(c.indice >= 9 && c.indice <= 11);
+  int coup, valeur;
+  unsigned char profondeur;
+  Borne borne;
+  CU_ASSERT_FALSE(sonderTransposition(autre, cleCanonique(jeu, NULL), &coup,
+                                      &valeur, &profondeur, &borne));
+
+  for (int col = 2; col < 6; col++)
+    modifJeton(jeu, NB_LIGNE - 1, col, J1);
+  for (int col = 2; col < 5; col++)
+    modifJeton(jeu, NB_LIGNE - 2, col, J2);
+  c = meilleurCoup(jeu, 4);
+  CU_ASSERT_TRUE(c.indice == 1 || c.indice == 6);
+  CU_ASSERT_EQUAL(c.valeur, VICTOIRE);
+  free(ia);
+  definirVoisinageIA(0);
+  cleanIA();
+  destroyTransposition(autre);
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie qu'avec la règle Pop Out, l'IA trouve la victoire en retirant
+ * son jeton du bas de la première colonne (ses jetons de la deuxième ligne sont
+ * alors alignés), et ne la trouve pas avec les règles standard. Les indices
+ * (analyseColonnes) désignent aussi ce retrait.
+ */
+void test_popOut(void) {
+  Joueur *ia = makeIA(J1, '3');
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  const Type premiere[] = {J1, J2, J1, J2, VIDE, J2, J2};
+  const Type deuxieme[] = {J2, J1, J1, J1, VIDE, VIDE, J2};
+  for (int c = 0; c < NB_COLONNE; c++) {
+    if (premiere[c] != VIDE)
+      modifJeton(jeu, NB_LIGNE - 1, c, premiere[c]);
+    if (deuxieme[c] != VIDE)
+      modifJeton(jeu, NB_LIGNE - 2, c, deuxieme[c]);
+  }
+  modifJeton(jeu, NB_LIGNE - 3, 0, J1);
+
+  Couple c = meilleurCoup(jeu, 4);
+  CU_ASSERT_TRUE(c.indice < NB_COLONNE);
+  CU_ASSERT_NOT_EQUAL(c.valeur, VICTOIRE);
+  jeu->regle = POP_OUT;
+  c = meilleurCoup(jeu, 4);
+  CU_ASSERT_EQUAL(c.indice, RETRAIT(0));
+  CU_ASSERT_EQUAL(c.valeur, VICTOIRE);
+  Analyse a = analyseColonnes(jeu, 4);
+  CU_ASSERT_EQUAL(a.meilleur, RETRAIT(0));
+  CU_ASSERT_EQUAL(a.scores[RETRAIT(0)], VICTOIRE);
+  CU_ASSERT_FALSE(a.jouable[RETRAIT(4)]); // colonne vide
+  CU_ASSERT_TRUE(a.jouable[4]);
+  jeu->regle = STANDARD;
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie qu'avec la règle Pop Out, une même position n'a pas la même
+ * valeur selon le nombre de retraits déjà faits : J2 menace de gagner des deux
+ * côtés de sa ligne du bas, J1 ne peut que retirer son jeton de la dernière
+ * colonne, ce qui fait nulle s'il ne reste qu'un retrait. Les deux recherches
+ * ne doivent pas partager leur résultat (table, cache ou archive).
+ */
+void test_popOutRetraits(void) {
+  Joueur *ia = makeIA(J1, '3');
+  jeu->regle = POP_OUT;
+  for (int ordre = 0; ordre < 2; ordre++) {
+    reinitialiserIA();
+    initGame(jeu);
+    jeu->courant = jeu->j1;
+    for (int c = 1; c <= 3; c++)
+      modifJeton(jeu, NB_LIGNE - 1, c, J2);
+    modifJeton(jeu, NB_LIGNE - 2, 1, J1);
+    modifJeton(jeu, NB_LIGNE - 2, 2, J1);
+    modifJeton(jeu, NB_LIGNE - 1, NB_COLONNE - 1, J1);
+    for (int k = 0; k < 2; k++) {
+      bool limite = (k == ordre); // la nulle en un retrait
+      jeu->retraits = limite ? RETRAITS_MAX - 1 : 0;
+      Couple c = meilleurCoup(jeu, 4);
+      if (limite) {
+        CU_ASSERT_EQUAL(c.indice, RETRAIT(NB_COLONNE - 1));
+        CU_ASSERT_EQUAL(c.valeur, 0);
+      } else {
+        CU_ASSERT_TRUE(c.valeur < 0);
+      }
+    }
+  }
+  jeu->regle = STANDARD;
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie qu'après arreterReflexionIA, la réflexion lancée par un coup
+ * de l'IA contre un humain ne lit plus les joueurs : ils peuvent être libérés
+ * (une lecture après libération est signalée avec -fsanitize=address).
+ */
+void test_reflexionArretee(void) {
+  Puissance4 *game = initPuissance4();
+  CU_ASSERT_FATAL(game != NULL);
+  game->j1 = makeIA(J1, '3');
+  game->j2 = malloc(sizeof(Joueur));
+  CU_ASSERT_FATAL(game->j1 != NULL && game->j2 != NULL);
+  *game->j2 = (Joueur){J2, 0, 0, NULL}; // un humain : l'IA réfléchit
+  initGame(game);
+  game->courant = game->j1;
+  unsigned coup = game->j1->play(game);
+  CU_ASSERT_TRUE(coup < NB_COLONNE);
+  arreterReflexionIA();
+  clean(game, NULL);
+  usleep(20000); // le temps qu'une réflexion non arrêtée lise les joueurs
+  cleanIA();
+}
+
 static CU_TestInfo test_array_IA[] = {
     {"vérifie la valeur d'une case", test_valeurCase},
     {"vérifie la valeur associée à chaque case d'un plateau "
@@ -220,6 +580,25 @@ static CU_TestInfo test_array_IA[] = {
     {"vérifie le score des joueurs pour un plateau "
      "rempli avec 11 jetons",
      test_scoreJoueurP2},
+    {"vérifie que deux positions symétriques ont des meilleurs coups "
+     "symétriques",
+     test_meilleurCoupSymetrique},
+    {"vérifie l'analyse de toutes les colonnes d'une position",
+     test_analyseColonnes},
+    {"vérifie qu'une recherche interrompue rend un coup légal",
+     test_rechercheInterrompue},
+    {"vérifie les statistiques d'une recherche", test_statsRecherche},
+    {"vérifie que les algorithmes de recherche donnent le même score",
+     test_algorithmes},
+    {"vérifie l'évaluation et la recherche sur de grands plateaux",
+     test_grandsPlateaux},
+    {"vérifie les recherches limitées aux colonnes proches des jetons",
+     test_voisinage},
+    {"vérifie que l'IA joue les retraits de la règle Pop Out", test_popOut},
+    {"vérifie les positions Pop Out selon les retraits restants",
+     test_popOutRetraits},
+    {"vérifie que la réflexion arrêtée ne lit plus les joueurs",
+     test_reflexionArretee},
     CU_TEST_INFO_NULL};
 
 static CU_SuiteInfo suites[2] = {
@@ -0,0 +1,84 @@
+/**
+ * @file test_latence.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier latence.
+ * @version 0.1
+ * @date 2023-02-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/latence.h"
+#include "test_latence.h"
+
+/**
+ * @brief Vérifie les percentiles d'un histogramme : exacts pour les petites
+ * durées, à 1,6 % près pour les grandes.
+ */
+void test_percentiles(void) {
+  Histogramme *h = makeHistogramme();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(h);
+  CU_ASSERT_EQUAL(percentileHistogramme(h, 50), 0);
+  for (uint64_t v = 1; v <= 100; v++)
+    ajouterHistogramme(h, v);
+  CU_ASSERT_EQUAL(nbHistogramme(h), 100);
+  CU_ASSERT_EQUAL(percentileHistogramme(h, 50), 50);
+  CU_ASSERT_EQUAL(percentileHistogramme(h, 90), 90);
+  CU_ASSERT_EQUAL(percentileHistogramme(h, 100), 100);
+
+  ajouterHistogramme(h, 1000000); // une seconde
+  uint64_t max = percentileHistogramme(h, 100);
+  CU_ASSERT_EQUAL(max, 1000000);
+  ajouterHistogramme(h, 999000);
+  uint64_t p = percentileHistogramme(h, 99.5);
+  CU_ASSERT_TRUE(p >= 999000 && p <= 999000 * 1.016);
+
+  Histogramme *autre = makeHistogramme();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(autre);
+  ajouterHistogramme(autre, 5000000);
+  fusionnerHistogramme(h, autre);
+  CU_ASSERT_EQUAL(nbHistogramme(h), 103);
+  CU_ASSERT_EQUAL(percentileHistogramme(h, 100), 5000000);
+  destroyHistogramme(autre);
+  destroyHistogramme(h);
+}
+
+/**
+ * @brief Vérifie que les coups des IA sont rangés par profondeur et par phase
+ * de la partie.
+ */
+void test_latencesIA(void) {
+  viderLatences();
+  CU_ASSERT_PTR_NULL(histogrammeLatence(5, 0));
+  finLatence(5, 0, debutLatence());
+  finLatence(5, TRANCHE_COUPS - 1, debutLatence());
+  finLatence(5, TRANCHE_COUPS, debutLatence());
+  finLatence(NB_PROFONDEURS + 3, 0, debutLatence());
+  CU_ASSERT_EQUAL(nbHistogramme(histogrammeLatence(5, 0)), 2);
+  CU_ASSERT_EQUAL(nbHistogramme(histogrammeLatence(5, 1)), 1);
+  CU_ASSERT_EQUAL(nbHistogramme(histogrammeLatence(NB_PROFONDEURS - 1, 0)), 1);
+  CU_ASSERT_PTR_NULL(histogrammeLatence(3, 0));
+  viderLatences();
+  CU_ASSERT_PTR_NULL(histogrammeLatence(5, 0));
+}
+
+static CU_TestInfo test_array_latence[] = {
+    {"vérifie les percentiles d'un histogramme", test_percentiles},
+    {"vérifie le rangement des latences des IA", test_latencesIA},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteLatence", NULL, NULL, NULL, NULL, test_array_latence},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Latence Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestLatenceSuites() { return suites; }
@@ -0,0 +1,20 @@
+/**
+ * @file test_latence.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier latence.
+ * @version 0.1
+ * @date 2023-02-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_LATENCE_H
+/**
+ * @def TEST_LATENCE_H
+ * @brief la garde
+ */
+#define TEST_LATENCE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestLatenceSuites();
+#endif
@@ -0,0 +1,191 @@
+/**
+ * @file test_lot.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier lot.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../src/commun.h"
+#include "../src/ia.h"
+#include "../src/lot.h"
+#include "../src/puissance_quatre.h"
+#include "test_lot.h"
+
+/**
+ * @def NB_PARTIES
+ * @brief le nombre de parties des lots de test (pas un multiple des blocs de
+ * lot.c)
+ */
+#define NB_PARTIES 100
+
+/**
+ * @brief Tire une colonne non pleine d'un jeu.
+ *
+ * @param jeu le jeu
+ * @param graine l'état du générateur
+ * @return unsigned la colonne
+ */
+static unsigned colonneLibre(Puissance4 *jeu, uint64_t *graine) {
+  unsigned c = tirer(graine) % NB_COLONNE;
+  while (ligneLibre(jeu, c) == -1)
+    c = (c + 1) % NB_COLONNE;
+  return c;
+}
+
+/**
+ * @brief Joue NB_PARTIES parties au hasard à la fois dans un lot et dans
+ * autant de jeux, et vérifie à chaque coup que le lot donne les mêmes coups
+ * possibles, fins de partie et évaluations que puissance_quatre.c et ia.c.
+ *
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de pions à aligner
+ */
+static void comparerParties(unsigned L, unsigned C, unsigned A) {
+  CU_ASSERT_FATAL(definirGeometrie(L, C, A));
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *jeux[NB_PARTIES];
+  bool finies[NB_PARTIES];
+  uint64_t graine = 0x9E3779B97F4A7C15ULL;
+  Lot *lot = makeLot(NB_PARTIES);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(lot);
+  for (unsigned i = 0; i < NB_PARTIES; i++) {
+    jeux[i] = initPuissance4();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(jeux[i]);
+    jeux[i]->j1 = &j1;
+    jeux[i]->j2 = &j2;
+    initGame(jeux[i]);
+    changerJoueur(jeux[i]); // J1 au trait
+    for (unsigned k = 0; k < i % 5; k++) { // une ouverture différente
+      unsigned c = colonneLibre(jeux[i], &graine);
+      modifJeton(jeux[i], ligneLibre(jeux[i], c), c, jeux[i]->courant->type);
+      changerJoueur(jeux[i]);
+    }
+    placerLot(lot, i, jeux[i]);
+    finies[i] = false;
+  }
+
+  uint8_t coups[NB_PARTIES], gagnants[NB_PARTIES];
+  uint32_t legaux[NB_PARTIES];
+  int scores[NB_PARTIES];
+  unsigned enCours = NB_PARTIES, victoires = 0, erreurs = 0;
+  while (enCours > 0) {
+    coupsLegauxLot(lot, legaux);
+    for (unsigned i = 0; i < NB_PARTIES; i++) {
+      coups[i] = COUP_PASSE;
+      if (finies[i])
+        continue;
+      uint32_t attendus = 0;
+      for (unsigned c = 0; c < C; c++)
+        attendus |= (uint32_t)(ligneLibre(jeux[i], c) != -1) << c;
+      erreurs += legaux[i] != attendus;
+      coups[i] = colonneLibre(jeux[i], &graine);
+    }
+    jouerLot(lot, coups);
+    gagnantsLot(lot, gagnants);
+    evaluerLot(lot, scores);
+    for (unsigned i = 0; i < NB_PARTIES; i++) {
+      if (finies[i])
+        continue;
+      unsigned c = coups[i];
+      int l = ligneLibre(jeux[i], c);
+      modifJeton(jeux[i], l, c, jeux[i]->courant->type);
+      bool fin = testEnd(jeux[i], l, c);
+      if (jeux[i]->courant) { // NULL après une égalité
+        changerJoueur(jeux[i]);
+        erreurs += scores[i] != evaluation(jeux[i]);
+      }
+      erreurs += gagnants[i] && !fin;
+      erreurs += !gagnants[i] && fin && jeux[i]->nb_jetons < L * C;
+      if (fin) {
+        finies[i] = true;
+        enCours--;
+        victoires += gagnants[i];
+      }
+    }
+  }
+  CU_ASSERT_EQUAL(erreurs, 0);
+  CU_ASSERT_TRUE(victoires > NB_PARTIES / 2);
+
+  // une partie finie reste telle quelle
+  for (unsigned i = 0; i < NB_PARTIES; i++)
+    coups[i] = COUP_PASSE;
+  coupsLegauxLot(lot, legaux);
+  jouerLot(lot, coups);
+  uint32_t apres[NB_PARTIES];
+  coupsLegauxLot(lot, apres);
+  for (unsigned i = 0; i < NB_PARTIES; i++) {
+    erreurs += legaux[i] != apres[i];
+    free(jeux[i]);
+  }
+  CU_ASSERT_EQUAL(erreurs, 0);
+  destroyLot(lot);
+}
+
+/**
+ * @brief Vérifie le lot sur les plateaux qui tiennent sur un mot, dont le
+ * plateau 7 x 8 qui en occupe les 64 bits, et son refus des plus grands.
+ */
+void test_lotParties(void) {
+  comparerParties(6, 7, 4);
+  comparerParties(7, 8, 4);
+  comparerParties(6, 9, 5);
+  CU_ASSERT_TRUE(definirGeometrie(7, 9, 4));
+  CU_ASSERT_PTR_NULL(makeLot(NB_PARTIES));
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie les coups d'un lot vidé : toutes les colonnes possibles,
+ * aucun gagnant, une évaluation nulle, puis le premier jeton au bas de la
+ * colonne jouée.
+ */
+void test_lotVide(void) {
+  CU_ASSERT_FATAL(definirGeometrie(6, 7, 4));
+  Lot *lot = makeLot(3);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(lot);
+  uint32_t legaux[3];
+  uint8_t gagnants[3], coups[3] = {0, 3, COUP_PASSE};
+  int scores[3];
+  coupsLegauxLot(lot, legaux);
+  gagnantsLot(lot, gagnants);
+  evaluerLot(lot, scores);
+  for (unsigned i = 0; i < 3; i++) {
+    CU_ASSERT_EQUAL(legaux[i], 0x7F);
+    CU_ASSERT_EQUAL(gagnants[i], 0);
+    CU_ASSERT_EQUAL(scores[i], 0);
+  }
+  jouerLot(lot, coups);
+  CU_ASSERT_EQUAL(lot->occupees[0], (uint64_t)1 << bitCase(5, 0, 6));
+  CU_ASSERT_EQUAL(lot->occupees[1], (uint64_t)1 << bitCase(5, 3, 6));
+  CU_ASSERT_EQUAL(lot->occupees[2], 0);
+  CU_ASSERT_EQUAL(lot->joueur[1], 0); // J2 au trait, sans jeton
+  viderLot(lot);
+  CU_ASSERT_EQUAL(lot->occupees[1], 0);
+  destroyLot(lot);
+}
+
+static CU_TestInfo test_array_lot[] = {
+    {"vérifie un lot vide et son premier coup", test_lotVide},
+    {"vérifie les parties d'un lot contre puissance_quatre et ia",
+     test_lotParties},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteLot", NULL, NULL, NULL, NULL, test_array_lot}, CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Lot Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestLotSuites() { return suites; }
@@ -0,0 +1,20 @@
+/**
+ * @file test_lot.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier lot.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_LOT_H
+/**
+ * @def TEST_LOT_H
+ * @brief la garde
+ */
+#define TEST_LOT_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestLotSuites();
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file test_memoire.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier memoire.
+ * @version 0.1
+ * @date 2023-03-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/memoire.h"
+#include "test_memoire.h"
+
+/**
+ * @brief Vérifie que tous les octets d'une zone sont nuls.
+ *
+ * @param debut la zone
+ * @param taille sa taille, en octets
+ * @return true si tous sont nuls
+ * @return false sinon
+ */
+static bool nulle(const unsigned char *debut, size_t taille) {
+  for (size_t i = 0; i < taille; i++)
+    if (debut[i])
+      return false;
+  return true;
+}
+
+/**
+ * @brief Vérifie l'allocation d'une table mise à zéro et alignée, avec ou
+ * sans pages énormes, et sa remise à zéro par plusieurs threads.
+ */
+void test_allouerPages(void) {
+  size_t taille = 64UL << 20; // assez pour partager entre deux threads
+  ModePages mode;
+  unsigned char *p = allouerPages(taille, 4, &mode);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+  CU_ASSERT_EQUAL((uintptr_t)p % 64, 0);
+  CU_ASSERT(mode == PAGES_ENORMES || mode == PAGES_TRANSPARENTES ||
+            mode == PAGES_NORMALES);
+  CU_ASSERT_TRUE(nulle(p, taille));
+  memset(p, 0xAB, taille);
+  effacerPages(p, taille, 4);
+  CU_ASSERT_TRUE(nulle(p, taille));
+  libererPages(p, taille);
+
+  autoriserPagesEnormes(false);
+  p = allouerPages(3UL << 20, threadsPages(), &mode);
+  autoriserPagesEnormes(true);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+  CU_ASSERT_EQUAL(mode, PAGES_NORMALES);
+  CU_ASSERT_TRUE(nulle(p, 3UL << 20));
+  libererPages(p, 3UL << 20);
+
+  p = allouerPages(100, 1, NULL); // plus petit qu'une page énorme
+  CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+  CU_ASSERT_TRUE(nulle(p, 100));
+  libererPages(p, 100);
+  CU_ASSERT_TRUE(threadsPages() >= 1);
+}
+
+static CU_TestInfo test_array_memoire[] = {
+    {"vérifie l'allocation et la remise à zéro des grandes tables",
+     test_allouerPages},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteMemoire", NULL, NULL, NULL, NULL, test_array_memoire},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Memoire Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestMemoireSuites() { return suites; }
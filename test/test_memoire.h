@@ -0,0 +1,20 @@
+/**
+ * @file test_memoire.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier memoire.
+ * @version 0.1
+ * @date 2023-03-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_MEMOIRE_H
+/**
+ * @def TEST_MEMOIRE_H
+ * @brief la garde
+ */
+#define TEST_MEMOIRE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestMemoireSuites();
+#endif
@@ -12,6 +12,7 @@
 #include <CUnit/Basic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../src/puissance_quatre.h"
 #include "test_p4.h"
@@ -156,6 +157,45 @@ void test_alignement1Jeton(void) {
   CU_ASSERT_FALSE(testEnd(jeu, NB_LIGNE - 1, 4));
 }
 
+/**
+ * @brief Vérifie que clePosition distingue les positions et que cleCanonique
+ * associe la même clé à une position et à sa symétrique.
+ *
+ */
+void test_clePosition(void) {
+  initGame(jeu);
+  uint64_t vide = clePosition(jeu, false);
+  CU_ASSERT_EQUAL(vide, clePosition(jeu, true));
+
+  modifJeton(jeu, NB_LIGNE - 1, 1, J1);
+  modifJeton(jeu, NB_LIGNE - 2, 1, J2);
+  uint64_t cle = clePosition(jeu, false);
+  uint64_t cleM = clePosition(jeu, true);
+  CU_ASSERT_NOT_EQUAL(cle, vide);
+  CU_ASSERT_NOT_EQUAL(cle, cleM);
+  bool miroir1, miroir2;
+  uint64_t canonique = cleCanonique(jeu, &miroir1);
+
+  initGame(jeu);
+  modifJeton(jeu, NB_LIGNE - 1, NB_COLONNE - 2, J1);
+  modifJeton(jeu, NB_LIGNE - 2, NB_COLONNE - 2, J2);
+  CU_ASSERT_EQUAL(clePosition(jeu, false), cleM);
+  CU_ASSERT_EQUAL(clePosition(jeu, true), cle);
+  CU_ASSERT_EQUAL(cleCanonique(jeu, &miroir2), canonique);
+  CU_ASSERT_NOT_EQUAL(miroir1, miroir2);
+
+  // même jetons, joueur courant différent
+  changerJoueur(jeu);
+  CU_ASSERT_NOT_EQUAL(clePosition(jeu, false), cleM);
+
+  // les clés sont tenues à jour quand on enlève des jetons
+  modifJeton(jeu, NB_LIGNE - 2, NB_COLONNE - 2, VIDE);
+  modifJeton(jeu, NB_LIGNE - 1, NB_COLONNE - 2, VIDE);
+  changerJoueur(jeu);
+  CU_ASSERT_EQUAL(clePosition(jeu, false), vide);
+  CU_ASSERT_EQUAL(clePosition(jeu, true), vide);
+}
+
 static CU_TestInfo test_array_Beginning[] = {
     {"vérifie que le jeu est bien initialisé", test_initGame},
     {"vérifie que le plateau est bien initialisé", test_plateauVide},
@@ -168,6 +208,7 @@ static CU_TestInfo test_array_Beginning[] = {
      "à vide",
      test_plateauVide},
     {"ajoute un jeton et test ses alignements", test_alignement1Jeton},
+    {"vérifie les clés d'une position et de sa symétrique", test_clePosition},
     CU_TEST_INFO_NULL};
 
 // suite FIN :
@@ -442,10 +483,270 @@ static CU_TestInfo test_array_Fin[] = {
      test_gagnerPlateauPlein},
     CU_TEST_INFO_NULL};
 
-static CU_SuiteInfo suites[3] = {
+/**
+ * @brief Vérifie que les géométries invalides sont refusées sans changer la
+ * géométrie courante.
+ *
+ */
+void test_geometrieInvalide(void) {
+  CU_ASSERT_FALSE(definirGeometrie(0, 7, 4));
+  CU_ASSERT_FALSE(definirGeometrie(6, NB_COLONNE_MAX + 1, 4));
+  CU_ASSERT_FALSE(definirGeometrie(6, 7, 1));
+  CU_ASSERT_FALSE(definirGeometrie(3, 3, 4));
+  CU_ASSERT_EQUAL(NB_LIGNE, 6);
+  CU_ASSERT_EQUAL(NB_COLONNE, 7);
+  CU_ASSERT_EQUAL(NB_ALIGNE, 4);
+  CU_ASSERT_EQUAL(geometrie.forme, 0);
+  CU_ASSERT_TRUE(geometrie.cleExacte);
+}
+
+/**
+ * @brief Vérifie les fonctions du module puissance_quatre sur un plateau de 7
+ * lignes et 9 colonnes (version spécialisée) puis sur le puissance 5 (6
+ * lignes, 9 colonnes).
+ *
+ */
+void test_geometrieSpecialisee(void) {
+  CU_ASSERT_FATAL(definirGeometrie(7, 9, 4));
+  CU_ASSERT_TRUE(geometrie.forme < NB_FORMES);
+  CU_ASSERT_FALSE(geometrie.cleExacte); // 8 bits par colonne, 9 colonnes
+  initGame(jeu);
+  changerJoueur(jeu);
+  CU_ASSERT_EQUAL(testColonne(jeu->plateau, 8), 6);
+  for (int c = 5; c < 8; c++)
+    modifJeton(jeu, 6, c, J1);
+  CU_ASSERT_FALSE(testEnd(jeu, 6, 7));
+  modifJeton(jeu, 6, 8, J1);
+  CU_ASSERT_TRUE(testAlign(jeu->plateau, 6, 8, 0, 1));
+  CU_ASSERT_TRUE(testEnd(jeu, 6, 8));
+  CU_ASSERT_EQUAL(testColonne(jeu->plateau, 8), 5);
+
+  CU_ASSERT_FATAL(definirGeometrie(6, 9, 5));
+  CU_ASSERT_TRUE(geometrie.forme < NB_FORMES);
+  initGame(jeu);
+  changerJoueur(jeu);
+  for (int l = 5; l > 1; l--)
+    modifJeton(jeu, l, 0, J2);
+  CU_ASSERT_FALSE(testEnd(jeu, 2, 0));
+  modifJeton(jeu, 1, 0, J2);
+  CU_ASSERT_TRUE(testEnd(jeu, 1, 0));
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie les fonctions du module puissance_quatre sur une géométrie
+ * sans version spécialisée, dont la clé est une empreinte : même clé pour une
+ * position quel que soit l'ordre des coups, même clé canonique pour deux
+ * positions symétriques.
+ *
+ */
+void test_geometrieGenerique(void) {
+  CU_ASSERT_FATAL(definirGeometrie(10, 12, 4));
+  CU_ASSERT_EQUAL(geometrie.forme, NB_FORMES);
+  CU_ASSERT_FALSE(geometrie.cleExacte);
+  initGame(jeu);
+  changerJoueur(jeu);
+  uint64_t vide = jeu->cle;
+  CU_ASSERT_EQUAL(testColonne(jeu->plateau, 11), 9);
+  modifJeton(jeu, 9, 0, J1);
+  modifJeton(jeu, 9, 11, J2);
+  uint64_t cle = jeu->cle;
+  modifJeton(jeu, 9, 11, VIDE);
+  modifJeton(jeu, 9, 0, VIDE);
+  CU_ASSERT_EQUAL(jeu->cle, vide);
+  CU_ASSERT_EQUAL(jeu->nb_jetons, 0);
+  modifJeton(jeu, 9, 11, J2);
+  modifJeton(jeu, 9, 0, J1);
+  CU_ASSERT_EQUAL(jeu->cle, cle);
+  modifJeton(jeu, 9, 11, VIDE);
+  modifJeton(jeu, 9, 0, VIDE);
+
+  modifJeton(jeu, 9, 1, J1);
+  uint64_t gauche = cleCanonique(jeu, NULL);
+  modifJeton(jeu, 9, 1, VIDE);
+  modifJeton(jeu, 9, 10, J1);
+  CU_ASSERT_EQUAL(cleCanonique(jeu, NULL), gauche);
+  CU_ASSERT_NOT_EQUAL(clePosition(jeu, false), clePosition(jeu, true));
+
+  for (int l = 9; l > 6; l--)
+    modifJeton(jeu, l, 4 + 9 - l, J1); // diagonale de 3 jetons
+  CU_ASSERT_FALSE(testEnd(jeu, 7, 6));
+  modifJeton(jeu, 6, 7, J1);
+  CU_ASSERT_TRUE(testAlign(jeu->plateau, 9, 4, 1, -1));
+  CU_ASSERT_TRUE(testEnd(jeu, 6, 7));
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie les colonnes candidates sur un plateau de 15 x 15, tenues à
+ * jour quand des jetons sont ajoutés puis enlevés.
+ */
+void test_colonnesCandidates(void) {
+  CU_ASSERT_FATAL(definirGeometrie(15, 15, 5));
+  initGame(jeu);
+  changerJoueur(jeu);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 2), 0x7FFF); // plateau vide
+  modifJeton(jeu, 14, 7, J1);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 2), 0x3E0); // colonnes 5 à 9
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 0), 0x7FFF);
+  modifJeton(jeu, 13, 7, J2);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 1), 0x1C0);
+  modifJeton(jeu, 14, 0, J2);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 1), 0x1C3);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 20), 0x7FFF);
+  modifJeton(jeu, 14, 0, VIDE);
+  modifJeton(jeu, 13, 7, VIDE);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 1), 0x1C0);
+  modifJeton(jeu, 14, 7, VIDE);
+  CU_ASSERT_EQUAL(colonnesCandidates(jeu, 1), 0x7FFF);
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+// suite PopOut :
+
+/**
+ * @brief Empile des jetons dans une colonne, en partant du bas.
+ *
+ * @param colonne le numéro de colonne (vide)
+ * @param jetons les jetons, du bas vers le haut
+ * @param nb le nombre de jetons
+ */
+static void empiler(unsigned colonne, const Type *jetons, unsigned nb) {
+  for (unsigned i = 0; i < nb; i++)
+    modifJeton(jeu, NB_LIGNE - 1 - i, colonne, jetons[i]);
+}
+
+/**
+ * @brief Vérifie que deux jeux ont les mêmes jetons, clés, bitboards et
+ * colonnes non vides.
+ *
+ * @param a le premier jeu
+ * @param b le second jeu
+ */
+static void verifierMemePosition(Puissance4 *a, Puissance4 *b) {
+  CU_ASSERT_EQUAL(a->cle, b->cle);
+  CU_ASSERT_EQUAL(a->cleMiroir, b->cleMiroir);
+  CU_ASSERT_EQUAL(a->nb_jetons, b->nb_jetons);
+  CU_ASSERT_EQUAL(a->occupees, b->occupees);
+  CU_ASSERT_EQUAL(memcmp(a->pions, b->pions, sizeof(a->pions)), 0);
+  for (int l = 0; l < NB_LIGNE; l++)
+    for (int c = 0; c < NB_COLONNE; c++)
+      CU_ASSERT_EQUAL(a->plateau[l][c], b->plateau[l][c]);
+}
+
+/**
+ * @brief Vérifie qu'un retrait donne la même position que les jetons restants
+ * posés directement, puis que son annulation rend la position de départ, sur
+ * le plateau standard et sur un plateau de 10 x 10 (la colonne 5 de ses
+ * bitboards est à cheval sur deux mots, sa clé est une empreinte).
+ */
+void test_retrait(void) {
+  const Type pile[] = {J1, J2, J2, J1};
+  const unsigned geometries[][3] = {{6, 7, 3}, {10, 10, 5}};
+  for (unsigned g = 0; g < 2; g++) {
+    CU_ASSERT_FATAL(definirGeometrie(geometries[g][0], geometries[g][1], 4));
+    unsigned colonne = geometries[g][2];
+    initGame(jeu);
+    changerJoueur(jeu);
+    jeu->regle = POP_OUT;
+    modifJeton(jeu, NB_LIGNE - 1, 0, J2);
+    empiler(colonne, pile, 4);
+    CU_ASSERT_TRUE(retraitPossible(jeu, colonne));
+    CU_ASSERT_FALSE(retraitPossible(jeu, 0)); // jeton de l'adversaire
+    CU_ASSERT_FALSE(retraitPossible(jeu, 1)); // colonne vide
+    Puissance4 avant = *jeu;
+    retirerJeton(jeu, colonne);
+    CU_ASSERT_EQUAL(jeu->retraits, 1);
+    Puissance4 apres = *jeu;
+
+    initGame(jeu);
+    changerJoueur(jeu);
+    modifJeton(jeu, NB_LIGNE - 1, 0, J2);
+    empiler(colonne, pile + 1, 3);
+    verifierMemePosition(&apres, jeu);
+
+    *jeu = apres;
+    remettreJeton(jeu, colonne, J1);
+    CU_ASSERT_EQUAL(jeu->retraits, 0);
+    verifierMemePosition(&avant, jeu);
+
+    // le dernier jeton d'une colonne : elle redevient vide
+    retirerJeton(jeu, 0);
+    CU_ASSERT_EQUAL(jeu->occupees, 1u << colonne);
+    CU_ASSERT_EQUAL(jeu->plateau[NB_LIGNE - 1][0], VIDE);
+    remettreJeton(jeu, 0, J2);
+    verifierMemePosition(&avant, jeu);
+    jeu->regle = STANDARD;
+    CU_ASSERT_FALSE(retraitPossible(jeu, colonne));
+  }
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie le gagnant après un retrait de J1 dans la colonne 0, qui fait
+ * descendre ses autres jetons : J1 aligne quatre jetons sur la deuxième ligne,
+ * J2 sur la première, ou les deux (J1 gagne alors, puisqu'il a retiré).
+ */
+void test_gagnantRetrait(void) {
+  const Type colonne0[] = {J1, J2, J1};
+  const Type premiere[][3] = {{J2, J1, J2}, {J2, J2, J2}, {J2, J2, J2}};
+  const bool deuxieme[] = {true, false, true};
+  const Type gagnants[] = {J1, J2, J1};
+  for (int i = 0; i < 3; i++) {
+    initGame(jeu);
+    changerJoueur(jeu);
+    jeu->regle = POP_OUT;
+    empiler(0, colonne0, deuxieme[i] ? 3 : 2);
+    for (int c = 1; c < 4; c++) {
+      modifJeton(jeu, NB_LIGNE - 1, c, premiere[i][c - 1]);
+      if (deuxieme[i])
+        modifJeton(jeu, NB_LIGNE - 2, c, J1);
+    }
+    CU_ASSERT_EQUAL(gagnantRetrait(jeu, J1), VIDE);
+    retirerJeton(jeu, 0);
+    CU_ASSERT_EQUAL(gagnantRetrait(jeu, J1), gagnants[i]);
+    CU_ASSERT_TRUE(testEndRetrait(jeu));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(jeu->courant);
+    CU_ASSERT_EQUAL(jeu->courant->type, gagnants[i]);
+  }
+
+  // sans alignement, la partie est nulle après RETRAITS_MAX retraits
+  initGame(jeu);
+  changerJoueur(jeu);
+  jeu->regle = POP_OUT;
+  empiler(0, colonne0, 3);
+  jeu->retraits = RETRAITS_MAX - 2;
+  retirerJeton(jeu, 0);
+  CU_ASSERT_FALSE(testEndRetrait(jeu));
+  retirerJeton(jeu, 0);
+  CU_ASSERT_TRUE(testEndRetrait(jeu));
+  CU_ASSERT_PTR_NULL(jeu->courant);
+  jeu->regle = STANDARD;
+}
+
+static CU_TestInfo test_array_PopOut[] = {
+    {"vérifie le retrait d'un jeton et son annulation", test_retrait},
+    {"vérifie le gagnant après un retrait", test_gagnantRetrait},
+    CU_TEST_INFO_NULL};
+
+static CU_TestInfo test_array_Geometrie[] = {
+    {"vérifie que les géométries invalides sont refusées",
+     test_geometrieInvalide},
+    {"vérifie le jeu sur des géométries spécialisées",
+     test_geometrieSpecialisee},
+    {"vérifie le jeu et les clés sur une géométrie générique",
+     test_geometrieGenerique},
+    {"vérifie les colonnes candidates d'un grand plateau",
+     test_colonnesCandidates},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[5] = {
     {"suiteBeginning", initSuiteBeginning, cleanSuite, NULL, NULL,
      test_array_Beginning},
     {"suiteEnd", initSuite, cleanSuite, NULL, NULL, test_array_Fin},
+    {"suiteGeometrie", initSuite, cleanSuite, NULL, NULL,
+     test_array_Geometrie},
+    {"suitePopOut", initSuite, cleanSuite, NULL, NULL, test_array_PopOut},
     CU_SUITE_INFO_NULL};
 
 /**
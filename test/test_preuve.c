@@ -0,0 +1,158 @@
+/**
+ * @file test_preuve.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier preuve.
+ * @version 0.1
+ * @date 2023-02-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/ia.h"
+#include "../src/preuve.h"
+#include "test_p4.h"
+#include "test_preuve.h"
+
+/**
+ * @brief Un pointeur sur le jeu (extern : celui dans test_p4.c)
+ *
+ */
+extern Puissance4 *jeu;
+
+/**
+ * @brief Des positions de fin de partie, résolues par une recherche complète.
+ */
+static const char *positions[] = {"7332622547162454511113", // gagnée
+                                  "6445665654143365222643", // perdue
+                                  "1323773644225561331244"}; // nulle
+
+/**
+ * @brief Joue des coups depuis le plateau vide (sans fin de partie).
+ *
+ * @param coups les colonnes jouées (de 1 à 7)
+ */
+static void placer(const char *coups) {
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  for (const char *c = coups; *c; c++) {
+    modifJeton(jeu, testColonne(jeu->plateau, *c - '1'), *c - '1',
+               jeu->courant->type);
+    changerJoueur(jeu);
+  }
+}
+
+/**
+ * @brief Donne le résultat exact d'une position par une recherche complète.
+ *
+ * @param r le contexte de la recherche
+ * @return Resultat le résultat pour le joueur courant
+ */
+static Resultat resultatExact(Recherche *r) {
+  reinitialiserIA();
+  definirAlgorithme(r, ALPHABETA);
+  int v = rechercher(r, jeu, NB_LIGNE * NB_COLONNE - jeu->nb_jetons).valeur;
+  return (v > 0) ? GAGNE : (v < 0) ? PERDU : NUL;
+}
+
+/**
+ * @brief Vérifie les résultats de df-pn contre une recherche complète, le coup
+ * gagnant trouvé, le budget et le ramasse-miettes.
+ */
+void test_prouver(void) {
+  Joueur *ia = makeIA(J1, '3');
+  Recherche *r = makeRecherche();
+  Preuve *p = makePreuve(1 << 16);
+  Preuve *petite = makePreuve(4096); // ramasse-miettes sollicité
+  CU_ASSERT_PTR_NOT_NULL_FATAL(p);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(petite);
+  for (unsigned k = 0; k < sizeof(positions) / sizeof(positions[0]); k++) {
+    placer(positions[k]);
+    Resultat attendu = resultatExact(r);
+    CU_ASSERT_EQUAL(prouver(p, jeu, 1 << 24, NULL, NULL), attendu);
+    CU_ASSERT_EQUAL(prouver(petite, jeu, 1 << 24, NULL, NULL), attendu);
+  }
+  StatsPreuve s = statsPreuve(petite);
+  CU_ASSERT_TRUE(s.collectes > 0);
+  CU_ASSERT_TRUE(s.occupees <= s.capacite);
+
+  // deux jetons de J1 en bas, libres des deux côtés : victoire forcée
+  placer("4455");
+  CU_ASSERT_EQUAL(prouver(p, jeu, 1 << 20, NULL, NULL), GAGNE);
+  int coup = coupPreuve(p); // doit laisser l'adversaire perdant
+  CU_ASSERT_FATAL(coup >= 0 && coup < NB_COLONNE);
+  modifJeton(jeu, testColonne(jeu->plateau, coup), coup, J1);
+  changerJoueur(jeu);
+  CU_ASSERT_EQUAL(prouver(p, jeu, 1 << 20, NULL, NULL), PERDU);
+
+  placer("");
+  CU_ASSERT_EQUAL(prouver(p, jeu, 1000, NULL, NULL), INCONNU);
+  CU_ASSERT_EQUAL(coupPreuve(p), -1);
+
+  destroyPreuve(petite);
+  destroyPreuve(p);
+  destroyRecherche(r);
+  free(ia);
+  cleanIA();
+}
+
+/**
+ * @brief Vérifie les IA avec l'algorithme DFPN : score exact à toute
+ * profondeur, retour à alpha-beta quand le budget est épuisé.
+ */
+void test_rechercheDfpn(void) {
+  Joueur *ia = makeIA(J1, '3');
+  Recherche *r = makeRecherche();
+  placer(positions[0]);
+  Resultat attendu = resultatExact(r);
+  Analyse exacte = analyseColonnes(jeu, NB_LIGNE * NB_COLONNE - jeu->nb_jetons);
+
+  reinitialiserIA();
+  definirAlgorithme(r, DFPN);
+  Couple c = rechercher(r, jeu, 2);
+  CU_ASSERT_EQUAL(c.valeur, (attendu == GAGNE)  ? VICTOIRE
+                            : (attendu == NUL) ? 0
+                                               : -VICTOIRE);
+#ifndef SANS_STATS
+  CU_ASSERT_TRUE(statsRecherche(r).preuves > 0);
+#endif
+
+  definirAlgorithme(rechercheIA(), DFPN);
+  reinitialiserIA();
+  Analyse a = analyseColonnes(jeu, 1);
+  for (int i = 0; i < NB_COLONNE; i++) {
+    CU_ASSERT_EQUAL(a.jouable[i], exacte.jouable[i]);
+    CU_ASSERT_EQUAL(a.scores[i], exacte.scores[i]);
+  }
+
+  placer("44"); // budget épuisé : alpha-beta
+  definirBudget(r, 100);
+  reinitialiserIA();
+  c = rechercher(r, jeu, 3);
+  CU_ASSERT_TRUE(c.indice >= 0 && c.indice < NB_COLONNE);
+  CU_ASSERT_EQUAL(profondeurAtteinte(r), 3);
+  definirAlgorithme(rechercheIA(), ALGORITHME_DEFAUT);
+  destroyRecherche(r);
+  free(ia);
+  cleanIA();
+}
+
+static CU_TestInfo test_array_preuve[] = {
+    {"vérifie les résultats de df-pn", test_prouver},
+    {"vérifie les recherches des IA avec df-pn", test_rechercheDfpn},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suitePreuve", initSuite, cleanSuite, NULL, NULL, test_array_preuve},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Preuve Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestPreuveSuites() { return suites; }
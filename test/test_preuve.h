@@ -0,0 +1,20 @@
+/**
+ * @file test_preuve.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier preuve.
+ * @version 0.1
+ * @date 2023-02-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_PREUVE_H
+/**
+ * @def TEST_PREUVE_H
+ * @brief la garde
+ */
+#define TEST_PREUVE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestPreuveSuites();
+#endif
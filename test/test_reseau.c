@@ -0,0 +1,369 @@
+/**
+ * @file test_reseau.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier reseau.
+ * @version 0.1
+ * @date 2023-03-07
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/commun.h"
+#include "../src/ia.h"
+#include "../src/puissance_quatre.h"
+#include "../src/reseau.h"
+#include "../src/transposition.h"
+#include "test_reseau.h"
+
+/**
+ * @def FICHIER_RESEAU
+ * @brief le fichier temporaire des poids
+ */
+#define FICHIER_RESEAU "test_reseau.p4r"
+
+/**
+ * @def FICHIER_ARCHIVE
+ * @brief le fichier temporaire de l'archive
+ */
+#define FICHIER_ARCHIVE "test_reseau.p4a"
+
+/**
+ * @def NOM_PARTAGE
+ * @brief le nom de la table de transposition partagée du test
+ */
+#define NOM_PARTAGE "/puissance4_test_reseau"
+
+/**
+ * @def NB_COUPS_TEST
+ * @brief le nombre de coups joués au hasard par partie de test
+ */
+#define NB_COUPS_TEST 200
+
+/**
+ * @brief Tire un entier entre -borne et borne.
+ *
+ * @param graine l'état du générateur
+ * @param borne la borne
+ * @return int l'entier tiré
+ */
+static int tirerEntre(uint64_t *graine, int borne) {
+  return (int)(tirer(graine) % (2 * borne + 1)) - borne;
+}
+
+/**
+ * @brief Crée un réseau aux poids tirés au hasard pour un plateau.
+ *
+ * @param lignes le nombre de lignes du plateau
+ * @param colonnes le nombre de colonnes du plateau
+ * @param graine la graine des poids
+ * @return Reseau* le réseau (à libérer), NULL en cas de problème d'allocation
+ */
+static Reseau *reseauAuHasard(unsigned lignes, unsigned colonnes,
+                              uint64_t graine) {
+  Reseau *r = calloc(1, sizeof(Reseau));
+  if (!r)
+    return NULL;
+  r->lignes = lignes;
+  r->colonnes = colonnes;
+  for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+    r->biais1[k] = tirerEntre(&graine, 64) + 32;
+  for (unsigned e = 0; e < 2 * lignes * colonnes; e++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      r->poids1[e][k] = tirerEntre(&graine, 40);
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    r->biais2[j] = tirerEntre(&graine, 4000);
+    for (unsigned k = 0; k < 2 * RESEAU_CACHEES; k++)
+      r->poids2[j][k] = tirerEntre(&graine, 127);
+    r->poids3[j] = tirerEntre(&graine, 127);
+  }
+  r->biais3 = tirerEntre(&graine, 20000);
+  return r;
+}
+
+/**
+ * @brief Calcule la première couche d'un réseau en parcourant le plateau.
+ *
+ * @param jeu le jeu
+ * @param r le réseau
+ * @param acc la première couche, du point de vue de J1 puis de J2
+ */
+static void accumulateurReference(Puissance4 *jeu, const Reseau *r,
+                                  int32_t acc[2][RESEAU_CACHEES]) {
+  unsigned n = NB_LIGNE * NB_COLONNE;
+  for (unsigned p = 0; p < 2; p++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      acc[p][k] = r->biais1[k];
+  for (unsigned l = 0; l < NB_LIGNE; l++)
+    for (unsigned c = 0; c < NB_COLONNE; c++) {
+      Type t = jeu->plateau[l][c];
+      if (t == VIDE)
+        continue;
+      for (unsigned p = 0; p < 2; p++) {
+        unsigned e = l * NB_COLONNE + c + (t - 1 == p ? 0 : n);
+        for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+          acc[p][k] += r->poids1[e][k];
+      }
+    }
+}
+
+/**
+ * @brief Borne une activation entre 0 et RESEAU_UN.
+ *
+ * @param x l'activation
+ * @return int32_t l'activation bornée
+ */
+static int32_t bornerReference(int32_t x) {
+  return x < 0 ? 0 : x > RESEAU_UN ? RESEAU_UN : x;
+}
+
+/**
+ * @brief Calcule l'évaluation d'un réseau couche par couche (voir Reseau).
+ *
+ * @param acc la première couche (voir accumulateurReference)
+ * @param r le réseau
+ * @param joueur le joueur pour qui évaluer, 0 pour J1 et 1 pour J2
+ * @return int l'évaluation
+ */
+static int evaluationReference(int32_t acc[2][RESEAU_CACHEES],
+                               const Reseau *r, unsigned joueur) {
+  int64_t sortie = r->biais3;
+  for (unsigned j = 0; j < RESEAU_SECONDE; j++) {
+    int64_t somme = r->biais2[j];
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      somme += r->poids2[j][k] * bornerReference(acc[joueur][k]) +
+               r->poids2[j][RESEAU_CACHEES + k] *
+                   bornerReference(acc[1 - joueur][k]);
+    sortie += r->poids3[j] * bornerReference(somme >> RESEAU_DECALAGE);
+  }
+  return sortie * RESEAU_POINTS / (RESEAU_UN << RESEAU_DECALAGE);
+}
+
+/**
+ * @brief Compare l'accumulateur et l'évaluation d'un jeu au calcul de
+ * référence.
+ *
+ * @param jeu le jeu, le joueur courant étant celui qui n'a pas joué
+ * @param r le réseau actif
+ * @return unsigned le nombre de différences
+ */
+static unsigned differences(Puissance4 *jeu, const Reseau *r) {
+  int32_t acc[2][RESEAU_CACHEES];
+  accumulateurReference(jeu, r, acc);
+  unsigned erreurs = 0;
+  for (unsigned p = 0; p < 2; p++)
+    for (unsigned k = 0; k < RESEAU_CACHEES; k++)
+      erreurs += jeu->accumulateur[p][k] != acc[p][k];
+  unsigned precedent = jeu->courant->type == J1 ? 1 : 0;
+  erreurs += evaluation(jeu) != evaluationReference(acc, r, precedent);
+  return erreurs;
+}
+
+/**
+ * @brief Joue une partie au hasard avec un réseau actif, en annulant de temps
+ * en temps le dernier coup, et vérifie l'accumulateur à chaque étape. Avec la
+ * règle Pop Out, des jetons sont aussi retirés puis remis.
+ *
+ * @param L le nombre de lignes du plateau
+ * @param C le nombre de colonnes du plateau
+ * @param A le nombre de pions à aligner
+ * @param regle les règles de la partie
+ */
+static void verifierPartie(unsigned L, unsigned C, unsigned A, Regle regle) {
+  CU_ASSERT_FATAL(definirGeometrie(L, C, A));
+  Reseau *r = reseauAuHasard(L, C, 0x9E3779B97F4A7C15ULL + L * C);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+  CU_ASSERT_FATAL(activerReseau(r));
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *jeu = initPuissance4();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(jeu);
+  jeu->j1 = &j1;
+  jeu->j2 = &j2;
+  jeu->regle = regle;
+  initGame(jeu);
+  changerJoueur(jeu); // J1 au trait
+  uint64_t graine = 0x2545F4914F6CDD1DULL;
+  unsigned erreurs = 0, retraits = 0;
+  for (unsigned i = 0; i < NB_COUPS_TEST && jeu->nb_jetons < L * C; i++) {
+    Type type = jeu->courant->type;
+    unsigned c = tirer(&graine) % C;
+    if (regle == POP_OUT && retraitPossible(jeu, c) && tirer(&graine) % 3) {
+      retirerJeton(jeu, c);
+      changerJoueur(jeu);
+      erreurs += differences(jeu, r);
+      changerJoueur(jeu);
+      remettreJeton(jeu, c, type); // annulé, puis rejoué
+      erreurs += differences(jeu, r);
+      retirerJeton(jeu, c);
+      retraits++;
+    } else {
+      while (ligneLibre(jeu, c) == -1)
+        c = (c + 1) % C;
+      int l = ligneLibre(jeu, c);
+      modifJeton(jeu, l, c, type);
+      if (tirer(&graine) % 4 == 0) { // annulé, puis rejoué
+        modifJeton(jeu, l, c, VIDE);
+        erreurs += differences(jeu, r);
+        modifJeton(jeu, l, c, type);
+      }
+    }
+    changerJoueur(jeu);
+    erreurs += differences(jeu, r);
+  }
+  CU_ASSERT_EQUAL(erreurs, 0);
+  CU_ASSERT_TRUE(regle == STANDARD || retraits > 0);
+  initGame(jeu); // l'accumulateur revient aux biais
+  for (unsigned p = 0; p < 2; p++)
+    erreurs += memcmp(jeu->accumulateur[p], r->biais1, sizeof(r->biais1)) != 0;
+  CU_ASSERT_EQUAL(erreurs, 0);
+  activerReseau(NULL);
+  free(jeu);
+  free(r);
+}
+
+/**
+ * @brief Vérifie la première couche tenue à jour jeton par jeton et
+ * l'évaluation par le réseau contre un calcul direct, sur le plateau
+ * standard, sur un plateau dont les bitboards ont plusieurs mots et sur le
+ * plus grand plateau, ainsi qu'avec la règle Pop Out.
+ */
+void test_reseauAccumulateur(void) {
+  verifierPartie(6, 7, 4, STANDARD);
+  verifierPartie(7, 9, 4, STANDARD);
+  verifierPartie(15, 15, 5, STANDARD);
+  verifierPartie(6, 7, 4, POP_OUT);
+  verifierPartie(10, 10, 4, POP_OUT);
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+}
+
+/**
+ * @brief Vérifie l'écriture puis la lecture des poids, le refus d'un fichier
+ * qui n'est pas un réseau et d'un réseau fait pour un autre plateau, et le
+ * chargement par les IA.
+ */
+void test_reseauFichier(void) {
+  CU_ASSERT_FATAL(definirGeometrie(6, 7, 4));
+  Reseau *r = reseauAuHasard(6, 7, 42);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+  CU_ASSERT_FATAL(ecrireReseau(r, FICHIER_RESEAU));
+  Reseau *lu = lireReseau(FICHIER_RESEAU);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(lu);
+  CU_ASSERT_EQUAL(memcmp(r, lu, sizeof(Reseau)), 0);
+  free(lu);
+
+  // les IA évaluent avec le réseau chargé, qui est oublié sur un autre plateau
+  CU_ASSERT_TRUE(chargerReseauIA(FICHIER_RESEAU));
+  CU_ASSERT_PTR_NOT_NULL(reseauActif);
+  CU_ASSERT_TRUE(definirGeometrie(7, 9, 4));
+  CU_ASSERT_PTR_NULL(reseauActif);
+  CU_ASSERT_FALSE(activerReseau(r));
+  CU_ASSERT_FALSE(chargerReseauIA(FICHIER_RESEAU));
+  CU_ASSERT_PTR_NULL(reseauActif);
+  CU_ASSERT_TRUE(definirGeometrie(6, 7, 4));
+  CU_ASSERT_TRUE(chargerReseauIA(NULL));
+
+  // un fichier tronqué ou d'un autre format
+  FILE *f = fopen(FICHIER_RESEAU, "r+b");
+  CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+  fputc('X', f);
+  fclose(f);
+  CU_ASSERT_PTR_NULL(lireReseau(FICHIER_RESEAU));
+  CU_ASSERT_FALSE(chargerReseauIA(FICHIER_RESEAU));
+  CU_ASSERT_PTR_NULL(reseauActif);
+  remove(FICHIER_RESEAU);
+  CU_ASSERT_PTR_NULL(lireReseau(FICHIER_RESEAU));
+  free(r);
+}
+
+/**
+ * @brief Vérifie que les résultats calculés avec le réseau ne servent pas aux
+ * recherches avec l'heuristique, ni par l'archive ni par une table partagée,
+ * et que la fin des IA ne vide pas la table partagée.
+ */
+void test_reseauResultats(void) {
+  CU_ASSERT_FATAL(definirGeometrie(6, 7, 4));
+  Reseau *r = reseauAuHasard(6, 7, 7);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(r);
+  CU_ASSERT_FATAL(ecrireReseau(r, FICHIER_RESEAU));
+  free(r);
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_ARCHIVE ".journal");
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  Transposition *autre = makeTranspositionPartagee(NOM_PARTAGE, 1 << 16);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(autre); // celle d'un autre processus
+  stockerTransposition(autre, 42, 4, 3, -5, EXACTE);
+  int coup, valeur;
+  unsigned char profondeur;
+  Borne borne;
+
+  Joueur j1 = {J1, 0, 0, NULL}, j2 = {J2, 0, 0, NULL};
+  Puissance4 *jeu = initPuissance4();
+  CU_ASSERT_PTR_NOT_NULL_FATAL(jeu);
+  jeu->j1 = &j1;
+  jeu->j2 = &j2;
+  Recherche *recherche = makeRecherche();
+  CU_ASSERT_TRUE(partagerTableIA(NOM_PARTAGE));
+  CU_ASSERT_TRUE(chargerArchiveIA(FICHIER_ARCHIVE));
+  CU_ASSERT_TRUE(chargerReseauIA(FICHIER_RESEAU));
+  Joueur *ia = makeIA(J1, '3');
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  rechercher(recherche, jeu, 4); // archivée et rangée dans la table partagée
+  CU_ASSERT_FALSE(sonderTransposition(autre, cleCanonique(jeu, NULL), &coup,
+                                      &valeur, &profondeur, &borne));
+
+  // avec l'heuristique, l'archive ne répond pas ; de nouveau avec le réseau,
+  // elle répond
+  CU_ASSERT_TRUE(chargerReseauIA(NULL));
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  rechercher(recherche, jeu, 4);
+#ifndef SANS_STATS
+  CU_ASSERT_TRUE(statsRecherche(recherche).noeuds > 0);
+#endif
+  CU_ASSERT_TRUE(chargerReseauIA(FICHIER_RESEAU));
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  rechercher(recherche, jeu, 4);
+#ifndef SANS_STATS
+  CU_ASSERT_EQUAL(statsRecherche(recherche).noeuds, 0);
+#endif
+
+  free(ia);
+  destroyRecherche(recherche);
+  cleanIA(); // sans vider la table partagée
+  CU_ASSERT_TRUE(sonderTransposition(autre, 42, &coup, &valeur, &profondeur,
+                                     &borne));
+  destroyTransposition(autre);
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  free(jeu);
+  remove(FICHIER_ARCHIVE);
+  remove(FICHIER_ARCHIVE ".journal");
+  remove(FICHIER_RESEAU);
+}
+
+static CU_TestInfo test_array_reseau[] = {
+    {"vérifie la première couche tenue à jour et l'évaluation",
+     test_reseauAccumulateur},
+    {"vérifie la lecture et l'écriture des poids", test_reseauFichier},
+    {"vérifie les résultats du réseau dans l'archive et la table partagée",
+     test_reseauResultats},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteReseau", NULL, NULL, NULL, NULL, test_array_reseau},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Reseau Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestReseauSuites() { return suites; }
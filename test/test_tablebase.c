@@ -0,0 +1,146 @@
+/**
+ * @file test_tablebase.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier tablebase.
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/ia.h"
+#include "../src/tablebase.h"
+#include "../src/transposition.h"
+#include "test_p4.h"
+#include "test_tablebase.h"
+
+/**
+ * @brief Un pointeur sur le jeu (extern : celui dans test_p4.c)
+ *
+ */
+extern Puissance4 *jeu;
+
+/**
+ * @def RACINE
+ * @brief une position de 28 jetons dont la table se calcule vite
+ */
+#define RACINE "2536244324367571423341636672"
+
+/**
+ * @def FICHIER_TABLE
+ * @brief le fichier temporaire de la table
+ */
+#define FICHIER_TABLE "test_tablebase.p4t"
+
+/**
+ * @def NOM_PARTAGE
+ * @brief le nom de la table de transposition partagée du test
+ */
+#define NOM_PARTAGE "/puissance4_test_finales"
+
+/**
+ * @brief Joue des coups depuis le plateau vide.
+ *
+ * @param coups les colonnes jouées (de 1 à 7)
+ * @return true si le dernier coup fait gagner
+ */
+static bool placer(const char *coups) {
+  initGame(jeu);
+  jeu->courant = jeu->j1;
+  bool fin = false;
+  for (const char *c = coups; *c; c++) {
+    int l = testColonne(jeu->plateau, *c - '1');
+    modifJeton(jeu, l, *c - '1', jeu->courant->type);
+    fin = testEnd(jeu, l, *c - '1');
+    changerJoueur(jeu);
+  }
+  return fin;
+}
+
+/**
+ * @brief Vérifie les résultats de la table des finales contre une recherche
+ * complète, sur la position de départ et ses suites.
+ */
+void test_tableFinale(void) {
+  CU_ASSERT_FALSE(genererTableFinale("4444444", 0, 2, FICHIER_TABLE, NULL));
+  CU_ASSERT_FATAL(genererTableFinale(RACINE, 28, 2, FICHIER_TABLE, NULL));
+  TableFinale *t = ouvrirTableFinale(FICHIER_TABLE);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(t);
+  CU_ASSERT_EQUAL(jetonsTableFinale(t), 28);
+  CU_ASSERT_TRUE(tailleTableFinale(t) > 0);
+
+  Recherche *r = makeRecherche();
+  char coups[] = RACINE "0";
+  for (int c = 0; c <= NB_COLONNE; c++) {
+    // c == NB_COLONNE : la position de départ elle-même
+    coups[sizeof(coups) - 2] = (c < NB_COLONNE) ? '1' + c : '\0';
+    placer(RACINE);
+    if (c < NB_COLONNE && testColonne(jeu->plateau, c) < 0)
+      continue;
+    if (placer(coups))
+      continue; // partie terminée : pas dans la table
+    Resultat res = sonderTableFinale(t, cleCanonique(jeu, NULL));
+    reinitialiserIA();
+    int v = rechercher(r, jeu, NB_LIGNE * NB_COLONNE - jeu->nb_jetons).valeur;
+    CU_ASSERT_EQUAL(res, (v > 0) ? GAGNE : (v < 0) ? PERDU : NUL);
+  }
+
+  placer("44");
+  CU_ASSERT_EQUAL(sonderTableFinale(t, cleCanonique(jeu, NULL)), INCONNU);
+  fermerTableFinale(t);
+
+  // consultée par minimax : exacte dès la profondeur 1
+  placer(RACINE);
+  reinitialiserIA();
+  int exacte = rechercher(r, jeu, NB_LIGNE * NB_COLONNE - jeu->nb_jetons).valeur;
+  CU_ASSERT_TRUE(chargerTableIA(FICHIER_TABLE));
+  CU_ASSERT_EQUAL(rechercher(r, jeu, 1).valeur, exacte);
+#ifndef SANS_STATS
+  CU_ASSERT_TRUE(statsRecherche(r).finales > 0);
+#endif
+  CU_ASSERT_FALSE(chargerTableIA("inexistant.p4t"));
+  chargerTableIA(NULL);
+  destroyRecherche(r);
+  cleanIA();
+
+  // une table partagée survit au chargement et à la fin des IA
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  Transposition *autre = makeTranspositionPartagee(NOM_PARTAGE, 1 << 16);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(autre); // celle d'un autre processus
+  stockerTransposition(autre, 42, 4, 3, -5, EXACTE);
+  CU_ASSERT_TRUE(partagerTableIA(NOM_PARTAGE));
+  Joueur *ia = makeIA(J1, '3');
+  CU_ASSERT_TRUE(chargerTableIA(FICHIER_TABLE));
+  reinitialiserIA();
+  free(ia);
+  cleanIA();
+  int coup, valeur;
+  unsigned char profondeur;
+  Borne borne;
+  CU_ASSERT_TRUE(sonderTransposition(autre, 42, &coup, &valeur, &profondeur,
+                                     &borne));
+  destroyTransposition(autre);
+  supprimerTranspositionPartagee(NOM_PARTAGE);
+  remove(FICHIER_TABLE);
+}
+
+static CU_TestInfo test_array_tablebase[] = {
+    {"vérifie la table des finales et sa consultation par les IA",
+     test_tableFinale},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteTablebase", initSuite, cleanSuite, NULL, NULL, test_array_tablebase},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Tablebase Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestTablebaseSuites() { return suites; }
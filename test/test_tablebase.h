@@ -0,0 +1,20 @@
+/**
+ * @file test_tablebase.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier tablebase.
+ * @version 0.1
+ * @date 2023-02-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_TABLEBASE_H
+/**
+ * @def TEST_TABLEBASE_H
+ * @brief la garde
+ */
+#define TEST_TABLEBASE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestTablebaseSuites();
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file test_trace.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier trace.
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/trace.h"
+#include "test_trace.h"
+
+/**
+ * @def FICHIER_TRACE
+ * @brief le fichier de trace des tests (supprimé à la fin)
+ */
+#define FICHIER_TRACE "test_trace.json"
+
+/**
+ * @brief Enregistre un événement depuis un autre thread.
+ *
+ * @param arg inutilisé
+ * @return void* NULL
+ */
+static void *tracerThread(void *arg) {
+  finTrace("thread", debutTrace(), SANS_VALEUR);
+  return NULL;
+}
+
+/**
+ * @brief Compte les occurrences d'un motif dans un fichier.
+ *
+ * @param f le fichier
+ * @param motif le motif
+ * @return int le nombre d'occurrences
+ */
+static int compter(FILE *f, const char *motif) {
+  char ligne[256];
+  int n = 0;
+  rewind(f);
+  while (fgets(ligne, sizeof(ligne), f))
+    for (char *p = strstr(ligne, motif); p; p = strstr(p + 1, motif))
+      n++;
+  return n;
+}
+
+/**
+ * @brief Vérifie que les événements de plusieurs threads sont écrits à la fin
+ * de la trace, et seulement ceux enregistrés pendant la trace.
+ */
+void test_trace(void) {
+  finTrace("avant", debutTrace(), SANS_VALEUR);
+  CU_ASSERT_EQUAL(debutTrace(), 0);
+  CU_ASSERT_TRUE(demarrerTrace(FICHIER_TRACE));
+  CU_ASSERT_FALSE(demarrerTrace(FICHIER_TRACE));
+  finTrace("principal", debutTrace(), 4);
+  for (int i = 0; i < 2; i++) { // le second thread reprend le tampon du premier
+    pthread_t t;
+    CU_ASSERT_EQUAL(pthread_create(&t, NULL, &tracerThread, NULL), 0);
+    pthread_join(t, NULL);
+  }
+  terminerTrace();
+  finTrace("apres", debutTrace(), SANS_VALEUR);
+  terminerTrace();
+
+  FILE *f = fopen(FICHIER_TRACE, "r");
+  CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+  CU_ASSERT_EQUAL(compter(f, "\"ph\":\"X\""), 3);
+  CU_ASSERT_EQUAL(compter(f, "\"name\":\"thread\""), 2);
+  CU_ASSERT_EQUAL(compter(f, "\"args\":{\"valeur\":4}"), 1);
+  CU_ASSERT_EQUAL(compter(f, "\"tid\":1,"), 1);
+  CU_ASSERT_EQUAL(compter(f, "\"tid\":2,"), 2);
+  CU_ASSERT_EQUAL(compter(f, "avant"), 0);
+  CU_ASSERT_EQUAL(compter(f, "apres"), 0);
+  fclose(f);
+  remove(FICHIER_TRACE);
+}
+
+static CU_TestInfo test_array_trace[] = {
+    {"vérifie l'écriture d'une trace de plusieurs threads", test_trace},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteTrace", NULL, NULL, NULL, NULL, test_array_trace},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Trace Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestTraceSuites() { return suites; }
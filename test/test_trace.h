@@ -0,0 +1,20 @@
+/**
+ * @file test_trace.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier trace.
+ * @version 0.1
+ * @date 2023-02-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_TRACE_H
+/**
+ * @def TEST_TRACE_H
+ * @brief la garde
+ */
+#define TEST_TRACE_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestTraceSuites();
+#endif
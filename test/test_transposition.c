@@ -0,0 +1,129 @@
+/**
+ * @file test_transposition.c
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Tests unitaires du fichier transposition.
+ * @version 0.1
+ * @date 2023-03-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/transposition.h"
+#include "test_transposition.h"
+
+/**
+ * @def NOM_PARTAGE
+ * @brief le nom de la table partagée des tests (supprimée à la fin)
+ */
+#define NOM_PARTAGE "/test_puissance4_transposition"
+
+/**
+ * @brief Vérifie qu'une position est dans une table avec ce résultat.
+ *
+ * @param table la table
+ * @param cle la clé de la position
+ * @param coup le meilleur coup attendu
+ * @param valeur la valeur attendue
+ * @return true si la position est trouvée avec ce coup et cette valeur
+ * @return false sinon
+ */
+static bool trouvee(Transposition *table, uint64_t cle, int coup, int valeur) {
+  int c, v;
+  unsigned char p;
+  Borne b;
+  return sonderTransposition(table, cle, &c, &v, &p, &b) && c == coup &&
+         v == valeur;
+}
+
+/**
+ * @brief Vérifie le stockage, le remplacement et l'effacement d'une table
+ * propre au processus.
+ */
+void test_transposition(void) {
+  Transposition *table = makeTransposition(1024);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(table);
+  CU_ASSERT_PTR_NULL(nomTransposition(table));
+  CU_ASSERT_EQUAL(octetsTransposition(table), 1024 * 8);
+  CU_ASSERT_FALSE(trouvee(table, 42, 3, -5));
+  stockerTransposition(table, 42, 4, 3, -5, EXACTE);
+  CU_ASSERT_TRUE(trouvee(table, 42, 3, -5));
+  stockerTransposition(table, 42, 6, -1, 12, INFERIEURE);
+  CU_ASSERT_TRUE(trouvee(table, 42, -1, 12));
+  viderTransposition(table);
+  CU_ASSERT_FALSE(trouvee(table, 42, -1, 12));
+  destroyTransposition(table);
+}
+
+/**
+ * @brief Vérifie qu'une table partagée est vue par toutes ses ouvertures, y
+ * compris dans un autre processus, garde la taille de sa création, n'est pas
+ * vidée et sépare les entrées de sels différents.
+ */
+void test_partage(void) {
+  supprimerTranspositionPartagee(NOM_PARTAGE); // reste d'un test interrompu
+  Transposition *a = makeTranspositionPartagee(NOM_PARTAGE, 1 << 16);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+  Transposition *b = makeTranspositionPartagee(NOM_PARTAGE, 1 << 10);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+  CU_ASSERT_STRING_EQUAL(nomTransposition(b), NOM_PARTAGE);
+  CU_ASSERT_EQUAL(octetsTransposition(b), octetsTransposition(a));
+
+  stockerTransposition(a, 42, 4, 3, -5, EXACTE);
+  CU_ASSERT_TRUE(trouvee(b, 42, 3, -5));
+  pid_t fils = fork();
+  CU_ASSERT_FATAL(fils != -1);
+  if (fils == 0) { // écrit dans sa propre ouverture, puis s'arrête
+    Transposition *c = makeTranspositionPartagee(NOM_PARTAGE, 1);
+    if (!c || !trouvee(c, 42, 3, -5))
+      _exit(1);
+    for (uint64_t cle = 1000; cle < 1100; cle++)
+      stockerTransposition(c, cle, 2, cle % 7, (int)cle, EXACTE);
+    destroyTransposition(c);
+    _exit(0);
+  }
+  int statut;
+  CU_ASSERT_EQUAL(waitpid(fils, &statut, 0), fils);
+  CU_ASSERT_TRUE(WIFEXITED(statut) && WEXITSTATUS(statut) == 0);
+  bool toutes = true;
+  for (uint64_t cle = 1000; cle < 1100; cle++)
+    toutes = toutes && trouvee(a, cle, cle % 7, (int)cle);
+  CU_ASSERT_TRUE(toutes);
+
+  // jamais vidée par un processus ; un autre sel ne voit pas les entrées
+  viderTransposition(b);
+  CU_ASSERT_TRUE(trouvee(a, 42, 3, -5));
+  salerTransposition(b, 0x1234);
+  CU_ASSERT_FALSE(trouvee(b, 42, 3, -5));
+  stockerTransposition(b, 42, 5, 1, 7, EXACTE);
+  CU_ASSERT_TRUE(trouvee(b, 42, 1, 7));
+  CU_ASSERT_TRUE(trouvee(a, 42, 3, -5));
+  destroyTransposition(b);
+  destroyTransposition(a);
+  CU_ASSERT_TRUE(supprimerTranspositionPartagee(NOM_PARTAGE));
+  CU_ASSERT_FALSE(supprimerTranspositionPartagee(NOM_PARTAGE));
+}
+
+static CU_TestInfo test_array_transposition[] = {
+    {"vérifie le stockage dans la table de transposition", test_transposition},
+    {"vérifie le partage de la table entre processus", test_partage},
+    CU_TEST_INFO_NULL};
+
+static CU_SuiteInfo suites[2] = {
+    {"suiteTransposition", NULL, NULL, NULL, NULL, test_array_transposition},
+    CU_SUITE_INFO_NULL};
+
+/**
+ * @brief Get the Test Transposition Suites object
+ *
+ * @return CU_SuiteInfo* un tableau avec une suite de tests
+ */
+CU_SuiteInfo *getTestTranspositionSuites() { return suites; }
@@ -0,0 +1,20 @@
+/**
+ * @file test_transposition.h
+ * @author Zoé Marquis (zoe_marquis@ens.univ-artois.fr)
+ * @author Enzo Nulli (enzo_nulli@ens.univ-artois.fr)
+ * @brief Définition des fonctions de tests unitaires du fichier transposition.
+ * @version 0.1
+ * @date 2023-03-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TEST_TRANSPOSITION_H
+/**
+ * @def TEST_TRANSPOSITION_H
+ * @brief la garde
+ */
+#define TEST_TRANSPOSITION_H
+#include <CUnit/Basic.h>
+CU_SuiteInfo *getTestTranspositionSuites();
+#endif